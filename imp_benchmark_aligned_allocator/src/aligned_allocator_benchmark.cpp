@@ -23,13 +23,76 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstdint>
+#include <deque>
 #include <iostream>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 #include <ze/common/logging.hpp>
 #include <ze/common/timer.hpp>
 #include <ze/common/timer_statistics.hpp>
+#include <imp/core/image_pool.hpp>
 #include <imp/core/image_raw.hpp>
 
+DEFINE_int32(num_threads, 4, "Number of threads allocating frames concurrently.");
+DEFINE_int32(num_frames, 2000, "Number of frames allocated per thread.");
+DEFINE_int32(pipeline_depth, 3, "Number of frames alive per thread.");
+
+namespace {
+
+//! Every thread allocates frames of varying size (1-4 MB), writes them and
+//! keeps the last few alive, as a multi-camera frontend does.
+void frameChurn(bool use_pool)
+{
+  ze::ImagePool& pool = ze::ImagePool::instance();
+  pool.clear();
+  pool.resetStatistics();
+  pool.setEnabled(use_pool);
+
+  const std::vector<ze::Size2u> sizes = {
+    {1280u, 1024u}, {2048u, 1536u}, {1024u, 1024u}, {2048u, 2048u} };
+
+  ze::Timer timer;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < FLAGS_num_threads; ++t)
+  {
+    threads.emplace_back([&sizes, t]()
+    {
+      std::deque<ze::ImageRaw8uC1::Ptr> alive;
+      for (int i = 0; i < FLAGS_num_frames; ++i)
+      {
+        const ze::Size2u& size = sizes[(i + t) % sizes.size()];
+        alive.push_back(std::make_shared<ze::ImageRaw8uC1>(size));
+        alive.back()->setValue(ze::Pixel8uC1(i % 256));
+        if (static_cast<int>(alive.size()) > FLAGS_pipeline_depth)
+        {
+          alive.pop_front();
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+  const ze::real_t total_ms = timer.stopAndGetMilliseconds();
+
+  const ze::ImagePoolStatistics stats = pool.statistics();
+  VLOG(1) << (use_pool ? "image pool" : "posix_memalign")
+          << " frame churn (" << FLAGS_num_threads << " threads): "
+          << total_ms << "ms total, "
+          << total_ms / (FLAGS_num_threads * FLAGS_num_frames) << "ms per frame"
+          << "\n  allocations: " << stats.num_allocations
+          << ", thread cache hits: " << stats.num_thread_hits
+          << ", pool hits: " << stats.num_pool_hits
+          << ", frees: " << stats.num_frees
+          << ", cached: " << stats.cached_bytes / (1024 * 1024) << "MB";
+  pool.clear();
+  pool.setEnabled(true);
+}
+
+} // unnamed namespace
+
 int main(int argc, char* argv[])
 {
   google::InitGoogleLogging(argv[0]);
@@ -65,7 +128,27 @@ int main(int argc, char* argv[])
       std::uint8_t* p_data_aligned = (std::uint8_t*)aligned_alloc(memaddr_align, memory_size);
       free(p_data_aligned);
     }
-    VLOG(1) << "posix_memalign: " << timer.mean() << "ms";
+    VLOG(1) << "aligned_alloc: " << timer.mean() << "ms";
+  }
+
+  {
+    ze::ImagePool& pool = ze::ImagePool::instance();
+    ze::ImagePoolKey key;
+    key.pixel_type = ze::PixelType::i8uC1;
+    key.width = 1000u;
+    key.height = 1000u;
+    key.pitch = 1024u;
+    ze::TimerStatistics timer;
+    for (std::uint64_t i=0; i<num_rounds; ++i)
+    {
+      __attribute__((unused)) auto t = timer.timeScope();
+      void* p_data_aligned = pool.acquire(key);
+      pool.release(key, p_data_aligned);
+    }
+    VLOG(1) << "image pool: " << timer.mean() << "ms";
+    pool.clear();
   }
 
+  frameChurn(false);
+  frameChurn(true);
 }
@@ -35,24 +35,10 @@
 namespace ze {
 
 //------------------------------------------------------------------------------
+//! Converts a gray or BGR image loaded by OpenCV to the given pixel type.
 template<typename Pixel>
-void cvBridgeLoad(ImageCvPtr<Pixel>& out,
-                  const std::string& filename, PixelOrder pixel_order)
+void cvBridgeFromMat(ImageCvPtr<Pixel>& out, cv::Mat& mat, PixelOrder pixel_order)
 {
-  CHECK(fileExists(filename)) << "File does not exist: " << filename;
-  cv::Mat mat;
-  if (pixel_order == PixelOrder::gray)
-  {
-    mat = cv::imread(filename, cv::IMREAD_GRAYSCALE);
-    CHECK(!mat.empty());
-  }
-  else
-  {
-    // everything else needs color information :)
-    mat = cv::imread(filename, cv::IMREAD_COLOR);
-    CHECK(!mat.empty());
-  }
-
   switch(pixel_type<Pixel>::type)
   {
   case PixelType::i8uC1:
@@ -80,6 +66,42 @@ void cvBridgeLoad(ImageCvPtr<Pixel>& out,
   }
 }
 
+//------------------------------------------------------------------------------
+template<typename Pixel>
+void cvBridgeLoad(ImageCvPtr<Pixel>& out,
+                  const std::string& filename, PixelOrder pixel_order)
+{
+  CHECK(fileExists(filename)) << "File does not exist: " << filename;
+  cv::Mat mat;
+  if (pixel_order == PixelOrder::gray)
+  {
+    mat = cv::imread(filename, cv::IMREAD_GRAYSCALE);
+    CHECK(!mat.empty());
+  }
+  else
+  {
+    // everything else needs color information :)
+    mat = cv::imread(filename, cv::IMREAD_COLOR);
+    CHECK(!mat.empty());
+  }
+  cvBridgeFromMat(out, mat, pixel_order);
+}
+
+//------------------------------------------------------------------------------
+//! Decodes an image file (e.g. png) that is stored in memory.
+template<typename Pixel>
+void cvBridgeDecode(ImageCvPtr<Pixel>& out,
+                    const uint8_t* data, size_t num_bytes, PixelOrder pixel_order)
+{
+  CHECK_NOTNULL(data);
+  const cv::Mat buffer(1, static_cast<int>(num_bytes), CV_8UC1,
+                       const_cast<uint8_t*>(data));
+  cv::Mat mat = cv::imdecode(buffer, (pixel_order == PixelOrder::gray)
+                                     ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+  CHECK(!mat.empty());
+  cvBridgeFromMat(out, mat, pixel_order);
+}
+
 //------------------------------------------------------------------------------
 template<typename Pixel>
 void cvBridgeSave(const std::string& filename, const ImageCv<Pixel>& img, bool normalize=false)
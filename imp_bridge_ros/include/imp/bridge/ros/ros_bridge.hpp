@@ -32,10 +32,18 @@ namespace ze {
 std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
     const std::string& encoding);
 
+//! Returns a deep copy of the image message.
 ImageBase::Ptr toImageCpu(
     const sensor_msgs::Image& src,
     PixelOrder pixel_order = PixelOrder::undefined);
 
+//! Returns an image that aliases the message buffer without copying. The
+//! returned image keeps the message alive. As messages may be shared with
+//! other subscribers, the image data must not be modified.
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::ImageConstPtr& src,
+    PixelOrder pixel_order = PixelOrder::undefined);
+
 ImageBase::Ptr toImageGpu(
     const sensor_msgs::Image& src,
     PixelOrder pixel_order = PixelOrder::undefined);
@@ -80,18 +80,96 @@ std::pair<PixelType, PixelOrder> getPixelTypeFromRosImageEncoding(
   {
     return std::make_pair(PixelType::i16uC4, PixelOrder::rgba);
   }
+  else if (encoding == imgenc::TYPE_8UC1)
+  {
+    return std::make_pair(PixelType::i8uC1, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_8UC2)
+  {
+    return std::make_pair(PixelType::i8uC2, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_8UC3)
+  {
+    return std::make_pair(PixelType::i8uC3, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_8UC4)
+  {
+    return std::make_pair(PixelType::i8uC4, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_16UC1)
+  {
+    return std::make_pair(PixelType::i16uC1, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_16UC2)
+  {
+    return std::make_pair(PixelType::i16uC2, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_16UC3)
+  {
+    return std::make_pair(PixelType::i16uC3, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_16UC4)
+  {
+    return std::make_pair(PixelType::i16uC4, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_32FC1)
+  {
+    return std::make_pair(PixelType::i32fC1, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_32FC2)
+  {
+    return std::make_pair(PixelType::i32fC2, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_32FC3)
+  {
+    return std::make_pair(PixelType::i32fC3, PixelOrder::undefined);
+  }
+  else if (encoding == imgenc::TYPE_32FC4)
+  {
+    return std::make_pair(PixelType::i32fC4, PixelOrder::undefined);
+  }
   LOG(FATAL) << "Unsupported image encoding " + encoding + ".";
   return std::make_pair(PixelType::undefined, PixelOrder::undefined);
 }
 
+namespace {
+
 //------------------------------------------------------------------------------
-ImageBase::Ptr toImageCpu(
-    const sensor_msgs::Image& src, PixelOrder /*pixel_order*/)
+//! Wraps the message data. If tracked is given, the image aliases the message
+//! buffer and keeps tracked alive, otherwise the data is deep copied.
+template<typename Pixel>
+ImageBase::Ptr wrapImage(
+    const sensor_msgs::Image& src,
+    PixelOrder pixel_order,
+    const std::shared_ptr<void const>& tracked)
+{
+  CHECK_EQ(src.step % sizeof(Pixel), 0u)
+      << "Row length is not a multiple of the pixel size.";
+  Pixel* data = reinterpret_cast<Pixel*>(const_cast<uint8_t*>(&src.data[0]));
+  if (tracked)
+  {
+    return std::make_shared<ImageRaw<Pixel>>(
+          data, src.width, src.height, src.step, tracked, pixel_order);
+  }
+  ImageRaw<Pixel> src_wrapped(
+        data, src.width, src.height, src.step, true, pixel_order);
+  return std::make_shared<ImageRaw<Pixel>>(src_wrapped); // Deep copy of the image data.
+}
+
+//------------------------------------------------------------------------------
+ImageBase::Ptr toImageCpuImpl(
+    const sensor_msgs::Image& src,
+    PixelOrder pixel_order,
+    const std::shared_ptr<void const>& tracked)
 {
   PixelType src_pixel_type;
   PixelOrder src_pixel_order;
   std::tie(src_pixel_type, src_pixel_order) =
       getPixelTypeFromRosImageEncoding(src.encoding);
+  if (pixel_order == PixelOrder::undefined)
+  {
+    pixel_order = src_pixel_order;
+  }
 
   int bit_depth = imgenc::bitDepth(src.encoding);
   int num_channels = imgenc::numChannels(src.encoding);
@@ -101,56 +179,35 @@ ImageBase::Ptr toImageCpu(
 
   // sanity check
   CHECK_GE(pitch, width * num_channels * bit_depth/8) << "Input image seem to wrongly formatted";
+  CHECK_GE(src.data.size(), pitch * height) << "Input image seem to wrongly formatted";
+  CHECK(bit_depth == 8 || !src.is_bigendian) << "Big endian images are not supported.";
 
   switch (src_pixel_type)
   {
     case PixelType::i8uC1:
-    {
-      ImageRaw8uC1 src_wrapped(
-          reinterpret_cast<Pixel8uC1*>(const_cast<uint8_t*>(&src.data[0])),
-          width, height, pitch, true, PixelOrder::gray);
-      ImageRaw8uC1::Ptr dst =
-          std::make_shared<ImageRaw8uC1>(src_wrapped); // Deep copy of the image data.
-      return dst;
-    }
-//  case imp::PixelType::i8uC2:
-//  { } break;
-//  case imp::PixelType::i8uC3:
-//  { } break;
-//  case imp::PixelType::i8uC4:
-//  { } break;
-//  case imp::PixelType::i16uC1:
-//  { } break;
-//  case imp::PixelType::i16uC2:
-//  { } break;
-//  case imp::PixelType::i16uC3:
-//  { } break;
-//  case imp::PixelType::i16uC4:
-//  { } break;
-//  case imp::PixelType::i32uC1:
-//  { } break;
-//  case imp::PixelType::i32uC2:
-//  { } break;
-//  case imp::PixelType::i32uC3:
-//  { } break;
-//  case imp::PixelType::i32uC4:
-//  { } break;
-//  case imp::PixelType::i32sC1:
-//  { } break;
-//  case imp::PixelType::i32sC2:
-//  { } break;
-//  case imp::PixelType::i32sC3:
-//  { } break;
-//  case imp::PixelType::i32sC4:
-//  { } break;
-//  case imp::PixelType::i32fC1:
-//  { } break;
-//  case imp::PixelType::i32fC2:
-//  { } break;
-//  case imp::PixelType::i32fC3:
-//  { } break;
-//  case imp::PixelType::i32fC4:
-//  { } break;
+      return wrapImage<Pixel8uC1>(src, pixel_order, tracked);
+    case PixelType::i8uC2:
+      return wrapImage<Pixel8uC2>(src, pixel_order, tracked);
+    case PixelType::i8uC3:
+      return wrapImage<Pixel8uC3>(src, pixel_order, tracked);
+    case PixelType::i8uC4:
+      return wrapImage<Pixel8uC4>(src, pixel_order, tracked);
+    case PixelType::i16uC1:
+      return wrapImage<Pixel16uC1>(src, pixel_order, tracked);
+    case PixelType::i16uC2:
+      return wrapImage<Pixel16uC2>(src, pixel_order, tracked);
+    case PixelType::i16uC3:
+      return wrapImage<Pixel16uC3>(src, pixel_order, tracked);
+    case PixelType::i16uC4:
+      return wrapImage<Pixel16uC4>(src, pixel_order, tracked);
+    case PixelType::i32fC1:
+      return wrapImage<Pixel32fC1>(src, pixel_order, tracked);
+    case PixelType::i32fC2:
+      return wrapImage<Pixel32fC2>(src, pixel_order, tracked);
+    case PixelType::i32fC3:
+      return wrapImage<Pixel32fC3>(src, pixel_order, tracked);
+    case PixelType::i32fC4:
+      return wrapImage<Pixel32fC4>(src, pixel_order, tracked);
     default:
     {
       LOG(FATAL) << "Unsupported pixel type" + src.encoding + ".";
@@ -160,4 +217,25 @@ ImageBase::Ptr toImageCpu(
   return nullptr;
 }
 
+} // unnamed namespace
+
+//------------------------------------------------------------------------------
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::Image& src, PixelOrder pixel_order)
+{
+  return toImageCpuImpl(src, pixel_order, nullptr);
+}
+
+//------------------------------------------------------------------------------
+ImageBase::Ptr toImageCpu(
+    const sensor_msgs::ImageConstPtr& src, PixelOrder pixel_order)
+{
+  CHECK(src);
+  // The deleter holds a reference to the message, whose shared pointer type
+  // is not std::shared_ptr.
+  std::shared_ptr<void const> tracked(
+        src.get(), [src](void const*) {});
+  return toImageCpuImpl(*src, pixel_order, tracked);
+}
+
 } // namespace ze
@@ -0,0 +1,189 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <string>
+
+#include <boost/weak_ptr.hpp>
+#include <sensor_msgs/image_encodings.h>
+
+#include <imp/bridge/ros/ros_bridge.hpp>
+#include <imp/core/image_raw.hpp>
+#include <ze/common/test_entrypoint.hpp>
+
+namespace {
+
+namespace imgenc = sensor_msgs::image_encodings;
+
+// Message with padded rows and a byte pattern as content.
+sensor_msgs::ImagePtr createMessage(
+    const std::string& encoding, uint32_t width, uint32_t height,
+    uint32_t pixel_size)
+{
+  sensor_msgs::ImagePtr msg(new sensor_msgs::Image);
+  msg->encoding = encoding;
+  msg->width = width;
+  msg->height = height;
+  msg->step = (width + 2) * pixel_size;
+  msg->is_bigendian = 0;
+  msg->data.resize(msg->step * height);
+  for (size_t i = 0; i < msg->data.size(); ++i)
+  {
+    msg->data[i] = static_cast<uint8_t>(i % 251);
+  }
+  return msg;
+}
+
+template <typename Pixel>
+void expectEqualContent(const ze::ImageRaw<Pixel>& img, const sensor_msgs::Image& msg)
+{
+  ASSERT_EQ(img.width(), msg.width);
+  ASSERT_EQ(img.height(), msg.height);
+  for (uint32_t y = 0; y < img.height(); ++y)
+  {
+    EXPECT_EQ(std::memcmp(img.data(0, y), &msg.data[y * msg.step],
+                          msg.width * sizeof(Pixel)), 0) << "row " << y;
+  }
+}
+
+template <typename Pixel>
+void testRoundTrip(
+    const std::string& encoding, ze::PixelType pixel_type,
+    ze::PixelOrder pixel_order)
+{
+  using namespace ze;
+  SCOPED_TRACE(encoding);
+  sensor_msgs::ImagePtr msg = createMessage(encoding, 7, 5, sizeof(Pixel));
+
+  // Deep copy.
+  ImageBase::Ptr copy = toImageCpu(*msg);
+  ASSERT_TRUE(copy);
+  EXPECT_EQ(copy->pixelType(), pixel_type);
+  EXPECT_EQ(copy->pixelOrder(), pixel_order);
+  auto copy_raw = std::dynamic_pointer_cast<ImageRaw<Pixel>>(copy);
+  ASSERT_TRUE(copy_raw);
+  EXPECT_NE(reinterpret_cast<const uint8_t*>(copy_raw->data()), &msg->data[0]);
+  expectEqualContent(*copy_raw, *msg);
+
+  // Zero copy.
+  sensor_msgs::ImageConstPtr msg_const = msg;
+  ImageBase::Ptr alias = toImageCpu(msg_const);
+  ASSERT_TRUE(alias);
+  EXPECT_EQ(alias->pixelType(), pixel_type);
+  EXPECT_EQ(alias->pixelOrder(), pixel_order);
+  EXPECT_EQ(alias->pitch(), msg->step);
+  auto alias_raw = std::dynamic_pointer_cast<ImageRaw<Pixel>>(alias);
+  ASSERT_TRUE(alias_raw);
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(alias_raw->data()), &msg->data[0]);
+  expectEqualContent(*alias_raw, *msg);
+
+  // Explicit pixel order overrides the one of the encoding.
+  EXPECT_EQ(toImageCpu(msg_const, PixelOrder::bgr)->pixelOrder(), PixelOrder::bgr);
+}
+
+} // unnamed namespace
+
+TEST(RosBridgeTest, testRoundTrip)
+{
+  using namespace ze;
+  testRoundTrip<Pixel8uC1>(imgenc::TYPE_8UC1, PixelType::i8uC1, PixelOrder::undefined);
+  testRoundTrip<Pixel8uC2>(imgenc::TYPE_8UC2, PixelType::i8uC2, PixelOrder::undefined);
+  testRoundTrip<Pixel8uC3>(imgenc::TYPE_8UC3, PixelType::i8uC3, PixelOrder::undefined);
+  testRoundTrip<Pixel8uC4>(imgenc::TYPE_8UC4, PixelType::i8uC4, PixelOrder::undefined);
+  testRoundTrip<Pixel16uC1>(imgenc::TYPE_16UC1, PixelType::i16uC1, PixelOrder::undefined);
+  testRoundTrip<Pixel16uC2>(imgenc::TYPE_16UC2, PixelType::i16uC2, PixelOrder::undefined);
+  testRoundTrip<Pixel16uC3>(imgenc::TYPE_16UC3, PixelType::i16uC3, PixelOrder::undefined);
+  testRoundTrip<Pixel16uC4>(imgenc::TYPE_16UC4, PixelType::i16uC4, PixelOrder::undefined);
+  testRoundTrip<Pixel32fC1>(imgenc::TYPE_32FC1, PixelType::i32fC1, PixelOrder::undefined);
+  testRoundTrip<Pixel32fC2>(imgenc::TYPE_32FC2, PixelType::i32fC2, PixelOrder::undefined);
+  testRoundTrip<Pixel32fC3>(imgenc::TYPE_32FC3, PixelType::i32fC3, PixelOrder::undefined);
+  testRoundTrip<Pixel32fC4>(imgenc::TYPE_32FC4, PixelType::i32fC4, PixelOrder::undefined);
+
+  testRoundTrip<Pixel8uC1>(imgenc::MONO8, PixelType::i8uC1, PixelOrder::gray);
+  testRoundTrip<Pixel8uC3>(imgenc::RGB8, PixelType::i8uC3, PixelOrder::rgb);
+  testRoundTrip<Pixel8uC4>(imgenc::BGRA8, PixelType::i8uC4, PixelOrder::bgra);
+  testRoundTrip<Pixel16uC1>(imgenc::MONO16, PixelType::i16uC1, PixelOrder::gray);
+  testRoundTrip<Pixel16uC3>(imgenc::BGR16, PixelType::i16uC3, PixelOrder::bgr);
+  testRoundTrip<Pixel16uC4>(imgenc::RGBA16, PixelType::i16uC4, PixelOrder::rgba);
+}
+
+TEST(RosBridgeTest, testZeroCopyKeepsMessageAlive)
+{
+  using namespace ze;
+  sensor_msgs::ImagePtr msg = createMessage(imgenc::MONO8, 16, 8, 1);
+  const uint8_t* msg_data = &msg->data[0];
+  boost::weak_ptr<sensor_msgs::Image> msg_weak = msg;
+
+  ImageBase::Ptr img = toImageCpu(sensor_msgs::ImageConstPtr(msg));
+  msg.reset();
+  EXPECT_FALSE(msg_weak.expired());
+
+  // The image still reads the buffer of the message.
+  auto img_raw = std::dynamic_pointer_cast<ImageRaw<Pixel8uC1>>(img);
+  ASSERT_TRUE(img_raw);
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(img_raw->data()), msg_data);
+  EXPECT_EQ(img_raw->pixel(3, 2), (2 * 18 + 3) % 251);
+
+  img_raw.reset();
+  img.reset();
+  EXPECT_TRUE(msg_weak.expired());
+}
+
+TEST(RosBridgeTest, testMalformedMessageDeath)
+{
+  using namespace ze;
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+  // Rows shorter than the pixels of a row.
+  sensor_msgs::ImagePtr msg = createMessage(imgenc::TYPE_16UC3, 4, 3, 6);
+  msg->step = 4 * 6 - 6;
+  EXPECT_DEATH(toImageCpu(*msg), "wrongly formatted");
+  EXPECT_DEATH(toImageCpu(sensor_msgs::ImageConstPtr(msg)), "wrongly formatted");
+
+  // Less data than rows.
+  msg = createMessage(imgenc::TYPE_16UC3, 4, 3, 6);
+  msg->data.resize(msg->step * 2);
+  EXPECT_DEATH(toImageCpu(*msg), "wrongly formatted");
+  EXPECT_DEATH(toImageCpu(sensor_msgs::ImageConstPtr(msg)), "wrongly formatted");
+
+  // Rows not aligned to the pixel size.
+  msg = createMessage(imgenc::TYPE_32FC1, 4, 3, 4);
+  msg->step += 1;
+  msg->data.resize(msg->step * msg->height);
+  EXPECT_DEATH(toImageCpu(*msg), "Row length");
+
+  // Big endian data with more than 8 bits.
+  msg = createMessage(imgenc::MONO16, 4, 3, 2);
+  msg->is_bigendian = 1;
+  EXPECT_DEATH(toImageCpu(*msg), "Big endian");
+  EXPECT_DEATH(toImageCpu(sensor_msgs::ImageConstPtr(msg)), "Big endian");
+
+  // Byte order does not matter for 8 bit images.
+  msg = createMessage(imgenc::MONO8, 4, 3, 1);
+  msg->is_bigendian = 1;
+  EXPECT_TRUE(toImageCpu(*msg));
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <imp/core/pixel_enums.hpp>
+
+namespace ze {
+
+//! Size class of a pooled image buffer.
+struct ImagePoolKey
+{
+  PixelType pixel_type{PixelType::undefined};
+  uint32_t width{0};
+  uint32_t height{0};
+  uint32_t pitch{0}; //!< Row length in bytes.
+
+  inline size_t bytes() const { return static_cast<size_t>(pitch) * height; }
+
+  inline bool operator==(const ImagePoolKey& rhs) const
+  {
+    return pixel_type == rhs.pixel_type && width == rhs.width
+        && height == rhs.height && pitch == rhs.pitch;
+  }
+};
+
+struct ImagePoolKeyHash
+{
+  size_t operator()(const ImagePoolKey& key) const;
+};
+
+//! Counters since the last reset. Cached bytes include thread-local caches.
+struct ImagePoolStatistics
+{
+  uint64_t num_allocations{0};  //!< Buffers newly allocated from the system.
+  uint64_t num_thread_hits{0};  //!< Requests served from a thread-local cache.
+  uint64_t num_pool_hits{0};    //!< Requests served from the shared pool.
+  uint64_t num_releases{0};     //!< Buffers returned to the pool.
+  uint64_t num_frees{0};        //!< Returned buffers freed due to the budget.
+  uint64_t cached_bytes{0};     //!< Bytes currently held for reuse.
+};
+
+//! Process-wide pool of aligned image buffers, grouped by size class.
+//!
+//! Released buffers are first kept in a small per-thread cache, which needs
+//! no locking. Overflow goes to the shared pool, which holds at most
+//! maxCachedBytes() and frees the remaining buffers. Frame-sized images
+//! allocated and released at high rate are thereby recycled instead of
+//! hitting the system allocator (and the page faults of fresh mappings).
+class ImagePool
+{
+public:
+  ZE_DELETE_COPY_ASSIGN(ImagePool);
+
+  //! Buffers kept per size class in every thread-local cache.
+  static constexpr size_t c_max_thread_cached_buffers = 2u;
+
+  static ImagePool& instance();
+
+  //! Returns a buffer of key.bytes() bytes, aligned to memaddr_align bytes.
+  void* acquire(const ImagePoolKey& key);
+
+  //! Returns a buffer obtained with acquire() to the pool.
+  void release(const ImagePoolKey& key, void* buffer);
+
+  //! ImageRaw only draws from the pool when it is enabled (default).
+  inline bool enabled() const { return enabled_; }
+  inline void setEnabled(bool enabled) { enabled_ = enabled; }
+
+  inline size_t maxCachedBytes() const { return max_cached_bytes_; }
+  void setMaxCachedBytes(size_t max_cached_bytes);
+
+  //! Frees all buffers in the shared pool and in the calling thread's cache.
+  //! Caches of other threads are returned when these threads exit.
+  void clear();
+
+  ImagePoolStatistics statistics() const;
+  void resetStatistics();
+
+  static constexpr int c_memaddr_align = 32;
+
+private:
+  ImagePool() = default;
+
+  friend struct ImagePoolThreadCache;
+  using BufferMap =
+      std::unordered_map<ImagePoolKey, std::vector<void*>, ImagePoolKeyHash>;
+
+  //! Moves a buffer to the shared pool or frees it if over budget.
+  void releaseShared(const ImagePoolKey& key, void* buffer);
+
+  //! Frees buffers of the shared pool until it fits the budget.
+  void shrink();
+
+  std::atomic<bool> enabled_{true};
+  std::atomic<size_t> max_cached_bytes_{256u * 1024u * 1024u};
+
+  mutable std::mutex mutex_;
+  BufferMap buffers_;
+  size_t shared_bytes_{0};
+
+  std::atomic<uint64_t> num_allocations_{0};
+  std::atomic<uint64_t> num_thread_hits_{0};
+  std::atomic<uint64_t> num_pool_hits_{0};
+  std::atomic<uint64_t> num_releases_{0};
+  std::atomic<uint64_t> num_frees_{0};
+  std::atomic<uint64_t> cached_bytes_{0};
+};
+
+} // namespace ze
@@ -43,7 +43,8 @@ namespace ze {
  * care about the memory deletion. Instead when you let the class itself allocate
  * the memory it will take care of freeing the memory again. In addition the allocation
  * takes care about memory address alignment (default: 32-byte) for the beginning of
- * every row.
+ * every row. Allocated memory is drawn from and returned to the ImagePool
+ * unless pooling is disabled.
  *
  * The template parameters are as follows:
  *   - Pixel: The pixel's memory representation (e.g. imp::Pixel8uC1 for single-channel unsigned 8-bit images)
@@ -124,6 +125,11 @@ public:
   virtual const Pixel* data(uint32_t ox = 0, uint32_t oy = 0) const override;
 
 protected:
+  /**
+   * @brief allocate allocates aligned memory for the image size in the header (pooled if enabled)
+   */
+  void allocate();
+
   std::unique_ptr<Pixel, Deallocator> data_; //!< the actual image data
   std::shared_ptr<void const> tracked_ = nullptr; //!< tracked object to share memory
 };
@@ -113,14 +113,23 @@ public:
     assert((memaddr_align != 0) && memaddr_align <= 128 &&
            ((memaddr_align & (~memaddr_align + 1)) == memaddr_align));
 
+    *pitch = alignedPitch(size.width());
+    // round up, the pitch is not necessarily a multiple of the pixel size
+    const uint32_t pitched_width = (*pitch + sizeof(Pixel) - 1) / sizeof(Pixel);
+    return alignedAlloc(pitched_width*size.height(), init_with_zeros);
+  }
+
+  /**
+   * @brief alignedPitch returns the row length [bytes] of an image with \a width pixels so that every row starts aligned
+   */
+  static uint32_t alignedPitch(uint32_t width)
+  {
     // check if the width allows a correct alignment of every row, otherwise add padding
-    const uint32_t width_bytes = size.width() * sizeof(Pixel);
+    const uint32_t width_bytes = width * sizeof(Pixel);
     // bytes % memaddr_align = 0 for bytes=n*memaddr_align is the reason for
     // the decrement in the following compution:
     const uint32_t bytes_to_add = (memaddr_align-1) - ((width_bytes-1) % memaddr_align);
-    const uint32_t pitched_width = size.width() + bytes_to_add/sizeof(Pixel);
-    *pitch = width_bytes + bytes_to_add;
-    return alignedAlloc(pitched_width*size.height(), init_with_zeros);
+    return width_bytes + bytes_to_add;
   }
 
 
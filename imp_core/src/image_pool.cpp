@@ -0,0 +1,249 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/core/image_pool.hpp>
+
+#include <functional>
+#include <stdlib.h>
+
+#include <ze/common/logging.hpp>
+#include <imp/core/memory_storage.hpp>
+
+namespace ze {
+
+//------------------------------------------------------------------------------
+size_t ImagePoolKeyHash::operator()(const ImagePoolKey& key) const
+{
+  size_t seed = std::hash<int>()(static_cast<int>(key.pixel_type));
+  for (uint32_t v : {key.width, key.height, key.pitch})
+  {
+    seed ^= std::hash<uint32_t>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+
+//------------------------------------------------------------------------------
+//! Per-thread buffers, returned to the shared pool when the thread exits.
+struct ImagePoolThreadCache
+{
+  ImagePool::BufferMap buffers;
+
+  ~ImagePoolThreadCache();
+};
+
+namespace {
+
+thread_local bool tl_cache_destroyed = false;
+
+//! Returns nullptr during thread teardown, e.g. for images in static storage.
+ImagePoolThreadCache* threadCache()
+{
+  if (tl_cache_destroyed)
+  {
+    return nullptr;
+  }
+  static thread_local ImagePoolThreadCache cache;
+  return &cache;
+}
+
+} // unnamed namespace
+
+ImagePoolThreadCache::~ImagePoolThreadCache()
+{
+  tl_cache_destroyed = true;
+  ImagePool& pool = ImagePool::instance();
+  for (auto& it : buffers)
+  {
+    for (void* buffer : it.second)
+    {
+      pool.cached_bytes_ -= it.first.bytes();
+      pool.releaseShared(it.first, buffer);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+constexpr size_t ImagePool::c_max_thread_cached_buffers;
+constexpr int ImagePool::c_memaddr_align;
+
+//------------------------------------------------------------------------------
+ImagePool& ImagePool::instance()
+{
+  // Never destroyed, such that images in static storage can still be released.
+  static ImagePool* pool = new ImagePool();
+  return *pool;
+}
+
+//------------------------------------------------------------------------------
+void* ImagePool::acquire(const ImagePoolKey& key)
+{
+  CHECK_GT(key.bytes(), 0u);
+  ImagePoolThreadCache* cache = threadCache();
+  if (cache)
+  {
+    auto it = cache->buffers.find(key);
+    if (it != cache->buffers.end() && !it->second.empty())
+    {
+      void* buffer = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= key.bytes();
+      ++num_thread_hits_;
+      return buffer;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffers_.find(key);
+    if (it != buffers_.end() && !it->second.empty())
+    {
+      void* buffer = it->second.back();
+      it->second.pop_back();
+      shared_bytes_ -= key.bytes();
+      cached_bytes_ -= key.bytes();
+      ++num_pool_hits_;
+      return buffer;
+    }
+  }
+
+  ++num_allocations_;
+  return MemoryStorage<uint8_t, c_memaddr_align>::alignedAlloc(
+        static_cast<uint32_t>(key.bytes()));
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::release(const ImagePoolKey& key, void* buffer)
+{
+  DEBUG_CHECK_NOTNULL(buffer);
+  ++num_releases_;
+  ImagePoolThreadCache* cache = threadCache();
+  if (cache && key.bytes() <= max_cached_bytes_)
+  {
+    std::vector<void*>& buffers = cache->buffers[key];
+    if (buffers.size() < c_max_thread_cached_buffers)
+    {
+      buffers.push_back(buffer);
+      cached_bytes_ += key.bytes();
+      return;
+    }
+  }
+  releaseShared(key, buffer);
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::releaseShared(const ImagePoolKey& key, void* buffer)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shared_bytes_ + key.bytes() <= max_cached_bytes_)
+    {
+      buffers_[key].push_back(buffer);
+      shared_bytes_ += key.bytes();
+      cached_bytes_ += key.bytes();
+      return;
+    }
+  }
+  ++num_frees_;
+  free(buffer);
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::setMaxCachedBytes(size_t max_cached_bytes)
+{
+  max_cached_bytes_ = max_cached_bytes;
+  shrink();
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::shrink()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = buffers_.begin();
+       it != buffers_.end() && shared_bytes_ > max_cached_bytes_; ++it)
+  {
+    while (!it->second.empty() && shared_bytes_ > max_cached_bytes_)
+    {
+      free(it->second.back());
+      it->second.pop_back();
+      shared_bytes_ -= it->first.bytes();
+      cached_bytes_ -= it->first.bytes();
+      ++num_frees_;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::clear()
+{
+  ImagePoolThreadCache* cache = threadCache();
+  if (cache)
+  {
+    for (auto& it : cache->buffers)
+    {
+      for (void* buffer : it.second)
+      {
+        free(buffer);
+        cached_bytes_ -= it.first.bytes();
+      }
+    }
+    cache->buffers.clear();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& it : buffers_)
+  {
+    for (void* buffer : it.second)
+    {
+      free(buffer);
+    }
+  }
+  buffers_.clear();
+  cached_bytes_ -= shared_bytes_;
+  shared_bytes_ = 0u;
+}
+
+//------------------------------------------------------------------------------
+ImagePoolStatistics ImagePool::statistics() const
+{
+  ImagePoolStatistics stats;
+  stats.num_allocations = num_allocations_;
+  stats.num_thread_hits = num_thread_hits_;
+  stats.num_pool_hits = num_pool_hits_;
+  stats.num_releases = num_releases_;
+  stats.num_frees = num_frees_;
+  stats.cached_bytes = cached_bytes_;
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+void ImagePool::resetStatistics()
+{
+  num_allocations_ = 0u;
+  num_thread_hits_ = 0u;
+  num_pool_hits_ = 0u;
+  num_releases_ = 0u;
+  num_frees_ = 0u;
+}
+
+} // namespace ze
@@ -26,6 +26,7 @@
 
 #include <iostream>
 #include <ze/common/logging.hpp>
+#include <imp/core/image_pool.hpp>
 
 namespace ze {
 
@@ -34,8 +35,7 @@ template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const ze::Size2u& size, PixelOrder pixel_order)
   : Base(size, pixel_order)
 {
-  data_.reset(Memory::alignedAlloc(size, &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
+  allocate();
 }
 
 //-----------------------------------------------------------------------------
@@ -43,8 +43,7 @@ template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const ImageRaw& from)
   : Base(from)
 {
-  data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
+  allocate();
   from.copyTo(*this);
 }
 
@@ -53,8 +52,7 @@ template<typename Pixel>
 ImageRaw<Pixel>::ImageRaw(const Image<Pixel>& from)
   : Base(from)
 {
-  data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-  this->header_.memory_type = MemoryType::CpuAligned;
+  allocate();
   from.copyTo(*this);
 }
 
@@ -78,8 +76,7 @@ ImageRaw<Pixel>
   }
   else
   {
-    data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
-    this->header_.memory_type = MemoryType::CpuAligned;
+    allocate();
 
     if (this->bytes() == pitch*height)
     {
@@ -118,6 +115,31 @@ ImageRaw<Pixel>::ImageRaw(Pixel* data,
                                  MemoryType::CpuAligned : MemoryType::Cpu;
 }
 
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void ImageRaw<Pixel>::allocate()
+{
+  this->header_.memory_type = MemoryType::CpuAligned;
+  ImagePool& pool = ImagePool::instance();
+  if (!pool.enabled())
+  {
+    data_.reset(Memory::alignedAlloc(this->size(), &this->header_.pitch));
+    return;
+  }
+
+  static_assert(ImagePool::c_memaddr_align % alignof(Pixel) == 0,
+                "Pool alignment does not suffice for pixel type.");
+  ImagePoolKey key;
+  key.pixel_type = this->pixelType();
+  key.width = this->width();
+  key.height = this->height();
+  key.pitch = MemoryStorage<Pixel, ImagePool::c_memaddr_align>::alignedPitch(key.width);
+  this->header_.pitch = key.pitch;
+  data_ = std::unique_ptr<Pixel, Deallocator>(
+        static_cast<Pixel*>(pool.acquire(key)),
+        Deallocator([key](Pixel* p) { ImagePool::instance().release(key, p); }));
+}
+
 //-----------------------------------------------------------------------------
 template<typename Pixel>
 Pixel* ImageRaw<Pixel>::data(uint32_t ox, uint32_t oy)
@@ -0,0 +1,185 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <imp/core/image_pool.hpp>
+#include <imp/core/image_raw.hpp>
+
+TEST(ImagePoolTests, testRecycleBuffers)
+{
+  using namespace ze;
+  ImagePool& pool = ImagePool::instance();
+  pool.clear();
+  pool.resetStatistics();
+
+  const Pixel8uC1* data = nullptr;
+  {
+    ImageRaw8uC1 img(752, 480);
+    data = img.data();
+    EXPECT_TRUE(MemoryStorage<Pixel8uC1>::isAligned(img.data()));
+    EXPECT_EQ(img.pitch() % ImagePool::c_memaddr_align, 0u);
+  }
+  {
+    ImageRaw8uC1 img(752, 480);
+    EXPECT_EQ(img.data(), data);
+    // Other size classes must not share buffers.
+    ImageRaw8uC1 other_size(480, 752);
+    ImageRaw16uC1 other_type(752, 480);
+    EXPECT_NE(other_size.data(), data);
+  }
+  ImagePoolStatistics stats = pool.statistics();
+  EXPECT_EQ(stats.num_allocations, 3u);
+  EXPECT_EQ(stats.num_thread_hits, 1u);
+  EXPECT_EQ(stats.num_releases, 4u);
+  EXPECT_EQ(stats.cached_bytes, 768u * 480u + 480u * 752u + 1504u * 480u);
+
+  pool.clear();
+  EXPECT_EQ(pool.statistics().cached_bytes, 0u);
+}
+
+TEST(ImagePoolTests, testBudget)
+{
+  using namespace ze;
+  ImagePool& pool = ImagePool::instance();
+  pool.clear();
+  pool.resetStatistics();
+  const size_t max_cached_bytes = pool.maxCachedBytes();
+
+  // Fill the thread cache, the remaining buffers go to the shared pool.
+  const size_t num_images = ImagePool::c_max_thread_cached_buffers + 3u;
+  {
+    std::vector<ImageRaw32fC1> images;
+    images.reserve(num_images);
+    for (size_t i = 0u; i < num_images; ++i)
+    {
+      images.emplace_back(64, 64);
+    }
+  }
+  const size_t bytes = 64u * 64u * 4u;
+  EXPECT_EQ(pool.statistics().cached_bytes, num_images * bytes);
+
+  pool.setMaxCachedBytes(bytes);
+  ImagePoolStatistics stats = pool.statistics();
+  EXPECT_EQ(stats.num_frees, 2u);
+  EXPECT_EQ(stats.cached_bytes,
+            (ImagePool::c_max_thread_cached_buffers + 1u) * bytes);
+
+  pool.setMaxCachedBytes(max_cached_bytes);
+  pool.clear();
+}
+
+TEST(ImagePoolTests, testDisabled)
+{
+  using namespace ze;
+  ImagePool& pool = ImagePool::instance();
+  pool.clear();
+  pool.resetStatistics();
+  pool.setEnabled(false);
+  {
+    ImageRaw8uC3 img(101, 7);
+    EXPECT_GE(img.pitch(), 303u);
+    img.setValue(Pixel8uC3(1, 2, 3));
+  }
+  EXPECT_EQ(pool.statistics().num_allocations, 0u);
+  EXPECT_EQ(pool.statistics().cached_bytes, 0u);
+  pool.setEnabled(true);
+}
+
+TEST(ImagePoolTests, testMultiThreadedChurn)
+{
+  using namespace ze;
+  ImagePool& pool = ImagePool::instance();
+  pool.clear();
+  pool.resetStatistics();
+
+  // Images are allocated on the producer and released on the consumer thread
+  // while both run, handed over through a bounded queue.
+  const size_t num_frames = 200u;
+  const size_t queue_capacity = 4u;
+  std::deque<ImageRaw8uC1::Ptr> queue;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread producer([&]()
+  {
+    for (size_t i = 0u; i < num_frames; ++i)
+    {
+      ImageRaw8uC1::Ptr frame = std::make_shared<ImageRaw8uC1>(640, 480);
+      frame->setValue(Pixel8uC1(i % 256));
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [&] { return queue.size() < queue_capacity; });
+      queue.push_back(std::move(frame));
+      condition.notify_all();
+    }
+  });
+  std::thread consumer([&]()
+  {
+    for (size_t i = 0u; i < num_frames; ++i)
+    {
+      ImageRaw8uC1::Ptr frame;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&] { return !queue.empty(); });
+        frame = std::move(queue.front());
+        queue.pop_front();
+        condition.notify_all();
+      }
+      EXPECT_EQ(frame->pixel(10, 10), Pixel8uC1(i % 256));
+      frame.reset();
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  // Every request was served once and every buffer came back. Buffers of
+  // exited threads are in the shared pool.
+  const size_t bytes = 640u * 480u;
+  ImagePoolStatistics stats = pool.statistics();
+  EXPECT_EQ(stats.num_allocations + stats.num_thread_hits + stats.num_pool_hits,
+            num_frames);
+  EXPECT_EQ(stats.num_releases, num_frames);
+  EXPECT_EQ(stats.num_frees, 0u);
+  EXPECT_EQ(stats.cached_bytes, stats.num_allocations * bytes);
+
+  // The producer reused the buffers the consumer returned: a new buffer is
+  // only allocated if the shared pool is empty, i.e. all buffers are held by
+  // the producer, the queue, the consumer or its thread cache.
+  EXPECT_EQ(stats.num_thread_hits, 0u);
+  EXPECT_GT(stats.num_pool_hits, 0u);
+  EXPECT_LE(stats.num_allocations,
+            queue_capacity + 2u + ImagePool::c_max_thread_cached_buffers);
+
+  {
+    ImageRaw8uC1 img(640, 480);
+  }
+  EXPECT_EQ(pool.statistics().num_pool_hits, stats.num_pool_hits + 1u);
+  pool.clear();
+}
+
+ZE_UNITTEST_ENTRYPOINT
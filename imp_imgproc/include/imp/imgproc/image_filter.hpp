@@ -0,0 +1,79 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <imp/core/image_raw.hpp>
+#include <imp/core/types.hpp>
+
+namespace ze {
+
+// fwd
+class ThreadPool;
+
+//-----------------------------------------------------------------------------
+/** filterMedian3x3 performs a median filter on a 3x3 window
+ * @param[out] dst Median filtered result image (same size as \a src)
+ * @param[in] src Input image
+ * @param[in] thread_pool Optional thread pool to filter blocks of rows in parallel
+ * @note Borders are handled by replicating the outermost pixels.
+ */
+template<typename Pixel>
+void filterMedian3x3(ImageRaw<Pixel>& dst,
+                     const ImageRaw<Pixel>& src,
+                     ThreadPool* thread_pool = nullptr);
+
+//-----------------------------------------------------------------------------
+/** filterGauss performs a gaussian smoothing filter on the given input image \a src
+ * @param[out] dst Gauss filtered result image (same size as \a src)
+ * @param[in] src Input image
+ * @param[in] sigma Gaussian kernel standard deviation
+ * @param[in] kernel_size Gaussian filter kernel size. (if default (0) computed automatically)
+ * @param[in] thread_pool Optional thread pool to filter blocks of rows in parallel
+ * @note As opposed to the GPU version, all channels are filtered and integral
+ *       results are rounded instead of truncated.
+ */
+template<typename Pixel>
+void filterGauss(ImageRaw<Pixel>& dst,
+                 const ImageRaw<Pixel>& src,
+                 float sigma, int kernel_size = 0,
+                 ThreadPool* thread_pool = nullptr);
+
+//-----------------------------------------------------------------------------
+/** filterBilateral performs a bilateral filter with range weights computed on \a prior
+ * @param[out] dst Filtered result image (same size as \a src)
+ * @param[in] src Input image
+ * @param[in] prior Image the range weights are computed on (pass \a src for a standard bilateral filter)
+ * @param[in] sigma_spatial Standard deviation of the spatial weights [pixels]
+ * @param[in] sigma_range Standard deviation of the range weights
+ * @param[in] radius Filter radius [pixels]
+ * @param[in] thread_pool Optional thread pool to filter blocks of rows in parallel
+ */
+void filterBilateral(ImageRaw32fC1& dst,
+                     const ImageRaw32fC1& src,
+                     const ImageRaw32fC1& prior,
+                     float sigma_spatial, float sigma_range, int radius,
+                     ThreadPool* thread_pool = nullptr);
+
+} // namespace ze
@@ -0,0 +1,55 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <ze/common/thread_pool.hpp>
+
+namespace ze {
+namespace internal {
+
+//! Calls f(row_begin, row_end) for consecutive blocks of rows covering
+//! [0, height). Blocks run in parallel if a thread pool is given.
+template<typename F>
+void parallelRowBlocks(uint32_t height, ThreadPool* thread_pool, const F& f,
+                       uint32_t rows_per_block = 32u)
+{
+  if (!thread_pool || height <= rows_per_block)
+  {
+    f(0u, height);
+    return;
+  }
+  const uint32_t num_blocks = (height + rows_per_block - 1u) / rows_per_block;
+  thread_pool->parallelFor(0u, num_blocks, 1u, [&](size_t block)
+  {
+    const uint32_t row_begin = block * rows_per_block;
+    f(row_begin, std::min(height, row_begin + rows_per_block));
+  });
+}
+
+} // namespace internal
+} // namespace ze
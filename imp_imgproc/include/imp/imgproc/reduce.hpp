@@ -0,0 +1,59 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <imp/core/image_raw.hpp>
+#include <imp/core/types.hpp>
+
+namespace ze {
+
+// fwd
+class ThreadPool;
+
+/**
+ * @brief Image reduction from \a src to \a dst image
+ *
+ * Same as resample() but Gauss prefiltered by default.
+ */
+template<typename Pixel>
+void reduce(ImageRaw<Pixel>& dst,
+            const ImageRaw<Pixel>& src,
+            InterpolationMode interp = InterpolationMode::Linear,
+            bool gauss_prefilter = true,
+            ThreadPool* thread_pool = nullptr);
+
+/**
+ * @brief Halves \a src into \a dst by averaging 2x2 pixel blocks
+ *
+ * dst(x,y) is the mean of src(2x..2x+1, 2y..2y+1), rounded for integer types.
+ * \a dst is half the size of \a src, rounded down or up; in the latter case
+ * the last source column/row is replicated.
+ */
+template<typename Pixel>
+void halfSample(ImageRaw<Pixel>& dst,
+                const ImageRaw<Pixel>& src,
+                ThreadPool* thread_pool = nullptr);
+
+} // namespace ze
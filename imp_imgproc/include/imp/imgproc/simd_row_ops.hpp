@@ -0,0 +1,242 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define IMP_IMGPROC_SSE2
+#elif defined(HAVE_FAST_NEON) || defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define IMP_IMGPROC_NEON
+#endif
+
+//! @file simd_row_ops.hpp
+//! Row kernels shared by the CPU image processing functions. Rows are treated
+//! as flat arrays of channel values, i.e. n = width * num_channels. The
+//! uint8_t and float versions use SSE2 or NEON, other types fall back to
+//! scalar loops.
+
+namespace ze {
+namespace internal {
+
+//------------------------------------------------------------------------------
+//! Number of channels of a pixel type, e.g. 3 for Pixel8uC3.
+template<typename Pixel>
+constexpr size_t numChannels()
+{
+  return sizeof(Pixel) / sizeof(typename Pixel::T);
+}
+
+//------------------------------------------------------------------------------
+//! dst[i] = src[i]
+template<typename T>
+inline void convertRow(float* dst, const T* src, size_t n)
+{
+  for (size_t i = 0u; i < n; ++i)
+  {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+template<>
+inline void convertRow(float* dst, const float* src, size_t n)
+{
+  std::memcpy(dst, src, n * sizeof(float));
+}
+
+template<>
+inline void convertRow(float* dst, const uint8_t* src, size_t n)
+{
+  size_t i = 0u;
+#if defined(IMP_IMGPROC_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16u <= n; i += 16u)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i lo = _mm_unpacklo_epi8(v, zero);
+    const __m128i hi = _mm_unpackhi_epi8(v, zero);
+    _mm_storeu_ps(dst + i,      _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+    _mm_storeu_ps(dst + i + 4,  _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+    _mm_storeu_ps(dst + i + 8,  _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+    _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+  }
+#elif defined(IMP_IMGPROC_NEON)
+  for (; i + 16u <= n; i += 16u)
+  {
+    const uint8x16_t v = vld1q_u8(src + i);
+    const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    vst1q_f32(dst + i,      vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+    vst1q_f32(dst + i + 4,  vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+    vst1q_f32(dst + i + 8,  vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+    vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+//! dst[i] = src[i] rounded to the nearest value and saturated for integral T.
+template<typename T>
+inline void storeRow(T* dst, const float* src, size_t n)
+{
+  static_assert(std::is_integral<T>::value, "Non-integral type.");
+  // Largest float that still converts into T (float(INT_MAX) does not).
+  const float lo = static_cast<float>(std::numeric_limits<T>::lowest());
+  float hi = static_cast<float>(std::numeric_limits<T>::max());
+  if (static_cast<double>(hi) > static_cast<double>(std::numeric_limits<T>::max()))
+  {
+    hi = std::nextafter(hi, 0.0f);
+  }
+  for (size_t i = 0u; i < n; ++i)
+  {
+    dst[i] = static_cast<T>(std::nearbyint(std::min(hi, std::max(lo, src[i]))));
+  }
+}
+
+template<>
+inline void storeRow(float* dst, const float* src, size_t n)
+{
+  std::memcpy(dst, src, n * sizeof(float));
+}
+
+template<>
+inline void storeRow(uint8_t* dst, const float* src, size_t n)
+{
+  size_t i = 0u;
+#if defined(IMP_IMGPROC_SSE2)
+  for (; i + 16u <= n; i += 16u)
+  {
+    // Round to nearest, saturating packs.
+    const __m128i a = _mm_cvtps_epi32(_mm_loadu_ps(src + i));
+    const __m128i b = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 4));
+    const __m128i c = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 8));
+    const __m128i d = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 12));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  }
+#elif defined(IMP_IMGPROC_NEON)
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  for (; i + 8u <= n; i += 8u)
+  {
+    // Conversion truncates and saturates negative values to zero.
+    const uint32x4_t a = vcvtq_u32_f32(vaddq_f32(vld1q_f32(src + i), half));
+    const uint32x4_t b = vcvtq_u32_f32(vaddq_f32(vld1q_f32(src + i + 4), half));
+    vst1_u8(dst + i, vqmovn_u16(vcombine_u16(vqmovn_u32(a), vqmovn_u32(b))));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = static_cast<uint8_t>(std::nearbyint(std::min(255.0f, std::max(0.0f, src[i]))));
+  }
+}
+
+//------------------------------------------------------------------------------
+//! dst[i] = w * a[i]
+inline void scaleRow(float* dst, const float* a, float w, size_t n)
+{
+  size_t i = 0u;
+#if defined(IMP_IMGPROC_SSE2)
+  const __m128 wv = _mm_set1_ps(w);
+  for (; i + 4u <= n; i += 4u)
+  {
+    _mm_storeu_ps(dst + i, _mm_mul_ps(wv, _mm_loadu_ps(a + i)));
+  }
+#elif defined(IMP_IMGPROC_NEON)
+  for (; i + 4u <= n; i += 4u)
+  {
+    vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(a + i), w));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = w * a[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+//! dst[i] += w * (a[i] + b[i])
+inline void addWeightedPair(float* dst, const float* a, const float* b,
+                            float w, size_t n)
+{
+  size_t i = 0u;
+#if defined(IMP_IMGPROC_SSE2)
+  const __m128 wv = _mm_set1_ps(w);
+  for (; i + 4u <= n; i += 4u)
+  {
+    const __m128 s = _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(wv, s)));
+  }
+#elif defined(IMP_IMGPROC_NEON)
+  for (; i + 4u <= n; i += 4u)
+  {
+    const float32x4_t s = vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+    vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), s, w));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] += w * (a[i] + b[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+//! dst[i] = a[i] + w * (b[i] - a[i])
+inline void lerpRow(float* dst, const float* a, const float* b, float w, size_t n)
+{
+  size_t i = 0u;
+#if defined(IMP_IMGPROC_SSE2)
+  const __m128 wv = _mm_set1_ps(w);
+  for (; i + 4u <= n; i += 4u)
+  {
+    const __m128 av = _mm_loadu_ps(a + i);
+    _mm_storeu_ps(dst + i,
+                  _mm_add_ps(av, _mm_mul_ps(wv, _mm_sub_ps(_mm_loadu_ps(b + i), av))));
+  }
+#elif defined(IMP_IMGPROC_NEON)
+  for (; i + 4u <= n; i += 4u)
+  {
+    const float32x4_t av = vld1q_f32(a + i);
+    vst1q_f32(dst + i, vmlaq_n_f32(av, vsubq_f32(vld1q_f32(b + i), av), w));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    dst[i] = a[i] + w * (b[i] - a[i]);
+  }
+}
+
+} // namespace internal
+} // namespace ze
@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/image_filter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <ze/common/logging.hpp>
+#include <imp/imgproc/parallel_rows.hpp>
+
+namespace ze {
+
+//-----------------------------------------------------------------------------
+void filterBilateral(ImageRaw32fC1& dst,
+                     const ImageRaw32fC1& src,
+                     const ImageRaw32fC1& prior,
+                     float sigma_spatial, float sigma_range, int radius,
+                     ThreadPool* thread_pool)
+{
+  CHECK(dst.size() == src.size());
+  CHECK(prior.size() == src.size());
+  CHECK_NE(dst.data(), src.data()) << "In-place filtering is not supported.";
+  CHECK_GT(sigma_spatial, 0.0f);
+  CHECK_GT(sigma_range, 0.0f);
+  CHECK_GE(radius, 0);
+
+  const int width = src.width();
+  const int height = src.height();
+  const int window = 2 * radius + 1;
+
+  // The spatial weights only depend on the offset.
+  std::vector<float> spatial(window * window);
+  for (int l = -radius; l <= radius; ++l)
+  {
+    for (int k = -radius; k <= radius; ++k)
+    {
+      spatial[(l + radius) * window + k + radius] =
+          -(k * k + l * l) / (2.0f * sigma_spatial * sigma_spatial);
+    }
+  }
+  const float range_scale = -1.0f / (2.0f * sigma_range * sigma_range);
+
+  internal::parallelRowBlocks(height, thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    for (int y = row_begin; y < static_cast<int>(row_end); ++y)
+    {
+      const int l_begin = std::max(-radius, -y);
+      const int l_end = std::min(radius, height - 1 - y);
+      const float* prior_row = &prior.data(0, y)->x;
+      float* dst_row = &dst.data(0, y)->x;
+      for (int x = 0; x < width; ++x)
+      {
+        const float p = prior_row[x];
+        const int k_begin = std::max(-radius, -x);
+        const int k_end = std::min(radius, width - 1 - x);
+        float sum_g = 0.0f;
+        float sum_val = 0.0f;
+        for (int l = l_begin; l <= l_end; ++l)
+        {
+          const float* src_row = &src.data(0, y + l)->x;
+          const float* prior_nb = &prior.data(0, y + l)->x;
+          const float* spatial_row = &spatial[(l + radius) * window + radius];
+          for (int k = k_begin; k <= k_end; ++k)
+          {
+            const float d = p - prior_nb[x + k];
+            const float g = std::exp(spatial_row[k] + range_scale * d * d);
+            sum_g += g;
+            sum_val += g * src_row[x + k];
+          }
+        }
+        dst_row[x] = sum_val / std::max(1e-6f, sum_g);
+      }
+    }
+  });
+}
+
+} // namespace ze
@@ -0,0 +1,159 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/image_filter.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <ze/common/logging.hpp>
+#include <imp/imgproc/parallel_rows.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace ze {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//! Normalized weights w[0..radius] of a Gaussian kernel. Weights are
+//! normalized over the full kernel, as borders are replicated.
+std::vector<float> gaussWeights(float sigma, int radius)
+{
+  std::vector<float> weights(radius + 1);
+  float sum = 0.0f;
+  for (int k = 0; k <= radius; ++k)
+  {
+    weights[k] = std::exp(-0.5f * k * k / (sigma * sigma));
+    sum += (k == 0) ? weights[k] : 2.0f * weights[k];
+  }
+  for (float& w : weights)
+  {
+    w /= sum;
+  }
+  return weights;
+}
+
+} // unnamed namespace
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void filterGauss(ImageRaw<Pixel>& dst,
+                 const ImageRaw<Pixel>& src,
+                 float sigma, int kernel_size,
+                 ThreadPool* thread_pool)
+{
+  using T = typename Pixel::T;
+  CHECK_GT(sigma, 0.0f);
+  CHECK(dst.size() == src.size());
+  CHECK_NE(dst.data(), src.data()) << "In-place filtering is not supported.";
+
+  if (kernel_size == 0)
+    kernel_size = std::max(5, static_cast<int>(std::ceil(sigma*3)*2 + 1));
+  if (kernel_size % 2 == 0)
+    ++kernel_size;
+
+  const int radius = (kernel_size - 1) / 2;
+  const int window = 2 * radius + 1;
+  const int height = src.height();
+  const size_t nc = internal::numChannels<Pixel>();
+  const size_t n = src.width() * nc;
+  const std::vector<float> weights = gaussWeights(sigma, radius);
+
+  internal::parallelRowBlocks(height, thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    // Ring buffer of the source rows in the vertical window, in float.
+    std::vector<float> rows(window * n);
+    std::vector<int> row_idx(window, -1);
+    auto sourceRow = [&](int y) -> const float*
+    {
+      y = std::min(height - 1, std::max(0, y));
+      const int slot = y % window;
+      if (row_idx[slot] != y)
+      {
+        internal::convertRow(&rows[slot * n],
+                             reinterpret_cast<const T*>(src.data(0, y)), n);
+        row_idx[slot] = y;
+      }
+      return &rows[slot * n];
+    };
+
+    std::vector<float> padded(n + 2 * radius * nc);
+    std::vector<float> filtered(n);
+    float* vertical = &padded[radius * nc];
+    for (uint32_t y = row_begin; y < row_end; ++y)
+    {
+      // Convolve vertically.
+      internal::scaleRow(vertical, sourceRow(y), weights[0], n);
+      for (int k = 1; k <= radius; ++k)
+      {
+        internal::addWeightedPair(vertical, sourceRow(y - k), sourceRow(y + k),
+                                  weights[k], n);
+      }
+
+      // Replicate the border pixels.
+      for (int k = 1; k <= radius; ++k)
+      {
+        std::copy(vertical, vertical + nc, vertical - k * nc);
+        std::copy(vertical + n - nc, vertical + n, vertical + n + (k - 1) * nc);
+      }
+
+      // Convolve horizontally.
+      internal::scaleRow(filtered.data(), vertical, weights[0], n);
+      for (int k = 1; k <= radius; ++k)
+      {
+        internal::addWeightedPair(filtered.data(), vertical - k * nc,
+                                  vertical + k * nc, weights[k], n);
+      }
+      internal::storeRow(reinterpret_cast<T*>(dst.data(0, y)), filtered.data(), n);
+    }
+  });
+}
+
+//==============================================================================
+//
+// template instantiations for all our image types
+//
+
+template void filterGauss(ImageRaw8uC1& dst, const ImageRaw8uC1& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw8uC2& dst, const ImageRaw8uC2& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw8uC3& dst, const ImageRaw8uC3& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw8uC4& dst, const ImageRaw8uC4& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+
+template void filterGauss(ImageRaw16uC1& dst, const ImageRaw16uC1& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw16uC2& dst, const ImageRaw16uC2& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw16uC3& dst, const ImageRaw16uC3& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw16uC4& dst, const ImageRaw16uC4& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+
+template void filterGauss(ImageRaw32sC1& dst, const ImageRaw32sC1& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32sC2& dst, const ImageRaw32sC2& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32sC3& dst, const ImageRaw32sC3& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32sC4& dst, const ImageRaw32sC4& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+
+template void filterGauss(ImageRaw32fC1& dst, const ImageRaw32fC1& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32fC2& dst, const ImageRaw32fC2& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32fC3& dst, const ImageRaw32fC3& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+template void filterGauss(ImageRaw32fC4& dst, const ImageRaw32fC4& src, float sigma, int kernel_size, ThreadPool* thread_pool);
+
+} // namespace ze
@@ -0,0 +1,204 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/reduce.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#include <ze/common/logging.hpp>
+#include <imp/imgproc/parallel_rows.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace ze {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//! Rounded mean of four values (floor(mean + 0.5) for integer types).
+template<typename T>
+inline T average4(T a, T b, T c, T d)
+{
+  return static_cast<T>((static_cast<int64_t>(a) + b + c + d + 2) >> 2);
+}
+
+template<>
+inline float average4(float a, float b, float c, float d)
+{
+  return ((a + c) + (b + d)) * 0.25f;
+}
+
+//-----------------------------------------------------------------------------
+//! Averages the 2x2 blocks of the single channel rows r0 and r1 for the
+//! outputs [0, n) that have both source columns, i.e. r0/r1 hold at least 2*n
+//! values. Returns the number of outputs written.
+template<typename T>
+size_t halfSampleRowSimd(T*, const T*, const T*, size_t)
+{
+  return 0u;
+}
+
+#if defined(IMP_IMGPROC_SSE2)
+template<>
+size_t halfSampleRowSimd(uint8_t* dst, const uint8_t* r0, const uint8_t* r1, size_t n)
+{
+  const __m128i low_mask = _mm_set1_epi16(0x00ff);
+  const __m128i two = _mm_set1_epi16(2);
+  // Sum of the 2x2 blocks of 16 source columns as 8 x uint16.
+  auto blockSums = [&](const uint8_t* p0, const uint8_t* p1)
+  {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1));
+    const __m128i sum_a = _mm_add_epi16(_mm_and_si128(a, low_mask), _mm_srli_epi16(a, 8));
+    const __m128i sum_b = _mm_add_epi16(_mm_and_si128(b, low_mask), _mm_srli_epi16(b, 8));
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(sum_a, sum_b), two), 2);
+  };
+  size_t x = 0u;
+  for (; x + 16u <= n; x += 16u)
+  {
+    const __m128i lo = blockSums(r0 + 2u * x, r1 + 2u * x);
+    const __m128i hi = blockSums(r0 + 2u * x + 16u, r1 + 2u * x + 16u);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+  }
+  return x;
+}
+
+template<>
+size_t halfSampleRowSimd(float* dst, const float* r0, const float* r1, size_t n)
+{
+  const __m128 quarter = _mm_set1_ps(0.25f);
+  size_t x = 0u;
+  for (; x + 4u <= n; x += 4u)
+  {
+    // Vertical sums of 8 source columns, then add the even and odd columns.
+    const __m128 a = _mm_add_ps(_mm_loadu_ps(r0 + 2u * x), _mm_loadu_ps(r1 + 2u * x));
+    const __m128 b = _mm_add_ps(_mm_loadu_ps(r0 + 2u * x + 4u), _mm_loadu_ps(r1 + 2u * x + 4u));
+    const __m128 sum = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                                  _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm_storeu_ps(dst + x, _mm_mul_ps(sum, quarter));
+  }
+  return x;
+}
+#elif defined(IMP_IMGPROC_NEON)
+template<>
+size_t halfSampleRowSimd(uint8_t* dst, const uint8_t* r0, const uint8_t* r1, size_t n)
+{
+  size_t x = 0u;
+  for (; x + 8u <= n; x += 8u)
+  {
+    uint16x8_t sum = vpaddlq_u8(vld1q_u8(r0 + 2u * x));
+    sum = vpadalq_u8(sum, vld1q_u8(r1 + 2u * x));
+    vst1_u8(dst + x, vrshrn_n_u16(sum, 2));
+  }
+  return x;
+}
+
+template<>
+size_t halfSampleRowSimd(float* dst, const float* r0, const float* r1, size_t n)
+{
+  const float32x4_t quarter = vdupq_n_f32(0.25f);
+  size_t x = 0u;
+  for (; x + 4u <= n; x += 4u)
+  {
+    const float32x4x2_t a = vld2q_f32(r0 + 2u * x);
+    const float32x4x2_t b = vld2q_f32(r1 + 2u * x);
+    const float32x4_t sum = vaddq_f32(vaddq_f32(a.val[0], b.val[0]),
+                                      vaddq_f32(a.val[1], b.val[1]));
+    vst1q_f32(dst + x, vmulq_f32(sum, quarter));
+  }
+  return x;
+}
+#endif
+
+} // unnamed namespace
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void halfSample(ImageRaw<Pixel>& dst,
+                const ImageRaw<Pixel>& src,
+                ThreadPool* thread_pool)
+{
+  using T = typename Pixel::T;
+  CHECK_NE(dst.data(), src.data()) << "In-place half-sampling is not supported.";
+  CHECK(dst.width() == src.width() / 2u || dst.width() == (src.width() + 1u) / 2u)
+      << "dst width must be half of src width";
+  CHECK(dst.height() == src.height() / 2u || dst.height() == (src.height() + 1u) / 2u)
+      << "dst height must be half of src height";
+
+  const size_t nc = internal::numChannels<Pixel>();
+  const uint32_t src_width = src.width();
+  const uint32_t src_height = src.height();
+  // Outputs that have both source columns; an odd last column is replicated.
+  const uint32_t num_full = std::min(dst.width(), src_width / 2u);
+
+  internal::parallelRowBlocks(dst.height(), thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    for (uint32_t y = row_begin; y < row_end; ++y)
+    {
+      const T* r0 = reinterpret_cast<const T*>(src.data(0, 2u * y));
+      const T* r1 = reinterpret_cast<const T*>(
+            src.data(0, std::min(2u * y + 1u, src_height - 1u)));
+      T* out = reinterpret_cast<T*>(dst.data(0, y));
+
+      uint32_t x = (nc == 1u) ? halfSampleRowSimd(out, r0, r1, num_full) : 0u;
+      for (; x < dst.width(); ++x)
+      {
+        const size_t x0 = 2u * x * nc;
+        const size_t x1 = std::min(2u * x + 1u, src_width - 1u) * nc;
+        for (size_t c = 0u; c < nc; ++c)
+        {
+          out[x * nc + c] = average4(r0[x0 + c], r0[x1 + c], r1[x0 + c], r1[x1 + c]);
+        }
+      }
+    }
+  });
+}
+
+//==============================================================================
+//
+// template instantiations for all our image types
+//
+
+template void halfSample(ImageRaw8uC1& dst, const ImageRaw8uC1& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw8uC2& dst, const ImageRaw8uC2& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw8uC3& dst, const ImageRaw8uC3& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw8uC4& dst, const ImageRaw8uC4& src, ThreadPool* thread_pool);
+
+template void halfSample(ImageRaw16uC1& dst, const ImageRaw16uC1& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw16uC2& dst, const ImageRaw16uC2& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw16uC3& dst, const ImageRaw16uC3& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw16uC4& dst, const ImageRaw16uC4& src, ThreadPool* thread_pool);
+
+template void halfSample(ImageRaw32sC1& dst, const ImageRaw32sC1& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32sC2& dst, const ImageRaw32sC2& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32sC3& dst, const ImageRaw32sC3& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32sC4& dst, const ImageRaw32sC4& src, ThreadPool* thread_pool);
+
+template void halfSample(ImageRaw32fC1& dst, const ImageRaw32fC1& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32fC2& dst, const ImageRaw32fC2& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32fC3& dst, const ImageRaw32fC3& src, ThreadPool* thread_pool);
+template void halfSample(ImageRaw32fC4& dst, const ImageRaw32fC4& src, ThreadPool* thread_pool);
+
+} // namespace ze
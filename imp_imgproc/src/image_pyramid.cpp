@@ -0,0 +1,211 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/image_pyramid.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glog/logging.h>
+#include <imp/core/image_raw.hpp>
+#include <imp/core/pixel_enums.hpp>
+#include <imp/imgproc/image_filter.hpp>
+#include <imp/imgproc/reduce.hpp>
+#include <imp/imgproc/resample.hpp>
+
+namespace ze {
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+ImagePyramid<Pixel>::ImagePyramid(
+    Size2u size, float scale_factor, uint32_t size_bound, uint32_t max_num_levels)
+  : scale_factor_(scale_factor)
+  , size_bound_(size_bound)
+  , max_num_levels_(max_num_levels)
+{
+  this->init(size);
+}
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+void ImagePyramid<Pixel>::clear() noexcept
+{
+  levels_.clear();
+  scale_factors_.clear();
+}
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+void ImagePyramid<Pixel>::init(const ze::Size2u& size)
+{
+  CHECK_GT(scale_factor_, 0.0f);
+  CHECK_LT(scale_factor_, 1.0f);
+
+  this->clear();
+
+  uint32_t shorter_side = std::min(size.width(), size.height());
+
+  // calculate the maximum number of levels
+  float ratio = static_cast<float>(shorter_side)/static_cast<float>(size_bound_);
+  // +1 because the original size is level 0
+  size_t possible_num_levels =
+      static_cast<int>(-std::log(ratio)/std::log(scale_factor_)) + 1;
+  num_levels_ = std::min(max_num_levels_, possible_num_levels);
+
+  // init rate for each level
+  for (size_t i = 0; i<num_levels_; ++i)
+  {
+    scale_factors_.push_back(std::pow(scale_factor_, static_cast<float>(i)));
+  }
+}
+
+//------------------------------------------------------------------------------
+namespace {
+
+//! Per-thread buffer for the Gauss prefiltered level, grown on demand.
+template<typename Pixel>
+ImageRaw<Pixel>& prefilterBuffer(const Size2u& size)
+{
+  thread_local std::unique_ptr<ImageRaw<Pixel>> buffer;
+  if (!buffer || buffer->width() < size.width() || buffer->height() < size.height())
+  {
+    buffer.reset(new ImageRaw<Pixel>(
+                   std::max(size.width(), buffer ? buffer->width() : 0u),
+                   std::max(size.height(), buffer ? buffer->height() : 0u)));
+  }
+  return *buffer;
+}
+
+} // unnamed namespace
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+void updateImagePyramidCpu(
+    ImagePyramid<Pixel>& pyr, const typename Image<Pixel>::Ptr& img_level0,
+    ThreadPool* thread_pool)
+{
+  CHECK(img_level0);
+  CHECK(!img_level0->isGpuMemory());
+  const Size2u sz0 = img_level0->size();
+
+  typename ImagePyramid<Pixel>::ImageLevels& levels = pyr.levels();
+  if (levels.size() != pyr.numLevels() || levels.empty() || levels[0]->size() != sz0)
+  {
+    pyr.init(sz0);
+    pyr.push_back(img_level0);
+    for (size_t i=1; i<pyr.numLevels(); ++i)
+    {
+      Size2u sz(static_cast<uint32_t>(sz0.width() * pyr.scaleFactor(i) + 0.5f),
+                static_cast<uint32_t>(sz0.height() * pyr.scaleFactor(i) + 0.5f));
+      VLOG(300) << "Creating CPU ImagePyramid Level " << i << " of size " << sz;
+      pyr.emplace_back(std::make_shared<ImageRaw<Pixel>>(sz));
+    }
+  }
+  else
+  {
+    levels[0] = img_level0;
+  }
+
+  for (size_t i=1; i<pyr.numLevels(); ++i)
+  {
+    ImageRaw<Pixel>* img = CHECK_NOTNULL(dynamic_cast<ImageRaw<Pixel>*>(levels[i].get()));
+    // Level 0 may be any host image type, view it as ImageRaw without copying.
+    const Image<Pixel>& prev_img = *levels[i-1];
+    const ImageRaw<Pixel> prev(const_cast<Pixel*>(prev_img.data()), prev_img.width(),
+                               prev_img.height(), prev_img.pitch(), true);
+
+    if (pyr.scaleFactor() == 0.5f)
+    {
+      halfSample(*img, prev, thread_pool);
+    }
+    else
+    {
+      // Prefiltering as in resample(), into a reused buffer.
+      float sf = .5f*(static_cast<float>(prev.width()) / img->width()
+                      + static_cast<float>(prev.height()) / img->height());
+      float sigma = 1/(3*sf);
+      std::uint16_t kernel_size = std::ceil(6.0f*sigma);
+      if (kernel_size % 2 == 0)
+        kernel_size++;
+
+      ImageRaw<Pixel>& buffer = prefilterBuffer<Pixel>(prev.size());
+      ImageRaw<Pixel> filtered(buffer.data(), prev.width(), prev.height(),
+                               buffer.pitch(), true);
+      filterGauss(filtered, prev, sigma, kernel_size, thread_pool);
+      resample(*img, filtered, InterpolationMode::Linear, false, thread_pool);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template<typename Pixel>
+typename ImagePyramid<Pixel>::Ptr
+createImagePyramidCpu(
+    const typename Image<Pixel>::Ptr& img_level0, real_t scale_factor,
+    uint32_t max_num_levels, uint32_t size_bound, ThreadPool* thread_pool)
+{
+  CHECK(img_level0);
+  auto pyr = std::make_shared<ImagePyramid<Pixel>>(
+        img_level0->size(), scale_factor, size_bound, max_num_levels);
+  updateImagePyramidCpu(*pyr, img_level0, thread_pool);
+  return pyr;
+}
+
+//=============================================================================
+// Explicitely instantiate the desired classes
+// (sync with typedefs at the end of the hpp file)
+template class ImagePyramid<ze::Pixel8uC1>;
+template class ImagePyramid<ze::Pixel8uC2>;
+//template class ImagePyramid<imp::Pixel8uC3>;
+template class ImagePyramid<ze::Pixel8uC4>;
+
+template class ImagePyramid<ze::Pixel16uC1>;
+template class ImagePyramid<ze::Pixel16uC2>;
+//template class ImagePyramid<imp::Pixel16uC3>;
+template class ImagePyramid<ze::Pixel16uC4>;
+
+template class ImagePyramid<ze::Pixel32sC1>;
+template class ImagePyramid<ze::Pixel32sC2>;
+//template class ImagePyramid<imp::Pixel32sC3>;
+template class ImagePyramid<ze::Pixel32sC4>;
+
+template class ImagePyramid<ze::Pixel32fC1>;
+template class ImagePyramid<ze::Pixel32fC2>;
+//template class ImagePyramid<imp::Pixel32fC3>;
+template class ImagePyramid<ze::Pixel32fC4>;
+
+template ImagePyramid8uC1::Ptr createImagePyramidCpu<Pixel8uC1>(
+    const Image8uC1::Ptr& img_level0, real_t scale_factor,
+    uint32_t max_num_levels, uint32_t size_bound, ThreadPool* thread_pool);
+template ImagePyramid32fC1::Ptr createImagePyramidCpu<Pixel32fC1>(
+    const Image32fC1::Ptr& img_level0, real_t scale_factor,
+    uint32_t max_num_levels, uint32_t size_bound, ThreadPool* thread_pool);
+
+template void updateImagePyramidCpu(
+    ImagePyramid8uC1& pyr, const Image8uC1::Ptr& img_level0, ThreadPool* thread_pool);
+template void updateImagePyramidCpu(
+    ImagePyramid32fC1& pyr, const Image32fC1::Ptr& img_level0, ThreadPool* thread_pool);
+
+} // namespace ze
+
@@ -0,0 +1,225 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/image_filter.hpp>
+
+#include <algorithm>
+
+#include <ze/common/logging.hpp>
+#include <imp/imgproc/parallel_rows.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace ze {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+template<typename T>
+inline T vmin(const T& a, const T& b) { return std::min(a, b); }
+template<typename T>
+inline T vmax(const T& a, const T& b) { return std::max(a, b); }
+
+#if defined(IMP_IMGPROC_SSE2)
+inline __m128i vmin(const __m128i& a, const __m128i& b) { return _mm_min_epu8(a, b); }
+inline __m128i vmax(const __m128i& a, const __m128i& b) { return _mm_max_epu8(a, b); }
+inline __m128 vmin(const __m128& a, const __m128& b) { return _mm_min_ps(a, b); }
+inline __m128 vmax(const __m128& a, const __m128& b) { return _mm_max_ps(a, b); }
+#elif defined(IMP_IMGPROC_NEON)
+inline uint8x16_t vmin(const uint8x16_t& a, const uint8x16_t& b) { return vminq_u8(a, b); }
+inline uint8x16_t vmax(const uint8x16_t& a, const uint8x16_t& b) { return vmaxq_u8(a, b); }
+inline float32x4_t vmin(const float32x4_t& a, const float32x4_t& b) { return vminq_f32(a, b); }
+inline float32x4_t vmax(const float32x4_t& a, const float32x4_t& b) { return vmaxq_f32(a, b); }
+#endif
+
+template<typename V>
+inline void sort2(V& a, V& b)
+{
+  const V t = vmin(a, b);
+  b = vmax(a, b);
+  a = t;
+}
+
+//! Median of p[0..8] with a 19 compare-exchange network, returned in p[4].
+template<typename V>
+inline V median9(V* p)
+{
+  sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+  sort2(p[0], p[1]); sort2(p[3], p[4]); sort2(p[6], p[7]);
+  sort2(p[1], p[2]); sort2(p[4], p[5]); sort2(p[7], p[8]);
+  sort2(p[0], p[3]); sort2(p[5], p[8]); sort2(p[4], p[7]);
+  sort2(p[3], p[6]); sort2(p[1], p[4]); sort2(p[2], p[5]);
+  sort2(p[4], p[7]); sort2(p[4], p[2]); sort2(p[6], p[4]);
+  sort2(p[4], p[2]);
+  return p[4];
+}
+
+//-----------------------------------------------------------------------------
+//! Median of the 3x3 neighbourhoods of the channel values [begin, end) of a
+//! row, with neighbouring pixels nc values apart. Scalar version.
+template<typename T>
+void medianRowScalar(T* dst, const T* r0, const T* r1, const T* r2,
+                     size_t begin, size_t end, size_t nc, size_t n)
+{
+  for (size_t i = begin; i < end; ++i)
+  {
+    const size_t l = (i < nc) ? i : i - nc;
+    const size_t r = (i + nc >= n) ? i : i + nc;
+    T p[9] = { r0[l], r0[i], r0[r], r1[l], r1[i], r1[r], r2[l], r2[i], r2[r] };
+    dst[i] = median9(p);
+  }
+}
+
+//! Vectorized interior for uint8_t and float, scalar for other types.
+template<typename T>
+size_t medianRowSimd(T*, const T*, const T*, const T*, size_t begin, size_t, size_t)
+{
+  return begin;
+}
+
+#if defined(IMP_IMGPROC_SSE2) || defined(IMP_IMGPROC_NEON)
+template<typename V, size_t lanes, typename T, typename Load, typename Store>
+size_t medianRowVector(T* dst, const T* r0, const T* r1, const T* r2,
+                       size_t begin, size_t end, size_t nc,
+                       const Load& load, const Store& store)
+{
+  size_t i = begin;
+  for (; i + lanes <= end; i += lanes)
+  {
+    V p[9] = { load(r0 + i - nc), load(r0 + i), load(r0 + i + nc),
+               load(r1 + i - nc), load(r1 + i), load(r1 + i + nc),
+               load(r2 + i - nc), load(r2 + i), load(r2 + i + nc) };
+    store(dst + i, median9(p));
+  }
+  return i;
+}
+#endif
+
+#if defined(IMP_IMGPROC_SSE2)
+template<>
+size_t medianRowSimd(uint8_t* dst, const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                     size_t begin, size_t end, size_t nc)
+{
+  return medianRowVector<__m128i, 16u>(
+        dst, r0, r1, r2, begin, end, nc,
+        [](const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); },
+        [](uint8_t* p, const __m128i& v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); });
+}
+
+template<>
+size_t medianRowSimd(float* dst, const float* r0, const float* r1, const float* r2,
+                     size_t begin, size_t end, size_t nc)
+{
+  return medianRowVector<__m128, 4u>(
+        dst, r0, r1, r2, begin, end, nc,
+        [](const float* p) { return _mm_loadu_ps(p); },
+        [](float* p, const __m128& v) { _mm_storeu_ps(p, v); });
+}
+#elif defined(IMP_IMGPROC_NEON)
+template<>
+size_t medianRowSimd(uint8_t* dst, const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                     size_t begin, size_t end, size_t nc)
+{
+  return medianRowVector<uint8x16_t, 16u>(
+        dst, r0, r1, r2, begin, end, nc,
+        [](const uint8_t* p) { return vld1q_u8(p); },
+        [](uint8_t* p, const uint8x16_t& v) { vst1q_u8(p, v); });
+}
+
+template<>
+size_t medianRowSimd(float* dst, const float* r0, const float* r1, const float* r2,
+                     size_t begin, size_t end, size_t nc)
+{
+  return medianRowVector<float32x4_t, 4u>(
+        dst, r0, r1, r2, begin, end, nc,
+        [](const float* p) { return vld1q_f32(p); },
+        [](float* p, const float32x4_t& v) { vst1q_f32(p, v); });
+}
+#endif
+
+} // unnamed namespace
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void filterMedian3x3(ImageRaw<Pixel>& dst,
+                     const ImageRaw<Pixel>& src,
+                     ThreadPool* thread_pool)
+{
+  using T = typename Pixel::T;
+  CHECK(dst.size() == src.size());
+  CHECK_NE(dst.data(), src.data()) << "In-place filtering is not supported.";
+
+  const uint32_t height = src.height();
+  const size_t nc = internal::numChannels<Pixel>();
+  const size_t n = src.width() * nc;
+
+  internal::parallelRowBlocks(height, thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    for (uint32_t y = row_begin; y < row_end; ++y)
+    {
+      const T* r0 = reinterpret_cast<const T*>(src.data(0, (y > 0u) ? y - 1u : y));
+      const T* r1 = reinterpret_cast<const T*>(src.data(0, y));
+      const T* r2 = reinterpret_cast<const T*>(src.data(0, (y + 1u < height) ? y + 1u : y));
+      T* out = reinterpret_cast<T*>(dst.data(0, y));
+
+      // Interior pixels have both horizontal neighbours.
+      size_t i = nc;
+      if (n > 2u * nc)
+      {
+        i = medianRowSimd(out, r0, r1, r2, nc, n - nc, nc);
+        medianRowScalar(out, r0, r1, r2, i, n - nc, nc, n);
+      }
+      // First and last pixel.
+      medianRowScalar(out, r0, r1, r2, 0u, std::min(nc, n), nc, n);
+      medianRowScalar(out, r0, r1, r2, std::max(nc, n - nc), n, nc, n);
+    }
+  });
+}
+
+//==============================================================================
+//
+// template instantiations for all our image types
+//
+
+template void filterMedian3x3(ImageRaw8uC1& dst, const ImageRaw8uC1& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw8uC2& dst, const ImageRaw8uC2& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw8uC3& dst, const ImageRaw8uC3& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw8uC4& dst, const ImageRaw8uC4& src, ThreadPool* thread_pool);
+
+template void filterMedian3x3(ImageRaw16uC1& dst, const ImageRaw16uC1& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw16uC2& dst, const ImageRaw16uC2& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw16uC3& dst, const ImageRaw16uC3& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw16uC4& dst, const ImageRaw16uC4& src, ThreadPool* thread_pool);
+
+template void filterMedian3x3(ImageRaw32sC1& dst, const ImageRaw32sC1& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32sC2& dst, const ImageRaw32sC2& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32sC3& dst, const ImageRaw32sC3& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32sC4& dst, const ImageRaw32sC4& src, ThreadPool* thread_pool);
+
+template void filterMedian3x3(ImageRaw32fC1& dst, const ImageRaw32fC1& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32fC2& dst, const ImageRaw32fC2& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32fC3& dst, const ImageRaw32fC3& src, ThreadPool* thread_pool);
+template void filterMedian3x3(ImageRaw32fC4& dst, const ImageRaw32fC4& src, ThreadPool* thread_pool);
+
+} // namespace ze
@@ -0,0 +1,67 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/reduce.hpp>
+
+#include <imp/imgproc/resample.hpp>
+
+namespace ze {
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void reduce(ImageRaw<Pixel>& dst,
+            const ImageRaw<Pixel>& src,
+            InterpolationMode interp, bool gauss_prefilter,
+            ThreadPool* thread_pool)
+{
+  // Reduction and resampling only differ in the default prefiltering.
+  resample(dst, src, interp, gauss_prefilter, thread_pool);
+}
+
+//==============================================================================
+//
+// template instantiations for all our image types
+//
+
+template void reduce(ImageRaw8uC1& dst, const ImageRaw8uC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw8uC2& dst, const ImageRaw8uC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw8uC3& dst, const ImageRaw8uC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw8uC4& dst, const ImageRaw8uC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void reduce(ImageRaw16uC1& dst, const ImageRaw16uC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw16uC2& dst, const ImageRaw16uC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw16uC3& dst, const ImageRaw16uC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw16uC4& dst, const ImageRaw16uC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void reduce(ImageRaw32sC1& dst, const ImageRaw32sC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32sC2& dst, const ImageRaw32sC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32sC3& dst, const ImageRaw32sC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32sC4& dst, const ImageRaw32sC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void reduce(ImageRaw32fC1& dst, const ImageRaw32fC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32fC2& dst, const ImageRaw32fC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32fC3& dst, const ImageRaw32fC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void reduce(ImageRaw32fC4& dst, const ImageRaw32fC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+} // namespace ze
@@ -0,0 +1,221 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <imp/imgproc/resample.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <ze/common/logging.hpp>
+#include <imp/imgproc/image_filter.hpp>
+#include <imp/imgproc/parallel_rows.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace ze {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//! Source index and weight of the upper neighbour for linear interpolation at
+//! dst_idx * scale_factor, clamped to the image.
+struct LinearTap
+{
+  uint32_t i0;
+  uint32_t i1;
+  float w1;
+};
+
+std::vector<LinearTap> linearTaps(uint32_t dst_size, uint32_t src_size, float scale_factor)
+{
+  std::vector<LinearTap> taps(dst_size);
+  for (uint32_t i = 0u; i < dst_size; ++i)
+  {
+    const float pos = std::min(static_cast<float>(src_size - 1u),
+                               std::max(0.0f, i * scale_factor));
+    taps[i].i0 = static_cast<uint32_t>(pos);
+    taps[i].i1 = std::min(taps[i].i0 + 1u, src_size - 1u);
+    taps[i].w1 = pos - taps[i].i0;
+  }
+  return taps;
+}
+
+//! Index of the nearest source pixel of dst_idx * scale_factor.
+std::vector<uint32_t> pointTaps(uint32_t dst_size, uint32_t src_size, float scale_factor)
+{
+  std::vector<uint32_t> taps(dst_size);
+  for (uint32_t i = 0u; i < dst_size; ++i)
+  {
+    taps[i] = std::min(src_size - 1u,
+                       static_cast<uint32_t>(std::floor(i * scale_factor + 0.5f)));
+  }
+  return taps;
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void resamplePoint(ImageRaw<Pixel>& dst, const ImageRaw<Pixel>& src,
+                   float sf_x, float sf_y, ThreadPool* thread_pool)
+{
+  const std::vector<uint32_t> xs = pointTaps(dst.width(), src.width(), sf_x);
+  const std::vector<uint32_t> ys = pointTaps(dst.height(), src.height(), sf_y);
+  internal::parallelRowBlocks(dst.height(), thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    for (uint32_t y = row_begin; y < row_end; ++y)
+    {
+      const Pixel* src_row = src.data(0, ys[y]);
+      Pixel* dst_row = dst.data(0, y);
+      for (uint32_t x = 0u; x < dst.width(); ++x)
+      {
+        dst_row[x] = src_row[xs[x]];
+      }
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void resampleLinear(ImageRaw<Pixel>& dst, const ImageRaw<Pixel>& src,
+                    float sf_x, float sf_y, ThreadPool* thread_pool)
+{
+  using T = typename Pixel::T;
+  const size_t nc = internal::numChannels<Pixel>();
+  const size_t src_n = src.width() * nc;
+  const size_t dst_n = dst.width() * nc;
+  const std::vector<LinearTap> xs = linearTaps(dst.width(), src.width(), sf_x);
+  const std::vector<LinearTap> ys = linearTaps(dst.height(), src.height(), sf_y);
+
+  internal::parallelRowBlocks(dst.height(), thread_pool,
+                              [&](uint32_t row_begin, uint32_t row_end)
+  {
+    // Two converted source rows, reused while consecutive rows share them.
+    std::vector<float> rows(2u * src_n);
+    int64_t row_idx[2] = { -1, -1 };
+    auto sourceRow = [&](uint32_t y) -> const float*
+    {
+      const size_t slot = y % 2u;
+      if (row_idx[slot] != y)
+      {
+        internal::convertRow(&rows[slot * src_n],
+                             reinterpret_cast<const T*>(src.data(0, y)), src_n);
+        row_idx[slot] = y;
+      }
+      return &rows[slot * src_n];
+    };
+
+    std::vector<float> vertical(src_n);
+    std::vector<float> out(dst_n);
+    for (uint32_t y = row_begin; y < row_end; ++y)
+    {
+      // Interpolate vertically, then horizontally.
+      const LinearTap& ty = ys[y];
+      internal::lerpRow(vertical.data(), sourceRow(ty.i0), sourceRow(ty.i1),
+                        ty.w1, src_n);
+      for (uint32_t x = 0u; x < dst.width(); ++x)
+      {
+        const LinearTap& tx = xs[x];
+        const float* v0 = &vertical[tx.i0 * nc];
+        const float* v1 = &vertical[tx.i1 * nc];
+        for (size_t c = 0u; c < nc; ++c)
+        {
+          out[x * nc + c] = v0[c] + tx.w1 * (v1[c] - v0[c]);
+        }
+      }
+      internal::storeRow(reinterpret_cast<T*>(dst.data(0, y)), out.data(), dst_n);
+    }
+  });
+}
+
+} // unnamed namespace
+
+//-----------------------------------------------------------------------------
+template<typename Pixel>
+void resample(ImageRaw<Pixel>& dst,
+              const ImageRaw<Pixel>& src,
+              InterpolationMode interp, bool gauss_prefilter,
+              ThreadPool* thread_pool)
+{
+  CHECK_NE(dst.data(), src.data()) << "In-place resampling is not supported.";
+
+  // scale factor for x/y > 0 && < 1 (for multiplication with dst coords!)
+  const float sf_x = static_cast<float>(src.width()) / static_cast<float>(dst.width());
+  const float sf_y = static_cast<float>(src.height()) / static_cast<float>(dst.height());
+
+  const ImageRaw<Pixel>* input = &src;
+  std::unique_ptr<ImageRaw<Pixel>> filtered;
+  if (gauss_prefilter)
+  {
+    float sf = .5f*(sf_x+sf_y);
+
+    filtered.reset(new ImageRaw<Pixel>(src.size()));
+    float sigma = 1/(3*sf) ;  // empirical magic
+    std::uint16_t kernel_size = std::ceil(6.0f*sigma);
+    if (kernel_size % 2 == 0)
+      kernel_size++;
+
+    filterGauss(*filtered, src, sigma, kernel_size, thread_pool);
+    input = filtered.get();
+  }
+
+  switch(interp)
+  {
+  case InterpolationMode::Point:
+    resamplePoint(dst, *input, sf_x, sf_y, thread_pool);
+    break;
+  case InterpolationMode::Linear:
+    resampleLinear(dst, *input, sf_x, sf_y, thread_pool);
+    break;
+  default:
+    CHECK(false) << "unsupported interpolation type";
+  }
+}
+
+//==============================================================================
+//
+// template instantiations for all our image types
+//
+
+template void resample(ImageRaw8uC1& dst, const ImageRaw8uC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw8uC2& dst, const ImageRaw8uC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw8uC3& dst, const ImageRaw8uC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw8uC4& dst, const ImageRaw8uC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void resample(ImageRaw16uC1& dst, const ImageRaw16uC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw16uC2& dst, const ImageRaw16uC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw16uC3& dst, const ImageRaw16uC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw16uC4& dst, const ImageRaw16uC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void resample(ImageRaw32sC1& dst, const ImageRaw32sC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32sC2& dst, const ImageRaw32sC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32sC3& dst, const ImageRaw32sC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32sC4& dst, const ImageRaw32sC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+template void resample(ImageRaw32fC1& dst, const ImageRaw32fC1& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32fC2& dst, const ImageRaw32fC2& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32fC3& dst, const ImageRaw32fC3& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+template void resample(ImageRaw32fC4& dst, const ImageRaw32fC4& src, InterpolationMode interp, bool gauss_prefilter, ThreadPool* thread_pool);
+
+} // namespace ze
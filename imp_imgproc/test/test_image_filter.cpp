@@ -0,0 +1,287 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/image_filter.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace {
+
+using namespace ze;
+
+template<typename Pixel>
+void fillRandom(ImageRaw<Pixel>& img, double max_value, unsigned seed = 42u)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(0.0, max_value);
+  for (uint32_t y = 0u; y < img.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < img.width(); ++x)
+    {
+      for (size_t c = 0u; c < internal::numChannels<Pixel>(); ++c)
+      {
+        img.pixel(x, y).c[c] = static_cast<typename Pixel::T>(dist(gen));
+      }
+    }
+  }
+}
+
+inline int clampIdx(int i, int size)
+{
+  return std::min(size - 1, std::max(0, i));
+}
+
+template<typename Pixel>
+double maxAbsDiff(const ImageRaw<Pixel>& img, const std::vector<double>& ref)
+{
+  const size_t nc = internal::numChannels<Pixel>();
+  double max_diff = 0.0;
+  for (uint32_t y = 0u; y < img.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < img.width(); ++x)
+    {
+      for (size_t c = 0u; c < nc; ++c)
+      {
+        const double diff = std::abs(
+              static_cast<double>(img.pixel(x, y).c[c])
+              - ref[(y * img.width() + x) * nc + c]);
+        max_diff = std::max(max_diff, diff);
+      }
+    }
+  }
+  return max_diff;
+}
+
+//! Separable Gaussian with replicated borders, in double precision.
+template<typename Pixel>
+std::vector<double> referenceGauss(const ImageRaw<Pixel>& src, float sigma, int kernel_size)
+{
+  const int radius = (kernel_size - 1) / 2;
+  std::vector<double> weights(2 * radius + 1);
+  double sum = 0.0;
+  for (int k = -radius; k <= radius; ++k)
+  {
+    weights[k + radius] = std::exp(-0.5 * k * k / (sigma * sigma));
+    sum += weights[k + radius];
+  }
+  const int width = src.width();
+  const int height = src.height();
+  const size_t nc = internal::numChannels<Pixel>();
+  std::vector<double> ref(width * height * nc, 0.0);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      for (size_t c = 0u; c < nc; ++c)
+      {
+        double val = 0.0;
+        for (int l = -radius; l <= radius; ++l)
+        {
+          for (int k = -radius; k <= radius; ++k)
+          {
+            val += weights[l + radius] * weights[k + radius]
+                * src.pixel(clampIdx(x + k, width), clampIdx(y + l, height)).c[c];
+          }
+        }
+        ref[(y * width + x) * nc + c] = val / (sum * sum);
+      }
+    }
+  }
+  return ref;
+}
+
+template<typename Pixel>
+std::vector<double> referenceMedian3x3(const ImageRaw<Pixel>& src)
+{
+  const int width = src.width();
+  const int height = src.height();
+  const size_t nc = internal::numChannels<Pixel>();
+  std::vector<double> ref(width * height * nc, 0.0);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      for (size_t c = 0u; c < nc; ++c)
+      {
+        std::vector<double> vals;
+        for (int l = -1; l <= 1; ++l)
+        {
+          for (int k = -1; k <= 1; ++k)
+          {
+            vals.push_back(src.pixel(clampIdx(x + k, width), clampIdx(y + l, height)).c[c]);
+          }
+        }
+        std::nth_element(vals.begin(), vals.begin() + 4, vals.end());
+        ref[(y * width + x) * nc + c] = vals[4];
+      }
+    }
+  }
+  return ref;
+}
+
+template<typename Pixel>
+void testGauss(uint32_t width, uint32_t height, double max_value,
+               float sigma, int kernel_size, double tolerance,
+               ThreadPool* thread_pool)
+{
+  ImageRaw<Pixel> src(width, height);
+  ImageRaw<Pixel> dst(width, height);
+  fillRandom(src, max_value);
+  filterGauss(dst, src, sigma, kernel_size, thread_pool);
+
+  int expected_kernel_size = kernel_size;
+  if (expected_kernel_size == 0)
+    expected_kernel_size = std::max(5, static_cast<int>(std::ceil(sigma*3)*2 + 1));
+  if (expected_kernel_size % 2 == 0)
+    ++expected_kernel_size;
+  EXPECT_LE(maxAbsDiff(dst, referenceGauss(src, sigma, expected_kernel_size)), tolerance)
+      << "size " << width << "x" << height << ", sigma " << sigma
+      << ", kernel size " << kernel_size;
+}
+
+template<typename Pixel>
+void testMedian(uint32_t width, uint32_t height, double max_value,
+                ThreadPool* thread_pool)
+{
+  ImageRaw<Pixel> src(width, height);
+  ImageRaw<Pixel> dst(width, height);
+  fillRandom(src, max_value);
+  filterMedian3x3(dst, src, thread_pool);
+  EXPECT_EQ(maxAbsDiff(dst, referenceMedian3x3(src)), 0.0)
+      << "size " << width << "x" << height;
+}
+
+} // unnamed namespace
+
+TEST(ImageFilterTests, testGauss)
+{
+  ThreadPool thread_pool(2);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool})
+  {
+    // Odd sizes exercise the scalar tails of the vectorized rows.
+    testGauss<Pixel8uC1>(101, 77, 255.0, 1.0f, 0, 1.0, pool);
+    testGauss<Pixel8uC1>(37, 5, 255.0, 2.5f, 9, 1.0, pool);
+    testGauss<Pixel8uC1>(3, 40, 255.0, 1.5f, 0, 1.0, pool);
+    testGauss<Pixel8uC3>(53, 41, 255.0, 0.8f, 3, 1.0, pool);
+    testGauss<Pixel16uC1>(64, 48, 65535.0, 1.2f, 0, 1.0, pool);
+    testGauss<Pixel32fC1>(99, 70, 1.0, 1.7f, 0, 1e-5, pool);
+    testGauss<Pixel32fC4>(21, 33, 1.0, 0.9f, 7, 1e-5, pool);
+  }
+}
+
+TEST(ImageFilterTests, testGaussConstantImage)
+{
+  ImageRaw8uC1 src(64, 64);
+  ImageRaw8uC1 dst(64, 64);
+  src.setValue(Pixel8uC1(200));
+  filterGauss(dst, src, 3.0f);
+  for (uint32_t y = 0u; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < dst.width(); ++x)
+    {
+      ASSERT_EQ(dst.pixel(x, y), Pixel8uC1(200));
+    }
+  }
+}
+
+TEST(ImageFilterTests, testMedian3x3)
+{
+  ThreadPool thread_pool(2);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool})
+  {
+    testMedian<Pixel8uC1>(101, 77, 255.0, pool);
+    testMedian<Pixel8uC1>(1, 9, 255.0, pool);
+    testMedian<Pixel8uC1>(2, 2, 255.0, pool);
+    testMedian<Pixel8uC4>(35, 17, 255.0, pool);
+    testMedian<Pixel16uC2>(19, 23, 65535.0, pool);
+    testMedian<Pixel32fC1>(67, 45, 1.0, pool);
+    testMedian<Pixel32fC3>(13, 11, 1.0, pool);
+  }
+}
+
+TEST(ImageFilterTests, testMedian3x3RemovesSaltAndPepper)
+{
+  ImageRaw8uC1 src(32, 32);
+  ImageRaw8uC1 dst(32, 32);
+  src.setValue(Pixel8uC1(100));
+  src.pixel(10, 10) = Pixel8uC1(255);
+  src.pixel(20, 5) = Pixel8uC1(0);
+  filterMedian3x3(dst, src);
+  EXPECT_EQ(dst.pixel(10, 10), Pixel8uC1(100));
+  EXPECT_EQ(dst.pixel(20, 5), Pixel8uC1(100));
+}
+
+TEST(ImageFilterTests, testBilateral)
+{
+  const int width = 47;
+  const int height = 31;
+  const float sigma_spatial = 2.0f;
+  const float sigma_range = 0.2f;
+  const int radius = 3;
+
+  ImageRaw32fC1 src(width, height);
+  ImageRaw32fC1 dst(width, height);
+  fillRandom(src, 1.0);
+
+  ThreadPool thread_pool(2);
+  filterBilateral(dst, src, src, sigma_spatial, sigma_range, radius, &thread_pool);
+
+  std::vector<double> ref(width * height);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      double sum_g = 0.0;
+      double sum_val = 0.0;
+      for (int l = -radius; l <= radius; ++l)
+      {
+        for (int k = -radius; k <= radius; ++k)
+        {
+          const int xx = x + k;
+          const int yy = y + l;
+          if (xx >= 0 && yy >= 0 && xx < width && yy < height)
+          {
+            const double d = src.pixel(x, y).x - src.pixel(xx, yy).x;
+            const double g =
+                std::exp(-(k * k + l * l) / (2.0 * sigma_spatial * sigma_spatial)
+                         - d * d / (2.0 * sigma_range * sigma_range));
+            sum_g += g;
+            sum_val += g * src.pixel(xx, yy).x;
+          }
+        }
+      }
+      ref[y * width + x] = sum_val / sum_g;
+    }
+  }
+  EXPECT_LE(maxAbsDiff(dst, ref), 1e-5);
+}
+
+ZE_UNITTEST_ENTRYPOINT
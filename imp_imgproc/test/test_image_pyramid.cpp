@@ -0,0 +1,210 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <ze/common/benchmark.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/image_pyramid.hpp>
+#include <imp/imgproc/reduce.hpp>
+
+namespace {
+
+using namespace ze;
+
+template<typename Pixel>
+void fillRandom(ImageRaw<Pixel>& img, double max_value, unsigned seed = 42u)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(0.0, max_value);
+  for (uint32_t y = 0u; y < img.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < img.width(); ++x)
+    {
+      img.pixel(x, y) = Pixel(static_cast<typename Pixel::T>(dist(gen)));
+    }
+  }
+}
+
+template<typename Pixel>
+double referenceHalfSample(const ImageRaw<Pixel>& src, uint32_t x, uint32_t y)
+{
+  const uint32_t x1 = std::min(2u * x + 1u, src.width() - 1u);
+  const uint32_t y1 = std::min(2u * y + 1u, src.height() - 1u);
+  return 0.25 * (static_cast<double>(src.pixel(2u * x, 2u * y).x) + src.pixel(x1, 2u * y).x
+                 + src.pixel(2u * x, y1).x + src.pixel(x1, y1).x);
+}
+
+template<typename Pixel>
+void testHalfSample(uint32_t width, uint32_t height, bool round_up,
+                    double max_value, double tolerance, ThreadPool* thread_pool)
+{
+  ImageRaw<Pixel> src(width, height);
+  ImageRaw<Pixel> dst(round_up ? (width + 1u) / 2u : width / 2u,
+                      round_up ? (height + 1u) / 2u : height / 2u);
+  fillRandom(src, max_value);
+  halfSample(dst, src, thread_pool);
+
+  double max_diff = 0.0;
+  for (uint32_t y = 0u; y < dst.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < dst.width(); ++x)
+    {
+      max_diff = std::max(max_diff, std::abs(dst.pixel(x, y).x
+                                             - referenceHalfSample(src, x, y)));
+    }
+  }
+  EXPECT_LE(max_diff, tolerance) << width << "x" << height;
+}
+
+} // unnamed namespace
+
+TEST(ImagePyramidTest, testHalfSample)
+{
+  ThreadPool thread_pool(2);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool})
+  {
+    for (bool round_up : {false, true})
+    {
+      // The rounded mean of integers is within 0.5 of the exact mean.
+      testHalfSample<Pixel8uC1>(752, 480, round_up, 255.0, 0.5, pool);
+      testHalfSample<Pixel8uC1>(101, 77, round_up, 255.0, 0.5, pool);
+      testHalfSample<Pixel8uC1>(3, 2, round_up, 255.0, 0.5, pool);
+      testHalfSample<Pixel32fC1>(640, 480, round_up, 1.0, 1e-6, pool);
+      testHalfSample<Pixel32fC1>(37, 19, round_up, 1.0, 1e-6, pool);
+    }
+  }
+}
+
+TEST(ImagePyramidTest, testImagePyramidCpuHalfSampling)
+{
+  ImageRaw8uC1::Ptr img = std::make_shared<ImageRaw8uC1>(753, 481);
+  fillRandom(*img, 255.0);
+
+  ImagePyramid8uC1::Ptr pyr = createImagePyramidCpu<Pixel8uC1>(img, 0.5, 5u);
+  ASSERT_EQ(pyr->numLevels(), 5u);
+  EXPECT_EQ(pyr->atShared(0), img);
+  for (size_t i = 1u; i < pyr->numLevels(); ++i)
+  {
+    const Size2u sz = pyr->size(i);
+    EXPECT_EQ(sz.width(), static_cast<uint32_t>(753 * pyr->scaleFactor(i) + 0.5f));
+    EXPECT_EQ(sz.height(), static_cast<uint32_t>(481 * pyr->scaleFactor(i) + 0.5f));
+
+    const ImageRaw8uC1& prev = dynamic_cast<const ImageRaw8uC1&>(pyr->at(i-1));
+    ImageRaw8uC1 expected(sz);
+    halfSample(expected, prev);
+    const ImageRaw8uC1& level = dynamic_cast<const ImageRaw8uC1&>(pyr->at(i));
+    for (uint32_t y = 0u; y < sz.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < sz.width(); ++x)
+      {
+        ASSERT_EQ(level.pixel(x, y), expected.pixel(x, y));
+      }
+    }
+  }
+}
+
+TEST(ImagePyramidTest, testImagePyramidCpuScaleFactor)
+{
+  ImageRaw32fC1::Ptr img = std::make_shared<ImageRaw32fC1>(320, 240);
+  fillRandom(*img, 1.0);
+
+  ThreadPool thread_pool(2);
+  ImagePyramid32fC1::Ptr pyr =
+      createImagePyramidCpu<Pixel32fC1>(img, 0.8, UINT32_MAX, 8u, &thread_pool);
+  // 240 * 0.8^15 > 8 > 240 * 0.8^16
+  ASSERT_EQ(pyr->numLevels(), 16u);
+  for (size_t i = 1u; i < pyr->numLevels(); ++i)
+  {
+    const ImageRaw32fC1& prev = dynamic_cast<const ImageRaw32fC1&>(pyr->at(i-1));
+    ImageRaw32fC1 expected(pyr->size(i));
+    reduce(expected, prev);
+    const ImageRaw32fC1& level = dynamic_cast<const ImageRaw32fC1&>(pyr->at(i));
+    for (uint32_t y = 0u; y < level.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < level.width(); ++x)
+      {
+        ASSERT_NEAR(level.pixel(x, y).x, expected.pixel(x, y).x, 1e-6f);
+      }
+    }
+  }
+}
+
+TEST(ImagePyramidTest, testImagePyramidCpuReusesLevels)
+{
+  ImageRaw8uC1::Ptr frame0 = std::make_shared<ImageRaw8uC1>(640, 480);
+  ImageRaw8uC1::Ptr frame1 = std::make_shared<ImageRaw8uC1>(640, 480);
+  fillRandom(*frame0, 255.0, 1u);
+  fillRandom(*frame1, 255.0, 2u);
+
+  ImagePyramid8uC1::Ptr pyr = createImagePyramidCpu<Pixel8uC1>(frame0, 0.5, 4u);
+  std::vector<const Pixel8uC1*> level_data;
+  for (size_t i = 1u; i < pyr->numLevels(); ++i)
+  {
+    level_data.push_back(pyr->at(i).data());
+  }
+
+  // Same size: levels are recomputed in place.
+  updateImagePyramidCpu(*pyr, frame1);
+  ASSERT_EQ(pyr->numLevels(), 4u);
+  EXPECT_EQ(pyr->atShared(0), frame1);
+  ImagePyramid8uC1::Ptr fresh = createImagePyramidCpu<Pixel8uC1>(frame1, 0.5, 4u);
+  for (size_t i = 1u; i < pyr->numLevels(); ++i)
+  {
+    EXPECT_EQ(pyr->at(i).data(), level_data[i-1]);
+    const ImageRaw8uC1& level = dynamic_cast<const ImageRaw8uC1&>(pyr->at(i));
+    const ImageRaw8uC1& expected = dynamic_cast<const ImageRaw8uC1&>(fresh->at(i));
+    for (uint32_t y = 0u; y < level.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < level.width(); ++x)
+      {
+        ASSERT_EQ(level.pixel(x, y), expected.pixel(x, y));
+      }
+    }
+  }
+
+  // New size: levels are reallocated.
+  ImageRaw8uC1::Ptr small = std::make_shared<ImageRaw8uC1>(320, 240);
+  fillRandom(*small, 255.0);
+  updateImagePyramidCpu(*pyr, small);
+  ASSERT_EQ(pyr->numLevels(), 4u);
+  EXPECT_EQ(pyr->size(1), Size2u(160, 120));
+  EXPECT_EQ(pyr->size(3), Size2u(40, 30));
+}
+
+TEST(ImagePyramidTest, benchmarkImagePyramidCpu)
+{
+  ImageRaw8uC1::Ptr img = std::make_shared<ImageRaw8uC1>(752, 480);
+  fillRandom(*img, 255.0);
+  ImagePyramid8uC1::Ptr pyr = createImagePyramidCpu<Pixel8uC1>(img, 0.5, 5u);
+
+  auto update = [&]() { updateImagePyramidCpu(*pyr, img); };
+  runTimingBenchmark(update, 100, 10, "CPU image pyramid 752x480, 5 levels", true);
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,191 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <imp/core/image_raw.hpp>
+#include <imp/imgproc/image_filter.hpp>
+#include <imp/imgproc/reduce.hpp>
+#include <imp/imgproc/resample.hpp>
+#include <imp/imgproc/simd_row_ops.hpp>
+
+namespace {
+
+using namespace ze;
+
+template<typename Pixel>
+void fillRandom(ImageRaw<Pixel>& img, double max_value, unsigned seed = 42u)
+{
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(0.0, max_value);
+  for (uint32_t y = 0u; y < img.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < img.width(); ++x)
+    {
+      for (size_t c = 0u; c < internal::numChannels<Pixel>(); ++c)
+      {
+        img.pixel(x, y).c[c] = static_cast<typename Pixel::T>(dist(gen));
+      }
+    }
+  }
+}
+
+//! Bilinear lookup at (x*sf_x, y*sf_y), clamped to the image.
+template<typename Pixel>
+double referenceLinear(const ImageRaw<Pixel>& src, double px, double py, size_t c)
+{
+  px = std::min<double>(src.width() - 1, std::max(0.0, px));
+  py = std::min<double>(src.height() - 1, std::max(0.0, py));
+  const uint32_t x0 = static_cast<uint32_t>(px);
+  const uint32_t y0 = static_cast<uint32_t>(py);
+  const uint32_t x1 = std::min(x0 + 1u, src.width() - 1u);
+  const uint32_t y1 = std::min(y0 + 1u, src.height() - 1u);
+  const double wx = px - x0;
+  const double wy = py - y0;
+  const double top = (1.0 - wx) * src.pixel(x0, y0).c[c] + wx * src.pixel(x1, y0).c[c];
+  const double bottom = (1.0 - wx) * src.pixel(x0, y1).c[c] + wx * src.pixel(x1, y1).c[c];
+  return (1.0 - wy) * top + wy * bottom;
+}
+
+template<typename Pixel>
+void testLinear(uint32_t src_width, uint32_t src_height,
+                uint32_t dst_width, uint32_t dst_height,
+                double max_value, double tolerance, ThreadPool* thread_pool)
+{
+  ImageRaw<Pixel> src(src_width, src_height);
+  ImageRaw<Pixel> dst(dst_width, dst_height);
+  fillRandom(src, max_value);
+  resample(dst, src, InterpolationMode::Linear, false, thread_pool);
+
+  const double sf_x = static_cast<double>(src_width) / dst_width;
+  const double sf_y = static_cast<double>(src_height) / dst_height;
+  double max_diff = 0.0;
+  for (uint32_t y = 0u; y < dst_height; ++y)
+  {
+    for (uint32_t x = 0u; x < dst_width; ++x)
+    {
+      for (size_t c = 0u; c < internal::numChannels<Pixel>(); ++c)
+      {
+        max_diff = std::max(
+              max_diff,
+              std::abs(dst.pixel(x, y).c[c] - referenceLinear(src, x * sf_x, y * sf_y, c)));
+      }
+    }
+  }
+  EXPECT_LE(max_diff, tolerance)
+      << src_width << "x" << src_height << " -> " << dst_width << "x" << dst_height;
+}
+
+} // unnamed namespace
+
+TEST(ResampleTests, testLinear)
+{
+  ThreadPool thread_pool(2);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool})
+  {
+    testLinear<Pixel8uC1>(128, 96, 64, 48, 255.0, 1.0, pool);
+    testLinear<Pixel8uC1>(101, 77, 70, 53, 255.0, 1.0, pool);
+    testLinear<Pixel8uC1>(40, 30, 65, 49, 255.0, 1.0, pool);
+    testLinear<Pixel8uC3>(51, 37, 33, 21, 255.0, 1.0, pool);
+    testLinear<Pixel16uC1>(64, 64, 45, 39, 65535.0, 1.0, pool);
+    testLinear<Pixel32fC1>(99, 71, 40, 100, 1.0, 1e-5, pool);
+    testLinear<Pixel32fC4>(30, 20, 17, 13, 1.0, 1e-5, pool);
+  }
+}
+
+TEST(ResampleTests, testLinearRamp)
+{
+  const uint32_t src_width = 120u;
+  ImageRaw32fC1 src(src_width, 10u);
+  for (uint32_t y = 0u; y < src.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < src_width; ++x)
+    {
+      src.pixel(x, y) = Pixel32fC1(static_cast<float>(x));
+    }
+  }
+  ImageRaw32fC1 dst(50u, 10u);
+  resample(dst, src);
+  const float sf = static_cast<float>(src_width) / dst.width();
+  for (uint32_t x = 0u; x < dst.width(); ++x)
+  {
+    EXPECT_NEAR(dst.pixel(x, 5).x, x * sf, 1e-4f);
+  }
+}
+
+TEST(ResampleTests, testPoint)
+{
+  ThreadPool thread_pool(2);
+  for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr), &thread_pool})
+  {
+    ImageRaw8uC2 src(97, 63);
+    ImageRaw8uC2 dst(41, 80);
+    fillRandom(src, 255.0);
+    resample(dst, src, InterpolationMode::Point, false, pool);
+    const float sf_x = static_cast<float>(src.width()) / dst.width();
+    const float sf_y = static_cast<float>(src.height()) / dst.height();
+    for (uint32_t y = 0u; y < dst.height(); ++y)
+    {
+      for (uint32_t x = 0u; x < dst.width(); ++x)
+      {
+        const uint32_t sx = std::min(src.width() - 1u,
+                                     static_cast<uint32_t>(std::floor(x * sf_x + 0.5f)));
+        const uint32_t sy = std::min(src.height() - 1u,
+                                     static_cast<uint32_t>(std::floor(y * sf_y + 0.5f)));
+        ASSERT_EQ(dst.pixel(x, y), src.pixel(sx, sy));
+      }
+    }
+  }
+}
+
+TEST(ResampleTests, testReduceMatchesPrefilteredResample)
+{
+  ImageRaw32fC1 src(160, 120);
+  fillRandom(src, 1.0);
+
+  ImageRaw32fC1 reduced(100, 75);
+  ThreadPool thread_pool(2);
+  reduce(reduced, src, InterpolationMode::Linear, true, &thread_pool);
+
+  // sf = 1.6 -> sigma = 1/(3*sf), kernel size ceil(6*sigma) made odd.
+  const float sigma = 1.0f / (3.0f * 1.6f);
+  ImageRaw32fC1 filtered(src.size());
+  filterGauss(filtered, src, sigma, 3);
+  ImageRaw32fC1 expected(100, 75);
+  resample(expected, filtered, InterpolationMode::Linear);
+  for (uint32_t y = 0u; y < reduced.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < reduced.width(); ++x)
+    {
+      ASSERT_NEAR(reduced.pixel(x, y).x, expected.pixel(x, y).x, 1e-6f);
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
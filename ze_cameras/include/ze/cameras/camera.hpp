@@ -37,6 +37,7 @@
 
 #include <imp/core/image.hpp>
 #include <imp/core/size.hpp>
+#include <ze/cameras/camera_undistortion_lut.hpp>
 #include <ze/common/macros.hpp>
 #include <ze/common/types.hpp>
 
@@ -125,6 +126,8 @@ public:
   virtual Bearings backProjectVectorized(const Eigen::Ref<const Keypoints>& px_vec) const;
   virtual Keypoints projectVectorized(const Eigen::Ref<const Bearings>& bearing_vec) const;
   virtual Matrix6X dProject_dLandmarkVectorized(const Positions& pos_vec) const;
+  virtual std::pair<Keypoints, Matrix6X> projectWithJacobianVectorized(
+      const Positions& pos_vec) const;
   //! @}
 
   //! @name Image dimension.
@@ -164,6 +167,24 @@ public:
   //! Get mask.
   inline Image8uC1::ConstPtr mask() const { return mask_; }
 
+  //! @name Undistortion lookup table.
+  //! For models with iterative undistortion, backProject() and
+  //! backProjectVectorized() can use a precomputed table instead. Not
+  //! thread-safe with respect to concurrent back-projection.
+  //! @{
+  //! Builds the table within max_bytes and with reprojection error below
+  //! max_error_px. Returns false if the model has closed-form undistortion or
+  //! no table satisfies the bounds, in which case the table is disabled.
+  bool enableUndistortionLut(size_t max_bytes, real_t max_error_px = 0.01);
+
+  inline void disableUndistortionLut() { undistortion_lut_.reset(); }
+
+  inline const UndistortionLut::ConstPtr& undistortionLut() const
+  {
+    return undistortion_lut_;
+  }
+  //! @}
+
 protected:
   Size2u size_;
 
@@ -176,6 +197,7 @@ protected:
   std::string label_;
   CameraType type_;
   Image8uC1::Ptr mask_ = nullptr;
+  UndistortionLut::ConstPtr undistortion_lut_ = nullptr;
 };
 
 //! Load a camera rig form a yaml file. Returns a nullptr if the loading fails.
@@ -68,6 +68,11 @@ public:
   virtual Bearing backProject(
       const Eigen::Ref<const Keypoint>& px) const override
   {
+    if (this->undistortion_lut_
+        && this->undistortion_lut_->contains(px(0), px(1)))
+    {
+      return this->undistortion_lut_->backProject(px);
+    }
     Bearing bearing;
     bearing << px(0), px(1), 1.0;
     PinholeGeometry::backProject(this->projection_params_.data(), bearing.data());
@@ -105,6 +110,91 @@ public:
     return std::make_pair(px, J);
   }
 
+  virtual Bearings backProjectVectorized(
+      const Eigen::Ref<const Keypoints>& px_vec) const override
+  {
+    const int n = px_vec.cols();
+    Bearings bearings(3, n);
+    const real_t fx = this->projection_params_[0];
+    const real_t fy = this->projection_params_[1];
+    const real_t cx = this->projection_params_[2];
+    const real_t cy = this->projection_params_[3];
+    real_t x[c_block_size];
+    real_t y[c_block_size];
+    const UndistortionLut* lut = this->undistortion_lut_.get();
+    int idx[c_block_size];
+    int k = 0;
+    for (int j = 0; j <= n; ++j)
+    {
+      if (j < n)
+      {
+        const real_t u = px_vec(0, j);
+        const real_t v = px_vec(1, j);
+        if (lut && lut->contains(u, v))
+        {
+          // Don't touch x/y here, they may hold pending points.
+          real_t x_lut, y_lut;
+          lut->lookup(u, v, &x_lut, &y_lut);
+          const real_t norm_inv = 1.0 / std::sqrt(x_lut * x_lut + y_lut * y_lut + 1.0);
+          bearings(0, j) = x_lut * norm_inv;
+          bearings(1, j) = y_lut * norm_inv;
+          bearings(2, j) = norm_inv;
+          continue;
+        }
+        // Gather the points that need the camera model.
+        idx[k] = j;
+        x[k] = (u - cx) / fx;
+        y[k] = (v - cy) / fy;
+        ++k;
+      }
+      if (k == c_block_size || (j == n && k > 0))
+      {
+        for (int i = k; i < c_block_size; ++i)
+        {
+          // Padding lanes are set to the principal point.
+          x[i] = 0.0;
+          y[i] = 0.0;
+        }
+        Distortion::template undistortBlock<c_block_size>(
+              this->distortion_params_.data(), x, y);
+        for (int i = 0; i < k; ++i)
+        {
+          const real_t norm_inv = 1.0 / std::sqrt(x[i] * x[i] + y[i] * y[i] + 1.0);
+          bearings(0, idx[i]) = x[i] * norm_inv;
+          bearings(1, idx[i]) = y[i] * norm_inv;
+          bearings(2, idx[i]) = norm_inv;
+        }
+        k = 0;
+      }
+    }
+    return bearings;
+  }
+
+  virtual Keypoints projectVectorized(
+      const Eigen::Ref<const Bearings>& bearing_vec) const override
+  {
+    Keypoints px_vec(2, bearing_vec.cols());
+    projectBlocks(bearing_vec, &px_vec, nullptr);
+    return px_vec;
+  }
+
+  virtual Matrix6X dProject_dLandmarkVectorized(
+      const Positions& pos_vec) const override
+  {
+    Matrix6X J_vec(6, pos_vec.cols());
+    projectBlocks(pos_vec, nullptr, &J_vec);
+    return J_vec;
+  }
+
+  virtual std::pair<Keypoints, Matrix6X> projectWithJacobianVectorized(
+      const Positions& pos_vec) const override
+  {
+    std::pair<Keypoints, Matrix6X> res(
+          Keypoints(2, pos_vec.cols()), Matrix6X(6, pos_vec.cols()));
+    projectBlocks(pos_vec, &res.first, &res.second);
+    return res;
+  }
+
   virtual real_t getApproxAnglePerPixel() const override
   {
     //! @todo: Is this correct? And if yes, this is costlty to compute often!
@@ -122,6 +212,69 @@ public:
     return std::atan(px_diff / (2.0 * std::abs(this->projection_params_[0])))
          + std::atan(px_diff / (2.0 * std::abs(this->projection_params_[1])));
   }
+
+private:
+  //! Number of points processed together by the batched (vectorized) methods.
+  static constexpr int c_block_size = 8;
+
+  //! Projects blocks of points and optionally computes the Jacobians, stored
+  //! column-wise as in dProject_dLandmarkVectorized. px_vec and J_vec must be
+  //! preallocated or nullptr.
+  void projectBlocks(const Eigen::Ref<const Positions>& pos_vec,
+                     Keypoints* px_vec, Matrix6X* J_vec) const
+  {
+    const int n = pos_vec.cols();
+    const real_t fx = this->projection_params_[0];
+    const real_t fy = this->projection_params_[1];
+    const real_t cx = this->projection_params_[2];
+    const real_t cy = this->projection_params_[3];
+    real_t z_inv[c_block_size];
+    real_t x[c_block_size];
+    real_t y[c_block_size];
+    real_t jac[4 * c_block_size];
+    for (int begin = 0; begin < n; begin += c_block_size)
+    {
+      const int m = (n - begin < c_block_size) ? n - begin : c_block_size;
+      for (int i = 0; i < c_block_size; ++i)
+      {
+        // Padding lanes are set to the optical axis.
+        z_inv[i] = (i < m) ? 1.0 / pos_vec(2, begin + i) : 1.0;
+        x[i] = (i < m) ? pos_vec(0, begin + i) * z_inv[i] : 0.0;
+        y[i] = (i < m) ? pos_vec(1, begin + i) * z_inv[i] : 0.0;
+      }
+      Distortion::template distortBlock<c_block_size>(
+            this->distortion_params_.data(), x, y, J_vec ? jac : nullptr);
+      if (px_vec)
+      {
+        for (int i = 0; i < m; ++i)
+        {
+          (*px_vec)(0, begin + i) = x[i] * fx + cx;
+          (*px_vec)(1, begin + i) = y[i] * fy + cy;
+        }
+      }
+      if (J_vec)
+      {
+        const real_t* J_00 = jac;
+        const real_t* J_10 = jac + c_block_size;
+        const real_t* J_01 = jac + 2 * c_block_size;
+        const real_t* J_11 = jac + 3 * c_block_size;
+        for (int i = 0; i < m; ++i)
+        {
+          // Column-major Matrix23 as in the scalar dProject_dLandmark.
+          const int k = begin + i;
+          const real_t z_inv_sq = z_inv[i] * z_inv[i];
+          const real_t px = pos_vec(0, k);
+          const real_t py = pos_vec(1, k);
+          (*J_vec)(0, k) = fx * J_00[i] * z_inv[i];
+          (*J_vec)(1, k) = fy * J_10[i] * z_inv[i];
+          (*J_vec)(2, k) = fx * J_01[i] * z_inv[i];
+          (*J_vec)(3, k) = fy * J_11[i] * z_inv[i];
+          (*J_vec)(4, k) = -fx * (px * J_00[i] + py * J_01[i]) * z_inv_sq;
+          (*J_vec)(5, k) = -fy * (px * J_10[i] + py * J_11[i]) * z_inv_sq;
+        }
+      }
+    }
+  }
 };
 
 //-----------------------------------------------------------------------------
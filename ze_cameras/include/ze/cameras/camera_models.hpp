@@ -42,6 +42,13 @@ namespace ze {
 // Pure static camera projection and distortion models, intended to be used in
 // both GPU and CPU code. Parameter checking should be performed in interface
 // classes.
+//
+// The distortion models additionally provide host-only batched variants
+// distortBlock<N>() and undistortBlock<N>() that operate on structure-of-arrays
+// blocks of N points. The Jacobian of distortBlock() is stored as four arrays
+// of length N in the order J_00, J_10, J_01, J_11. Branches are written as
+// selects so that the compiler can vectorize the loops; transcendental
+// functions are kept in separate loops as they are evaluated per point.
 
 // Pinhole projection model.
 struct PinholeGeometry
@@ -122,6 +129,25 @@ struct NoDistortion
   CUDA_HOST CUDA_DEVICE
   static void undistort(const T* /*params*/, T* /*px*/)
   {}
+
+  template <int N, typename T>
+  static void distortBlock(const T* /*params*/, T* /*x*/, T* /*y*/, T* jac = nullptr)
+  {
+    if (jac)
+    {
+      for (int i = 0; i < N; ++i)
+      {
+        jac[i] = 1.0;
+        jac[N + i] = 0.0;
+        jac[2 * N + i] = 0.0;
+        jac[3 * N + i] = 1.0;
+      }
+    }
+  }
+
+  template <int N, typename T>
+  static void undistortBlock(const T* /*params*/, T* /*x*/, T* /*y*/)
+  {}
 };
 
 // -----------------------------------------------------------------------------
@@ -196,8 +222,169 @@ struct FovDistortion
     px[0] *= factor;
     px[1] *= factor;
   }
+
+  template <int N, typename T>
+  static void distortBlock(const T* params, T* x, T* y, T* jac = nullptr)
+  {
+    const T s = params[0];
+    const T tan_s_half_x2 = params[1];
+    T rad[N];
+    T factor[N];
+    for (int i = 0; i < N; ++i)
+    {
+      rad[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      factor[i] = std::atan(rad[i] * tan_s_half_x2);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      const bool center = rad[i] < 0.001;
+      const T rad_safe = center ? T(1.0) : rad[i];
+      factor[i] = center ? T(1.0) : factor[i] / (s * rad_safe);
+    }
+
+    if (jac)
+    {
+      T* J_00 = jac;
+      T* J_10 = jac + N;
+      T* J_01 = jac + 2 * N;
+      T* J_11 = jac + 3 * N;
+      if (s * s < 1e-5)
+      {
+        for (int i = 0; i < N; ++i)
+        {
+          J_00[i] = 1.0; J_01[i] = 0.0;
+          J_10[i] = 0.0; J_11[i] = 1.0;
+        }
+      }
+      else
+      {
+        const T J_center = 2.0 * std::tan(s / 2.0) / s;
+        const T tan_sq = tan_s_half_x2 * tan_s_half_x2;
+        for (int i = 0; i < N; ++i)
+        {
+          const T xx = x[i] * x[i];
+          const T yy = y[i] * y[i];
+          const T rad_sq = xx + yy;
+          const bool center = rad_sq < 1e-5;
+          const T rad_sq_safe = center ? T(1.0) : rad_sq;
+          const T scale =
+              tan_s_half_x2 / (s * rad_sq_safe * (tan_sq * rad_sq_safe + 1.0))
+              - factor[i] / rad_sq_safe;
+          J_00[i] = center ? J_center : xx * scale + factor[i];
+          J_11[i] = center ? J_center : yy * scale + factor[i];
+          J_01[i] = center ? T(0.0) : x[i] * y[i] * scale;
+          J_10[i] = J_01[i];
+        }
+      }
+    }
+
+    for (int i = 0; i < N; ++i)
+    {
+      x[i] *= factor[i];
+      y[i] *= factor[i];
+    }
+  }
+
+  template <int N, typename T>
+  static void undistortBlock(const T* params, T* x, T* y)
+  {
+    const T s = params[0];
+    const T tan_s_half_x2 = params[1];
+    T rad[N];
+    T factor[N];
+    for (int i = 0; i < N; ++i)
+    {
+      rad[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      factor[i] = std::tan(rad[i] * s);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      const bool center = rad[i] < 0.001;
+      const T rad_safe = center ? T(1.0) : rad[i];
+      factor[i] = center ? T(1.0) : (factor[i] / tan_s_half_x2) / rad_safe;
+      x[i] *= factor[i];
+      y[i] *= factor[i];
+    }
+  }
 };
 
+namespace internal {
+
+//! Gauss-Newton undistortion of a block of N points for distortion models
+//! without closed-form inverse. Each lane follows exactly the iterations of
+//! the scalar undistort() and is frozen once its residual is small.
+template <class Distortion, int N, typename T>
+void undistortBlockGaussNewton(const T* params, T* x_io, T* y_io)
+{
+  T x[N], y[N], x_tmp[N], y_tmp[N], jac[4 * N];
+  bool active[N];
+  for (int i = 0; i < N; ++i)
+  {
+    x[i] = x_io[i];
+    y[i] = y_io[i];
+    active[i] = true;
+  }
+
+  for (int iter = 0; iter < 30; ++iter)
+  {
+    for (int i = 0; i < N; ++i)
+    {
+      x_tmp[i] = x[i];
+      y_tmp[i] = y[i];
+    }
+    Distortion::template distortBlock<N>(params, x_tmp, y_tmp, jac);
+
+    int num_active = 0;
+    for (int i = 0; i < N; ++i)
+    {
+      const T e_u = x_io[i] - x_tmp[i];
+      const T e_v = y_io[i] - y_tmp[i];
+
+      const T a = jac[i];
+      const T b = jac[N + i];
+      const T d = jac[3 * N + i];
+
+      // direct gauss newton step
+      const T a_sqr = a * a;
+      const T b_sqr = b * b;
+      const T d_sqr = d * d;
+      const T abbd = a * b + b * d;
+      const T abbd_sqr = abbd * abbd;
+      const T a2b2 = a_sqr + b_sqr;
+      const T a2b2_inv = 1.0 / a2b2;
+      const T adabdb = a_sqr * d_sqr - 2 * a * b_sqr * d + b_sqr * b_sqr;
+      const T adabdb_inv = 1.0 / adabdb;
+      const T c1 = abbd * adabdb_inv;
+
+      const T dx = e_u * (a * (abbd_sqr * a2b2_inv * adabdb_inv + a2b2_inv) - b * c1) + e_v * (b * (abbd_sqr * a2b2_inv * adabdb_inv + a2b2_inv) - d * c1);
+      const T dy = e_u * (-a * c1 + b * a2b2 * adabdb_inv) + e_v * (-b * c1 + d * a2b2 * adabdb_inv);
+      x[i] = active[i] ? x[i] + dx : x[i];
+      y[i] = active[i] ? y[i] + dy : y[i];
+
+      active[i] = active[i] && (e_u * e_u + e_v * e_v) >= 1e-8;
+      num_active += active[i];
+    }
+    if (num_active == 0)
+    {
+      break;
+    }
+  }
+
+  for (int i = 0; i < N; ++i)
+  {
+    x_io[i] = x[i];
+    y_io[i] = y[i];
+  }
+}
+
+} // namespace internal
+
 // -----------------------------------------------------------------------------
 // This class implements the radial and tangential distortion model used by
 // OpenCV and ROS. Reference:
@@ -283,6 +470,43 @@ struct RadialTangentialDistortion
     px[0] = x[0];
     px[1] = x[1];
   }
+
+  template <int N, typename T>
+  static void distortBlock(const T* params, T* x, T* y, T* jac = nullptr)
+  {
+    const T k1 = params[0];
+    const T k2 = params[1];
+    const T p1 = params[2];
+    const T p2 = params[3];
+    for (int i = 0; i < N; ++i)
+    {
+      const T xi = x[i];
+      const T yi = y[i];
+      const T xx = xi * xi;
+      const T yy = yi * yi;
+      const T xy = xi * yi;
+      const T r2 = xx + yy;
+      const T cdist = (k1 + k2 * r2) * r2;
+      x[i] += xi * cdist + p1 * 2.0 * xy + p2 * (r2 + 2.0 * xx);
+      y[i] += yi * cdist + p2 * 2.0 * xy + p1 * (r2 + 2.0 * yy);
+
+      if (jac)
+      {
+        const T k2_r2_x4 = k2 * r2 * 4.0;
+        const T cdist_p1 = cdist + 1.0;
+        jac[i] = cdist_p1 + k1 * 2.0 * xx + k2_r2_x4 * xx + 2.0 * p1 * yi + 6.0 * p2 * xi;
+        jac[3 * N + i] = cdist_p1 + k1 * 2.0 * yy + k2_r2_x4 * yy + 2.0 * p2 * xi + 6.0 * p1 * yi;
+        jac[N + i] = 2.0 * k1 * xy + k2_r2_x4 * xy + 2.0 * p1 * xi + 2.0 * p2 * yi;
+        jac[2 * N + i] = jac[N + i];
+      }
+    }
+  }
+
+  template <int N, typename T>
+  static void undistortBlock(const T* params, T* x, T* y)
+  {
+    internal::undistortBlockGaussNewton<RadialTangentialDistortion, N>(params, x, y);
+  }
 };
 
 // -----------------------------------------------------------------------------
@@ -403,6 +627,66 @@ struct EquidistantDistortion
     px[0] = x[0];
     px[1] = x[1];
   }
+
+  template <int N, typename T>
+  static void distortBlock(const T* params, T* x, T* y, T* jac = nullptr)
+  {
+    const T k1 = params[0];
+    const T k2 = params[1];
+    const T k3 = params[2];
+    const T k4 = params[3];
+    T r[N];
+    T theta[N];
+    for (int i = 0; i < N; ++i)
+    {
+      r[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      theta[i] = std::atan(r[i]);
+    }
+    for (int i = 0; i < N; ++i)
+    {
+      const T xi = x[i];
+      const T yi = y[i];
+      const T r_sqr = r[i] * r[i];
+      const T theta2 = theta[i] * theta[i];
+      const T theta4 = theta2 * theta2;
+      const T theta6 = theta4 * theta2;
+      const T theta8 = theta4 * theta4;
+      const T t2 = k1 * theta2 + k2 * theta4 + k3 * theta6 + k4 * theta8 + 1.0;
+      const T r_safe = (r[i] > 1e-8) ? r[i] : T(1.0);
+      const T theta_inv_r = theta[i] / r_safe;
+      const T scaling = (r[i] > 1e-8) ? t2 * theta_inv_r : T(1.0);
+      x[i] *= scaling;
+      y[i] *= scaling;
+
+      if (jac)
+      {
+        const bool center = r[i] < 1e-7;
+        const T r_sqr_safe = center ? T(1.0) : r_sqr;
+        const T t1 = 1.0 / (r_sqr + 1.0);
+        const T t3 = t1 * theta_inv_r;
+        const T offset = t2 * theta_inv_r;
+        const T scale = t2 * (t1 / r_sqr_safe - theta_inv_r / r_sqr_safe)
+            + theta_inv_r * t3 * (
+                  2.0 * k1
+                + 4.0 * k2 * theta2
+                + 6.0 * k3 * theta4
+                + 8.0 * k4 * theta6);
+        jac[i] = center ? T(1.0) : xi * xi * scale + offset;
+        jac[3 * N + i] = center ? T(1.0) : yi * yi * scale + offset;
+        jac[N + i] = center ? T(0.0) : xi * yi * scale;
+        jac[2 * N + i] = jac[N + i];
+      }
+    }
+  }
+
+  template <int N, typename T>
+  static void undistortBlock(const T* params, T* x, T* y)
+  {
+    internal::undistortBlockGaussNewton<EquidistantDistortion, N>(params, x, y);
+  }
 };
 
 } // namespace ze
@@ -0,0 +1,122 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <ze/common/logging.hpp>
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+// fwd
+class Camera;
+
+//! Precomputed pixel to unit-plane lookup table for cameras whose
+//! undistortion is iterative (radial-tangential, equidistant).
+//!
+//! The undistorted unit-plane coordinates are stored on a regular pixel grid
+//! with a step of 2^k pixels and bilinearly interpolated in between. The grid
+//! covers [0, width-1] x [0, height-1]; pixels outside are not contained and
+//! must be back-projected with the camera model.
+class UndistortionLut
+{
+public:
+  ZE_POINTER_TYPEDEFS(UndistortionLut);
+
+  //! Builds the table with the given grid step for a camera that has no
+  //! lookup table enabled.
+  UndistortionLut(const Camera& cam, int step);
+
+  //! Builds the table with the coarsest grid step whose memory does not exceed
+  //! max_bytes and whose reprojection error, evaluated at all cell centers,
+  //! is below max_error_px. Returns nullptr if no grid step satisfies both.
+  static Ptr create(const Camera& cam, size_t max_bytes, real_t max_error_px);
+
+  //! Returns true if the pixel can be looked up.
+  inline bool contains(real_t u, real_t v) const
+  {
+    return u >= 0.0 && v >= 0.0 && u <= u_max_ && v <= v_max_;
+  }
+
+  //! Interpolated unit-plane coordinates of pixel (u, v), which must be contained.
+  inline void lookup(real_t u, real_t v, real_t* x, real_t* y) const
+  {
+    DEBUG_CHECK(contains(u, v));
+    const real_t gu = u * step_inv_;
+    const real_t gv = v * step_inv_;
+    const int iu = std::min(static_cast<int>(gu), cols_ - 2);
+    const int iv = std::min(static_cast<int>(gv), rows_ - 2);
+    const real_t wu = gu - iu;
+    const real_t wv = gv - iv;
+    const real_t* p00 = &table_[2 * (iv * cols_ + iu)];
+    const real_t* p01 = p00 + 2;
+    const real_t* p10 = p00 + 2 * cols_;
+    const real_t* p11 = p10 + 2;
+    *x = (1.0 - wv) * ((1.0 - wu) * p00[0] + wu * p01[0])
+        + wv * ((1.0 - wu) * p10[0] + wu * p11[0]);
+    *y = (1.0 - wv) * ((1.0 - wu) * p00[1] + wu * p01[1])
+        + wv * ((1.0 - wu) * p10[1] + wu * p11[1]);
+  }
+
+  //! Normalized bearing vector of pixel px, which must be contained.
+  inline Bearing backProject(const Eigen::Ref<const Keypoint>& px) const
+  {
+    Bearing f;
+    lookup(px(0), px(1), &f(0), &f(1));
+    f(2) = 1.0;
+    return f.normalized();
+  }
+
+  //! Grid step in pixels.
+  inline int step() const { return step_; }
+
+  //! Size of the table in bytes.
+  inline size_t memoryBytes() const { return table_.size() * sizeof(real_t); }
+
+  //! Maximum reprojection error in pixels, evaluated at all cell centers.
+  inline real_t maxError() const { return max_error_; }
+
+  //! Memory in bytes of a table with the given grid step.
+  static size_t memoryBytes(const Camera& cam, int step);
+
+private:
+  real_t evaluateMaxError(const Camera& cam) const;
+
+  int step_;
+  real_t step_inv_;
+  int cols_;
+  int rows_;
+  real_t u_max_;
+  real_t v_max_;
+  real_t max_error_ = 0.0;
+
+  //! Interleaved unit-plane coordinates (x, y), row-major over the grid.
+  std::vector<real_t> table_;
+};
+
+} // namespace ze
@@ -145,6 +145,13 @@ Matrix6X Camera::dProject_dLandmarkVectorized(const Positions& pos_vec) const
   return J_vec;
 }
 
+std::pair<Keypoints, Matrix6X> Camera::projectWithJacobianVectorized(
+    const Positions& pos_vec) const
+{
+  return std::make_pair(projectVectorized(pos_vec),
+                        dProject_dLandmarkVectorized(pos_vec));
+}
+
 std::string Camera::typeAsString() const
 {
   switch (type_)
@@ -166,6 +173,27 @@ void Camera::setMask(const Image8uC1::Ptr& mask)
   mask_ = mask;
 }
 
+bool Camera::enableUndistortionLut(size_t max_bytes, real_t max_error_px)
+{
+  undistortion_lut_.reset();
+  if (type_ != CameraType::PinholeRadialTangential
+      && type_ != CameraType::PinholeEquidistant)
+  {
+    VLOG(1) << "No undistortion table needed for " << typeAsString() << ".";
+    return false;
+  }
+  undistortion_lut_ = UndistortionLut::create(*this, max_bytes, max_error_px);
+  if (!undistortion_lut_)
+  {
+    LOG(WARNING) << "No undistortion table within " << max_bytes
+                 << " bytes and " << max_error_px << " px error.";
+    return false;
+  }
+  VLOG(1) << "Undistortion table with step " << undistortion_lut_->step()
+          << " and max error " << undistortion_lut_->maxError() << " px.";
+  return true;
+}
+
 Camera::Ptr cameraFromYaml(const std::string& path)
 {
   try
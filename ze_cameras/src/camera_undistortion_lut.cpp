@@ -0,0 +1,125 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/cameras/camera_undistortion_lut.hpp>
+
+#include <ze/cameras/camera.hpp>
+
+namespace ze {
+
+namespace {
+
+inline int gridSize(uint32_t size, int step)
+{
+  // Nodes at 0, step, ..., with the last node at or beyond size - 1.
+  return (static_cast<int>(size) - 2) / step + 2;
+}
+
+} // unnamed namespace
+
+UndistortionLut::UndistortionLut(const Camera& cam, int step)
+  : step_(step)
+  , step_inv_(1.0 / step)
+  , cols_(gridSize(cam.width(), step))
+  , rows_(gridSize(cam.height(), step))
+  , u_max_(cam.width() - 1)
+  , v_max_(cam.height() - 1)
+{
+  CHECK_GT(step, 0);
+  CHECK_GE(cam.width(), 2u);
+  CHECK_GE(cam.height(), 2u);
+  CHECK(!cam.undistortionLut()) << "Camera must back-project without table.";
+
+  Keypoints px(2, cols_ * rows_);
+  for (int v = 0; v < rows_; ++v)
+  {
+    for (int u = 0; u < cols_; ++u)
+    {
+      px.col(v * cols_ + u) = Keypoint(u * step, v * step);
+    }
+  }
+  const Bearings f = cam.backProjectVectorized(px);
+  table_.resize(2 * f.cols());
+  for (int i = 0; i < f.cols(); ++i)
+  {
+    table_[2 * i] = f(0, i) / f(2, i);
+    table_[2 * i + 1] = f(1, i) / f(2, i);
+  }
+  max_error_ = evaluateMaxError(cam);
+}
+
+UndistortionLut::Ptr UndistortionLut::create(
+    const Camera& cam, size_t max_bytes, real_t max_error_px)
+{
+  // Coarse grids are cheaper and more cache friendly, hence start with the
+  // coarsest step and refine until the error bound holds.
+  for (int step = 64; step >= 1; step /= 2)
+  {
+    if (memoryBytes(cam, step) > max_bytes)
+    {
+      break;
+    }
+    Ptr lut = std::make_shared<UndistortionLut>(cam, step);
+    VLOG(10) << "Undistortion table with step " << step << ": "
+             << lut->memoryBytes() << " bytes, max error "
+             << lut->maxError() << " px.";
+    if (lut->maxError() <= max_error_px)
+    {
+      return lut;
+    }
+  }
+  return nullptr;
+}
+
+size_t UndistortionLut::memoryBytes(const Camera& cam, int step)
+{
+  return static_cast<size_t>(gridSize(cam.width(), step))
+      * gridSize(cam.height(), step) * 2u * sizeof(real_t);
+}
+
+real_t UndistortionLut::evaluateMaxError(const Camera& cam) const
+{
+  // Bilinear interpolation is least accurate in the cell centers.
+  const real_t half_step = 0.5 * step_;
+  Keypoints px(2, (cols_ - 1) * (rows_ - 1));
+  int n = 0;
+  for (int v = 0; v < rows_ - 1; ++v)
+  {
+    for (int u = 0; u < cols_ - 1; ++u)
+    {
+      const Keypoint center(std::min(u * step_ + half_step, u_max_),
+                            std::min(v * step_ + half_step, v_max_));
+      px.col(n++) = center;
+    }
+  }
+  Bearings f(3, n);
+  for (int i = 0; i < n; ++i)
+  {
+    f.col(i) = backProject(px.col(i));
+  }
+  return (cam.projectVectorized(f) - px).colwise().norm().maxCoeff();
+}
+
+} // namespace ze
@@ -222,8 +222,41 @@ public:
     EXPECT_TRUE(EIGEN_MATRIX_NEAR(H, H_numerical, 1e-6));
   }
 
+  void testVectorized()
+  {
+    // Batched kernels must agree with the per-point implementation, including
+    // the image center and a number of points that is not a block multiple.
+    Keypoints px(2, sample_size_ + 1);
+    px.leftCols(sample_size_) =
+        generateRandomKeypoints(cam_.size(), 10u, sample_size_);
+    px.col(sample_size_) = cam_.projectionParameters().tail<2>();
+    Bearings f = cam_.backProjectVectorized(px);
+    Positions pos = f * 2.5;
+    Keypoints px_vec = cam_.projectVectorized(pos);
+    Matrix6X J_vec = cam_.dProject_dLandmarkVectorized(pos);
+    std::pair<Keypoints, Matrix6X> px_J_vec = cam_.projectWithJacobianVectorized(pos);
+#ifndef ZE_SINGLE_PRECISION_FLOAT
+    const real_t tol = 1e-9;
+#else
+    const real_t tol = 1e-4;
+#endif
+    for (int i = 0; i < px.cols(); ++i)
+    {
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(f.col(i), cam_.backProject(px.col(i)), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px_vec.col(i), cam_.project(pos.col(i)), tol));
+      Matrix23 J = cam_.dProject_dLandmark(pos.col(i));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(J_vec.col(i), Eigen::Map<Matrix61>(J.data()), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px_J_vec.first.col(i), px_vec.col(i), tol));
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(px_J_vec.second.col(i), J_vec.col(i), tol));
+    }
+  }
+
   void testAll()
   {
+    {
+      SCOPED_TRACE("Vectorized");
+      testVectorized();
+    }
     {
       SCOPED_TRACE("Projection");
       testProjection();
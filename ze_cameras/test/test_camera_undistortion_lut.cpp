@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_utils.hpp>
+#include <ze/cameras/camera_impl.hpp>
+#include <ze/cameras/camera_undistortion_lut.hpp>
+#include <ze/cameras/camera_utils.hpp>
+
+namespace ze {
+
+void testUndistortionLut(Camera& cam, size_t max_bytes, real_t max_error_px)
+{
+  Keypoints px(2, 503);
+  px.leftCols(500) = generateRandomKeypoints(cam.size(), 0u, 500);
+  px.col(500) = Keypoint(0.0, 0.0);
+  px.col(501) = Keypoint(cam.width() - 1, cam.height() - 1);
+  px.col(502) = Keypoint(-3.0, cam.height() + 2.0); // Outside of table.
+  const Bearings f_model = cam.backProjectVectorized(px);
+
+  ASSERT_TRUE(cam.enableUndistortionLut(max_bytes, max_error_px));
+  const UndistortionLut::ConstPtr& lut = cam.undistortionLut();
+  ASSERT_TRUE(lut);
+  EXPECT_LE(lut->memoryBytes(), max_bytes);
+  EXPECT_LE(lut->maxError(), max_error_px);
+  EXPECT_FALSE(lut->contains(px(0, 502), px(1, 502)));
+
+  const Bearings f_lut = cam.backProjectVectorized(px);
+  for (int i = 0; i < px.cols(); ++i)
+  {
+    Bearing f = cam.backProject(px.col(i));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(f, f_lut.col(i), 1e-9));
+    EXPECT_NEAR(f.norm(), 1.0, 1e-9);
+    EXPECT_LE((cam.project(f) - px.col(i)).norm(), max_error_px);
+  }
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(f_lut.col(502), f_model.col(502), 1e-9));
+
+  cam.disableUndistortionLut();
+  EXPECT_FALSE(cam.undistortionLut());
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(cam.backProjectVectorized(px), f_model, 1e-9));
+}
+
+} // namespace ze
+
+TEST(CameraUndistortionLutTests, testRadTan)
+{
+  using namespace ze;
+  RadTanCamera cam = createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                                        -0.2834, 0.0739, 0.00019, 1.76e-05);
+  testUndistortionLut(cam, 1u << 20, 0.05);
+}
+
+TEST(CameraUndistortionLutTests, testEquidistant)
+{
+  using namespace ze;
+  EquidistantCamera cam = createEquidistantCamera(752, 480, 310, 320, 376.0, 240.0,
+                                                  -0.00279, 0.02414, -0.04304, 0.03118);
+  testUndistortionLut(cam, 1u << 20, 0.05);
+}
+
+TEST(CameraUndistortionLutTests, testMixedInsideOutside)
+{
+  using namespace ze;
+  RadTanCamera cam = createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                                        -0.2834, 0.0739, 0.00019, 1.76e-05);
+  // Table hits between pending outside points must not overwrite them.
+  Keypoints px(2, 7);
+  px << -3.0, 100.0, 700.0, 800.0,  -5.0, 376.0, 760.0,
+        490.0, 100.0, 400.0, 240.0, -4.0, 240.0, 485.0;
+  const Bearings f_model = cam.backProjectVectorized(px);
+
+  ASSERT_TRUE(cam.enableUndistortionLut(1u << 20, 0.05));
+  const Bearings f_lut = cam.backProjectVectorized(px);
+  for (int i = 0; i < px.cols(); ++i)
+  {
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(f_lut.col(i), cam.backProject(px.col(i)), 1e-9));
+    if (!cam.undistortionLut()->contains(px(0, i), px(1, i)))
+    {
+      EXPECT_TRUE(EIGEN_MATRIX_NEAR(f_lut.col(i), f_model.col(i), 1e-9));
+    }
+  }
+}
+
+TEST(CameraUndistortionLutTests, testBounds)
+{
+  using namespace ze;
+  RadTanCamera cam = createRadTanCamera(752, 480, 310, 320, 376.0, 240.0,
+                                        -0.2834, 0.0739, 0.00019, 1.76e-05);
+  // Finer error bounds need finer grids.
+  ASSERT_TRUE(cam.enableUndistortionLut(1u << 24, 0.1));
+  const int coarse_step = cam.undistortionLut()->step();
+  ASSERT_TRUE(cam.enableUndistortionLut(1u << 24, 0.01));
+  EXPECT_LT(cam.undistortionLut()->step(), coarse_step);
+
+  // Budget too small for the error bound.
+  EXPECT_FALSE(cam.enableUndistortionLut(
+                 UndistortionLut::memoryBytes(cam, 64), 1e-6));
+  EXPECT_FALSE(cam.undistortionLut());
+
+  // Closed-form undistortion does not use a table.
+  PinholeCamera pinhole = createPinholeCamera(752, 480, 310, 320, 376.0, 240.0);
+  EXPECT_FALSE(pinhole.enableUndistortionLut(1u << 24, 0.01));
+  FovCamera fov = createFovCamera(752, 480, 310, 320, 376.0, 240.0, 0.947367);
+  EXPECT_FALSE(fov.enableUndistortionLut(1u << 24, 0.01));
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -42,44 +42,22 @@ Buffer<Scalar,Dim>::getNearestValue(int64_t stamp)
     return std::make_tuple(-1, Vector(), false);
   }
 
-  auto it_before = iterator_equal_or_before(stamp);
-  if(it_before->first == stamp)
+  // Select the closer of the entries before and after stamp, prefer the one
+  // before on ties.
+  const size_t i_after = buffer_.lowerBound(stamp);
+  if(i_after == buffer_.size())
   {
-    return std::make_tuple(it_before->first, it_before->second, true);
+    return std::make_tuple(buffer_.backStamp(), Vector(buffer_.value(i_after - 1)), true);
   }
-
-  // Compute time difference between stamp and closest entries.
-  auto it_after = iterator_equal_or_after(stamp);
-  int64_t dt_after = -1, dt_before = -1;
-  if(it_after != buffer_.end())
-  {
-    dt_after = it_after->first - stamp;
-  }
-  if(it_before != buffer_.end())
-  {
-    dt_before = stamp - it_before->first;
-  }
-
-  // Select which entry is closest based on time difference.
-  std::pair<int64_t,Vector> result;
-  if(dt_after < 0 && dt_before < 0)
-  {
-    CHECK(false) << "Should not occur.";
-    return std::make_tuple(-1, Vector(), false);
-  }
-  else if(dt_after < 0)
-  {
-    return std::make_tuple(it_before->first, it_before->second, true);
-  }
-  else if(dt_before < 0)
+  if(i_after == 0u || buffer_.stamp(i_after) == stamp)
   {
-    return std::make_tuple(it_after->first, it_after->second, true);
+    return std::make_tuple(buffer_.stamp(i_after), Vector(buffer_.value(i_after)), true);
   }
-  else if(dt_after > 0 && dt_before > 0 && dt_after < dt_before)
-  {
-    return std::make_tuple(it_after->first, it_after->second, true);
-  }
-  return std::make_tuple(it_before->first, it_before->second, true);
+  const size_t i_before = i_after - 1u;
+  const int64_t dt_after = buffer_.stamp(i_after) - stamp;
+  const int64_t dt_before = stamp - buffer_.stamp(i_before);
+  const size_t i = (dt_after < dt_before) ? i_after : i_before;
+  return std::make_tuple(buffer_.stamp(i), Vector(buffer_.value(i)), true);
 }
 
 template <typename Scalar, int Dim>
@@ -90,7 +68,7 @@ std::pair<Eigen::Matrix<Scalar, Dim, 1>, bool> Buffer<Scalar,Dim>::getOldestValu
   {
     return std::make_pair(Vector(), false);
   }
-  return std::make_pair(buffer_.begin()->second, true);
+  return std::make_pair(Vector(buffer_.value(0u)), true);
 }
 
 template <typename Scalar, int Dim>
@@ -101,7 +79,7 @@ std::pair<Eigen::Matrix<Scalar, Dim, 1>, bool> Buffer<Scalar,Dim>::getNewestValu
   {
     return std::make_pair(Vector(), false);
   }
-  return std::make_pair(buffer_.rbegin()->second, true);
+  return std::make_pair(Vector(buffer_.value(buffer_.size() - 1u)), true);
 }
 
 template <typename Scalar, int Dim>
@@ -112,7 +90,7 @@ std::tuple<int64_t, int64_t, bool> Buffer<Scalar,Dim>::getOldestAndNewestStamp()
   {
     return std::make_tuple(-1, -1, false);
   }
-  return std::make_tuple(buffer_.begin()->first, buffer_.rbegin()->first, true);
+  return std::make_tuple(buffer_.frontStamp(), buffer_.backStamp(), true);
 }
 
 template <typename Scalar, int Dim>
@@ -131,8 +109,8 @@ Buffer<Scalar,Dim>::getBetweenValuesInterpolated(int64_t stamp_from, int64_t sta
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
-  const int64_t oldest_stamp = buffer_.begin()->first;
-  const int64_t newest_stamp = buffer_.rbegin()->first;
+  const int64_t oldest_stamp = buffer_.frontStamp();
+  const int64_t newest_stamp = buffer_.backStamp();
   if(stamp_from < oldest_stamp)
   {
     LOG(WARNING) << "Requests older timestamp than in buffer.";
@@ -144,89 +122,105 @@ Buffer<Scalar,Dim>::getBetweenValuesInterpolated(int64_t stamp_from, int64_t sta
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
-  auto it_from_before = iterator_equal_or_before(stamp_from);
-  auto it_to_after = iterator_equal_or_after(stamp_to);
-  CHECK(it_from_before != buffer_.end());
-  CHECK(it_to_after != buffer_.end());
-  auto it_from_after = it_from_before;
-  ++it_from_after;
-  auto it_to_before = it_to_after;
-  --it_to_before;
-  if(it_from_after == it_to_before)
+  const size_t i_from_before = indexEqualOrBefore(stamp_from);
+  const size_t i_to_after = buffer_.lowerBound(stamp_to);
+  CHECK_LT(i_from_before, buffer_.size());
+  CHECK_LT(i_to_after, buffer_.size());
+  const size_t i_from_after = i_from_before + 1u;
+  const size_t i_to_before = i_to_after - 1u;
+  if(i_from_after == i_to_before)
   {
     LOG(WARNING) << "Not enough data for interpolation";
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
-  // Count number of measurements.
-  size_t n = 0;
-  auto it = it_from_after;
-  while(it != it_to_after)
-  {
-    ++n;
-    ++it;
-  }
-  n += 2;
-
-  // Interpolate values at start and end and copy in output vector.
+  // Interpolate values at start and end and copy the samples in between.
+  const size_t n_inner = i_to_after - i_from_after;
+  const size_t n = n_inner + 2u;
   stamps.resize(n);
   values.resize(kDim, n);
-  for(size_t i = 0; i < n; ++i)
-  {
-    if(i == 0)
-    {
-      stamps(i) = stamp_from;
-      const double w =
-          static_cast<double>(stamp_from - it_from_before->first) /
-          static_cast<double>(it_from_after->first - it_from_before->first);
-      values.col(i) = (1.0 - w) * it_from_before->second + w * it_from_after->second;
-    }
-    else if(i == n-1)
-    {
-      stamps(i) = stamp_to;
-      const double w =
-          static_cast<double>(stamp_to - it_to_before->first) /
-          static_cast<double>(it_to_after->first - it_to_before->first);
-      values.col(i) = (1.0 - w) * it_to_before->second + w * it_to_after->second;
-    }
-    else
-    {
-      stamps(i) = it_from_after->first;
-      values.col(i) = it_from_after->second;
-      ++it_from_after;
-    }
-  }
+
+  stamps(0) = stamp_from;
+  const double w_from =
+      static_cast<double>(stamp_from - buffer_.stamp(i_from_before)) /
+      static_cast<double>(buffer_.stamp(i_from_after) - buffer_.stamp(i_from_before));
+  values.col(0) = (1.0 - w_from) * buffer_.value(i_from_before)
+      + w_from * buffer_.value(i_from_after);
+
+  stamps.segment(1, n_inner) = buffer_.stamps(i_from_after, n_inner);
+  values.middleCols(1, n_inner) = buffer_.values(i_from_after, n_inner);
+
+  stamps(n - 1) = stamp_to;
+  const double w_to =
+      static_cast<double>(stamp_to - buffer_.stamp(i_to_before)) /
+      static_cast<double>(buffer_.stamp(i_to_after) - buffer_.stamp(i_to_before));
+  values.col(n - 1) = (1.0 - w_to) * buffer_.value(i_to_before)
+      + w_to * buffer_.value(i_to_after);
 
   return std::make_pair(stamps, values);
 }
 
 template <typename Scalar, int Dim>
-typename Buffer<Scalar,Dim>::VectorBuffer::iterator Buffer<Scalar,Dim>::iterator_equal_or_before(int64_t stamp)
+std::pair<typename Buffer<Scalar,Dim>::StampsMap, typename Buffer<Scalar,Dim>::ValuesMap>
+Buffer<Scalar,Dim>::getBetweenValues(int64_t stamp_from, int64_t stamp_to) const
 {
   DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
-  auto it = buffer_.lower_bound(stamp);
-
-  if(it->first == stamp)
+  CHECK_LE(stamp_from, stamp_to);
+  const size_t begin = buffer_.lowerBound(stamp_from);
+  size_t end = buffer_.lowerBound(stamp_to);
+  if(end < buffer_.size() && buffer_.stamp(end) == stamp_to)
   {
-    return it; // Return iterator to key if exact key exists.
+    ++end;
   }
-  if(stamp > buffer_.rbegin()->first)
+  return std::make_pair(buffer_.stamps(begin, end - begin),
+                        buffer_.values(begin, end - begin));
+}
+
+template <typename Scalar, int Dim>
+size_t Buffer<Scalar,Dim>::indexEqualOrBefore(int64_t stamp) const
+{
+  const size_t i = buffer_.lowerBound(stamp);
+  if(i < buffer_.size() && buffer_.stamp(i) == stamp)
   {
-    return (--buffer_.end()); // Pointer to last value.
+    return i; // Return key if exact key exists.
   }
-  if(it == buffer_.begin())
+  if(i == 0u)
   {
-    return buffer_.end(); // Invalid if data before first value.
+    return buffer_.size(); // Invalid if data before first value.
   }
-  --it;
-  return it;
+  return i - 1u;
+}
+
+template <typename Scalar, int Dim>
+typename Buffer<Scalar,Dim>::VectorBuffer::iterator
+Buffer<Scalar,Dim>::iterator_equal_or_before(int64_t stamp)
+{
+  DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+  return buffer_.begin() + indexEqualOrBefore(stamp);
+}
+
+template <typename Scalar, int Dim>
+typename Buffer<Scalar,Dim>::VectorBuffer::const_iterator
+Buffer<Scalar,Dim>::iterator_equal_or_before(int64_t stamp) const
+{
+  DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+  return buffer_.begin() + indexEqualOrBefore(stamp);
+}
+
+template <typename Scalar, int Dim>
+typename Buffer<Scalar,Dim>::VectorBuffer::iterator
+Buffer<Scalar,Dim>::iterator_equal_or_after(int64_t stamp)
+{
+  DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+  return buffer_.begin() + buffer_.lowerBound(stamp);
 }
 
 template <typename Scalar, int Dim>
-typename Buffer<Scalar,Dim>::VectorBuffer::iterator Buffer<Scalar,Dim>::iterator_equal_or_after(int64_t stamp)
+typename Buffer<Scalar,Dim>::VectorBuffer::const_iterator
+Buffer<Scalar,Dim>::iterator_equal_or_after(int64_t stamp) const
 {
   DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
-  return buffer_.lower_bound(stamp);
+  return buffer_.begin() + buffer_.lowerBound(stamp);
 }
 
 } // namespace ze
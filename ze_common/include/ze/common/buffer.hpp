@@ -25,11 +25,12 @@
 
 #pragma once
 
-#include <map>
+#include <algorithm>
 #include <tuple>
 #include <thread>
 #include <utility>
 #include <mutex>
+#include <vector>
 
 #include <ze/common/logging.hpp>
 #include <ze/common/types.hpp>
@@ -37,13 +38,232 @@
 
 namespace ze {
 
-// Oldest entry: buffer.begin(), newest entry: buffer.rbegin()
+//! Contiguous storage of samples sorted by timestamp.
+//!
+//! Timestamps and values are stored in two arrays (values column-major, one
+//! column per sample), such that ranges can be exposed as Eigen::Map views.
+//! Appending in time order is amortized O(1), out-of-order inserts fall back
+//! to a sorted insert. Removing the oldest samples only advances an offset and
+//! compacts the arrays once more than half of them is unused.
+template <typename Scalar, int Dim>
+class BufferStorage
+{
+public:
+  using Vector = Eigen::Matrix<Scalar, Dim, 1>;
+  using VectorMap = Eigen::Map<const Vector>;
+  using StampsMap = Eigen::Map<const Eigen::Matrix<int64_t, Eigen::Dynamic, 1>>;
+  using ValuesMap = Eigen::Map<const Eigen::Matrix<Scalar, Dim, Eigen::Dynamic>>;
+
+  //! Sample as returned by the iterators, mimics std::pair<int64_t, Vector>.
+  template <typename MapType>
+  struct EntryBase
+  {
+    template <typename Pointer>
+    EntryBase(int64_t stamp, Pointer value)
+      : first(stamp)
+      , second(value)
+    {}
+
+    //! Allows it->first on the iterators, which return entries by value.
+    inline EntryBase* operator->() { return this; }
+    inline const EntryBase* operator->() const { return this; }
+
+    int64_t first;
+    MapType second;
+  };
+  using Entry = EntryBase<VectorMap>;
+  using MutableEntry = EntryBase<Eigen::Map<Vector>>;
+
+  //! Random access iterator, Step is 1 for forward and -1 for reverse
+  //! iteration. Mutable and const iterators compare with each other.
+  template <typename EntryType, typename StorageType, int Step>
+  class IteratorBase
+  {
+  public:
+    IteratorBase() = default;
+    IteratorBase(StorageType* storage, ptrdiff_t idx)
+      : storage_(storage)
+      , idx_(idx)
+    {}
+
+    //! Conversion from the mutable to the const iterator.
+    template <typename OtherEntry, typename OtherStorage>
+    IteratorBase(const IteratorBase<OtherEntry, OtherStorage, Step>& other)
+      : storage_(other.storage_)
+      , idx_(other.idx_)
+    {}
+
+    inline EntryType operator*() const
+    {
+      return EntryType(storage_->stamp(idx_), storage_->valuePtr(idx_));
+    }
+    inline EntryType operator->() const { return **this; }
+    inline IteratorBase& operator++() { idx_ += Step; return *this; }
+    inline IteratorBase& operator--() { idx_ -= Step; return *this; }
+    inline IteratorBase operator++(int) { IteratorBase it = *this; idx_ += Step; return it; }
+    inline IteratorBase operator--(int) { IteratorBase it = *this; idx_ -= Step; return it; }
+    inline IteratorBase operator+(ptrdiff_t n) const { return IteratorBase(storage_, idx_ + Step * n); }
+    inline IteratorBase operator-(ptrdiff_t n) const { return IteratorBase(storage_, idx_ - Step * n); }
+
+    template <typename OtherEntry, typename OtherStorage>
+    inline ptrdiff_t operator-(const IteratorBase<OtherEntry, OtherStorage, Step>& rhs) const
+    {
+      return Step * (idx_ - rhs.idx_);
+    }
+
+    template <typename OtherEntry, typename OtherStorage>
+    inline bool operator==(const IteratorBase<OtherEntry, OtherStorage, Step>& rhs) const
+    {
+      return idx_ == rhs.idx_;
+    }
+
+    template <typename OtherEntry, typename OtherStorage>
+    inline bool operator!=(const IteratorBase<OtherEntry, OtherStorage, Step>& rhs) const
+    {
+      return idx_ != rhs.idx_;
+    }
+
+    //! Position relative to the oldest sample.
+    inline size_t index() const { return idx_; }
+
+  private:
+    template <typename, typename, int> friend class IteratorBase;
+
+    StorageType* storage_ = nullptr;
+    ptrdiff_t idx_ = 0;
+  };
+  using iterator = IteratorBase<MutableEntry, BufferStorage, 1>;
+  using const_iterator = IteratorBase<Entry, const BufferStorage, 1>;
+  using reverse_iterator = IteratorBase<MutableEntry, BufferStorage, -1>;
+  using const_reverse_iterator = IteratorBase<Entry, const BufferStorage, -1>;
+
+  inline size_t size() const { return stamps_.size() - offset_; }
+
+  inline bool empty() const { return stamps_.size() == offset_; }
+
+  inline iterator begin() { return iterator(this, 0); }
+  inline const_iterator begin() const { return const_iterator(this, 0); }
+
+  inline iterator end() { return iterator(this, size()); }
+  inline const_iterator end() const { return const_iterator(this, size()); }
+
+  inline reverse_iterator rbegin() { return reverse_iterator(this, size() - 1); }
+  inline const_reverse_iterator rbegin() const { return const_reverse_iterator(this, size() - 1); }
+
+  inline reverse_iterator rend() { return reverse_iterator(this, -1); }
+  inline const_reverse_iterator rend() const { return const_reverse_iterator(this, -1); }
+
+  //! Oldest and newest sample. Storage must not be empty.
+  inline MutableEntry front() { return *begin(); }
+  inline Entry front() const { return *begin(); }
+  inline MutableEntry back() { return *rbegin(); }
+  inline Entry back() const { return *rbegin(); }
+
+  inline int64_t stamp(size_t i) const { return stamps_[offset_ + i]; }
+
+  inline VectorMap value(size_t i) const { return VectorMap(valuePtr(i)); }
+
+  inline Entry entry(size_t i) const { return Entry(stamp(i), valuePtr(i)); }
+
+  //! Oldest and newest timestamp. Storage must not be empty.
+  inline int64_t frontStamp() const { return stamps_[offset_]; }
+  inline int64_t backStamp() const { return stamps_.back(); }
+
+  //! Views of the timestamps and values of samples [begin, begin + n).
+  inline StampsMap stamps(size_t begin, size_t n) const
+  {
+    return StampsMap(stamps_.data() + offset_ + begin, n);
+  }
+
+  inline ValuesMap values(size_t begin, size_t n) const
+  {
+    return ValuesMap(valuePtr(begin), Dim, n);
+  }
+
+  //! Index of first sample with timestamp not less than stamp, size() if none.
+  inline size_t lowerBound(int64_t stamp) const
+  {
+    return std::lower_bound(stamps_.begin() + offset_, stamps_.end(), stamp)
+        - (stamps_.begin() + offset_);
+  }
+
+  //! Inserts or overwrites the sample at stamp.
+  void insert(int64_t stamp, const Vector& value)
+  {
+    if (empty() || stamp > stamps_.back())
+    {
+      stamps_.push_back(stamp);
+      values_.insert(values_.end(), value.data(), value.data() + Dim);
+      return;
+    }
+
+    const size_t i = lowerBound(stamp);
+    if (stamps_[offset_ + i] != stamp)
+    {
+      // Out-of-order insert.
+      stamps_.insert(stamps_.begin() + offset_ + i, stamp);
+      values_.insert(values_.begin() + (offset_ + i) * Dim,
+                     value.data(), value.data() + Dim);
+      return;
+    }
+    std::copy(value.data(), value.data() + Dim, values_.begin() + (offset_ + i) * Dim);
+  }
+
+  //! Removes the n oldest samples.
+  void eraseFront(size_t n)
+  {
+    DEBUG_CHECK_LE(n, size());
+    offset_ += n;
+    if (empty())
+    {
+      clear();
+    }
+    else if (offset_ > size())
+    {
+      stamps_.erase(stamps_.begin(), stamps_.begin() + offset_);
+      values_.erase(values_.begin(), values_.begin() + offset_ * Dim);
+      offset_ = 0u;
+    }
+  }
+
+  inline void clear()
+  {
+    stamps_.clear();
+    values_.clear();
+    offset_ = 0u;
+  }
+
+  inline void reserve(size_t n)
+  {
+    stamps_.reserve(offset_ + n);
+    values_.reserve((offset_ + n) * Dim);
+  }
+
+private:
+  inline const Scalar* valuePtr(size_t i) const
+  {
+    return values_.data() + (offset_ + i) * Dim;
+  }
+
+  inline Scalar* valuePtr(size_t i)
+  {
+    return values_.data() + (offset_ + i) * Dim;
+  }
+
+  std::vector<int64_t> stamps_;
+  std::vector<Scalar> values_;
+  size_t offset_ = 0u; //!< Number of removed samples at the front.
+};
+
+// Oldest entry: data().begin(), newest entry: data().rbegin()
 template <typename Scalar, int Dim>
 class Buffer
 {
 public:
   using Vector = Eigen::Matrix<Scalar, Dim, 1>;
-  using VectorBuffer = std::map<int64_t, Vector, std::less<int64_t>, Eigen::aligned_allocator<std::pair<const int64_t,Vector>>>;
+  using VectorBuffer = BufferStorage<Scalar, Dim>;
+  using StampsMap = typename VectorBuffer::StampsMap;
+  using ValuesMap = typename VectorBuffer::ValuesMap;
 
   static constexpr int kDim = Dim;
 
@@ -65,15 +285,22 @@ public:
   inline void insert(int64_t stamp, const Vector& data)
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    buffer_[stamp] = data;
+    buffer_.insert(stamp, data);
     if(buffer_size_nanosec_ > 0)
     {
       removeDataBeforeTimestamp_impl(
-            buffer_.rbegin()->first - buffer_size_nanosec_);
+            buffer_.backStamp() - buffer_size_nanosec_);
 
     }
   }
 
+  //! Reserve memory for n samples, e.g. before loading a trajectory.
+  inline void reserve(size_t n)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.reserve(n);
+  }
+
   //! Get value with timestamp closest to stamp. Boolean in returns if successful.
   std::tuple<int64_t, Vector, bool> getNearestValue(int64_t stamp);
 
@@ -95,6 +322,14 @@ public:
   std::pair<Eigen::Matrix<int64_t, Eigen::Dynamic, 1>, Eigen::Matrix<Scalar, Dim, Eigen::Dynamic> >
   getBetweenValuesInterpolated(int64_t stamp_from, int64_t stamp_to);
 
+  /*! @brief Get views of the samples with stamp_from <= stamp <= stamp_to.
+   *
+   * No copy is made, call lock() before and keep the buffer locked while
+   * using the views. Returns empty views if there are no such samples.
+   */
+  std::pair<StampsMap, ValuesMap> getBetweenValues(
+      int64_t stamp_from, int64_t stamp_to) const;
+
   inline void clear()
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -126,7 +361,7 @@ public:
       return;
 
     removeDataBeforeTimestamp_impl(
-          buffer_.rbegin()->first - secToNanosec(seconds));
+          buffer_.backStamp() - secToNanosec(seconds));
   }
 
   inline void lock() const
@@ -139,6 +374,12 @@ public:
     mutex_.unlock();
   }
 
+  VectorBuffer& data()
+  {
+    CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+    return buffer_;
+  }
+
   const VectorBuffer& data() const
   {
     CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
@@ -146,8 +387,10 @@ public:
   }
 
   typename VectorBuffer::iterator iterator_equal_or_before(int64_t stamp);
+  typename VectorBuffer::const_iterator iterator_equal_or_before(int64_t stamp) const;
 
   typename VectorBuffer::iterator iterator_equal_or_after(int64_t stamp);
+  typename VectorBuffer::const_iterator iterator_equal_or_after(int64_t stamp) const;
 
 protected:
   mutable std::mutex mutex_;
@@ -156,9 +399,11 @@ protected:
 
   inline void removeDataBeforeTimestamp_impl(int64_t stamp)
   {
-    auto it = buffer_.lower_bound(stamp);
-    buffer_.erase(buffer_.begin(), it);
+    buffer_.eraseFront(buffer_.lowerBound(stamp));
   }
+
+  //! Index of the sample equal or before stamp, size() if there is none.
+  size_t indexEqualOrBefore(int64_t stamp) const;
 };
 
 // -----------------------------------------------------------------------------
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <map>
+
 #include <ze/common/buffer.hpp>
 #include <ze/common/file_utils.hpp>
 #include <ze/common/macros.hpp>
@@ -0,0 +1,545 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <ze/common/noncopyable.hpp>
+
+namespace ze {
+
+/*!
+ * @brief Wait policies for LockFreeFifo.
+ *
+ * A waiting thread first polls the queue SpinIterations times. Afterwards it
+ * either parks on a condition variable until the other side signals progress
+ * (Park = true) or keeps yielding its time slice (Park = false).
+ **/
+//@{
+template <unsigned SpinIterations, bool Park>
+struct FifoWaitPolicy
+{
+  static constexpr unsigned c_spin_iterations = SpinIterations;
+  static constexpr bool c_park = Park;
+};
+
+//! Spin briefly, then sleep. Good default when producer and consumer run at
+//! different rates.
+using FifoSpinThenParkWait = FifoWaitPolicy<256, true>;
+
+//! Never sleep. Lowest latency, but a waiting thread keeps its core busy.
+using FifoSpinWait = FifoWaitPolicy<256, false>;
+
+//! Sleep immediately. Behaves like ThreadSafeFifo without the lock on the
+//! non-blocking path.
+using FifoParkWait = FifoWaitPolicy<0, true>;
+//@}
+
+/*!
+ * @brief Lock-free bounded FIFO for one reader and one or many writer threads.
+ *
+ * Drop-in alternative to ThreadSafeFifo for the common single-producer /
+ * single-consumer (MultiProducer = false) or multi-producer / single-consumer
+ * (MultiProducer = true) topologies. Elements are stored in a ring of slots
+ * that each carry a sequence number, the reader and writer positions are
+ * atomics on separate cache lines. Non-blocking reads and writes never take a
+ * lock; blocking and timed calls only touch a mutex when they have to park
+ * (see WaitPolicy) or when the other side is parked.
+ *
+ * The object class must be <default constructible> and <move assignable>.
+ *
+ * Capacity must be a power of two. Unlike ThreadSafeFifo, all Capacity slots
+ * are usable.
+ *
+ * Only one thread may call read(), nonBlockingRead(), timedRead() and clear()
+ * at a time. empty(), full() and size() are exact only when called from the
+ * reader or writer thread while the other side is idle.
+ **/
+template <class T, unsigned Capacity, bool MultiProducer=false,
+          class WaitPolicy=FifoSpinThenParkWait>
+class LockFreeFifo : Noncopyable
+{
+public:
+
+  static_assert(Capacity >= 2u && (Capacity & (Capacity - 1u)) == 0u,
+                "Capacity must be a power of two.");
+
+  //! Assumed size of a cache line, used to keep reader and writer state apart.
+  static constexpr size_t c_cache_line_size = 64u;
+
+  LockFreeFifo();
+  ~LockFreeFifo() = default;
+
+  /*!
+   * @name Status
+   **/
+  //@{
+
+  bool empty() const;
+  bool full() const;
+  unsigned size() const;
+
+  //@} // Status
+
+  /*!
+   * @name Data Access
+   **/
+  //@{
+
+  /*!
+   * Writes the data element to the buffer.
+   * This method will block while the buffer is full.
+   **/
+  //@{
+  void write(const T& data);
+  void write(T&& data);
+  //@}
+
+  /*!
+   * Writes the data element to the buffer if the buffer is not full.
+   * Returns whether the data was written or not.
+   **/
+  //@{
+  bool nonBlockingWrite(const T& data);
+  bool nonBlockingWrite(T&& data);
+  //@}
+
+  /*!
+   * Writes the data element to the buffer.
+   * This method will block for the specified timeout [ms] if the buffer is
+   * full. Returns whether data was written or not.
+   **/
+  //@{
+  bool timedWrite(const T& data, unsigned timeout);
+  bool timedWrite(T&& data, unsigned timeout);
+  //@}
+
+  /*!
+   * Returns the next element from the queue.
+   * The method blocks until data is available.
+   **/
+  T read();
+
+  /*!
+   * Reads the next element (if available) into the provided variable.
+   * Returns whether data was read or not.
+   **/
+  bool nonBlockingRead(T& data);
+
+  /*!
+   * Reads the next element (if available) into the provided variable.
+   * This method will block for the specified timeout [ms] if no data is
+   * available. Returns whether data was read or not.
+   **/
+  bool timedRead(T& data, unsigned timeout);
+
+  /*!
+   * Clears the content of the queue. Must be called from the reader thread.
+   **/
+  void clear();
+
+  //@} // Data Access
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  //! Threads that ran out of spin iterations sleep here until the other side
+  //! of the queue makes progress.
+  struct ParkingSpot
+  {
+    std::atomic<unsigned> num_waiting{0u};
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    void notify();
+
+    //! Waits until ready() returns true. Returns false on timeout.
+    template <class Predicate>
+    bool wait(const Predicate& ready, const Clock::time_point* deadline);
+  };
+
+  template <class U>
+  bool _tryWrite(U&& data);
+  bool _tryRead(T& data);
+  bool _canWrite() const;
+  bool _canRead() const;
+
+  template <class Predicate>
+  bool _wait(ParkingSpot& spot, const Predicate& ready,
+             const Clock::time_point* deadline);
+
+  static void _cpuRelax();
+
+  static constexpr size_t c_mask = Capacity - 1u;
+
+  // The padding keeps the writer and reader state on separate cache lines.
+  // It is used instead of alignas so that the queue can be allocated with new.
+  std::array<Slot, Capacity> buf_;
+  char pad0_[c_cache_line_size];
+  std::atomic<size_t> tail_; // writer end
+  char pad1_[c_cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> head_; // reader end
+  char pad2_[c_cache_line_size - sizeof(std::atomic<size_t>)];
+  ParkingSpot readers_;
+  char pad3_[c_cache_line_size];
+  ParkingSpot writers_;
+
+}; // LockFreeFifo
+
+//------------------------------------------------------------------------------
+// implementation
+//
+
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::LockFreeFifo()
+  : buf_()
+  , tail_(0u)
+  , head_(0u)
+{
+  for (size_t i = 0u; i < Capacity; ++i)
+  {
+    buf_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::empty() const
+{
+  return !_canRead();
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::full() const
+{
+  return !_canWrite();
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+unsigned LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::size() const
+{
+  const size_t head = head_.load(std::memory_order_acquire);
+  const size_t tail = tail_.load(std::memory_order_acquire);
+  return (tail > head) ? static_cast<unsigned>(tail - head) : 0u;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+void LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::write(const T& data)
+{
+  while (!_tryWrite(data))
+  {
+    _wait(writers_, [this]{ return _canWrite(); }, nullptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+void LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::write(T&& data)
+{
+  // _tryWrite() only moves from data on success.
+  while (!_tryWrite(std::move(data)))
+  {
+    _wait(writers_, [this]{ return _canWrite(); }, nullptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::nonBlockingWrite(const T& data)
+{
+  return _tryWrite(data);
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::nonBlockingWrite(T&& data)
+{
+  return _tryWrite(std::move(data));
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::timedWrite(const T& data, unsigned timeout)
+{
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(timeout);
+  while (!_tryWrite(data))
+  {
+    if (!_wait(writers_, [this]{ return _canWrite(); }, &deadline))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::timedWrite(T&& data, unsigned timeout)
+{
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(timeout);
+  while (!_tryWrite(std::move(data)))
+  {
+    if (!_wait(writers_, [this]{ return _canWrite(); }, &deadline))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+T LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::read()
+{
+  T data;
+  while (!_tryRead(data))
+  {
+    _wait(readers_, [this]{ return _canRead(); }, nullptr);
+  }
+  return data;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::nonBlockingRead(T& data)
+{
+  return _tryRead(data);
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>
+::timedRead(T& data, unsigned timeout)
+{
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(timeout);
+  while (!_tryRead(data))
+  {
+    if (!_wait(readers_, [this]{ return _canRead(); }, &deadline))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+void LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::clear()
+{
+  T data;
+  while (_tryRead(data))
+  {
+    data = T();
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+template <class U>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_tryWrite(U&& data)
+{
+  size_t pos = tail_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true)
+  {
+    slot = &buf_[pos & c_mask];
+    const size_t seq = slot->sequence.load(std::memory_order_acquire);
+    const std::intptr_t diff =
+        static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    if (diff == 0)
+    {
+      if (!MultiProducer)
+      {
+        tail_.store(pos + 1u, std::memory_order_relaxed);
+        break;
+      }
+      if (tail_.compare_exchange_weak(pos, pos + 1u,
+                                      std::memory_order_relaxed))
+      {
+        break;
+      }
+      // pos was reloaded by compare_exchange_weak.
+    }
+    else if (diff < 0)
+    {
+      // The slot still holds the element from the previous round: full.
+      return false;
+    }
+    else
+    {
+      // Another writer claimed this slot in the meantime.
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->data = std::forward<U>(data);
+  slot->sequence.store(pos + 1u, std::memory_order_release);
+  readers_.notify();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_tryRead(T& data)
+{
+  const size_t pos = head_.load(std::memory_order_relaxed);
+  Slot& slot = buf_[pos & c_mask];
+  const size_t seq = slot.sequence.load(std::memory_order_acquire);
+  if (seq != pos + 1u)
+  {
+    // Not yet published by the writer: empty.
+    return false;
+  }
+
+  data = std::move(slot.data);
+  slot.sequence.store(pos + Capacity, std::memory_order_release);
+  head_.store(pos + 1u, std::memory_order_release);
+  writers_.notify();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_canWrite() const
+{
+  const size_t pos = tail_.load(std::memory_order_relaxed);
+  return buf_[pos & c_mask].sequence.load(std::memory_order_acquire) == pos;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_canRead() const
+{
+  const size_t pos = head_.load(std::memory_order_relaxed);
+  return buf_[pos & c_mask].sequence.load(std::memory_order_acquire) == pos + 1u;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+template <class Predicate>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_wait(
+    ParkingSpot& spot, const Predicate& ready,
+    const Clock::time_point* deadline)
+{
+  for (unsigned i = 0u; i < WaitPolicy::c_spin_iterations; ++i)
+  {
+    if (ready())
+    {
+      return true;
+    }
+    _cpuRelax();
+  }
+
+  if (WaitPolicy::c_park)
+  {
+    return spot.wait(ready, deadline);
+  }
+
+  while (!ready())
+  {
+    if (deadline && Clock::now() >= *deadline)
+    {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+void LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::_cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+void LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::ParkingSpot::notify()
+{
+  // Pairs with the fence in wait(): either the waiter sees the new state or
+  // we see the waiter.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_waiting.load(std::memory_order_relaxed) > 0u)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    cond.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+template <class T, unsigned Capacity, bool MultiProducer, class WaitPolicy>
+template <class Predicate>
+bool LockFreeFifo<T, Capacity, MultiProducer, WaitPolicy>::ParkingSpot::wait(
+    const Predicate& ready, const Clock::time_point* deadline)
+{
+  num_waiting.fetch_add(1u, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool result = true;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (deadline)
+    {
+      result = cond.wait_until(lock, *deadline, ready);
+    }
+    else
+    {
+      cond.wait(lock, ready);
+    }
+  }
+  num_waiting.fetch_sub(1u, std::memory_order_relaxed);
+  return result;
+}
+
+} // namespace ze
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <memory>
 #include <ze/common/random.hpp>
 #include <ze/common/types.hpp>
 #include <ze/common/macros.hpp>
@@ -54,7 +55,14 @@ public:
     for (size_t i = 0; i < DIM; ++i)
     {
       // The gaussian takes a standard deviation as input.
-      noise(i) = sampleNormalDistribution<real_t>(deterministic_, 0.0, sigma_(i));
+      if (gen_)
+      {
+        noise(i) = std::normal_distribution<real_t>(0.0, sigma_(i))(*gen_);
+      }
+      else
+      {
+        noise(i) = sampleNormalDistribution<real_t>(deterministic_, 0.0, sigma_(i));
+      }
     }
     return noise;
   }
@@ -73,6 +81,15 @@ public:
     return noise;
   }
 
+  //! Sampler with its own generator, the samples are reproducible for a seed.
+  static Ptr sigmasSeeded(const sigma_vector_t& sigmas, uint32_t seed)
+  {
+    Ptr noise(new RandomVectorSampler(true));
+    noise->sigma_ = sigmas;
+    noise->gen_.reset(new std::mt19937(seed));
+    return noise;
+  }
+
 protected:
   RandomVectorSampler(bool deteterministic)
     : deterministic_(deteterministic)
@@ -81,6 +98,7 @@ protected:
 private:
   const bool deterministic_;
   sigma_vector_t sigma_;
+  std::unique_ptr<std::mt19937> gen_;
 };
 
 //------------------------------------------------------------------------------
@@ -27,30 +27,40 @@
 
 namespace ze {
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::TimeDataBoolTuple
-Ringbuffer<Scalar, ValueDim, Size>::getNearestValue(time_t stamp)
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::TimeDataBoolTuple
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getNearestValue(time_t stamp)
 {
   CHECK_GE(stamp, 0u);
 
-  std::lock_guard<std::mutex> lock(mutex_);
+  const TimeDataBoolTuple result =
+      read([&]() { return getNearestValue_impl(stamp); });
+  if(!std::get<2>(result))
+  {
+    LOG(WARNING) << "Buffer is empty.";
+  }
+  return result;
+}
 
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::TimeDataBoolTuple
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getNearestValue_impl(time_t stamp)
+{
   if(times_.empty())
   {
-    LOG(WARNING) << "Buffer is empty.";
     return std::make_tuple(-1, DataType(), false);
   }
 
   auto it_before = iterator_equal_or_before(stamp);
   //! @todo an approx equality could return the desired result immediately
-  if(*it_before == stamp)
+  if(it_before != times_.end() && *it_before == stamp)
   {
     return std::make_tuple(*it_before, dataAtTimeIterator(it_before), true);
   }
 
   auto it_after = iterator_equal_or_after(stamp);
   //! @todo an approx equality could return the desired result immediately
-  if(*it_after == stamp)
+  if(it_after != times_.end() && *it_after == stamp)
   {
     return std::make_tuple(*it_after, dataAtTimeIterator(it_after), true);
   }
@@ -69,7 +79,7 @@ Ringbuffer<Scalar, ValueDim, Size>::getNearestValue(time_t stamp)
   // Select which entry is closest based on time difference.
   if(dt_after < 0 && dt_before < 0)
   {
-    CHECK(false) << "Should not occur.";
+    // Only possible while the buffer is modified in SeqLock mode.
     return std::make_tuple(-1, DataType(), false);
   }
   else if(dt_after < 0)
@@ -88,58 +98,87 @@ Ringbuffer<Scalar, ValueDim, Size>::getNearestValue(time_t stamp)
   return std::make_tuple(*it_before, dataAtTimeIterator(it_before), true);
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::DataBoolPair
-Ringbuffer<Scalar, ValueDim, Size>::getOldestValue() const
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::DataBoolPair
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getOldestValue() const
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if(times_.empty())
+  return read([&]()
   {
-    return std::make_pair(DataType(), false);
-  }
-  return std::make_pair(dataAtTimeIterator(times_.begin()), true);
+    if(times_.empty())
+    {
+      return std::make_pair(DataType(), false);
+    }
+    return std::make_pair(dataAtTimeIterator(times_.begin()), true);
+  });
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::DataBoolPair
-Ringbuffer<Scalar, ValueDim, Size>::getNewestValue() const
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::DataBoolPair
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getNewestValue() const
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if(times_.empty())
+  return read([&]()
   {
-    return std::make_pair(DataType(), false);
-  }
-  return std::make_pair(dataAtTimeIterator((times_.end()-1)), true);
+    if(times_.empty())
+    {
+      return std::make_pair(DataType(), false);
+    }
+    return std::make_pair(dataAtTimeIterator((times_.end()-1)), true);
+  });
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
 std::tuple<int64_t, int64_t, bool>
-Ringbuffer<Scalar, ValueDim, Size>::getOldestAndNewestStamp() const
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getOldestAndNewestStamp() const
 {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if(times_.empty())
+  return read([&]()
   {
-    return std::make_tuple(-1, -1, false);
-  }
-  return std::make_tuple(times_.front(), times_.back(), true);
+    if(times_.empty())
+    {
+      return std::make_tuple(time_t{-1}, time_t{-1}, false);
+    }
+    return std::make_tuple(times_.front(), times_.back(), true);
+  });
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
 template <typename Interpolator>
-typename Ringbuffer<Scalar, ValueDim, Size>::TimeDataRangePair
-Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::TimeDataRangePair
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getBetweenValuesInterpolated(
     time_t stamp_from,
     time_t stamp_to)
 {
   CHECK_GE(stamp_from, 0u);
   CHECK_LT(stamp_from, stamp_to);
+
+  // Warnings are only logged for the consistent result.
+  const char* warning = nullptr;
+  TimeDataRangePair result = read([&]()
+  {
+    warning = nullptr;
+    return getBetweenValuesInterpolated_impl<Interpolator>(
+          stamp_from, stamp_to, &warning);
+  });
+  if(warning)
+  {
+    LOG(WARNING) << warning;
+  }
+  return result;
+}
+
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+template <typename Interpolator>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::TimeDataRangePair
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getBetweenValuesInterpolated_impl(
+    time_t stamp_from,
+    time_t stamp_to,
+    const char** warning)
+{
   times_dynamic_t stamps;
   data_dynamic_t values;
 
-  std::lock_guard<std::mutex> lock(mutex_);
   if(times_.size() < 2)
   {
-    LOG(WARNING) << "Buffer has less than 2 entries.";
+    *warning = "Buffer has less than 2 entries.";
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
@@ -147,24 +186,29 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
   const time_t newest_stamp = times_.back();
   if(stamp_from < oldest_stamp)
   {
-    LOG(WARNING) << "Requests older timestamp than in buffer.";
+    *warning = "Requests older timestamp than in buffer.";
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
   if(stamp_to > newest_stamp)
   {
-    LOG(WARNING) << "Requests newer timestamp than in buffer.";
+    *warning = "Requests newer timestamp than in buffer.";
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
   auto it_from_before = iterator_equal_or_before(stamp_from);
   auto it_to_after = iterator_equal_or_after(stamp_to);
-  CHECK(it_from_before != times_.end());
-  CHECK(it_to_after != times_.end());
+  if(it_from_before == times_.end() || it_to_after == times_.end()
+     || it_to_after <= it_from_before)
+  {
+    // Only possible while the buffer is modified in SeqLock mode.
+    *warning = "Inconsistent buffer.";
+    return std::make_pair(stamps, values);
+  }
   auto it_from_after = it_from_before + 1;
   auto it_to_before = it_to_after - 1;
   if(it_from_after == it_to_before)
   {
-    LOG(WARNING) << "Not enough data for interpolation";
+    *warning = "Not enough data for interpolation";
     return std::make_pair(stamps, values); // return empty means unsuccessful.
   }
 
@@ -182,16 +226,17 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
   if (range > 2)
   {
     // will we cross the boundaries of the ringbuffer?
-    if (it_to_before.container_index() < it_from_after.container_index())
+    const size_t from_idx = it_from_after.container_index();
+    if (from_idx + range - 2 > Size)
     {
       // first batch at end of data structure
-      size_t end_block_size = times_raw_.size() - it_from_after.container_index();
+      size_t end_block_size = Size - from_idx;
       stamps.segment(1, end_block_size) = times_raw_.segment(
-                                            it_from_after.container_index(),
+                                            from_idx,
                                             end_block_size);
 
       values.middleCols(1, end_block_size) =
-          data_.middleCols(it_from_after.container_index(), end_block_size);
+          data_.middleCols(from_idx, end_block_size);
       // second batch at beginning
       size_t begin_block_size = range - 2 - end_block_size;
       stamps.segment(end_block_size + 1, begin_block_size) =
@@ -204,11 +249,11 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
     else
     {
       stamps.segment(1, range - 2) = times_raw_.segment(
-                                       it_from_after.container_index(),
+                                       from_idx,
                                        range - 2);
 
       values.middleCols(1, range - 2) = data_.middleCols(
-                                                  it_from_after.container_index(),
+                                                  from_idx,
                                                   range - 2);
     }
   }
@@ -221,157 +266,177 @@ Ringbuffer<Scalar, ValueDim, Size>::getBetweenValuesInterpolated(
   return std::make_pair(stamps, values);
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
 template <typename Interpolator>
-typename Ringbuffer<Scalar, ValueDim, Size>::data_dynamic_t
-Ringbuffer<Scalar, ValueDim, Size>::getValuesInterpolated(
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::data_dynamic_t
+Ringbuffer<Scalar, ValueDim, Size, Sync>::getValuesInterpolated(
     times_dynamic_t stamps)
 {
   CHECK_GT(stamps.size(), 0);
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  time_t oldest_time = times_.front();
-  time_t newest_time = times_.back();
-
-  data_dynamic_t values(ValueDim, stamps.size());
-
-  // Starting point
-  auto it_before = iterator_equal_or_before(stamps(0));
-  values.col(0) = Interpolator::interpolate(this, stamps(0), it_before);
-
-  for (int i = 1; i < stamps.size(); ++i)
+  // Index of the first stamp out of range, checked for the consistent result.
+  int out_of_range = -1;
+  bool hit_end = false;
+  data_dynamic_t values = read([&]()
   {
-    // ensure that we stay within the bounds of the buffer
-    CHECK_LT(stamps(i), newest_time);
-    CHECK_GT(stamps(i), oldest_time);
+    out_of_range = -1;
+    hit_end = false;
+    time_t oldest_time = times_.front();
+    time_t newest_time = times_.back();
+
+    data_dynamic_t values(ValueDim, stamps.size());
 
-    // advance to next value
-    while (*(it_before + 1) < stamps(i))
+    // Starting point
+    auto it_before = iterator_equal_or_before(stamps(0));
+    if (it_before == times_.end())
     {
-      ++it_before;
+      out_of_range = 0;
+      return values;
     }
+    hit_end = (it_before + 1 == times_.end());
+    values.col(0) = Interpolator::interpolate(this, stamps(0), it_before);
 
-    values.col(i) = Interpolator::interpolate(this, stamps(i), it_before);
+    for (int i = 1; i < stamps.size(); ++i)
+    {
+      // ensure that we stay within the bounds of the buffer
+      if (stamps(i) >= newest_time || stamps(i) <= oldest_time)
+      {
+        out_of_range = i;
+        return values;
+      }
+
+      // advance to next value
+      while (it_before + 1 < times_.end() && *(it_before + 1) < stamps(i))
+      {
+        ++it_before;
+      }
+
+      values.col(i) = Interpolator::interpolate(this, stamps(i), it_before);
+    }
+    return values;
+  });
+  CHECK_EQ(out_of_range, -1)
+      << "Timestamp " << stamps(std::max(out_of_range, 0))
+      << " not within the buffer.";
+  if (hit_end)
+  {
+    LOG(WARNING) << "Interpolation hit end of buffer.";
   }
 
   return values;
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
 template <typename Interpolator>
-bool Ringbuffer<Scalar, ValueDim, Size>::getValueInterpolated(
+bool Ringbuffer<Scalar, ValueDim, Size, Sync>::getValueInterpolated(
     time_t stamp,
-    Eigen::Ref<typename Ringbuffer<Scalar, ValueDim, Size>::data_dynamic_t> out)
+    Eigen::Ref<typename Ringbuffer<Scalar, ValueDim, Size, Sync>::data_dynamic_t> out)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 1> value;
+  bool hit_end = false;
+  const bool success = read([&]()
+  {
+    hit_end = false;
+    if (times_.empty() || stamp > times_.back())
+    {
+      return false;
+    }
+
+    // Starting point
+    auto it_before = iterator_equal_or_before(stamp);
+    if (it_before == times_.end())
+    {
+      return false;
+    }
+
+    hit_end = (it_before + 1 == times_.end());
+    value = Interpolator::interpolate(this, stamp, it_before);
+    return true;
+  });
 
-  if (stamp > times_.back())
+  if (success)
   {
-    return false;
+    out = value;
   }
-
-  // Starting point
-  auto it_before = iterator_equal_or_before(stamp);
-  if (it_before == times_.end())
+  if (hit_end)
   {
-    return false;
+    LOG(WARNING) << "Interpolation hit end of buffer.";
   }
-
-  out = Interpolator::interpolate(this, stamp, it_before);
-
-  return true;
+  return success;
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::timering_t::iterator
-Ringbuffer<Scalar, ValueDim, Size>::iterator_equal_or_before(time_t stamp)
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::timering_t::iterator
+Ringbuffer<Scalar, ValueDim, Size, Sync>::iterator_equal_or_before(time_t stamp)
 {
-  DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+  DEBUG_CHECK(isAccessAllowed()) << "Call lock() before accessing data.";
   auto it = lower_bound(stamp);
 
-  if(*it == stamp)
+  if(it != times_.end() && *it == stamp)
   {
     return it; // Return iterator to key if exact key exists.
   }
-  if(stamp > times_.back())
-  {
-    return (--times_.end()); // Pointer to last value.
-  }
   if(it == times_.begin())
   {
     return times_.end(); // Invalid if data before first value.
   }
-  --it;
+  --it; // Pointer to last value if stamp is newer than all data.
   return it;
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::timering_t::iterator
-Ringbuffer<Scalar, ValueDim, Size>::iterator_equal_or_after(time_t stamp)
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::timering_t::iterator
+Ringbuffer<Scalar, ValueDim, Size, Sync>::iterator_equal_or_after(time_t stamp)
 {
-  DEBUG_CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+  DEBUG_CHECK(isAccessAllowed()) << "Call lock() before accessing data.";
   return lower_bound(stamp);
 }
 
-template <typename Scalar, size_t ValueDim, size_t Size>
-typename Ringbuffer<Scalar, ValueDim, Size>::timering_t::iterator
-Ringbuffer<Scalar, ValueDim, Size>::lower_bound(time_t stamp)
+template <typename Scalar, size_t ValueDim, size_t Size, RingbufferSync Sync>
+typename Ringbuffer<Scalar, ValueDim, Size, Sync>::timering_t::iterator
+Ringbuffer<Scalar, ValueDim, Size, Sync>::lower_bound(time_t stamp)
 {
-  // implements a heuristic that assumes approx. equally spaced timestamps
-  time_t time_range = times_.back() - times_.front();
+  // All bounds are derived from one read of the size, such that the search
+  // terminates even if the buffer is modified concurrently (SeqLock mode).
+  const size_t n = times_.size();
 
   // stamp is out of range
-  if (stamp > times_.back())
+  if (n == 0u || stamp > times_.at(n - 1u))
   {
-    return times_.end();
+    return times_.begin() + n;
   }
 
-  if (stamp < times_.front())
+  const time_t front = times_.at(0u);
+  if (stamp <= front)
   {
     return times_.begin();
   }
 
-  size_t offset = times_.size() * (stamp - times_.front()) / time_range;
-  // make sure we stay within the bounds
-  if (offset >= times_.size())
-  {
-    offset = times_.size() - 1;
-  }
-  typename timering_t::iterator candidate = times_.begin() + offset;
-
-  if (*candidate == stamp)
+  // implements a heuristic that assumes approx. equally spaced timestamps
+  const time_t time_range = times_.at(n - 1u) - front;
+  size_t i = 0u;
+  if (time_range > 0)
   {
-    return candidate;
+    i = std::min(n - 1u, static_cast<size_t>(n * (stamp - front) / time_range));
   }
 
-  // iterate backwards
-  if (*candidate > stamp)
+  if (times_.at(i) >= stamp)
   {
-    while (candidate > times_.begin())
+    // iterate backwards
+    while (i > 0u && times_.at(i - 1u) >= stamp)
     {
-      if (*(candidate - 1) < stamp)
-      {
-        return candidate;
-      }
-      candidate = candidate - 1;
+      --i;
     }
-    // no match
   }
   else
   {
-    while (candidate < times_.end() - 1)
+    // iterate forwards
+    while (i < n && times_.at(i) < stamp)
     {
-      candidate++;
-      if (*candidate >= stamp)
-      {
-        return candidate;
-      }
+      ++i;
     }
-    // no match
   }
-
-  // no match points to end
-  return times_.end();
+  return times_.begin() + i;
 }
 
 } // namespace ze
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <tuple>
 #include <thread>
@@ -45,7 +47,9 @@ namespace ze {
 //! _ interpolate(Ringbuffer<...>*, int64_t time, Ringbuffer<...>timering_t::iterator);
 //! Passing the (optional) interator to the timestamp right before the to be
 //! interpolated value speeds up the process.
-//! The passed it_before is expected to be valid.
+//! The passed it_before is expected to be valid. Interpolators run inside
+//! Ringbuffer::read() and must therefore neither log nor abort; at the end of
+//! the buffer they return the last value and the caller reports it.
 //!
 //! A nearest neighbour "interpolator".
 struct InterpolatorNearest
@@ -60,7 +64,6 @@ struct InterpolatorNearest
     auto it_after = it_before + 1;
     if (it_after == buffer->times_.end())
     {
-      LOG(WARNING) << "Interpolation hit end of buffer.";
       return buffer->dataAtTimeIterator(it_before);
     }
 
@@ -98,7 +101,6 @@ struct InterpolatorLinear
     auto it_after = it_before + 1;
     if (it_after == buffer->times_.end())
     {
-      LOG(WARNING) << "Interpolation hit end of buffer.";
       return buffer->dataAtTimeIterator(it_before);
     }
 
@@ -124,12 +126,26 @@ struct InterpolatorLinear
 };
 using DefaultInterpolator = InterpolatorLinear;
 
+//! Synchronization of a Ringbuffer between threads.
+enum class RingbufferSync
+{
+  //! Every access is serialized by a mutex. Any number of writers.
+  Mutex,
+  //! Single writer, lock-free readers: The writer publishes every
+  //! modification with a sequence counter, readers read optimistically and
+  //! retry if the sequence changed. The writer never blocks.
+  SeqLock
+};
 
 //! A fixed size timed buffer templated on the number of entries.
 //! Opposed to the `Buffer`, values are expected to be received ORDERED in
 //! TIME!
+//! With RingbufferSync::SeqLock, insert(), clear() and remove*() must only be
+//! called from one thread, and data(), times() and the iterator functions are
+//! only safe on the writer thread or inside read().
 // Oldest entry: buffer.begin(), newest entry: buffer.rbegin()
-template <typename Scalar, size_t ValueDim, size_t Size>
+template <typename Scalar, size_t ValueDim, size_t Size,
+          RingbufferSync Sync = RingbufferSync::Mutex>
 class Ringbuffer
 {
 public:
@@ -172,9 +188,11 @@ public:
   inline void insert(time_t stamp,
                      const DataType& data)
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    times_.push_back(stamp);
-    data_.col(times_.back_idx()) = data;
+    write([&]()
+    {
+      times_.push_back(stamp);
+      data_.col(times_.back_idx()) = data;
+    });
   }
 
   //! Get value with timestamp closest to stamp. Boolean returns if successful.
@@ -210,39 +228,37 @@ public:
 
   inline void clear()
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    times_.reset();
+    write([&]() { times_.reset(); });
   }
 
   inline size_t size() const
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return times_.size();
+    return read([&]() { return times_.size(); });
   }
 
   inline bool empty() const
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return times_.empty();
+    return read([&]() { return times_.empty(); });
   }
 
   //! technically does not remove but only moves the beginning of the ring
   inline void removeDataBeforeTimestamp(time_t stamp)
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    removeDataBeforeTimestamp_impl(stamp);
+    write([&]() { removeDataBeforeTimestamp_impl(stamp); });
   }
 
   inline void removeDataOlderThan(real_t seconds)
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if(times_.empty())
+    write([&]()
     {
-      return;
-    }
-
-    removeDataBeforeTimestamp_impl(
-          times_.back() - secToNanosec(seconds));
+      if(times_.empty())
+      {
+        return;
+      }
+
+      removeDataBeforeTimestamp_impl(
+            times_.back() - secToNanosec(seconds));
+    });
   }
 
   inline void lock() const
@@ -257,13 +273,13 @@ public:
 
   const data_t& data() const
   {
-    CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+    CHECK(isAccessAllowed()) << "Call lock() before accessing data.";
     return data_;
   }
 
   const timering_t& times() const
   {
-    CHECK(!mutex_.try_lock()) << "Call lock() before accessing data.";
+    CHECK(isAccessAllowed()) << "Call lock() before accessing data.";
     return times_;
   }
 
@@ -276,12 +292,77 @@ public:
 
   inline std::mutex& mutex() {return mutex_;}
 
+  //! Returns f() evaluated on a consistent state of the buffer. In SeqLock
+  //! mode f may run on a concurrently modified buffer and is repeated until
+  //! no modification happened in between; f must therefore not have side
+  //! effects beyond its captured results and must not log or abort on
+  //! inconsistent data. times(), data() and the iterator functions may be
+  //! used inside f. Nested calls on several buffers give a consistent state
+  //! of all of them.
+  template <typename F>
+  inline auto read(const F& f) const -> decltype(f())
+  {
+    if (Sync == RingbufferSync::Mutex)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return f();
+    }
+    for (;;)
+    {
+      const uint64_t seq = seq_.load(std::memory_order_acquire);
+      if (seq & 1u)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      auto result = f();
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq)
+      {
+        return result;
+      }
+    }
+  }
+
 protected:
   mutable std::mutex mutex_;
   data_t data_;
   times_t times_raw_;
   timering_t times_;
 
+  //! Modification counter of the SeqLock mode, odd while writing.
+  std::atomic<uint64_t> seq_{0u};
+
+  //! Direct access to the data requires the lock in Mutex mode. In SeqLock
+  //! mode the caller must be the writer or inside read().
+  inline bool isAccessAllowed() const
+  {
+    return Sync == RingbufferSync::SeqLock || !mutex_.try_lock();
+  }
+
+  //! Applies modification f exclusively.
+  template <typename F>
+  inline void write(const F& f)
+  {
+    if (Sync == RingbufferSync::Mutex)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      f();
+      return;
+    }
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    f();
+    seq_.store(seq + 2u, std::memory_order_release);
+  }
+
+  std::tuple<time_t, DataType, bool> getNearestValue_impl(time_t stamp);
+
+  template <typename Interpolator>
+  TimeDataRangePair getBetweenValuesInterpolated_impl(
+      time_t stamp_from, time_t stamp_to, const char** warning);
+
   //! return the data at a given point in time
   inline DataType dataAtTimeIterator(typename timering_t::iterator iter) const
   {
@@ -301,7 +382,7 @@ protected:
   inline void removeDataBeforeTimestamp_impl(time_t stamp)
   {
     auto it = lower_bound(stamp);
-    times_.reset_front(it.container_index());
+    times_.reset(it.container_index(), times_.size() - it.index());
   }
 };
 
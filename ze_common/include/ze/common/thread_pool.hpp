@@ -25,22 +25,154 @@
 
 #pragma once
 
-#include <vector>
-#include <queue>
-#include <memory>
-#include <thread>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <future>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <Eigen/Core>
 #include <glog/logging.h>
 
 namespace ze {
 
+//! Move-only type-erased void() callable. Callables of up to c_inline_size
+//! bytes are stored in place, larger ones on the heap.
+class ThreadPoolTask
+{
+public:
+  static constexpr size_t c_inline_size = 48u;
+
+  ThreadPoolTask() = default;
+
+  template<class F, class = typename std::enable_if<
+             !std::is_same<typename std::decay<F>::type, ThreadPoolTask>::value>::type>
+  ThreadPoolTask(F&& f)
+  {
+    using Fn = typename std::decay<F>::type;
+    constexpr bool fits_inline =
+        sizeof(Fn) <= c_inline_size
+        && alignof(Fn) <= alignof(Storage)
+        && std::is_nothrow_move_constructible<Fn>::value;
+    init<Fn>(std::forward<F>(f), std::integral_constant<bool, fits_inline>());
+  }
+
+  ThreadPoolTask(ThreadPoolTask&& other) noexcept
+  {
+    moveFrom(other);
+  }
+
+  ThreadPoolTask& operator=(ThreadPoolTask&& other) noexcept
+  {
+    if (this != &other)
+    {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  ThreadPoolTask(const ThreadPoolTask&) = delete;
+  ThreadPoolTask& operator=(const ThreadPoolTask&) = delete;
+
+  ~ThreadPoolTask() { reset(); }
+
+  explicit operator bool() const { return invoke_ != nullptr; }
+
+  void operator()() { invoke_(&storage_); }
+
+private:
+  enum class Operation { Move, Destroy };
+  using Storage =
+      typename std::aligned_storage<c_inline_size, alignof(std::max_align_t)>::type;
+  using InvokeFn = void (*)(void*);
+  using ManageFn = void (*)(Operation, void*, void*);
+
+  template<class Fn, class F>
+  void init(F&& f, std::true_type /*fits_inline*/)
+  {
+    new (&storage_) Fn(std::forward<F>(f));
+    invoke_ = [](void* s) { (*static_cast<Fn*>(s))(); };
+    manage_ = [](Operation op, void* src, void* dst) {
+      Fn* fn = static_cast<Fn*>(src);
+      if (op == Operation::Move)
+      {
+        new (dst) Fn(std::move(*fn));
+      }
+      fn->~Fn();
+    };
+  }
+
+  template<class Fn, class F>
+  void init(F&& f, std::false_type /*fits_inline*/)
+  {
+    *reinterpret_cast<Fn**>(&storage_) = new Fn(std::forward<F>(f));
+    invoke_ = [](void* s) { (**static_cast<Fn**>(s))(); };
+    manage_ = [](Operation op, void* src, void* dst) {
+      Fn** fn = static_cast<Fn**>(src);
+      if (op == Operation::Move)
+      {
+        *static_cast<Fn**>(dst) = *fn;
+      }
+      else
+      {
+        delete *fn;
+      }
+    };
+  }
+
+  void moveFrom(ThreadPoolTask& other)
+  {
+    if (other.invoke_)
+    {
+      other.manage_(Operation::Move, &other.storage_, &storage_);
+      invoke_ = other.invoke_;
+      manage_ = other.manage_;
+      other.invoke_ = nullptr;
+      other.manage_ = nullptr;
+    }
+  }
+
+  void reset()
+  {
+    if (invoke_)
+    {
+      manage_(Operation::Destroy, &storage_, nullptr);
+      invoke_ = nullptr;
+      manage_ = nullptr;
+    }
+  }
+
+  Storage storage_;
+  InvokeFn invoke_ = nullptr;
+  ManageFn manage_ = nullptr;
+};
+
+//! Work-stealing thread pool.
+//!
+//! Every worker owns a task deque: it pushes and pops its own tasks at the
+//! back and steals from the front of the other workers' deques when it runs
+//! out of work. Tasks submitted from outside the pool are distributed
+//! round-robin. Idle workers sleep on a condition variable.
+//!
+//! Threads that wait for a TaskGroup (including parallelFor and
+//! parallelReduce) execute pending tasks while waiting, so nested parallelism
+//! does not dead-lock and a pool without threads runs everything in the
+//! calling thread.
 class ThreadPool
 {
 public:
+  class TaskGroup;
+
   ThreadPool() = default;
 
   //! Creates a thread pool and starts the amount of specified worker threads.
@@ -49,30 +181,123 @@ public:
     startThreads(n_threads);
   }
 
-  //! The destructor joins all threads.
+  //! The destructor executes all remaining tasks and joins all threads.
   ~ThreadPool();
 
-  //! Launches the amount of specified worker threads.
+  //! Launches the amount of specified worker threads. Can only be called once.
   void startThreads(size_t n_threads);
 
+  inline size_t numThreads() const { return workers_.size(); }
+
   //! Add task to threadpool. See for example usage in unit-test.
   template<class F, class... Args>
   auto enqueue(F&& f, Args&&... args)
   -> std::future<typename std::result_of<F(Args...)>::type>;
 
+  //! Add task to threadpool without creating a future. Small tasks are stored
+  //! without heap allocation.
+  void submit(ThreadPoolTask&& task);
+
+  //! Calls f(i) for all i in [begin, end). The range is split into chunks of
+  //! grain_size indices that are processed in parallel. grain_size = 0 picks a
+  //! chunk size based on the number of threads. Returns when all calls
+  //! have finished.
+  template<class F>
+  void parallelFor(size_t begin, size_t end, size_t grain_size, const F& f);
+
+  //! Reduces over [begin, end). Every chunk of grain_size indices starts from
+  //! identity and is accumulated by map(chunk_begin, chunk_end, accumulator).
+  //! The chunk results are combined with reduce(lhs, rhs) in chunk order, so
+  //! the result only depends on grain_size, not on the scheduling. Pass a
+  //! non-zero grain_size for results that do not depend on the thread count.
+  template<class T, class Map, class Reduce>
+  T parallelReduce(size_t begin, size_t end, size_t grain_size,
+                   const T& identity, const Map& map, const Reduce& reduce);
+
+  //! Executes one pending task in the calling thread.
+  //! Returns false if no task was available.
+  bool runPendingTask();
+
 private:
+  //! Task deque of a worker, implemented as a growing ring buffer so that
+  //! steady-state pushing and popping does not allocate.
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::vector<ThreadPoolTask> ring;
+    size_t head = 0u;
+    size_t size = 0u;
+    //! Keeps queues that are allocated back-to-back off each other's cache line.
+    char padding[64];
+
+    void pushBack(ThreadPoolTask&& task);
+    bool popBack(ThreadPoolTask& task);
+    bool popFront(ThreadPoolTask& task);
+  };
+
+  void workerLoop(size_t index);
+
+  //! Takes a task from the own queue (index < numThreads()) or steals one.
+  bool popTask(size_t index, ThreadPoolTask& task);
+
+  size_t chunkSize(size_t range, size_t grain_size) const;
+
   //! need to keep track of threads so we can join them
   std::vector<std::thread> workers_;
 
-  //! the task queue
-  std::queue<std::function<void()>> tasks_;
+  //! the task queues, one per worker
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::atomic<size_t> next_queue_{0u};
 
   //! synchronization
-  std::mutex queue_mutex_;
+  std::atomic<size_t> num_queued_{0u};
+  std::atomic<size_t> num_sleeping_{0u};
+  std::mutex sleep_mutex_;
   std::condition_variable condition_;
-  bool stop_ = false;
+  std::atomic<bool> stop_{false};
+};
+
+//! A set of tasks that can be waited on without futures.
+class ThreadPool::TaskGroup
+{
+public:
+  explicit TaskGroup(ThreadPool& pool)
+    : pool_(pool)
+  {}
+
+  //! Waits for all tasks that are still running.
+  ~TaskGroup() { waitNoThrow(); }
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  //! Schedules f() on the pool.
+  template<class F>
+  void run(F&& f);
+
+  //! Blocks until all tasks of the group have finished, helping to execute
+  //! pending tasks in the meantime. Rethrows the first exception thrown by a
+  //! task of the group.
+  void wait();
+
+private:
+  //! Runs the user callable and signals completion to the group.
+  template<class Fn>
+  struct GroupTask
+  {
+    TaskGroup* group;
+    Fn fn;
+    void operator()();
+  };
+
+  void waitNoThrow();
+
+  ThreadPool& pool_;
+  std::atomic<size_t> pending_{0u};
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
 };
- 
+
 // add new work item to the pool
 template<class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args)
@@ -85,19 +310,89 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
   );
 
   std::future<return_type> res = task->get_future();
-  {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
+  submit([task](){ (*task)(); });
+  return res;
+}
 
-    // don't allow enqueueing after stopping the pool
-    if (stop_)
+template<class Fn>
+void ThreadPool::TaskGroup::GroupTask<Fn>::operator()()
+{
+  try
+  {
+    fn();
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(group->exception_mutex_);
+    if (!group->exception_)
     {
-      LOG(FATAL) << "Enqueue on stopped ThreadPool";
+      group->exception_ = std::current_exception();
     }
+  }
+  group->pending_.fetch_sub(1u, std::memory_order_release);
+}
 
-    tasks_.emplace([task](){ (*task)(); });
+template<class F>
+void ThreadPool::TaskGroup::run(F&& f)
+{
+  pending_.fetch_add(1u, std::memory_order_relaxed);
+  pool_.submit(GroupTask<typename std::decay<F>::type>{this, std::forward<F>(f)});
+}
+
+template<class F>
+void ThreadPool::parallelFor(
+    size_t begin, size_t end, size_t grain_size, const F& f)
+{
+  if (end <= begin)
+  {
+    return;
   }
-  condition_.notify_one();
-  return res;
+  const size_t chunk = chunkSize(end - begin, grain_size);
+  TaskGroup group(*this);
+  for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk)
+  {
+    const size_t chunk_end = std::min(end, chunk_begin + chunk);
+    group.run([&f, chunk_begin, chunk_end]() {
+      for (size_t i = chunk_begin; i < chunk_end; ++i)
+      {
+        f(i);
+      }
+    });
+  }
+  group.wait();
+}
+
+template<class T, class Map, class Reduce>
+T ThreadPool::parallelReduce(
+    size_t begin, size_t end, size_t grain_size,
+    const T& identity, const Map& map, const Reduce& reduce)
+{
+  if (end <= begin)
+  {
+    return identity;
+  }
+  const size_t chunk = chunkSize(end - begin, grain_size);
+  const size_t num_chunks = (end - begin + chunk - 1u) / chunk;
+  std::vector<T, Eigen::aligned_allocator<T>> partial(num_chunks, identity);
+  {
+    TaskGroup group(*this);
+    for (size_t c = 0u; c < num_chunks; ++c)
+    {
+      T* result = &partial[c];
+      const size_t chunk_begin = begin + c * chunk;
+      const size_t chunk_end = std::min(end, chunk_begin + chunk);
+      group.run([&map, result, chunk_begin, chunk_end]() {
+        map(chunk_begin, chunk_end, *result);
+      });
+    }
+    group.wait();
+  }
+  T total = partial[0];
+  for (size_t c = 1u; c < num_chunks; ++c)
+  {
+    total = reduce(total, partial[c]);
+  }
+  return total;
 }
 
 } // namespace ze
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <ze/common/noncopyable.hpp>
@@ -193,8 +195,8 @@ private:
   bool _notFull() const;
 
   mutable Mutex mutex_;
-  ConditionVariable read_cond_;
-  ConditionVariable write_cond_;
+  mutable ConditionVariable read_cond_;
+  mutable ConditionVariable write_cond_;
 
   std::array<T, Capacity> buf_;
   unsigned tail_; // writer end
@@ -55,6 +55,13 @@ public:
     return t;
   }
 
+  //! Adds a timing in milliseconds that was not measured with start() and
+  //! stop(), e.g. because it started in another thread.
+  inline void addTiming(real_t milliseconds)
+  {
+    stat_.addSample(milliseconds);
+  }
+
   inline real_t numTimings() const { return stat_.numSamples(); }
   inline real_t accumulated() const { return stat_.sum(); }
   inline real_t min() const { return stat_.min(); }
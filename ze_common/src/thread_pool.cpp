@@ -27,42 +27,76 @@
 
 namespace ze {
 
+namespace {
+
+//! Pool and queue index of the calling thread if it is a worker.
+thread_local ThreadPool* tl_pool = nullptr;
+thread_local size_t tl_worker_index = 0u;
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+void ThreadPool::WorkerQueue::pushBack(ThreadPoolTask&& task)
+{
+  if (size == ring.size())
+  {
+    // Grow and unwrap the ring.
+    std::vector<ThreadPoolTask> grown(std::max<size_t>(16u, 2u * ring.size()));
+    for (size_t i = 0u; i < size; ++i)
+    {
+      grown[i] = std::move(ring[(head + i) % ring.size()]);
+    }
+    ring.swap(grown);
+    head = 0u;
+  }
+  ring[(head + size) % ring.size()] = std::move(task);
+  ++size;
+}
+
+//------------------------------------------------------------------------------
+bool ThreadPool::WorkerQueue::popBack(ThreadPoolTask& task)
+{
+  if (size == 0u)
+  {
+    return false;
+  }
+  --size;
+  task = std::move(ring[(head + size) % ring.size()]);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool ThreadPool::WorkerQueue::popFront(ThreadPoolTask& task)
+{
+  if (size == 0u)
+  {
+    return false;
+  }
+  task = std::move(ring[head]);
+  head = (head + 1u) % ring.size();
+  --size;
+  return true;
+}
+
+//------------------------------------------------------------------------------
 void ThreadPool::startThreads(size_t threads)
 {
-  for(size_t i = 0;i<threads;++i)
-  {
-    workers_.emplace_back(
-      [this] {
-
-        // Thread loop:
-        while (true)
-        {
-          std::function<void()> task;
-
-          // Wait for next task.
-          {
-            std::unique_lock<std::mutex> lock(this->queue_mutex_);
-            this->condition_.wait(lock, [this]{ return this->stop_ || !this->tasks_.empty(); });
-            if (this->stop_ && this->tasks_.empty())
-            {
-              return;
-            }
-            task = std::move(this->tasks_.front());
-            this->tasks_.pop();
-          }
-
-          // Execute task.
-          task();
-        }
-      }
-    );
+  CHECK(workers_.empty()) << "Threads have already been started.";
+  for (size_t i = 0u; i < threads; ++i)
+  {
+    queues_.emplace_back(new WorkerQueue());
+  }
+  for (size_t i = 0u; i < threads; ++i)
+  {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
   }
 }
 
+//------------------------------------------------------------------------------
 ThreadPool::~ThreadPool()
 {
   {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
     stop_ = true;
   }
   condition_.notify_all();
@@ -72,4 +106,159 @@ ThreadPool::~ThreadPool()
   }
 }
 
+//------------------------------------------------------------------------------
+void ThreadPool::submit(ThreadPoolTask&& task)
+{
+  // don't allow enqueueing after stopping the pool
+  if (stop_)
+  {
+    LOG(FATAL) << "Enqueue on stopped ThreadPool";
+  }
+
+  if (queues_.empty())
+  {
+    // No worker threads: run in the calling thread.
+    task();
+    return;
+  }
+
+  // Workers push to their own queue, everybody else round-robin.
+  const size_t index = (tl_pool == this)
+      ? tl_worker_index
+      : next_queue_.fetch_add(1u, std::memory_order_relaxed) % queues_.size();
+  // Count the task before it can be popped, otherwise the counter could
+  // wrap around. Pairs with the sleeping worker in workerLoop(): either the
+  // worker sees the new task or we see the sleeping worker.
+  num_queued_.fetch_add(1u, std::memory_order_seq_cst);
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->pushBack(std::move(task));
+  }
+
+  if (num_sleeping_.load(std::memory_order_seq_cst) > 0u)
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    condition_.notify_one();
+  }
+}
+
+//------------------------------------------------------------------------------
+bool ThreadPool::popTask(size_t index, ThreadPoolTask& task)
+{
+  if (num_queued_.load(std::memory_order_relaxed) == 0u)
+  {
+    return false;
+  }
+
+  const size_t num_queues = queues_.size();
+  if (index < num_queues)
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    if (queues_[index]->popBack(task))
+    {
+      num_queued_.fetch_sub(1u, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Steal the oldest task of another queue.
+  for (size_t i = 1u; i <= num_queues; ++i)
+  {
+    const size_t victim = (index + i) % num_queues;
+    std::lock_guard<std::mutex> lock(queues_[victim]->mutex);
+    if (queues_[victim]->popFront(task))
+    {
+      num_queued_.fetch_sub(1u, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool ThreadPool::runPendingTask()
+{
+  ThreadPoolTask task;
+  const size_t index = (tl_pool == this) ? tl_worker_index : queues_.size();
+  if (!popTask(index, task))
+  {
+    return false;
+  }
+  task();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+size_t ThreadPool::chunkSize(size_t range, size_t grain_size) const
+{
+  if (grain_size > 0u)
+  {
+    return grain_size;
+  }
+  // A few chunks per thread to balance uneven work.
+  const size_t num_chunks = 4u * (numThreads() + 1u);
+  return std::max<size_t>(1u, (range + num_chunks - 1u) / num_chunks);
+}
+
+//------------------------------------------------------------------------------
+void ThreadPool::workerLoop(size_t index)
+{
+  tl_pool = this;
+  tl_worker_index = index;
+
+  // Thread loop:
+  while (true)
+  {
+    ThreadPoolTask task;
+    if (popTask(index, task))
+    {
+      // Execute task.
+      task();
+      continue;
+    }
+
+    // Wait for next task.
+    num_sleeping_.fetch_add(1u, std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      condition_.wait(lock, [this] {
+        return stop_ || num_queued_.load(std::memory_order_seq_cst) > 0u;
+      });
+    }
+    num_sleeping_.fetch_sub(1u, std::memory_order_relaxed);
+
+    if (stop_ && num_queued_.load() == 0u)
+    {
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void ThreadPool::TaskGroup::wait()
+{
+  waitNoThrow();
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(exception_mutex_);
+    std::swap(exception, exception_);
+  }
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+//------------------------------------------------------------------------------
+void ThreadPool::TaskGroup::waitNoThrow()
+{
+  while (pending_.load(std::memory_order_acquire) > 0u)
+  {
+    if (!pool_.runPendingTask())
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
 } // namespace ze
@@ -155,4 +155,102 @@ TEST(BufferTest, testInterpolation)
   EXPECT_FLOATTYPE_EQ(values(0, stamps.size()-1), 9);
 }
 
+TEST(BufferTest, testOutOfOrderInsert)
+{
+  ze::Buffer<double, 2> buffer;
+  for(int i : {5, 1, 9, 3, 7, 2, 8, 4, 6})
+  {
+    buffer.insert(i, Eigen::Vector2d(i, -i));
+  }
+  // Overwrite existing entry.
+  buffer.insert(4, Eigen::Vector2d(40, -40));
+  EXPECT_EQ(buffer.size(), 9u);
+
+  buffer.lock();
+  int64_t i = 1;
+  for(auto it = buffer.data().begin(); it != buffer.data().end(); ++it, ++i)
+  {
+    EXPECT_EQ(it->first, i);
+    EXPECT_EQ(it->second(0), (i == 4) ? 40 : i);
+    EXPECT_EQ((*it).second(1), (i == 4) ? -40 : -i);
+  }
+  buffer.unlock();
+}
+
+TEST(BufferTest, testMutableIterator)
+{
+  ze::Buffer<double, 2> buffer;
+  for(int i = 1; i < 10; ++i)
+  {
+    buffer.insert(ze::secToNanosec(i), Eigen::Vector2d(i, i));
+  }
+  buffer.removeDataBeforeTimestamp(ze::secToNanosec(2));
+
+  buffer.lock();
+  for(auto it = buffer.data().begin(); it != buffer.data().end(); ++it)
+  {
+    it->second(1) *= 10;
+  }
+  buffer.iterator_equal_or_after(ze::secToNanosec(4.5))->second(0) = -5;
+  buffer.data().back().second(0) = -9;
+
+  // Reverse iteration.
+  int i = 9;
+  for(auto it = buffer.data().rbegin(); it != buffer.data().rend(); ++it, --i)
+  {
+    EXPECT_EQ(it->first, ze::secToNanosec(i));
+    EXPECT_EQ(it->second(0), (i == 5 || i == 9) ? -i : i);
+    EXPECT_EQ(it->second(1), 10 * i);
+  }
+  EXPECT_EQ(i, 1);
+  EXPECT_EQ(buffer.data().front().first, ze::secToNanosec(2));
+  EXPECT_EQ(buffer.data().back().first, ze::secToNanosec(9));
+  buffer.unlock();
+}
+
+TEST(BufferTest, testFixedSizeTrimming)
+{
+  using namespace ze;
+  Buffer<real_t, 3> buffer(1.0);
+  for(int i = 0; i <= 1000; ++i)
+  {
+    buffer.insert(millisecToNanosec(i * 10), Vector3(i, 2 * i, 3 * i));
+  }
+  int64_t oldest, newest;
+  bool success;
+  std::tie(oldest, newest, success) = buffer.getOldestAndNewestStamp();
+  EXPECT_TRUE(success);
+  EXPECT_EQ(oldest, millisecToNanosec(9000));
+  EXPECT_EQ(newest, millisecToNanosec(10000));
+  EXPECT_EQ(buffer.size(), 101u);
+  EXPECT_FLOATTYPE_EQ(buffer.getOldestValue().first(2), 2700);
+  EXPECT_FLOATTYPE_EQ(buffer.getNewestValue().first(2), 3000);
+}
+
+TEST(BufferTest, testBetweenValuesView)
+{
+  using namespace ze;
+  Buffer<real_t, 2> buffer;
+  for(int i = 0; i < 10; ++i)
+  {
+    buffer.insert(secToNanosec(i), Vector2(i, 10 * i));
+  }
+  buffer.removeDataBeforeTimestamp(secToNanosec(2));
+
+  buffer.lock();
+  auto view = buffer.getBetweenValues(secToNanosec(1.5), secToNanosec(5));
+  ASSERT_EQ(view.first.size(), 4);
+  ASSERT_EQ(view.second.cols(), 4);
+  for(int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(view.first(i), secToNanosec(i + 2));
+    EXPECT_FLOATTYPE_EQ(view.second(1, i), 10 * (i + 2));
+  }
+
+  auto empty_view = buffer.getBetweenValues(secToNanosec(5.5), secToNanosec(5.6));
+  EXPECT_EQ(empty_view.first.size(), 0);
+  EXPECT_EQ(empty_view.second.cols(), 0);
+  buffer.unlock();
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,380 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include <ze/common/benchmark.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_thread_blocking.hpp>
+#include <ze/common/lock_free_fifo.hpp>
+#include <ze/common/thread_safe_fifo.hpp>
+
+using namespace ::ze;
+
+// unnamed namespace for internal stuff
+namespace {
+
+std::atomic<unsigned> s_num_live(0);
+std::atomic<unsigned> s_counter(0);
+
+constexpr unsigned c_num_objects_per_thread = 12000;
+
+class TestObject
+{
+public:
+  TestObject()
+  {
+    s_num_live.fetch_add(1, std::memory_order_relaxed);
+    counter_ = s_counter.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~TestObject()
+  {
+    s_num_live.fetch_sub(1, std::memory_order_relaxed);
+  }
+  unsigned counter() const
+  {
+    return counter_;
+  }
+private:
+  unsigned counter_;
+}; // class TestObject
+
+typedef std::shared_ptr<TestObject> TestObjectPtr;
+typedef LockFreeFifo<TestObjectPtr, 8> TestObjectQueue;
+
+//------------------------------------------------------------------------------
+TestObjectPtr createObj()
+{
+  return std::make_shared<TestObject>();
+}
+
+//------------------------------------------------------------------------------
+class BlockingReadTest : public BlockingTest
+{
+public:
+  BlockingReadTest() : queue_() { }
+  ~BlockingReadTest() { }
+  virtual void performBlockingAction(unsigned testId);
+  virtual void performUnblockingAction(unsigned testId);
+private:
+  TestObjectQueue queue_;
+}; // class BlockingReadTest
+
+//------------------------------------------------------------------------------
+void BlockingReadTest::performBlockingAction(unsigned testId)
+{
+  TestObjectPtr obj = queue_.read();
+  EXPECT_TRUE(obj.get() != nullptr);
+}
+
+//------------------------------------------------------------------------------
+void BlockingReadTest::performUnblockingAction(unsigned testId)
+{
+  queue_.write(createObj());
+}
+
+//------------------------------------------------------------------------------
+class BlockingWriteTest : public BlockingTest {
+public:
+  BlockingWriteTest();
+  ~BlockingWriteTest() { }
+  virtual void performBlockingAction(unsigned testId);
+  virtual void performUnblockingAction(unsigned testId);
+private:
+  TestObjectQueue queue_;
+};
+
+//------------------------------------------------------------------------------
+BlockingWriteTest::BlockingWriteTest()
+  : queue_()
+{
+  for (unsigned i = 0; i < 8; ++i)
+  {
+    queue_.write(createObj());
+  }
+}
+
+//------------------------------------------------------------------------------
+void BlockingWriteTest::performBlockingAction(unsigned testId)
+{
+  queue_.write(createObj());
+}
+
+//------------------------------------------------------------------------------
+void BlockingWriteTest::performUnblockingAction(unsigned testId)
+{
+  TestObjectPtr obj = queue_.read();
+  EXPECT_TRUE(obj.get() != nullptr);
+}
+
+//------------------------------------------------------------------------------
+//! Runs num_writers writer threads and one reader thread on the queue and
+//! returns the number of elements received. Every writer sends
+//! num_objects increasing integers, the reader checks that the elements of
+//! each writer arrive in order.
+template <class Queue>
+unsigned runThreadTest(Queue& queue, unsigned num_writers, unsigned num_objects)
+{
+  std::vector<std::thread> writers;
+  for (unsigned w = 0; w < num_writers; ++w)
+  {
+    writers.emplace_back([&queue, w, num_objects]()
+    {
+      for (unsigned i = 0; i < num_objects; ++i)
+      {
+        queue.write(static_cast<uint64_t>(w) << 32 | i);
+      }
+    });
+  }
+
+  unsigned count = 0;
+  std::vector<int64_t> last(num_writers, -1);
+  bool in_order = true;
+  std::thread reader([&]()
+  {
+    uint64_t value;
+    while (count < num_writers * num_objects)
+    {
+      if (!queue.timedRead(value, 100))
+      {
+        continue;
+      }
+      const unsigned w = value >> 32;
+      const int64_t i = value & 0xffffffff;
+      in_order &= (i == last[w] + 1);
+      last[w] = i;
+      ++count;
+    }
+  });
+
+  for (std::thread& writer : writers)
+  {
+    writer.join();
+  }
+  reader.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_TRUE(queue.empty());
+  return count;
+}
+
+} // unnamed namespace
+
+TEST(LockFreeFifo, Default)
+{
+  TestObjectQueue queue;
+
+  //
+  // write objects until the queue is full, then clear it again
+  //
+
+  s_counter = 0;
+  EXPECT_TRUE(queue.empty());
+  for (unsigned i = 0; i < 8; ++i)
+  {
+    EXPECT_EQ(i, queue.size());
+    queue.write(createObj());
+  }
+  EXPECT_EQ(8, queue.size());
+  EXPECT_EQ(8, s_num_live);
+  EXPECT_TRUE(queue.full());
+  EXPECT_FALSE(queue.nonBlockingWrite(createObj()));
+  EXPECT_FALSE(queue.timedWrite(createObj(), 1));
+
+  for (unsigned i = 0; i < 8; ++i)
+  {
+    TestObjectPtr obj = queue.read();
+    ASSERT_TRUE(obj.get() != nullptr);
+    EXPECT_EQ(i, obj->counter());
+  }
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(0, queue.size());
+  EXPECT_EQ(0, s_num_live);
+
+  TestObjectPtr obj;
+  EXPECT_FALSE(queue.nonBlockingRead(obj));
+  EXPECT_FALSE(queue.timedRead(obj, 1));
+
+  //
+  // use non-blocking reads and writes across the wrap-around
+  //
+
+  s_counter = 0;
+
+  for (unsigned i = 0; i < 8; ++i)
+  {
+    EXPECT_TRUE(queue.nonBlockingWrite(createObj()));
+  }
+  EXPECT_FALSE(queue.nonBlockingWrite(createObj()));
+  EXPECT_EQ(8, s_num_live);
+
+  for (unsigned i = 0; i < 5; ++i)
+  {
+    TestObjectPtr obj;
+    EXPECT_TRUE(queue.nonBlockingRead(obj));
+    ASSERT_TRUE(obj.get() != nullptr);
+    EXPECT_EQ(i, obj->counter());
+  }
+  for (unsigned i = 0; i < 2; ++i)
+  {
+    EXPECT_TRUE(queue.timedWrite(createObj(), 1));
+  }
+  EXPECT_EQ(5, queue.size());
+  EXPECT_EQ(5, s_num_live);
+  for (unsigned i = 0; i < 3; ++i)
+  {
+    TestObjectPtr obj;
+    EXPECT_TRUE(queue.timedRead(obj, 1));
+    ASSERT_TRUE(obj.get() != nullptr);
+    EXPECT_EQ(i + 5, obj->counter());
+  }
+  for (unsigned i = 0; i < 2; ++i)
+  {
+    TestObjectPtr obj;
+    EXPECT_TRUE(queue.nonBlockingRead(obj));
+    ASSERT_TRUE(obj.get() != nullptr);
+    EXPECT_EQ(i + 9, obj->counter()); // 8 previous reads, plus one failed write
+  }
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(0, s_num_live);
+
+  //
+  // test the clear() functionality
+  //
+
+  for (unsigned i = 0; i < 8; ++i)
+  {
+    queue.write(createObj());
+  }
+  EXPECT_EQ(8, s_num_live);
+  EXPECT_TRUE(queue.full());
+  queue.clear();
+  EXPECT_EQ(0, s_num_live);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.full());
+}
+
+TEST(LockFreeFifo, StringTest)
+{
+  LockFreeFifo<std::string, 16, true, FifoSpinWait> queue;
+
+  queue.write("a");
+  queue.write("b");
+  queue.write("c");
+
+  EXPECT_EQ("a", queue.read());
+  EXPECT_EQ("b", queue.read());
+  EXPECT_EQ("c", queue.read());
+
+  for (unsigned i = 0; i < 3; i++) {
+    queue.write("x");
+    queue.write("y");
+    queue.write("z");
+  }
+
+  EXPECT_EQ(9, queue.size());
+
+  for (unsigned i = 0; i < 3; i++) {
+    EXPECT_EQ("x", queue.read());
+    EXPECT_EQ("y", queue.read());
+    EXPECT_EQ("z", queue.read());
+  }
+}
+
+TEST(LockFreeFifo, BlockingReadTest)
+{
+  EXPECT_EQ(0, s_num_live);
+  {
+    BlockingReadTest test;
+    test.runBlockingTest(0, 200);
+  }
+  EXPECT_EQ(0, s_num_live);
+}
+
+TEST(LockFreeFifo, BlockingWriteTest)
+{
+  EXPECT_EQ(0, s_num_live);
+  {
+    BlockingWriteTest test;
+    EXPECT_EQ(8, s_num_live);
+    test.runBlockingTest(0, 200);
+  }
+  EXPECT_EQ(0, s_num_live);
+}
+
+TEST(LockFreeFifo, SingleProducerThreadTest)
+{
+  LockFreeFifo<uint64_t, 512> queue;
+  EXPECT_EQ(c_num_objects_per_thread,
+            runThreadTest(queue, 1, c_num_objects_per_thread));
+
+  LockFreeFifo<uint64_t, 4, false, FifoParkWait> small_queue;
+  EXPECT_EQ(c_num_objects_per_thread,
+            runThreadTest(small_queue, 1, c_num_objects_per_thread));
+}
+
+TEST(LockFreeFifo, MultiProducerThreadTest)
+{
+  LockFreeFifo<uint64_t, 512, true> queue;
+  EXPECT_EQ(4 * c_num_objects_per_thread,
+            runThreadTest(queue, 4, c_num_objects_per_thread));
+
+  LockFreeFifo<uint64_t, 4, true, FifoSpinWait> small_queue;
+  EXPECT_EQ(4 * c_num_objects_per_thread,
+            runThreadTest(small_queue, 4, c_num_objects_per_thread));
+}
+
+TEST(LockFreeFifo, Benchmark)
+{
+  // Same thread topologies as ThreadSafeFifo.ThreadTest.
+  ThreadSafeFifo<uint64_t, 512> mutex_queue;
+  LockFreeFifo<uint64_t, 512> spsc_queue;
+  LockFreeFifo<uint64_t, 512, true> mpsc_queue;
+
+  auto spscMutex = [&]() { runThreadTest(mutex_queue, 1, c_num_objects_per_thread); };
+  auto spscLockFree = [&]() { runThreadTest(spsc_queue, 1, c_num_objects_per_thread); };
+  auto mpscMutex = [&]() { runThreadTest(mutex_queue, 4, c_num_objects_per_thread); };
+  auto mpscLockFree = [&]() { runThreadTest(mpsc_queue, 4, c_num_objects_per_thread); };
+
+  real_t spsc_mutex = runTimingBenchmark(spscMutex, 2, 5,
+                                         "ThreadSafeFifo: 1 writer", true);
+  real_t spsc_lock_free = runTimingBenchmark(spscLockFree, 2, 5,
+                                             "LockFreeFifo: 1 writer", true);
+  VLOG(1) << "[1 writer] ThreadSafeFifo/LockFreeFifo: "
+          << spsc_mutex / spsc_lock_free << "\n";
+
+  real_t mpsc_mutex = runTimingBenchmark(mpscMutex, 2, 5,
+                                         "ThreadSafeFifo: 4 writers", true);
+  real_t mpsc_lock_free = runTimingBenchmark(mpscLockFree, 2, 5,
+                                             "LockFreeFifo: 4 writers", true);
+  VLOG(1) << "[4 writers] ThreadSafeFifo/LockFreeFifo: "
+          << mpsc_mutex / mpsc_lock_free << "\n";
+}
+
+ZE_UNITTEST_ENTRYPOINT
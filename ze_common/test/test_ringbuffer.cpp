@@ -23,7 +23,11 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 
@@ -32,6 +36,7 @@
 #include <ze/common/ringbuffer.hpp>
 #include <ze/common/buffer.hpp>
 #include <ze/common/test_entrypoint.hpp>
+#include <ze/common/timer.hpp>
 
 DEFINE_bool(run_benchmark, false, "Benchmark the buffer vs. ringbuffer");
 
@@ -490,4 +495,243 @@ TEST(RingBufferTest, benchmarkBufferVsRingBuffer)
   VLOG(1) << "[Remove]" << "Buffer/Ringbuffer: " <<  buffer_remove / ringbuffer_remove << "\n";
 }
 
+TEST(RingBufferTest, testSeqLockSingleThreaded)
+{
+  using namespace ze;
+  Ringbuffer<real_t, 2, 10, RingbufferSync::SeqLock> buffer;
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_FALSE(std::get<2>(buffer.getNearestValue(secToNanosec(1))));
+
+  for(int i = 0; i < 15; ++i)
+  {
+    buffer.insert(secToNanosec(i), Vector2(i, i));
+  }
+  EXPECT_EQ(buffer.size(), 10u);
+  EXPECT_EQ(buffer.getOldestValue().first[0], 5);
+  EXPECT_EQ(buffer.getNewestValue().first[0], 14);
+  EXPECT_EQ(std::get<1>(buffer.getNearestValue(secToNanosec(7.4)))[0], 7);
+
+  Vector2 out;
+  EXPECT_TRUE(buffer.getValueInterpolated(secToNanosec(8.5), out));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(out, Vector2(8.5, 8.5), 1e-8));
+  EXPECT_FALSE(buffer.getValueInterpolated(secToNanosec(4), out));
+
+  Eigen::Matrix<int64_t, Eigen::Dynamic, 1> stamps;
+  Eigen::Matrix<real_t, 2, Eigen::Dynamic> values;
+  std::tie(stamps, values) = buffer.getBetweenValuesInterpolated(
+        secToNanosec(7.5), secToNanosec(12.5));
+  ASSERT_EQ(stamps.size(), 7);
+  for (int i = 0; i < 7; ++i)
+  {
+    EXPECT_DOUBLE_EQ(values(0, i), nanosecToSecTrunc(stamps(i)));
+  }
+
+  buffer.removeDataOlderThan(3.0);
+  EXPECT_EQ(buffer.size(), 4u);
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+namespace {
+
+// One read of every kind. The writer inserts (t, 2t) at stamp t, inconsistent
+// values are counted as errors.
+template<typename BufferType>
+void readAndCheck(BufferType& buffer, std::atomic<int>* num_errors)
+{
+  using namespace ze;
+  int64_t stamp;
+  typename BufferType::DataType value;
+  bool success;
+  std::tie(stamp, value, success) = buffer.getNearestValue(50);
+  if (success && (value(0) != stamp || value(1) != 2 * stamp))
+  {
+    ++(*num_errors);
+  }
+
+  int64_t newest;
+  std::tie(std::ignore, newest, std::ignore) = buffer.getOldestAndNewestStamp();
+  const int64_t t = newest - 10;
+  Vector2 out;
+  if (buffer.getValueInterpolated(t, out)
+      && (std::abs(out(0) - t) > 1e-6 || std::abs(out(1) - 2 * t) > 1e-6))
+  {
+    ++(*num_errors);
+  }
+
+  Eigen::Matrix<int64_t, Eigen::Dynamic, 1> stamps;
+  Eigen::Matrix<real_t, 2, Eigen::Dynamic> values;
+  std::tie(stamps, values) =
+      buffer.getBetweenValuesInterpolated(newest - 50, newest - 10);
+  for (int k = 0; k < stamps.size(); ++k)
+  {
+    if (std::abs(values(0, k) - stamps(k)) > 1e-6
+        || std::abs(values(1, k) - 2 * stamps(k)) > 1e-6)
+    {
+      ++(*num_errors);
+    }
+  }
+}
+
+// The writer inserts while the readers check that they never observe
+// inconsistent values.
+template<ze::RingbufferSync Sync>
+void runSingleWriterMultiReader(
+    int num_readers, int num_samples, std::atomic<int>* num_errors)
+{
+  using namespace ze;
+  Ringbuffer<real_t, 2, 256, Sync> buffer;
+  for (int i = 0; i < 100; ++i)
+  {
+    buffer.insert(i, Vector2(i, 2 * i));
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> num_started(0);
+  std::atomic<int64_t> num_reads(0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < num_readers; ++r)
+  {
+    readers.emplace_back([&]()
+    {
+      ++num_started;
+      while (!done.load(std::memory_order_relaxed))
+      {
+        readAndCheck(buffer, num_errors);
+        num_reads.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  // Write while all readers are running, until they read often enough.
+  while (num_started < num_readers)
+  {
+    std::this_thread::yield();
+  }
+  const int64_t min_reads = 20000 * num_readers;
+  for (int i = 100; i < num_samples || num_reads < min_reads; ++i)
+  {
+    buffer.insert(i, Vector2(i, 2 * i));
+  }
+  done = true;
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+}
+
+struct ConcurrencyBenchmarkResult
+{
+  real_t reads_per_second;
+  real_t mean_insert_ns;
+  real_t max_insert_ns;
+};
+
+// The writer inserts num_inserts samples at a fixed rate, like a sensor
+// driver, so that both synchronization modes do the same work in the same
+// time. Returns the throughput of the readers and the time the writer spends
+// in insert(), which includes waiting for the readers.
+template<ze::RingbufferSync Sync>
+ConcurrencyBenchmarkResult benchmarkSingleWriterMultiReader(
+    int num_readers, int num_inserts, int64_t insert_period_ns,
+    std::atomic<int>* num_errors)
+{
+  using namespace ze;
+  Ringbuffer<real_t, 2, 256, Sync> buffer;
+  for (int i = 0; i < 100; ++i)
+  {
+    buffer.insert(i, Vector2(i, 2 * i));
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> num_started(0);
+  std::atomic<int64_t> num_reads(0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < num_readers; ++r)
+  {
+    readers.emplace_back([&]()
+    {
+      int64_t n = 0;
+      ++num_started;
+      while (!done.load(std::memory_order_relaxed))
+      {
+        readAndCheck(buffer, num_errors);
+        ++n;
+      }
+      num_reads += n;
+    });
+  }
+  while (num_started < num_readers)
+  {
+    std::this_thread::yield();
+  }
+
+  int64_t sum_insert_ns = 0;
+  int64_t max_insert_ns = 0;
+  Timer duration;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_inserts; ++i)
+  {
+    std::this_thread::sleep_until(
+          start + std::chrono::nanoseconds(i * insert_period_ns));
+    Timer t;
+    buffer.insert(100 + i, Vector2(100 + i, 2 * (100 + i)));
+    const int64_t insert_ns = t.stopAndGetNanoseconds();
+    sum_insert_ns += insert_ns;
+    max_insert_ns = std::max(max_insert_ns, insert_ns);
+  }
+  std::this_thread::sleep_until(
+        start + std::chrono::nanoseconds(num_inserts * insert_period_ns));
+  done = true;
+  const real_t seconds = duration.stopAndGetSeconds();
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+
+  ConcurrencyBenchmarkResult result;
+  result.reads_per_second = num_reads / seconds;
+  result.mean_insert_ns = static_cast<real_t>(sum_insert_ns) / num_inserts;
+  result.max_insert_ns = max_insert_ns;
+  return result;
+}
+
+} // unnamed namespace
+
+TEST(RingBufferTest, testSeqLockConcurrentReaders)
+{
+  std::atomic<int> num_errors(0);
+  runSingleWriterMultiReader<ze::RingbufferSync::SeqLock>(4, 200000, &num_errors);
+  EXPECT_EQ(num_errors, 0);
+}
+
+TEST(RingBufferTest, benchmarkMutexVsSeqLock)
+{
+  if (!FLAGS_run_benchmark) {
+    return;
+  }
+
+  using namespace ze;
+  // 2000 inserts at 4 kHz, i.e. half a second per run.
+  const int num_inserts = 2000;
+  const int64_t insert_period_ns = 250000;
+  std::atomic<int> num_errors(0);
+  for (int num_readers : {1, 4})
+  {
+    const ConcurrencyBenchmarkResult mutex =
+        benchmarkSingleWriterMultiReader<RingbufferSync::Mutex>(
+          num_readers, num_inserts, insert_period_ns, &num_errors);
+    const ConcurrencyBenchmarkResult seqlock =
+        benchmarkSingleWriterMultiReader<RingbufferSync::SeqLock>(
+          num_readers, num_inserts, insert_period_ns, &num_errors);
+    VLOG(1) << "[1 writer, " << num_readers << " readers, "
+            << num_inserts << " inserts]\n"
+            << "> Mutex:   " << mutex.reads_per_second << " reads/s, insert mean "
+            << mutex.mean_insert_ns << " ns, max " << mutex.max_insert_ns << " ns\n"
+            << "> SeqLock: " << seqlock.reads_per_second << " reads/s, insert mean "
+            << seqlock.mean_insert_ns << " ns, max " << seqlock.max_insert_ns << " ns";
+  }
+  EXPECT_EQ(num_errors, 0);
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -26,6 +26,10 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <atomic>
+#include <array>
 
 #include <ze/common/logging.hpp>
 #include <ze/common/test_entrypoint.hpp>
@@ -54,4 +58,103 @@ TEST(ThreadPoolTests, testThreadPool)
   }
 }
 
+TEST(ThreadPoolTests, testTaskGroup)
+{
+  ze::ThreadPool pool(4);
+  std::atomic<size_t> sum(0u);
+  {
+    ze::ThreadPool::TaskGroup group(pool);
+    for (size_t i = 1u; i <= 100u; ++i)
+    {
+      group.run([&sum, i] { sum += i; });
+    }
+    group.wait();
+    EXPECT_EQ(sum, 5050u);
+
+    // A group can be reused after waiting.
+    group.run([&sum] { sum = 0u; });
+    group.wait();
+    EXPECT_EQ(sum, 0u);
+  }
+
+  // Exceptions are rethrown in wait().
+  ze::ThreadPool::TaskGroup group(pool);
+  group.run([] { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(group.wait(), std::runtime_error);
+}
+
+TEST(ThreadPoolTests, testParallelFor)
+{
+  ze::ThreadPool pool(4);
+  std::vector<int> values(10000, 0);
+  pool.parallelFor(0u, values.size(), 64u, [&values](size_t i) {
+    values[i] = static_cast<int>(i);
+  });
+  for (size_t i = 0u; i < values.size(); ++i)
+  {
+    ASSERT_EQ(values[i], static_cast<int>(i));
+  }
+
+  // Nested loops must not dead-lock.
+  std::vector<std::atomic<int>> counts(16);
+  pool.parallelFor(0u, counts.size(), 1u, [&pool, &counts](size_t i) {
+    counts[i] = 0;
+    pool.parallelFor(0u, 100u, 0u, [&counts, i](size_t) { ++counts[i]; });
+  });
+  for (const std::atomic<int>& count : counts)
+  {
+    EXPECT_EQ(count, 100);
+  }
+
+  // Empty range.
+  pool.parallelFor(5u, 5u, 0u, [](size_t) { FAIL(); });
+}
+
+TEST(ThreadPoolTests, testParallelReduce)
+{
+  std::vector<double> values(12345);
+  for (size_t i = 0u; i < values.size(); ++i)
+  {
+    values[i] = 1.0 / (1.0 + i);
+  }
+  auto map = [&values](size_t begin, size_t end, double& sum) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      sum += values[i];
+    }
+  };
+  auto reduce = [](double a, double b) { return a + b; };
+
+  // Results are bit-identical for a fixed grain size, independent of the
+  // number of threads.
+  ze::ThreadPool serial_pool;
+  const double serial =
+      serial_pool.parallelReduce(0u, values.size(), 100u, 0.0, map, reduce);
+  ze::ThreadPool pool(4);
+  for (int run = 0; run < 10; ++run)
+  {
+    const double parallel =
+        pool.parallelReduce(0u, values.size(), 100u, 0.0, map, reduce);
+    EXPECT_EQ(serial, parallel);
+  }
+  EXPECT_NEAR(serial, std::accumulate(values.begin(), values.end(), 0.0), 1e-10);
+}
+
+TEST(ThreadPoolTests, testTaskStorage)
+{
+  int calls = 0;
+  ze::ThreadPoolTask small([&calls] { ++calls; });
+  ze::ThreadPoolTask moved(std::move(small));
+  EXPECT_FALSE(static_cast<bool>(small));
+  moved();
+
+  // Larger than the inline storage.
+  std::array<double, 16> payload;
+  payload.fill(1.0);
+  ze::ThreadPoolTask large([&calls, payload] { calls += static_cast<int>(payload[15]); });
+  moved = std::move(large);
+  moved();
+  EXPECT_EQ(calls, 2);
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,208 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+
+//! @file binary_dataset.hpp
+//! Single-file binary dataset that is played back from a memory mapping.
+//!
+//! File layout, all values in host byte order:
+//! - BinaryDatasetHeader.
+//! - Chunks of image data and sensor columns, each starting at a multiple of
+//!   c_binary_dataset_alignment bytes.
+//! - The section table, header.num_sections BinaryDatasetSection entries at
+//!   header.section_table_offset.
+//!
+//! An IMU section with n samples consists of the columns
+//!   int64 stamp[n], double acc_x[n], acc_y[n], acc_z[n], gyr_x[n], gyr_y[n], gyr_z[n].
+//! A camera section with n images consists of the columns
+//!   int64 stamp[n], uint64 offset[n], uint64 num_bytes[n],
+//!   uint32 width[n], height[n], pitch[n], encoding[n],
+//! where every column starts at a multiple of 8 bytes. offset and num_bytes
+//! locate the image data in the file. Timestamps of a sensor are sorted, so
+//! seeking is a binary search.
+
+namespace ze {
+
+// fwd
+class ImageBase;
+
+constexpr uint64_t c_binary_dataset_alignment = 64u;
+constexpr uint32_t c_binary_dataset_version = 1u;
+
+struct BinaryDatasetHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t num_sections;
+  uint64_t section_table_offset;
+};
+
+enum class BinaryDatasetSectionType : uint32_t
+{
+  Imu,
+  Camera
+};
+
+struct BinaryDatasetSection
+{
+  BinaryDatasetSectionType type;
+  uint32_t sensor_index;
+  uint64_t offset;
+  uint64_t count;
+};
+
+enum class BinaryImageEncoding : uint32_t
+{
+  Raw8uC1,    //!< Uncompressed 8-bit gray pixels, rows are pitch bytes apart.
+  Compressed  //!< Losslessly compressed image file content, e.g. png.
+};
+
+//! Read-only view of a binary dataset file.
+class BinaryDataset
+{
+public:
+  ZE_POINTER_TYPEDEFS(BinaryDataset);
+
+  struct ImuColumns
+  {
+    uint32_t imu_index;
+    size_t size;
+    const int64_t* stamps;
+    const double* acc[3];
+    const double* gyr[3];
+  };
+
+  struct CameraColumns
+  {
+    uint32_t camera_index;
+    size_t size;
+    const int64_t* stamps;
+    const uint64_t* offsets;
+    const uint64_t* num_bytes;
+    const uint32_t* widths;
+    const uint32_t* heights;
+    const uint32_t* pitches;
+    const uint32_t* encodings;
+  };
+
+  //! Maps the file into memory.
+  explicit BinaryDataset(const std::string& filename);
+
+  inline const std::vector<ImuColumns>& imus() const { return imus_; }
+
+  inline const std::vector<CameraColumns>& cameras() const { return cameras_; }
+
+  //! Returns image i of the camera. Raw images reference the mapped memory,
+  //! which stays valid as long as the image exists.
+  std::shared_ptr<ImageBase> image(const CameraColumns& camera, size_t i) const;
+
+  //! Index of the first stamp that is not smaller than the given stamp.
+  static size_t lowerBound(const int64_t* stamps, size_t size, int64_t stamp);
+
+private:
+  template<typename T>
+  const T* column(uint64_t offset, size_t size) const;
+
+  std::shared_ptr<const uint8_t> data_;
+  size_t size_ = 0u;
+  std::vector<ImuColumns> imus_;
+  std::vector<CameraColumns> cameras_;
+};
+
+//! Writes a binary dataset. Images are written immediately, the sensor columns
+//! when the writer is finished.
+class BinaryDatasetWriter
+{
+public:
+  explicit BinaryDatasetWriter(const std::string& filename);
+
+  //! Only flushes the file if finish() has not been called, the dataset is
+  //! incomplete then.
+  ~BinaryDatasetWriter();
+
+  //! Samples of every IMU must be added in chronological order.
+  void addImu(uint32_t imu_index, int64_t stamp,
+              const Vector3& acc, const Vector3& gyr);
+
+  //! Images of every camera must be added in chronological order.
+  void addImage(uint32_t camera_index, int64_t stamp,
+                BinaryImageEncoding encoding,
+                uint32_t width, uint32_t height, uint32_t pitch,
+                const uint8_t* data, size_t num_bytes);
+
+  //! Writes the sensor columns and the section table and closes the file.
+  void finish();
+
+private:
+  struct ImuData
+  {
+    std::vector<int64_t> stamps;
+    std::vector<double> columns[6];
+  };
+
+  struct CameraData
+  {
+    std::vector<int64_t> stamps;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> num_bytes;
+    std::vector<uint32_t> widths;
+    std::vector<uint32_t> heights;
+    std::vector<uint32_t> pitches;
+    std::vector<uint32_t> encodings;
+  };
+
+  //! Pads the file to the alignment and returns the offset.
+  uint64_t align();
+
+  template<typename T>
+  void writeColumn(const std::vector<T>& column);
+
+  std::ofstream fs_;
+  bool finished_ = false;
+  std::map<uint32_t, ImuData> imus_;
+  std::map<uint32_t, CameraData> cameras_;
+};
+
+//! Converts a csv dataset (see DataProviderCsv) to a binary dataset. The maps
+//! contain the sensor directories and their indices.
+void convertCsvDatasetToBinary(
+    const std::string& csv_directory,
+    const std::map<std::string, size_t>& imu_topics,
+    const std::map<std::string, size_t>& camera_topics,
+    const std::string& filename,
+    BinaryImageEncoding encoding);
+
+} // namespace ze
@@ -26,12 +26,17 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 #include <ze/common/macros.hpp>
 #include <ze/common/noncopyable.hpp>
 #include <ze/common/signal_handler.hpp>
+#include <ze/common/timer.hpp>
+#include <ze/common/timer_collection.hpp>
 #include <ze/common/types.hpp>
 
 // fwd
@@ -67,7 +72,27 @@ using CameraCallback =
 enum class DataProviderType {
   Csv,
   Rosbag,
-  Rostopic
+  Rostopic,
+  Binary
+};
+
+enum class ReplayMode {
+  AsFastAsPossible, //!< Call the callbacks without waiting.
+  RealTime,         //!< Pace the callbacks with the message timestamps.
+  ConsumerAck       //!< Wait until the consumer acknowledged earlier messages.
+};
+
+struct ReplayOptions
+{
+  ReplayMode mode = ReplayMode::AsFastAsPossible;
+
+  //! RealTime: Seconds of data replayed per second, e.g. 2 for twice as fast
+  //! as real-time.
+  real_t rate = 1.0;
+
+  //! ConsumerAck: Number of messages that may be unacknowledged before the
+  //! next callback is delayed.
+  size_t max_unacknowledged = 1u;
 };
 
 //! A data provider registers to a data source and triggers callbacks when
@@ -114,6 +139,28 @@ public:
   //! Register callback function to call when new Accelerometer message is available.
   void registerAccelCallback(const AccelCallback& accel_callback);
 
+  //! Set how recorded data is replayed. Not available for live data.
+  //! The order of the callbacks does not depend on the replay mode.
+  void setReplayOptions(const ReplayOptions& options);
+
+  //! ConsumerAck mode: The consumer calls this once it finished processing a
+  //! message. Messages are acknowledged in the order of the callbacks. Can be
+  //! called from any thread.
+  void acknowledge();
+
+  //! Seconds of data replayed per second so far. Above 1 if the consumers
+  //! keep up with more than real-time.
+  real_t replayRealTimeFactor() const;
+
+  //! Replay timings in milliseconds per message:
+  //! imu_latency, camera_latency: from the time the message is due (RealTime
+  //! mode) or the callback is called (other modes) until the callback returned
+  //! (or the message was acknowledged in ConsumerAck mode). IMU latencies
+  //! include gyroscope and accelerometer messages.
+  //! lag: RealTime mode, how late the callback was called.
+  //! Only read them when no callback is running or unacknowledged.
+  DECLARE_TIMER(ReplayTimer, replay_timers_, imu_latency, camera_latency, lag);
+
 protected:
   DataProviderType type_;
   ImuCallback imu_callback_;
@@ -123,6 +170,29 @@ protected:
   volatile bool running_ = true;
 
 private:
+  //! Paces the replay and returns the time when the message is due.
+  Timer::TimePoint beginReplayMessage(int64_t stamp, ReplayTimer timer);
+
+  void endReplayMessage(ReplayTimer timer, const Timer::TimePoint& due_time);
+
+  //! ConsumerAck mode: Waits until all messages are acknowledged or shutdown.
+  void waitForAcknowledgements();
+
+  ReplayOptions replay_options_;
+
+  //! Replay schedule: the largest timestamp so far and when it is due.
+  bool replay_started_ = false;
+  int64_t replay_start_stamp_ = 0;
+  int64_t replay_last_stamp_ = 0;
+  Timer::TimePoint replay_start_time_;
+  Timer::TimePoint replay_last_time_;
+
+  //! Guards the timers and the unacknowledged messages.
+  mutable std::mutex replay_mutex_;
+  std::condition_variable ack_condition_;
+  //! Due times and timers of the messages that are not acknowledged yet.
+  std::deque<std::pair<Timer::TimePoint, ReplayTimer>> unacknowledged_;
+
   SimpleSigtermHandler signal_handler_; //!< Sets running_ to false when Ctrl-C is pressed.
 };
 
@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ze/common/macros.hpp>
+#include <ze/common/types.hpp>
+#include <ze/data_provider/binary_dataset.hpp>
+#include <ze/data_provider/data_provider_base.hpp>
+
+namespace ze {
+
+//! Plays back a binary dataset (see binary_dataset.hpp) from a memory mapping.
+//! Nothing is parsed or loaded at startup, raw images are not copied.
+class DataProviderBinary : public DataProviderBase
+{
+public:
+  //! Plays back the IMUs and cameras with the given sensor indices.
+  DataProviderBinary(
+      const std::string& filename,
+      const std::vector<uint32_t>& imu_indices,
+      const std::vector<uint32_t>& camera_indices);
+
+  virtual ~DataProviderBinary() = default;
+
+  virtual bool spinOnce() override;
+
+  virtual bool ok() const override;
+
+  virtual size_t imuCount() const override;
+
+  virtual size_t cameraCount() const override;
+
+  //! Total number of messages.
+  size_t size() const;
+
+  //! Continue the playback with the first messages that are played back at
+  //! stamp_ns or later.
+  void seek(int64_t stamp_ns);
+
+private:
+  //! Messages of one sensor.
+  struct Stream
+  {
+    const BinaryDataset::ImuColumns* imu = nullptr;
+    const BinaryDataset::CameraColumns* camera = nullptr;
+    const int64_t* stamps;
+    size_t size;
+    int64_t playback_delay;
+    size_t next = 0u;
+  };
+
+  BinaryDataset dataset_;
+  std::vector<Stream> streams_;
+  size_t imu_count_ = 0u;
+  size_t camera_count_ = 0u;
+};
+
+} // namespace ze
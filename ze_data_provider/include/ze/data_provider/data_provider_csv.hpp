@@ -25,12 +25,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include <ze/common/macros.hpp>
+#include <ze/common/running_statistics_collection.hpp>
+#include <ze/common/timer.hpp>
 #include <ze/common/types.hpp>
 #include <ze/data_provider/data_provider_base.hpp>
 
@@ -38,8 +44,11 @@
 namespace ze {
 
 //fwd
+class ImageBase;
+class ThreadPool;
 namespace internal {
 struct MeasurementBase;
+struct CameraMeasurement;
 }
 
 class DataProviderCsv : public DataProviderBase
@@ -55,7 +64,7 @@ public:
       const std::map<std::string, size_t>& imu_topics,
       const std::map<std::string, size_t>& camera_topics);
 
-  virtual ~DataProviderCsv() = default;
+  virtual ~DataProviderCsv();
 
   virtual bool spinOnce() override;
 
@@ -70,6 +79,28 @@ public:
     return buffer_.size();
   }
 
+  //! Decode the images of the upcoming camera measurements in num_threads
+  //! background threads. At most max_queued_images images are decoded ahead,
+  //! and only as many as fit into max_queued_bytes (at least one). Callbacks
+  //! are still called from spinOnce() in timestamp order. num_threads = 0
+  //! disables the prefetching, which is the default.
+  void setImagePrefetch(
+      size_t num_threads,
+      size_t max_queued_images,
+      size_t max_queued_bytes);
+
+  //! Images passed to the camera callback per second, measured from the first
+  //! to the last image.
+  real_t imagesPerSecond() const;
+
+  //! Prefetching statistics, all timings in milliseconds:
+  //! decode: time to load an image in a worker thread.
+  //! wait: time spinOnce() blocked because the next image was not decoded yet.
+  //! queued_images: number of decoded images ready when one was requested.
+  //! Only read them when no spinOnce() call is running.
+  DECLARE_STATISTICS(PrefetchStatistics, prefetch_statistics_,
+                     decode, wait, queued_images);
+
 private:
   void loadImuData(
       const std::string data_dir,
@@ -91,6 +122,39 @@ private:
   std::map<std::string, size_t> camera_topics_;
 
   size_t imu_count_ = 0u;
+
+  //! Decodes images ahead until the queue is full or the limits are reached.
+  void schedulePrefetch();
+
+  //! Returns the image of the measurement, from the prefetch queue if it has
+  //! been scheduled there.
+  std::shared_ptr<ImageBase> loadImage(
+      const internal::CameraMeasurement& measurement);
+
+  struct PrefetchedImage
+  {
+    const internal::CameraMeasurement* measurement;
+    std::future<std::shared_ptr<ImageBase>> image;
+  };
+
+  //! Image prefetching.
+  size_t max_queued_images_ = 0u;
+  size_t max_queued_bytes_ = 0u;
+  //! Next buffer value to consider for prefetching.
+  DataBuffer::const_iterator prefetch_it_;
+  std::deque<PrefetchedImage> prefetch_queue_;
+  //! Largest decoded image, used to estimate the memory of queued images.
+  std::atomic<size_t> max_image_bytes_ {0u};
+  std::mutex prefetch_statistics_mutex_;
+
+  //! Image throughput.
+  size_t num_images_ = 0u;
+  Timer throughput_timer_;
+  real_t throughput_seconds_ = 0.0;
+
+  //! Declared last so that the workers are joined before any member they
+  //! access is destroyed.
+  std::unique_ptr<ThreadPool> prefetch_pool_;
 };
 
 } // namespace ze
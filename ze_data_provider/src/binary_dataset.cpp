@@ -0,0 +1,375 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/binary_dataset.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <imp/bridge/opencv/cv_bridge.hpp>
+#include <imp/core/image_raw.hpp>
+#include <ze/common/file_utils.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/path_utils.hpp>
+#include <ze/common/string_utils.hpp>
+
+namespace ze {
+
+namespace {
+
+constexpr char c_magic[8] = {'Z', 'E', 'D', 'A', 'T', 'A', '\0', '\0'};
+
+inline uint64_t alignOffset(uint64_t offset, uint64_t alignment)
+{
+  return (offset + alignment - 1u) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+BinaryDataset::BinaryDataset(const std::string& filename)
+{
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Could not open file " << filename;
+  struct stat st;
+  CHECK_EQ(::fstat(fd, &st), 0);
+  size_ = static_cast<size_t>(st.st_size);
+  CHECK_GE(size_, sizeof(BinaryDatasetHeader)) << "Not a binary dataset: " << filename;
+
+  // A private writable mapping lets users modify the images in-place without
+  // changing the file.
+  void* addr = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  CHECK(addr != MAP_FAILED) << "Could not map file " << filename;
+  const size_t size = size_;
+  data_.reset(static_cast<const uint8_t*>(addr), [size](const uint8_t* p) {
+    ::munmap(const_cast<uint8_t*>(p), size);
+  });
+
+  BinaryDatasetHeader header;
+  std::memcpy(&header, data_.get(), sizeof(header));
+  CHECK(std::equal(std::begin(c_magic), std::end(c_magic), header.magic))
+      << "Not a binary dataset: " << filename;
+  CHECK_EQ(header.version, c_binary_dataset_version);
+
+  const BinaryDatasetSection* sections =
+      column<BinaryDatasetSection>(header.section_table_offset, header.num_sections);
+  for (uint32_t s = 0u; s < header.num_sections; ++s)
+  {
+    const BinaryDatasetSection& section = sections[s];
+    // Bound the untrusted values first so that the offsets below can not wrap.
+    CHECK_LE(section.offset, size_) << "Corrupt section table.";
+    CHECK_LE(section.count, size_ / sizeof(int64_t)) << "Corrupt section table.";
+    const size_t n = section.count;
+    const uint64_t stride = alignOffset(n * sizeof(int64_t), sizeof(int64_t));
+    switch (section.type)
+    {
+      case BinaryDatasetSectionType::Imu:
+      {
+        ImuColumns imu;
+        imu.imu_index = section.sensor_index;
+        imu.size = n;
+        imu.stamps = column<int64_t>(section.offset, n);
+        for (int i = 0; i < 3; ++i)
+        {
+          imu.acc[i] = column<double>(section.offset + (1 + i) * stride, n);
+          imu.gyr[i] = column<double>(section.offset + (4 + i) * stride, n);
+        }
+        imus_.push_back(imu);
+        break;
+      }
+      case BinaryDatasetSectionType::Camera:
+      {
+        const uint64_t stride32 = alignOffset(n * sizeof(uint32_t), sizeof(int64_t));
+        CameraColumns cam;
+        cam.camera_index = section.sensor_index;
+        cam.size = n;
+        uint64_t offset = section.offset;
+        cam.stamps = column<int64_t>(offset, n);
+        cam.offsets = column<uint64_t>(offset += stride, n);
+        cam.num_bytes = column<uint64_t>(offset += stride, n);
+        cam.widths = column<uint32_t>(offset += stride, n);
+        cam.heights = column<uint32_t>(offset += stride32, n);
+        cam.pitches = column<uint32_t>(offset += stride32, n);
+        cam.encodings = column<uint32_t>(offset += stride32, n);
+        for (size_t i = 0u; i < n; ++i)
+        {
+          CHECK_LE(cam.num_bytes[i], size_) << "Corrupt image index.";
+          CHECK_LE(cam.offsets[i], size_ - cam.num_bytes[i]) << "Corrupt image index.";
+        }
+        cameras_.push_back(cam);
+        break;
+      }
+      default:
+        LOG(WARNING) << "Skipping unknown section type "
+                     << static_cast<uint32_t>(section.type);
+        break;
+    }
+  }
+  VLOG(1) << "Mapped binary dataset " << filename << " with " << imus_.size()
+          << " IMUs and " << cameras_.size() << " cameras.";
+}
+
+template<typename T>
+const T* BinaryDataset::column(uint64_t offset, size_t size) const
+{
+  CHECK_EQ(offset % alignof(T), 0u) << "Misaligned column.";
+  CHECK_LE(offset, size_) << "Column exceeds the file.";
+  CHECK_LE(size, (size_ - offset) / sizeof(T)) << "Column exceeds the file.";
+  return reinterpret_cast<const T*>(data_.get() + offset);
+}
+
+std::shared_ptr<ImageBase> BinaryDataset::image(
+    const CameraColumns& camera, size_t i) const
+{
+  CHECK_LT(i, camera.size);
+  const uint8_t* data = data_.get() + camera.offsets[i];
+  switch (static_cast<BinaryImageEncoding>(camera.encodings[i]))
+  {
+    case BinaryImageEncoding::Raw8uC1:
+    {
+      CHECK_LE(static_cast<uint64_t>(camera.pitches[i]) * camera.heights[i],
+               camera.num_bytes[i]);
+      return std::make_shared<ImageRaw8uC1>(
+            reinterpret_cast<Pixel8uC1*>(const_cast<uint8_t*>(data)),
+            camera.widths[i], camera.heights[i], camera.pitches[i],
+            std::static_pointer_cast<void const>(data_), PixelOrder::gray);
+    }
+    case BinaryImageEncoding::Compressed:
+    {
+      ImageCv8uC1::Ptr img;
+      cvBridgeDecode<Pixel8uC1>(img, data, camera.num_bytes[i], PixelOrder::gray);
+      return img;
+    }
+    default:
+      LOG(FATAL) << "Unknown image encoding " << camera.encodings[i];
+      break;
+  }
+  return nullptr;
+}
+
+size_t BinaryDataset::lowerBound(const int64_t* stamps, size_t size, int64_t stamp)
+{
+  return std::lower_bound(stamps, stamps + size, stamp) - stamps;
+}
+
+// -----------------------------------------------------------------------------
+BinaryDatasetWriter::BinaryDatasetWriter(const std::string& filename)
+{
+  fs_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  CHECK(fs_.is_open()) << "Could not open file " << filename;
+  // The header is written when finished.
+  const BinaryDatasetHeader header {};
+  fs_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+BinaryDatasetWriter::~BinaryDatasetWriter()
+{
+  if (!finished_)
+  {
+    // No CHECKs here, finish() must be called explicitly.
+    fs_.flush();
+    LOG(WARNING) << "Binary dataset writer destroyed without calling finish(), "
+                 << "the dataset is incomplete.";
+  }
+}
+
+void BinaryDatasetWriter::addImu(
+    uint32_t imu_index, int64_t stamp, const Vector3& acc, const Vector3& gyr)
+{
+  CHECK(!finished_);
+  ImuData& imu = imus_[imu_index];
+  CHECK(imu.stamps.empty() || imu.stamps.back() <= stamp)
+      << "IMU samples are not sorted.";
+  imu.stamps.push_back(stamp);
+  for (int i = 0; i < 3; ++i)
+  {
+    imu.columns[i].push_back(acc(i));
+    imu.columns[3 + i].push_back(gyr(i));
+  }
+}
+
+void BinaryDatasetWriter::addImage(
+    uint32_t camera_index, int64_t stamp, BinaryImageEncoding encoding,
+    uint32_t width, uint32_t height, uint32_t pitch,
+    const uint8_t* data, size_t num_bytes)
+{
+  CHECK(!finished_);
+  CameraData& cam = cameras_[camera_index];
+  CHECK(cam.stamps.empty() || cam.stamps.back() <= stamp)
+      << "Images are not sorted.";
+  const uint64_t offset = align();
+  fs_.write(reinterpret_cast<const char*>(data), num_bytes);
+  cam.stamps.push_back(stamp);
+  cam.offsets.push_back(offset);
+  cam.num_bytes.push_back(num_bytes);
+  cam.widths.push_back(width);
+  cam.heights.push_back(height);
+  cam.pitches.push_back(pitch);
+  cam.encodings.push_back(static_cast<uint32_t>(encoding));
+}
+
+uint64_t BinaryDatasetWriter::align()
+{
+  const uint64_t offset = static_cast<uint64_t>(fs_.tellp());
+  const uint64_t aligned = alignOffset(offset, c_binary_dataset_alignment);
+  const char zeros[c_binary_dataset_alignment] = {};
+  fs_.write(zeros, aligned - offset);
+  return aligned;
+}
+
+template<typename T>
+void BinaryDatasetWriter::writeColumn(const std::vector<T>& column)
+{
+  fs_.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+  // Every column starts 8-byte aligned.
+  const uint64_t offset = static_cast<uint64_t>(fs_.tellp());
+  const char zeros[sizeof(int64_t)] = {};
+  fs_.write(zeros, alignOffset(offset, sizeof(int64_t)) - offset);
+}
+
+void BinaryDatasetWriter::finish()
+{
+  CHECK(!finished_);
+  std::vector<BinaryDatasetSection> sections;
+  for (const auto& it : imus_)
+  {
+    const ImuData& imu = it.second;
+    sections.push_back({BinaryDatasetSectionType::Imu, it.first, align(),
+                        imu.stamps.size()});
+    writeColumn(imu.stamps);
+    for (int i = 0; i < 6; ++i)
+    {
+      writeColumn(imu.columns[i]);
+    }
+  }
+  for (const auto& it : cameras_)
+  {
+    const CameraData& cam = it.second;
+    sections.push_back({BinaryDatasetSectionType::Camera, it.first, align(),
+                        cam.stamps.size()});
+    writeColumn(cam.stamps);
+    writeColumn(cam.offsets);
+    writeColumn(cam.num_bytes);
+    writeColumn(cam.widths);
+    writeColumn(cam.heights);
+    writeColumn(cam.pitches);
+    writeColumn(cam.encodings);
+  }
+
+  BinaryDatasetHeader header;
+  std::copy(std::begin(c_magic), std::end(c_magic), header.magic);
+  header.version = c_binary_dataset_version;
+  header.num_sections = sections.size();
+  header.section_table_offset = align();
+  fs_.write(reinterpret_cast<const char*>(sections.data()),
+            sections.size() * sizeof(BinaryDatasetSection));
+  fs_.seekp(0);
+  fs_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  CHECK(fs_.good()) << "Writing the binary dataset failed.";
+  fs_.close();
+  finished_ = true;
+}
+
+// -----------------------------------------------------------------------------
+void convertCsvDatasetToBinary(
+    const std::string& csv_directory,
+    const std::map<std::string, size_t>& imu_topics,
+    const std::map<std::string, size_t>& camera_topics,
+    const std::string& filename,
+    BinaryImageEncoding encoding)
+{
+  BinaryDatasetWriter writer(filename);
+
+  for (const auto& it : imu_topics)
+  {
+    const std::string kHeader = "#timestamp [ns],w_RS_S_x [rad s^-1],w_RS_S_y [rad s^-1],w_RS_S_z [rad s^-1],a_RS_S_x [m s^-2],a_RS_S_y [m s^-2],a_RS_S_z [m s^-2]";
+    std::ifstream fs;
+    openFileStreamAndCheckHeader(joinPath(csv_directory, it.first, "data.csv"), kHeader, &fs);
+    std::string line;
+    while (std::getline(fs, line))
+    {
+      std::vector<std::string> items = splitString(line, ',');
+      CHECK_EQ(items.size(), 7u);
+      Vector3 acc, gyr;
+      acc << std::stod(items[4]), std::stod(items[5]), std::stod(items[6]);
+      gyr << std::stod(items[1]), std::stod(items[2]), std::stod(items[3]);
+      writer.addImu(it.second, std::stoll(items[0]), acc, gyr);
+    }
+  }
+
+  for (const auto& it : camera_topics)
+  {
+    const std::string data_dir = joinPath(csv_directory, it.first);
+    const std::string kHeader = "#timestamp [ns],filename";
+    std::ifstream fs;
+    openFileStreamAndCheckHeader(joinPath(data_dir, "data.csv"), kHeader, &fs);
+    std::string line;
+    size_t n = 0u;
+    while (std::getline(fs, line))
+    {
+      std::vector<std::string> items = splitString(line, ',');
+      CHECK_EQ(items.size(), 2u);
+      const int64_t stamp = std::stoll(items[0]);
+      const std::string image_filename = joinPath(data_dir, "data", items[1]);
+      if (encoding == BinaryImageEncoding::Raw8uC1)
+      {
+        ImageCv8uC1::Ptr img;
+        cvBridgeLoad<Pixel8uC1>(img, image_filename, PixelOrder::gray);
+        // Rows are stored contiguously with an aligned pitch.
+        const uint32_t pitch = alignOffset(img->width(), 32u);
+        std::vector<uint8_t> pixels(static_cast<size_t>(pitch) * img->height(), 0u);
+        for (uint32_t y = 0u; y < img->height(); ++y)
+        {
+          std::memcpy(&pixels[y * pitch], img->data(0, y), img->width());
+        }
+        writer.addImage(it.second, stamp, encoding, img->width(), img->height(),
+                        pitch, pixels.data(), pixels.size());
+      }
+      else
+      {
+        // Keep the (compressed) file content.
+        std::ifstream image_fs(image_filename, std::ios::binary);
+        CHECK(image_fs.is_open()) << "Could not open file " << image_filename;
+        const std::vector<uint8_t> content(
+              (std::istreambuf_iterator<char>(image_fs)),
+              std::istreambuf_iterator<char>());
+        writer.addImage(it.second, stamp, encoding, 0u, 0u, 0u,
+                        content.data(), content.size());
+      }
+      ++n;
+    }
+    VLOG(1) << "Converted " << n << " images of " << it.first << ".";
+  }
+
+  writer.finish();
+}
+
+} // namespace ze
@@ -0,0 +1,77 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <ze/common/string_utils.hpp>
+#include <ze/common/timer.hpp>
+#include <ze/data_provider/binary_dataset.hpp>
+
+DEFINE_string(data_dir, "", "Directory of the csv dataset.");
+DEFINE_string(imus, "imu0", "Comma separated IMU directories, in the order of the IMU indices.");
+DEFINE_string(cameras, "cam0", "Comma separated camera directories, in the order of the camera indices.");
+DEFINE_string(output, "dataset.bin", "Filename of the binary dataset.");
+DEFINE_bool(raw_images, false,
+            "Store decoded pixels, which are played back without copy. "
+            "Otherwise the image files are stored as they are, e.g. as png.");
+
+int main(int argc, char** argv)
+{
+  google::InitGoogleLogging(argv[0]);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InstallFailureSignalHandler();
+
+  std::map<std::string, size_t> imu_topics, camera_topics;
+  if (!FLAGS_imus.empty())
+  {
+    for (const std::string& dir : ze::splitString(FLAGS_imus, ','))
+    {
+      const size_t index = imu_topics.size();
+      imu_topics[dir] = index;
+    }
+  }
+  if (!FLAGS_cameras.empty())
+  {
+    for (const std::string& dir : ze::splitString(FLAGS_cameras, ','))
+    {
+      const size_t index = camera_topics.size();
+      camera_topics[dir] = index;
+    }
+  }
+
+  ze::Timer timer;
+  ze::convertCsvDatasetToBinary(
+        FLAGS_data_dir, imu_topics, camera_topics, FLAGS_output,
+        FLAGS_raw_images ? ze::BinaryImageEncoding::Raw8uC1
+                         : ze::BinaryImageEncoding::Compressed);
+  LOG(INFO) << "Wrote " << FLAGS_output << " in "
+            << timer.stopAndGetSeconds() << " seconds.";
+  return 0;
+}
@@ -25,6 +25,13 @@
 
 #include <ze/data_provider/data_provider_base.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <ze/common/logging.hpp>
+#include <ze/common/time_conversions.hpp>
+
 namespace ze {
 
 DataProviderBase::DataProviderBase(DataProviderType type)
@@ -38,6 +45,7 @@ void DataProviderBase::spin()
   {
     spinOnce();
   }
+  waitForAcknowledgements();
 }
 
 void DataProviderBase::pause()
@@ -52,22 +60,181 @@ void DataProviderBase::shutdown()
 
 void DataProviderBase::registerImuCallback(const ImuCallback& imu_callback)
 {
-  imu_callback_ = imu_callback;
+  // Live data is not replayed, skip the replay gate.
+  if (type_ == DataProviderType::Rostopic)
+  {
+    imu_callback_ = imu_callback;
+    return;
+  }
+  imu_callback_ =
+      [this, imu_callback](int64_t stamp, const Vector3& acc, const Vector3& gyr,
+                           uint32_t imu_idx)
+  {
+    const Timer::TimePoint due_time = beginReplayMessage(stamp, ReplayTimer::imu_latency);
+    imu_callback(stamp, acc, gyr, imu_idx);
+    endReplayMessage(ReplayTimer::imu_latency, due_time);
+  };
 }
 
 void DataProviderBase::registerGyroCallback(const GyroCallback& gyro_callback)
 {
-  gyro_callback_ = gyro_callback;
+  if (type_ == DataProviderType::Rostopic)
+  {
+    gyro_callback_ = gyro_callback;
+    return;
+  }
+  gyro_callback_ =
+      [this, gyro_callback](int64_t stamp, const Vector3& gyr, uint32_t imu_idx)
+  {
+    const Timer::TimePoint due_time = beginReplayMessage(stamp, ReplayTimer::imu_latency);
+    gyro_callback(stamp, gyr, imu_idx);
+    endReplayMessage(ReplayTimer::imu_latency, due_time);
+  };
 }
 
 void DataProviderBase::registerAccelCallback(const AccelCallback& accel_callback)
 {
-  accel_callback_ = accel_callback;
+  if (type_ == DataProviderType::Rostopic)
+  {
+    accel_callback_ = accel_callback;
+    return;
+  }
+  accel_callback_ =
+      [this, accel_callback](int64_t stamp, const Vector3& acc, uint32_t imu_idx)
+  {
+    const Timer::TimePoint due_time = beginReplayMessage(stamp, ReplayTimer::imu_latency);
+    accel_callback(stamp, acc, imu_idx);
+    endReplayMessage(ReplayTimer::imu_latency, due_time);
+  };
 }
 
 void DataProviderBase::registerCameraCallback(const CameraCallback& camera_callback)
 {
-  camera_callback_ = camera_callback;
+  if (type_ == DataProviderType::Rostopic)
+  {
+    camera_callback_ = camera_callback;
+    return;
+  }
+  camera_callback_ =
+      [this, camera_callback](int64_t stamp, const std::shared_ptr<ImageBase>& img,
+                              uint32_t cam_idx)
+  {
+    const Timer::TimePoint due_time = beginReplayMessage(stamp, ReplayTimer::camera_latency);
+    camera_callback(stamp, img, cam_idx);
+    endReplayMessage(ReplayTimer::camera_latency, due_time);
+  };
+}
+
+void DataProviderBase::setReplayOptions(const ReplayOptions& options)
+{
+  CHECK(type_ != DataProviderType::Rostopic)
+      << "Replay options are not available for live data.";
+  CHECK_GT(options.rate, 0.0);
+  CHECK_GT(options.max_unacknowledged, 0u);
+  waitForAcknowledgements();
+  replay_options_ = options;
+  replay_started_ = false;
+}
+
+void DataProviderBase::acknowledge()
+{
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+  CHECK(!unacknowledged_.empty()) << "No message to acknowledge.";
+  const Timer::TimePoint now = Timer::Clock::now();
+  replay_timers_[unacknowledged_.front().second].addTiming(
+        nanosecToMillisecTrunc(
+          std::chrono::duration_cast<Timer::ns>(now - unacknowledged_.front().first).count()));
+  unacknowledged_.pop_front();
+  replay_last_time_ = std::max(replay_last_time_, now);
+  ack_condition_.notify_all();
+}
+
+real_t DataProviderBase::replayRealTimeFactor() const
+{
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+  const int64_t wall_ns =
+      std::chrono::duration_cast<Timer::ns>(replay_last_time_ - replay_start_time_).count();
+  if (!replay_started_ || wall_ns <= 0)
+  {
+    return 0.0;
+  }
+  return static_cast<real_t>(replay_last_stamp_ - replay_start_stamp_) / wall_ns;
+}
+
+Timer::TimePoint DataProviderBase::beginReplayMessage(int64_t stamp, ReplayTimer timer)
+{
+  std::unique_lock<std::mutex> lock(replay_mutex_);
+  if (replay_options_.mode == ReplayMode::ConsumerAck)
+  {
+    while (unacknowledged_.size() >= replay_options_.max_unacknowledged && running_)
+    {
+      ack_condition_.wait_for(lock, std::chrono::milliseconds(100));
+    }
+  }
+
+  const Timer::TimePoint now = Timer::Clock::now();
+  if (!replay_started_)
+  {
+    replay_started_ = true;
+    replay_start_stamp_ = stamp;
+    replay_last_stamp_ = stamp;
+    replay_start_time_ = now;
+    replay_last_time_ = now;
+  }
+  // Messages of different sensors are not strictly ordered by timestamp.
+  // Schedule them with the largest timestamp so far.
+  replay_last_stamp_ = std::max(replay_last_stamp_, stamp);
+
+  switch (replay_options_.mode)
+  {
+    case ReplayMode::AsFastAsPossible:
+    {
+      return now;
+    }
+    case ReplayMode::ConsumerAck:
+    {
+      // Register before the callback, which may acknowledge immediately.
+      unacknowledged_.emplace_back(now, timer);
+      return now;
+    }
+    case ReplayMode::RealTime:
+    {
+      const Timer::TimePoint due_time = replay_start_time_
+          + std::chrono::duration_cast<Timer::Clock::duration>(Timer::ns(
+              static_cast<int64_t>((replay_last_stamp_ - replay_start_stamp_)
+                                   / replay_options_.rate)));
+      const real_t lag_ms = (now < due_time) ? 0.0 : nanosecToMillisecTrunc(
+          std::chrono::duration_cast<Timer::ns>(now - due_time).count());
+      replay_timers_[ReplayTimer::lag].addTiming(lag_ms);
+      lock.unlock();
+      std::this_thread::sleep_until(due_time);
+      return due_time;
+    }
+  }
+  return now;
+}
+
+void DataProviderBase::endReplayMessage(
+    ReplayTimer timer, const Timer::TimePoint& due_time)
+{
+  std::lock_guard<std::mutex> lock(replay_mutex_);
+  if (replay_options_.mode == ReplayMode::ConsumerAck)
+  {
+    return;
+  }
+  const Timer::TimePoint now = Timer::Clock::now();
+  replay_timers_[timer].addTiming(nanosecToMillisecTrunc(
+      std::chrono::duration_cast<Timer::ns>(now - due_time).count()));
+  replay_last_time_ = now;
+}
+
+void DataProviderBase::waitForAcknowledgements()
+{
+  std::unique_lock<std::mutex> lock(replay_mutex_);
+  while (!unacknowledged_.empty() && running_)
+  {
+    ack_condition_.wait_for(lock, std::chrono::milliseconds(100));
+  }
 }
 
 } // namespace ze
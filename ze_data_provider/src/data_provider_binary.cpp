@@ -0,0 +1,185 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/data_provider/data_provider_binary.hpp>
+
+#include <limits>
+
+#include <imp/core/image_base.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/time_conversions.hpp>
+
+namespace ze {
+
+DataProviderBinary::DataProviderBinary(
+    const std::string& filename,
+    const std::vector<uint32_t>& imu_indices,
+    const std::vector<uint32_t>& camera_indices)
+  : DataProviderBase(DataProviderType::Binary)
+  , dataset_(filename)
+  , imu_count_(imu_indices.size())
+  , camera_count_(camera_indices.size())
+{
+  // Same order and camera delay as in DataProviderCsv.
+  for (uint32_t imu_index : imu_indices)
+  {
+    bool found = false;
+    for (const BinaryDataset::ImuColumns& imu : dataset_.imus())
+    {
+      if (imu.imu_index == imu_index)
+      {
+        Stream stream;
+        stream.imu = &imu;
+        stream.stamps = imu.stamps;
+        stream.size = imu.size;
+        stream.playback_delay = 0;
+        streams_.push_back(stream);
+        found = true;
+      }
+    }
+    CHECK(found) << "IMU " << imu_index << " not in dataset " << filename;
+  }
+  for (uint32_t camera_index : camera_indices)
+  {
+    bool found = false;
+    for (const BinaryDataset::CameraColumns& camera : dataset_.cameras())
+    {
+      if (camera.camera_index == camera_index)
+      {
+        Stream stream;
+        stream.camera = &camera;
+        stream.stamps = camera.stamps;
+        stream.size = camera.size;
+        stream.playback_delay = millisecToNanosec(100);
+        streams_.push_back(stream);
+        found = true;
+      }
+    }
+    CHECK(found) << "Camera " << camera_index << " not in dataset " << filename;
+  }
+}
+
+bool DataProviderBinary::spinOnce()
+{
+  // Pick the stream with the next message, earlier streams first on equal
+  // playback time.
+  Stream* next = nullptr;
+  int64_t next_time = std::numeric_limits<int64_t>::max();
+  for (Stream& stream : streams_)
+  {
+    if (stream.next < stream.size)
+    {
+      const int64_t time = stream.stamps[stream.next] + stream.playback_delay;
+      if (!next || time < next_time)
+      {
+        next = &stream;
+        next_time = time;
+      }
+    }
+  }
+  if (!next)
+  {
+    return false;
+  }
+
+  const size_t i = next->next++;
+  if (next->imu)
+  {
+    if (imu_callback_)
+    {
+      const BinaryDataset::ImuColumns& imu = *next->imu;
+      const Vector3 acc(imu.acc[0][i], imu.acc[1][i], imu.acc[2][i]);
+      const Vector3 gyr(imu.gyr[0][i], imu.gyr[1][i], imu.gyr[2][i]);
+      imu_callback_(imu.stamps[i], acc, gyr, imu.imu_index);
+    }
+    else
+    {
+      LOG_FIRST_N(WARNING, 1) << "No IMU callback registered but measurements available";
+    }
+  }
+  else
+  {
+    if (camera_callback_)
+    {
+      const BinaryDataset::CameraColumns& camera = *next->camera;
+      camera_callback_(camera.stamps[i], dataset_.image(camera, i),
+                       camera.camera_index);
+    }
+    else
+    {
+      LOG_FIRST_N(WARNING, 1) << "No camera callback registered but measurements available.";
+    }
+  }
+  return true;
+}
+
+bool DataProviderBinary::ok() const
+{
+  if (!running_)
+  {
+    VLOG(1) << "Data Provider was paused/terminated.";
+    return false;
+  }
+  for (const Stream& stream : streams_)
+  {
+    if (stream.next < stream.size)
+    {
+      return true;
+    }
+  }
+  VLOG(1) << "All data processed.";
+  return false;
+}
+
+size_t DataProviderBinary::imuCount() const
+{
+  return imu_count_;
+}
+
+size_t DataProviderBinary::cameraCount() const
+{
+  return camera_count_;
+}
+
+size_t DataProviderBinary::size() const
+{
+  size_t n = 0u;
+  for (const Stream& stream : streams_)
+  {
+    n += stream.size;
+  }
+  return n;
+}
+
+void DataProviderBinary::seek(int64_t stamp_ns)
+{
+  for (Stream& stream : streams_)
+  {
+    stream.next = BinaryDataset::lowerBound(
+          stream.stamps, stream.size, stamp_ns - stream.playback_delay);
+  }
+}
+
+} // namespace ze
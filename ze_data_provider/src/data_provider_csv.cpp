@@ -34,6 +34,7 @@
 #include <ze/common/time_conversions.hpp>
 #include <ze/common/string_utils.hpp>
 #include <ze/common/file_utils.hpp>
+#include <ze/common/thread_pool.hpp>
 
 namespace ze {
 namespace internal {
@@ -160,9 +161,135 @@ DataProviderCsv::DataProviderCsv(
   }
 
   buffer_it_ = buffer_.cbegin();
+  prefetch_it_ = buffer_it_;
   VLOG(1) << "done.";
 }
 
+DataProviderCsv::~DataProviderCsv()
+{
+  // The pool runs the remaining decode tasks before joining its threads.
+  prefetch_pool_.reset();
+}
+
+void DataProviderCsv::setImagePrefetch(
+    size_t num_threads,
+    size_t max_queued_images,
+    size_t max_queued_bytes)
+{
+  // Finish the running decode tasks.
+  prefetch_pool_.reset();
+  prefetch_queue_.clear();
+  prefetch_it_ = buffer_it_;
+
+  if (num_threads == 0u)
+  {
+    max_queued_images_ = 0u;
+    return;
+  }
+  CHECK_GT(max_queued_images, 0u);
+  max_queued_images_ = max_queued_images;
+  max_queued_bytes_ = max_queued_bytes;
+  prefetch_pool_.reset(new ThreadPool(num_threads));
+  VLOG(1) << "Prefetching up to " << max_queued_images_ << " images with "
+          << num_threads << " threads.";
+}
+
+real_t DataProviderCsv::imagesPerSecond() const
+{
+  if (num_images_ < 2u || throughput_seconds_ <= 0.0)
+  {
+    return 0.0;
+  }
+  return (num_images_ - 1u) / throughput_seconds_;
+}
+
+void DataProviderCsv::schedulePrefetch()
+{
+  if (!prefetch_pool_ || !camera_callback_)
+  {
+    return;
+  }
+
+  while (prefetch_queue_.size() < max_queued_images_)
+  {
+    // Keep the estimated memory of the queue below the limit, but always
+    // decode at least the next image.
+    const size_t image_bytes = max_image_bytes_.load(std::memory_order_relaxed);
+    if (!prefetch_queue_.empty()
+        && (prefetch_queue_.size() + 1u) * image_bytes > max_queued_bytes_)
+    {
+      return;
+    }
+
+    // Find the next camera measurement.
+    while (prefetch_it_ != buffer_.cend()
+           && prefetch_it_->second->type != internal::MeasurementType::Camera)
+    {
+      ++prefetch_it_;
+    }
+    if (prefetch_it_ == buffer_.cend())
+    {
+      return;
+    }
+
+    const internal::CameraMeasurement* measurement =
+        static_cast<const internal::CameraMeasurement*>(prefetch_it_->second.get());
+    ++prefetch_it_;
+
+    std::future<ImageBase::Ptr> image = prefetch_pool_->enqueue(
+          [this, measurement]() -> ImageBase::Ptr
+    {
+      Timer timer;
+      ImageBase::Ptr img = measurement->loadImage();
+      const real_t decode_ms = timer.stopAndGetMilliseconds();
+
+      size_t image_bytes = max_image_bytes_.load(std::memory_order_relaxed);
+      while (img->bytes() > image_bytes
+             && !max_image_bytes_.compare_exchange_weak(image_bytes, img->bytes()))
+      {}
+
+      std::lock_guard<std::mutex> lock(prefetch_statistics_mutex_);
+      prefetch_statistics_[PrefetchStatistics::decode].addSample(decode_ms);
+      return img;
+    });
+    prefetch_queue_.push_back(PrefetchedImage{measurement, std::move(image)});
+  }
+}
+
+ImageBase::Ptr DataProviderCsv::loadImage(
+    const internal::CameraMeasurement& measurement)
+{
+  schedulePrefetch();
+  if (prefetch_queue_.empty() || prefetch_queue_.front().measurement != &measurement)
+  {
+    return measurement.loadImage();
+  }
+
+  size_t num_ready = 0u;
+  for (const PrefetchedImage& queued : prefetch_queue_)
+  {
+    if (queued.image.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      ++num_ready;
+    }
+  }
+
+  std::future<ImageBase::Ptr> image = std::move(prefetch_queue_.front().image);
+  prefetch_queue_.pop_front();
+  Timer timer;
+  ImageBase::Ptr img = image.get();
+  const real_t wait_ms = timer.stopAndGetMilliseconds();
+  {
+    std::lock_guard<std::mutex> lock(prefetch_statistics_mutex_);
+    prefetch_statistics_[PrefetchStatistics::wait].addSample(wait_ms);
+    prefetch_statistics_[PrefetchStatistics::queued_images].addSample(num_ready);
+  }
+
+  // Refill the slot that was just freed.
+  schedulePrefetch();
+  return img;
+}
+
 bool DataProviderCsv::spinOnce()
 {
   if (buffer_it_ != buffer_.cend())
@@ -176,9 +303,14 @@ bool DataProviderCsv::spinOnce()
       {
         internal::CameraMeasurement::ConstPtr cam_data =
             std::dynamic_pointer_cast<const internal::CameraMeasurement>(data);
-        camera_callback_(cam_data->stamp_ns,
-                         cam_data->loadImage(),
-                         cam_data->camera_index);
+        ImageBase::Ptr img = loadImage(*cam_data);
+        if (num_images_ == 0u)
+        {
+          throughput_timer_.start();
+        }
+        ++num_images_;
+        throughput_seconds_ = throughput_timer_.stopAndGetSeconds();
+        camera_callback_(cam_data->stamp_ns, img, cam_data->camera_index);
       }
       else
       {
@@ -209,6 +341,11 @@ bool DataProviderCsv::spinOnce()
       break;
     }
     }
+    // Measurements are never prefetched behind the current position.
+    if (prefetch_it_ == buffer_it_)
+    {
+      ++prefetch_it_;
+    }
     ++buffer_it_;
     return true;
   }
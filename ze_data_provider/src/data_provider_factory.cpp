@@ -26,6 +26,7 @@
 #include <ze/common/logging.hpp>
 #include <ze/data_provider/data_provider_factory.hpp>
 #include <ze/data_provider/data_provider_base.hpp>
+#include <ze/data_provider/data_provider_binary.hpp>
 #include <ze/data_provider/data_provider_csv.hpp>
 #include <ze/data_provider/data_provider_rosbag.hpp>
 #include <ze/data_provider/data_provider_rostopic.hpp>
@@ -52,11 +53,20 @@ DEFINE_string(topic_gyr1, "/gyr1", "");
 DEFINE_string(topic_gyr2, "/gyr2", "");
 DEFINE_string(topic_gyr3, "/gyr3", "");
 
-DEFINE_int32(data_source, 1, " 0: CSV, 1: Rosbag, 2: Rostopic");
+DEFINE_int32(data_source, 1, " 0: CSV, 1: Rosbag, 2: Rostopic, 3: Binary");
 DEFINE_string(data_dir, "", "Directory for csv dataset.");
+DEFINE_string(binary_dataset_filename, "dataset.bin", "Binary dataset, see csv_to_binary_dataset.");
 DEFINE_uint64(num_imus, 1, "Number of IMUs used in the pipeline.");
 DEFINE_uint64(num_accels, 0, "Number of Accelerometers used in the pipeline.");
 DEFINE_uint64(num_gyros, 0, "Number of Gyroscopes used in the pipeline.");
+DEFINE_int32(replay_mode, 0,
+             "Replay of recorded data. 0: As fast as possible, 1: Real-time x replay_rate, 2: Wait for consumer acknowledgement");
+DEFINE_double(replay_rate, 1.0, "Replay rate in real-time mode.");
+DEFINE_uint64(replay_max_unacknowledged, 1, "Number of unacknowledged messages in consumer acknowledgement mode.");
+DEFINE_uint64(csv_prefetch_threads, 0,
+              "Number of threads that decode csv dataset images ahead. 0: decode in callback thread.");
+DEFINE_uint64(csv_prefetch_images, 8, "Maximum number of csv dataset images decoded ahead.");
+DEFINE_uint64(csv_prefetch_megabytes, 256, "Maximum memory of csv dataset images decoded ahead.");
 
 namespace ze {
 
@@ -100,8 +110,12 @@ DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
   {
     case 0: // CSV
     {
-      data_provider.reset(
+      std::shared_ptr<DataProviderCsv> dp_csv(
             new DataProviderCsv(FLAGS_data_dir, imu_topics, cam_topics));
+      dp_csv->setImagePrefetch(FLAGS_csv_prefetch_threads,
+                               FLAGS_csv_prefetch_images,
+                               FLAGS_csv_prefetch_megabytes * 1024u * 1024u);
+      data_provider = dp_csv;
       break;
     }
     case 1: // Rosbag
@@ -139,6 +153,21 @@ DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
 
       break;
     }
+    case 3: // Binary
+    {
+      std::vector<uint32_t> imu_indices, cam_indices;
+      for (uint32_t i = 0u; i < FLAGS_num_imus; ++i)
+      {
+        imu_indices.push_back(i);
+      }
+      for (uint32_t i = 0u; i < num_cams; ++i)
+      {
+        cam_indices.push_back(i);
+      }
+      data_provider.reset(new DataProviderBinary(FLAGS_binary_dataset_filename,
+                                                 imu_indices, cam_indices));
+      break;
+    }
     default:
     {
       LOG(FATAL) << "Data source not known.";
@@ -146,6 +175,17 @@ DataProviderBase::Ptr loadDataProviderFromGflags(const uint32_t num_cams)
     }
   }
 
+  if (FLAGS_data_source != 2)
+  {
+    CHECK_GE(FLAGS_replay_mode, 0);
+    CHECK_LE(FLAGS_replay_mode, 2);
+    ReplayOptions replay_options;
+    replay_options.mode = static_cast<ReplayMode>(FLAGS_replay_mode);
+    replay_options.rate = FLAGS_replay_rate;
+    replay_options.max_unacknowledged = FLAGS_replay_max_unacknowledged;
+    data_provider->setReplayOptions(replay_options);
+  }
+
   return data_provider;
 }
 
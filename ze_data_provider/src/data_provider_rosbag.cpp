@@ -332,7 +332,7 @@ bool DataProviderRosbag::cameraSpin(sensor_msgs::ImageConstPtr m_img,
       return false;
     }
 
-    ze::ImageBase::Ptr img = toImageCpu(*m_img);
+    ze::ImageBase::Ptr img = toImageCpu(m_img);
     camera_callback_(m_img->header.stamp.toNSec(), img, it->second);
   }
   else
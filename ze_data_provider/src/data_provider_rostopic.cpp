@@ -159,7 +159,7 @@ void DataProviderRostopic::imgCallback(
     return;
   }
 
-  ze::ImageBase::Ptr img = toImageCpu(*m_img);
+  ze::ImageBase::Ptr img = toImageCpu(m_img);
   camera_callback_(m_img->header.stamp.toNSec(), img, cam_idx);
 }
 
@@ -0,0 +1,341 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <imp/core/image.hpp>
+#include <ze/common/path_utils.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/test_utils.hpp>
+#include <ze/common/time_conversions.hpp>
+#include <ze/data_provider/binary_dataset.hpp>
+#include <ze/data_provider/data_provider_binary.hpp>
+#include <ze/data_provider/data_provider_csv.hpp>
+
+namespace {
+
+struct Message
+{
+  int64_t stamp;
+  uint32_t sensor_index;
+  bool is_image;
+  ze::Vector3 acc;
+  ze::Vector3 gyr;
+  ze::ImageBase::Ptr image;
+};
+
+void recordMessages(ze::DataProviderBase& dp, std::vector<Message>* messages)
+{
+  using namespace ze;
+  dp.registerImuCallback(
+        [=](int64_t stamp, const Vector3& acc, const Vector3& gyr, const uint32_t imu_idx)
+  {
+    messages->push_back(Message{stamp, imu_idx, false, acc, gyr, nullptr});
+  });
+  dp.registerCameraCallback(
+        [=](int64_t stamp, const ImageBase::Ptr& img, uint32_t cam_idx)
+  {
+    messages->push_back(Message{stamp, cam_idx, true, Vector3::Zero(),
+                                Vector3::Zero(), img});
+  });
+}
+
+int64_t playbackTime(const Message& message)
+{
+  // Images are played back with a delay of 100ms.
+  return message.stamp + (message.is_image ? ze::millisecToNanosec(100) : 0);
+}
+
+void expectEqualImages(const ze::ImageBase& a, const ze::ImageBase& b)
+{
+  const ze::Image8uC1& img_a = dynamic_cast<const ze::Image8uC1&>(a);
+  const ze::Image8uC1& img_b = dynamic_cast<const ze::Image8uC1&>(b);
+  ASSERT_EQ(img_a.width(), img_b.width());
+  ASSERT_EQ(img_a.height(), img_b.height());
+  for (uint32_t y = 0u; y < img_a.height(); ++y)
+  {
+    for (uint32_t x = 0u; x < img_a.width(); ++x)
+    {
+      ASSERT_EQ(img_a(x, y), img_b(x, y));
+    }
+  }
+}
+
+void expectEqualMessages(const Message& a, const Message& b)
+{
+  EXPECT_EQ(a.stamp, b.stamp);
+  EXPECT_EQ(a.sensor_index, b.sensor_index);
+  ASSERT_EQ(a.is_image, b.is_image);
+  if (a.is_image)
+  {
+    expectEqualImages(*a.image, *b.image);
+  }
+  else
+  {
+    EXPECT_TRUE(EIGEN_MATRIX_EQUAL_DOUBLE(a.acc, b.acc));
+    EXPECT_TRUE(EIGEN_MATRIX_EQUAL_DOUBLE(a.gyr, b.gyr));
+  }
+}
+
+void writeDataset(const std::string& filename)
+{
+  using namespace ze;
+  std::vector<uint8_t> pixels(32u * 4u, 0u);
+  BinaryDatasetWriter writer(filename);
+  for (int64_t i = 0; i < 10; ++i)
+  {
+    writer.addImu(0u, i * 10, Vector3(i, 0.0, 0.0), Vector3(0.0, i, 0.0));
+  }
+  writer.addImage(0u, 0, BinaryImageEncoding::Raw8uC1, 21u, 4u, 32u,
+                  pixels.data(), pixels.size());
+  writer.finish();
+}
+
+template<typename T>
+T readValue(const std::string& filename, uint64_t offset)
+{
+  std::ifstream fs(filename, std::ios::binary);
+  T value;
+  fs.seekg(offset);
+  fs.read(reinterpret_cast<char*>(&value), sizeof(T));
+  CHECK(fs.good());
+  return value;
+}
+
+template<typename T>
+void writeValue(const std::string& filename, uint64_t offset, const T& value)
+{
+  std::fstream fs(filename, std::ios::in | std::ios::out | std::ios::binary);
+  fs.seekp(offset);
+  fs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  CHECK(fs.good());
+}
+
+//! Offset of the section table entry of the given type.
+uint64_t sectionOffset(const std::string& filename, ze::BinaryDatasetSectionType type)
+{
+  using namespace ze;
+  const BinaryDatasetHeader header = readValue<BinaryDatasetHeader>(filename, 0u);
+  for (uint32_t s = 0u; s < header.num_sections; ++s)
+  {
+    const uint64_t offset =
+        header.section_table_offset + s * sizeof(BinaryDatasetSection);
+    if (readValue<BinaryDatasetSection>(filename, offset).type == type)
+    {
+      return offset;
+    }
+  }
+  LOG(FATAL) << "Section not found.";
+  return 0u;
+}
+
+} // anonymous namespace
+
+TEST(BinaryDatasetTests, testWriteRead)
+{
+  using namespace ze;
+
+  const std::string filename = "/tmp/test_binary_dataset.bin";
+  const uint32_t width = 21u, height = 5u, pitch = 32u;
+  std::vector<uint8_t> pixels(pitch * height);
+  {
+    BinaryDatasetWriter writer(filename);
+    for (int64_t i = 0; i < 101; ++i)
+    {
+      writer.addImu(1u, i * 10, Vector3(i, 2 * i, 3 * i), Vector3(-i, -2 * i, -3 * i));
+    }
+    for (int64_t i = 0; i < 3; ++i)
+    {
+      for (size_t k = 0u; k < pixels.size(); ++k)
+      {
+        pixels[k] = static_cast<uint8_t>(i + k);
+      }
+      writer.addImage(2u, i * 100, BinaryImageEncoding::Raw8uC1,
+                      width, height, pitch, pixels.data(), pixels.size());
+    }
+    writer.finish();
+  }
+
+  BinaryDataset dataset(filename);
+  ASSERT_EQ(dataset.imus().size(), 1u);
+  ASSERT_EQ(dataset.cameras().size(), 1u);
+
+  const BinaryDataset::ImuColumns& imu = dataset.imus()[0];
+  EXPECT_EQ(imu.imu_index, 1u);
+  ASSERT_EQ(imu.size, 101u);
+  for (size_t i = 0u; i < imu.size; ++i)
+  {
+    EXPECT_EQ(imu.stamps[i], static_cast<int64_t>(i * 10));
+    for (int d = 0; d < 3; ++d)
+    {
+      EXPECT_EQ(imu.acc[d][i], (d + 1.0) * i);
+      EXPECT_EQ(imu.gyr[d][i], -(d + 1.0) * i);
+    }
+  }
+  EXPECT_EQ(BinaryDataset::lowerBound(imu.stamps, imu.size, -5), 0u);
+  EXPECT_EQ(BinaryDataset::lowerBound(imu.stamps, imu.size, 500), 50u);
+  EXPECT_EQ(BinaryDataset::lowerBound(imu.stamps, imu.size, 501), 51u);
+  EXPECT_EQ(BinaryDataset::lowerBound(imu.stamps, imu.size, 5000), 101u);
+
+  const BinaryDataset::CameraColumns& cam = dataset.cameras()[0];
+  EXPECT_EQ(cam.camera_index, 2u);
+  ASSERT_EQ(cam.size, 3u);
+  for (size_t i = 0u; i < cam.size; ++i)
+  {
+    EXPECT_EQ(cam.offsets[i] % c_binary_dataset_alignment, 0u);
+    ImageBase::Ptr img = dataset.image(cam, i);
+    const Image8uC1& img8u = dynamic_cast<const Image8uC1&>(*img);
+    ASSERT_EQ(img8u.width(), width);
+    ASSERT_EQ(img8u.height(), height);
+    for (uint32_t y = 0u; y < height; ++y)
+    {
+      for (uint32_t x = 0u; x < width; ++x)
+      {
+        EXPECT_EQ(img8u(x, y), static_cast<uint8_t>(i + y * pitch + x));
+      }
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(BinaryDatasetTests, testCorruptFileDeath)
+{
+  using namespace ze;
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  const std::string filename = "/tmp/test_binary_dataset_corrupt.bin";
+  constexpr uint64_t c_max = std::numeric_limits<uint64_t>::max();
+
+  // Unmodified file.
+  writeDataset(filename);
+  {
+    BinaryDataset dataset(filename);
+    EXPECT_EQ(dataset.imus().size(), 1u);
+    EXPECT_EQ(dataset.cameras().size(), 1u);
+  }
+
+  // Section table beyond the end of the file.
+  const BinaryDatasetHeader header = readValue<BinaryDatasetHeader>(filename, 0u);
+  writeValue<uint64_t>(filename, offsetof(BinaryDatasetHeader, section_table_offset),
+                       c_max - 7u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Column exceeds the file");
+
+  // Truncated section table.
+  writeDataset(filename);
+  writeValue<uint32_t>(filename, offsetof(BinaryDatasetHeader, num_sections),
+                       header.num_sections + 1u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Column exceeds the file");
+
+  // Sample count whose column size wraps around.
+  writeDataset(filename);
+  const uint64_t imu_section = sectionOffset(filename, BinaryDatasetSectionType::Imu);
+  writeValue<uint64_t>(filename, imu_section + offsetof(BinaryDatasetSection, count),
+                       (c_max / sizeof(int64_t)) + 2u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Corrupt section table");
+
+  // Section offset that wraps around when adding the column strides.
+  writeDataset(filename);
+  writeValue<uint64_t>(filename, imu_section + offsetof(BinaryDatasetSection, offset),
+                       c_max - 7u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Corrupt section table");
+
+  // Image offset that wraps around when adding the image size.
+  writeDataset(filename);
+  const uint64_t cam_section = sectionOffset(filename, BinaryDatasetSectionType::Camera);
+  const BinaryDatasetSection cam = readValue<BinaryDatasetSection>(filename, cam_section);
+  // The offsets column follows the stamps column of the single image.
+  writeValue<uint64_t>(filename, cam.offset + sizeof(int64_t), c_max - 7u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Corrupt image index");
+
+  // Image size beyond the end of the file.
+  writeDataset(filename);
+  writeValue<uint64_t>(filename, cam.offset + 2u * sizeof(int64_t), c_max - 7u);
+  EXPECT_DEATH(BinaryDataset{filename}, "Corrupt image index");
+
+  std::remove(filename.c_str());
+}
+
+TEST(BinaryDatasetTests, testCsvConversion)
+{
+  using namespace ze;
+
+  std::string data_dir = joinPath(getTestDataDir("csv_dataset"), "data");
+
+  std::vector<Message> messages_csv;
+  {
+    DataProviderCsv dp(data_dir, {{"imu0", 0}}, {{"cam0", 0}});
+    recordMessages(dp, &messages_csv);
+    dp.spin();
+  }
+  ASSERT_EQ(messages_csv.size(), 74u);
+
+  const std::string filename = "/tmp/test_binary_dataset_csv.bin";
+  for (BinaryImageEncoding encoding : {BinaryImageEncoding::Raw8uC1,
+                                       BinaryImageEncoding::Compressed})
+  {
+    convertCsvDatasetToBinary(data_dir, {{"imu0", 0}}, {{"cam0", 0}},
+                              filename, encoding);
+
+    DataProviderBinary dp(filename, {0u}, {0u});
+    EXPECT_EQ(dp.size(), messages_csv.size());
+    EXPECT_EQ(dp.imuCount(), 1u);
+    EXPECT_EQ(dp.cameraCount(), 1u);
+    std::vector<Message> messages;
+    recordMessages(dp, &messages);
+    dp.spin();
+
+    // Same messages in the same order.
+    ASSERT_EQ(messages.size(), messages_csv.size());
+    for (size_t i = 0u; i < messages.size(); ++i)
+    {
+      expectEqualMessages(messages[i], messages_csv[i]);
+    }
+
+    // Seek to the middle of the dataset: the playback continues with the
+    // first message played back at that time, messages at the same time
+    // before it included.
+    size_t start = messages_csv.size() / 2u;
+    const int64_t playback_time = playbackTime(messages_csv[start]);
+    while (start > 0u && playbackTime(messages_csv[start - 1u]) == playback_time)
+    {
+      --start;
+    }
+    messages.clear();
+    dp.seek(playback_time);
+    dp.spin();
+    ASSERT_EQ(messages.size(), messages_csv.size() - start);
+    for (size_t i = 0u; i < messages.size(); ++i)
+    {
+      expectEqualMessages(messages[i], messages_csv[start + i]);
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+ZE_UNITTEST_ENTRYPOINT
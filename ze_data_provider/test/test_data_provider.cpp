@@ -23,14 +23,23 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-#include <string>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/test_utils.hpp>
 #include <ze/common/path_utils.hpp>
+#include <ze/common/time_conversions.hpp>
+#include <ze/common/timer.hpp>
 #include <ze/data_provider/data_provider_csv.hpp>
 #include <ze/data_provider/data_provider_rosbag.hpp>
+#include <imp/core/image.hpp>
 #include <imp/core/image_base.hpp>
 
 TEST(DataProviderTests, testCsv)
@@ -74,6 +83,164 @@ TEST(DataProviderTests, testCsv)
   EXPECT_EQ(num_imu_measurements, 69u);
 }
 
+TEST(DataProviderTests, testCsvPrefetch)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("csv_dataset");
+  EXPECT_FALSE(data_dir.empty());
+
+  // Records the order of all callbacks and the decoded images.
+  auto replay = [&](size_t num_threads, size_t max_images, size_t max_bytes,
+                    std::vector<int64_t>* stamps,
+                    std::vector<ImageBase::Ptr>* images)
+  {
+    DataProviderCsv dp(joinPath(data_dir, "data"), {{"imu0", 0}}, {{"cam0", 0}});
+    dp.setImagePrefetch(num_threads, max_images, max_bytes);
+    dp.registerImuCallback(
+          [&](int64_t stamp, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+    {
+      stamps->push_back(stamp);
+    });
+    dp.registerCameraCallback(
+          [&](int64_t stamp, const ImageBase::Ptr& img, uint32_t /*cam_idx*/)
+    {
+      stamps->push_back(stamp);
+      images->push_back(img);
+    });
+    dp.spin();
+    if (num_threads > 0u)
+    {
+      EXPECT_EQ(dp.prefetch_statistics_[DataProviderCsv::PrefetchStatistics::decode].numSamples(),
+                images->size());
+      EXPECT_LE(dp.prefetch_statistics_[DataProviderCsv::PrefetchStatistics::queued_images].max(),
+                max_images);
+    }
+  };
+
+  std::vector<int64_t> stamps_ref;
+  std::vector<ImageBase::Ptr> images_ref;
+  replay(0u, 0u, 0u, &stamps_ref, &images_ref);
+  ASSERT_EQ(images_ref.size(), 5u);
+
+  // Unlimited memory and a memory limit that only allows one queued image.
+  for (size_t max_bytes : {size_t{1u} << 30, size_t{1u}})
+  {
+    std::vector<int64_t> stamps;
+    std::vector<ImageBase::Ptr> images;
+    replay(3u, 4u, max_bytes, &stamps, &images);
+    EXPECT_EQ(stamps, stamps_ref);
+    ASSERT_EQ(images.size(), images_ref.size());
+    for (size_t i = 0u; i < images.size(); ++i)
+    {
+      const Image8uC1& img = dynamic_cast<const Image8uC1&>(*images[i]);
+      const Image8uC1& img_ref = dynamic_cast<const Image8uC1&>(*images_ref[i]);
+      ASSERT_EQ(img.width(), img_ref.width());
+      ASSERT_EQ(img.height(), img_ref.height());
+      for (uint32_t y = 0u; y < img.height(); ++y)
+      {
+        EXPECT_EQ(std::memcmp(img.data(0, y), img_ref.data(0, y), img.width()), 0);
+      }
+    }
+  }
+}
+
+TEST(DataProviderTests, testCsvReplayRealTime)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("csv_dataset");
+  EXPECT_FALSE(data_dir.empty());
+
+  DataProviderCsv dp(joinPath(data_dir, "data"), {{"imu0", 0}}, {{"cam0", 0}});
+  ReplayOptions options;
+  options.mode = ReplayMode::RealTime;
+  options.rate = 4.0;
+  dp.setReplayOptions(options);
+
+  int64_t first_stamp = -1, last_stamp = 0;
+  dp.registerImuCallback(
+        [&](int64_t stamp, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    if (first_stamp < 0)
+    {
+      first_stamp = stamp;
+    }
+    last_stamp = std::max(last_stamp, stamp);
+  });
+  dp.registerCameraCallback(
+        [&](int64_t /*stamp*/, const ImageBase::Ptr& /*img*/, uint32_t /*cam_idx*/)
+  {});
+
+  Timer timer;
+  dp.spin();
+  const real_t wall_s = timer.stopAndGetSeconds();
+  const real_t data_s = nanosecToSecTrunc(last_stamp - first_stamp);
+  EXPECT_GE(wall_s, data_s / options.rate);
+  EXPECT_LE(dp.replayRealTimeFactor(), options.rate * 1.01);
+  EXPECT_EQ(dp.replay_timers_[DataProviderBase::ReplayTimer::imu_latency].numTimings(), 69u);
+  EXPECT_EQ(dp.replay_timers_[DataProviderBase::ReplayTimer::camera_latency].numTimings(), 5u);
+  EXPECT_EQ(dp.replay_timers_[DataProviderBase::ReplayTimer::lag].numTimings(), 74u);
+}
+
+TEST(DataProviderTests, testCsvReplayConsumerAck)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("csv_dataset");
+  EXPECT_FALSE(data_dir.empty());
+
+  DataProviderCsv dp(joinPath(data_dir, "data"), {{"imu0", 0}}, {{"cam0", 0}});
+  ReplayOptions options;
+  options.mode = ReplayMode::ConsumerAck;
+  options.max_unacknowledged = 3u;
+  dp.setReplayOptions(options);
+
+  // The consumer processes the messages in another thread.
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t num_received = 0u, num_processed = 0u, max_pending = 0u;
+  auto receive = [&]()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++num_received;
+    max_pending = std::max(max_pending, num_received - num_processed);
+    condition.notify_one();
+  };
+  dp.registerImuCallback(
+        [&](int64_t /*stamp*/, const Vector3& /*acc*/, const Vector3& /*gyr*/, const uint32_t /*imu_idx*/)
+  {
+    receive();
+  });
+  dp.registerCameraCallback(
+        [&](int64_t /*stamp*/, const ImageBase::Ptr& /*img*/, uint32_t /*cam_idx*/)
+  {
+    receive();
+  });
+
+  std::thread consumer([&]()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (num_processed < 74u)
+    {
+      condition.wait(lock, [&]() { return num_processed < num_received; });
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      lock.lock();
+      ++num_processed;
+      dp.acknowledge();
+    }
+  });
+  dp.spin();
+  consumer.join();
+
+  EXPECT_EQ(num_received, 74u);
+  EXPECT_LE(max_pending, options.max_unacknowledged);
+  EXPECT_EQ(dp.replay_timers_[DataProviderBase::ReplayTimer::imu_latency].numTimings(), 69u);
+  EXPECT_EQ(dp.replay_timers_[DataProviderBase::ReplayTimer::camera_latency].numTimings(), 5u);
+  EXPECT_GT(dp.replayRealTimeFactor(), 0.0);
+}
+
 TEST(DataProviderTests, testRosbag)
 {
   using namespace ze;
@@ -48,6 +48,16 @@ public:
       const real_t measurement_sigma_pos,
       const real_t measurement_sigma_rot);
 
+  //! Aligns only the window of num_poses poses starting at first_pose, which
+  //! avoids copying the window into separate vectors.
+  PoseAligner(
+      const TransformationVector& T_W_A,
+      const TransformationVector& T_W_B,
+      const real_t measurement_sigma_pos,
+      const real_t measurement_sigma_rot,
+      const size_t first_pose,
+      const size_t num_poses);
+
   double evaluateError(
       const Transformation& T_A_B,
       HessianMatrix* H,
@@ -56,6 +66,8 @@ public:
 private:
   const TransformationVector& T_W_A_;
   const TransformationVector& T_W_B_;
+  size_t first_pose_;
+  size_t num_poses_;
   real_t measurement_sigma_pos_;
   real_t measurement_sigma_rot_;
 };
@@ -78,6 +78,7 @@ class Clam : public LeastSquaresSolver<ClamState, Clam>
 public:
   using LeastSquaresSolver::HessianMatrix;
   using LeastSquaresSolver::GradientVector;
+  using LeastSquaresSolver::UpdateVector;
   using ScaleEstimator = MADScaleEstimator<real_t>;
   using WeightFunction = TukeyWeightFunction<real_t>;
 
@@ -89,11 +90,21 @@ public:
       const real_t prior_weight_pos,
       const real_t prior_weight_rot);
 
+  //! Only fills the arrowhead structure of H: the pose block, the pose /
+  //! inverse-depth cross terms and the inverse-depth diagonal.
   real_t evaluateError(
       const ClamState& state,
       HessianMatrix* H,
       GradientVector* g);
 
+  //! Solves the arrowhead system with the Schur complement on the pose, in
+  //! time linear in the number of landmarks.
+  bool solve(
+      const ClamState& state,
+      const HessianMatrix& H,
+      const GradientVector& g,
+      UpdateVector& dx);
+
 private:
   const ClamLandmarks& landmarks_;
   const std::vector<ClamFrameData>& data_;
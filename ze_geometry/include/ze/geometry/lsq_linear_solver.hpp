@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Cholesky>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
+#include <Eigen/IterativeLinearSolvers>
+#include <ze/common/logging.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+//! Backend that solves the normal equations H*dx = g.
+enum class LinearSolverType {
+  DenseLDLT,       //!< Dense LDLT, cubic in the state dimension.
+  SparseCholesky,  //!< Simplicial LDLT, symbolic factorization is cached.
+  ConjugateGradient //!< Jacobi-preconditioned conjugate gradient.
+};
+
+using SparseMatrix = Eigen::SparseMatrix<real_t>;
+
+// -----------------------------------------------------------------------------
+//! Accumulates a symmetric Hessian from dense blocks, e.g. J_i^T * J_j of
+//! individual residuals, and assembles it as a compressed sparse matrix.
+//! Only the lower triangle is stored. Blocks that are added several times
+//! are summed up during assembly.
+class BlockSparseHessian
+{
+public:
+  BlockSparseHessian() = default;
+
+  //! Clears the Hessian and sets its dimension.
+  void resize(int dim);
+
+  //! Removes all blocks but keeps the allocated memory.
+  void setZero();
+
+  inline int size() const
+  {
+    return dim_;
+  }
+
+  //! Add block to H(row:row+block.rows(), col:col+block.cols()). The
+  //! transposed block at (col, row) is implicit. Blocks on the diagonal
+  //! (row == col) must be symmetric.
+  template<typename Derived>
+  void addBlock(int row, int col, const Eigen::MatrixBase<Derived>& block)
+  {
+    DEBUG_CHECK_GE(row, 0);
+    DEBUG_CHECK_GE(col, 0);
+    DEBUG_CHECK_LE(row + block.rows(), dim_);
+    DEBUG_CHECK_LE(col + block.cols(), dim_);
+    if (row == col)
+    {
+      DEBUG_CHECK_EQ(block.rows(), block.cols());
+      for (int j = 0; j < block.cols(); ++j)
+      {
+        for (int i = j; i < block.rows(); ++i)
+        {
+          triplets_.emplace_back(row + i, col + j, block(i, j));
+        }
+      }
+    }
+    else if (row > col)
+    {
+      for (int j = 0; j < block.cols(); ++j)
+      {
+        for (int i = 0; i < block.rows(); ++i)
+        {
+          triplets_.emplace_back(row + i, col + j, block(i, j));
+        }
+      }
+    }
+    else
+    {
+      for (int j = 0; j < block.cols(); ++j)
+      {
+        for (int i = 0; i < block.rows(); ++i)
+        {
+          triplets_.emplace_back(col + j, row + i, block(i, j));
+        }
+      }
+    }
+    assembled_ = false;
+  }
+
+  //! Lower triangle of the accumulated Hessian, assembles pending blocks.
+  const SparseMatrix& matrix();
+
+  //! Diagonal of the accumulated Hessian.
+  VectorX diagonal();
+
+  //! H += diag(H) * mu, i.e., Levenberg-Marquardt damping.
+  void addDiagonalDamping(real_t mu);
+
+  //! Number of stored non-zeros of the lower triangle.
+  inline int nonZeros()
+  {
+    return matrix().nonZeros();
+  }
+
+  //! Full symmetric matrix, for debugging and tests.
+  MatrixX toDense();
+
+private:
+  int dim_ = 0;
+  bool assembled_ = true;
+  std::vector<Eigen::Triplet<real_t>> triplets_;
+  SparseMatrix H_;
+};
+
+// -----------------------------------------------------------------------------
+//! Solves H*dx = g with a sparse backend. The sparse Cholesky backend keeps
+//! the symbolic factorization and only recomputes it when the sparsity
+//! pattern of H changes, which typically happens only in the first iteration.
+class SparseLinearSolver
+{
+public:
+  SparseLinearSolver() = default;
+
+  //! H holds the lower triangle of the symmetric matrix.
+  bool solve(
+      LinearSolverType type,
+      const SparseMatrix& H,
+      const Eigen::Ref<const VectorX>& g,
+      Eigen::Ref<VectorX> dx);
+
+  //! Number of times the symbolic factorization has been computed.
+  inline uint32_t numSymbolicFactorizations() const
+  {
+    return num_symbolic_factorizations_;
+  }
+
+  //! Number of iterations of the last conjugate gradient solve.
+  inline uint32_t numCgIterations() const
+  {
+    return num_cg_iterations_;
+  }
+
+  //! Maximum number of conjugate gradient iterations, 0 means dimension of H.
+  uint32_t cg_max_iter = 0u;
+
+  //! Relative residual tolerance of the conjugate gradient solver.
+  real_t cg_tolerance = 1.0e-10;
+
+private:
+  bool patternChanged(const SparseMatrix& H) const;
+
+  Eigen::SimplicialLDLT<SparseMatrix, Eigen::Lower> ldlt_;
+  Eigen::ConjugateGradient<SparseMatrix, Eigen::Lower,
+                           Eigen::DiagonalPreconditioner<real_t>> cg_;
+  std::vector<int> outer_index_;
+  std::vector<int> inner_index_;
+  uint32_t num_symbolic_factorizations_ = 0u;
+  uint32_t num_cg_iterations_ = 0u;
+};
+
+//! Copies the lower triangle of a dense symmetric matrix into a sparse matrix,
+//! skipping exact zeros.
+void denseToSparseLower(const Eigen::Ref<const MatrixX>& H, SparseMatrix* H_sparse);
+
+} // namespace ze
@@ -67,14 +67,11 @@ void LeastSquaresSolver<T, Implementation>::optimizeGaussNewton(State& state)
     rho_ = 0;
     startIteration();
 
-    H_.setZero();
-    g_.setZero();
-
     // compute initial error
-    real_t new_chi2 = evaluateError(state, &H_, &g_);
+    real_t new_chi2 = linearize(state);
 
     // solve the linear system
-    if (!solve(state, H_, g_, dx_))
+    if (!solveLinearSystem(state))
     {
       LOG(WARNING) << "Matrix is close to singular! Stop Optimizing."
                    << "H = " << H_ << "g = " << g_;
@@ -150,17 +147,15 @@ void LeastSquaresSolver<T, Implementation>::optimizeLevenbergMarquardt(State& st
       // init variables
       State new_model;
       real_t new_chi2 = -1;
-      H_.setZero();
-      g_.setZero();
 
       // linearize
-      evaluateError(state, &H_, &g_);
+      linearize(state);
 
       // add damping term:
-      H_ += (H_.diagonal() * mu_).asDiagonal();
+      addDamping(mu_);
 
       // solve the linear system to obtain small perturbation in direction of gradient
-      if (solve(state, H_, g_, dx_))
+      if (solveLinearSystem(state))
       {
         // apply perturbation to the state
         update(state, dx_, new_model);
@@ -237,12 +232,57 @@ void LeastSquaresSolver<T, Implementation>::reset()
   stop_ = false;
 }
 
+template <typename T, typename Implementation>
+real_t LeastSquaresSolver<T, Implementation>::linearize(const State& state)
+{
+  g_.setZero();
+  if (useSparseHessian())
+  {
+    H_sparse_.setZero();
+    return evaluateErrorSparse(state, &H_sparse_, &g_);
+  }
+  H_.setZero();
+  return evaluateError(state, &H_, &g_);
+}
+
+template <typename T, typename Implementation>
+void LeastSquaresSolver<T, Implementation>::addDamping(real_t mu)
+{
+  if (useSparseHessian())
+  {
+    H_sparse_.addDiagonalDamping(mu);
+  }
+  else
+  {
+    H_ += (H_.diagonal() * mu).asDiagonal();
+  }
+}
+
+template <typename T, typename Implementation>
+bool LeastSquaresSolver<T, Implementation>::solveLinearSystem(const State& state)
+{
+  sparse_solver_.cg_max_iter = solver_options_.cg_max_iter;
+  sparse_solver_.cg_tolerance = solver_options_.cg_tolerance;
+  if (useSparseHessian())
+  {
+    return sparse_solver_.solve(
+          solver_options_.linear_solver, H_sparse_.matrix(), g_, dx_);
+  }
+  return solve(state, H_, g_, dx_);
+}
+
 template <typename T, typename Implementation>
 bool LeastSquaresSolver<T, Implementation>::solveDefaultImpl(
     const HessianMatrix& H,
     const GradientVector& g,
     UpdateVector& dx)
 {
+  if (solver_options_.linear_solver != LinearSolverType::DenseLDLT)
+  {
+    denseToSparseLower(H, &H_lower_);
+    return sparse_solver_.solve(solver_options_.linear_solver, H_lower_, g, dx);
+  }
+
   dx = H.ldlt().solve(g);
   if (std::isnan(dx[0]))
   {
@@ -30,6 +30,7 @@
 
 #include <ze/common/types.hpp>
 #include <ze/common/manifold.hpp>
+#include <ze/geometry/lsq_linear_solver.hpp>
 
 namespace ze {
 
@@ -67,6 +68,17 @@ struct LeastSquaresSolverOptions
 
   //! Stop if update norm is smaller than eps
   real_t eps{1.0e-10};
+
+  //! Backend to solve the normal equations. The sparse backends assemble the
+  //! Hessian with a BlockSparseHessian if the implementation provides
+  //! evaluateErrorSparse(), otherwise the dense Hessian is converted.
+  LinearSolverType linear_solver{LinearSolverType::DenseLDLT};
+
+  //! Max number of conjugate gradient iterations, 0 means state dimension.
+  uint32_t cg_max_iter{0u};
+
+  //! Relative residual tolerance of the conjugate gradient solver.
+  real_t cg_tolerance{1.0e-10};
 };
 
 //! Abstract Class for solving nonlinear least-squares (NLLS) problems.
@@ -116,12 +128,26 @@ public:
     return chi2_per_iter_;
   }
 
-  //! The the Hessian matrix (Information Matrix).
+  //! The the Hessian matrix (Information Matrix). Empty if the Hessian is
+  //! assembled in sparse form, see sparseHessian().
   inline const HessianMatrix& hessian() const
   {
     return H_;
   }
 
+  //! Block-sparse Hessian, only used with sparse linear solvers and if the
+  //! implementation provides evaluateErrorSparse().
+  inline BlockSparseHessian& sparseHessian()
+  {
+    return H_sparse_;
+  }
+
+  //! Backend of the sparse linear solvers.
+  inline const SparseLinearSolver& sparseLinearSolver() const
+  {
+    return sparse_solver_;
+  }
+
 protected:
   //! Get implementation (Curiously-Returning Template Pattern).
   Implementation& impl()
@@ -141,6 +167,24 @@ protected:
     return impl().evaluateError(state, H, g);
   }
 
+  //! Optional: Same as evaluateError but assembles the Hessian block-wise in
+  //! sparse form, which avoids the dense dim x dim Hessian for large dynamic
+  //! states. Used instead of evaluateError to linearize the system if a sparse
+  //! linear solver is selected. evaluateError is still used to compute the
+  //! error alone.
+  real_t evaluateErrorSparse(
+      const State& state,
+      BlockSparseHessian* H,
+      GradientVector* g)
+  {
+    if(&LeastSquaresSolver::evaluateErrorSparse != &Implementation::evaluateErrorSparse)
+    {
+      return impl().evaluateErrorSparse(state, H, g);
+    }
+    LOG(FATAL) << "Implementation does not provide evaluateErrorSparse.";
+    return 0.0;
+  }
+
   //! Solve the linear system H*dx = g to obtain optimal perturbation dx.
   bool solve(
       const State& state,
@@ -193,6 +237,22 @@ protected:
   }
 
 private:
+  //! True if the Hessian is assembled in sparse form.
+  inline bool useSparseHessian()
+  {
+    return solver_options_.linear_solver != LinearSolverType::DenseLDLT
+        && &LeastSquaresSolver::evaluateErrorSparse != &Implementation::evaluateErrorSparse;
+  }
+
+  //! Linearize the system at state, i.e., compute Hessian and gradient.
+  real_t linearize(const State& state);
+
+  //! Add Levenberg-Marquardt damping to the diagonal of the Hessian.
+  void addDamping(real_t mu);
+
+  //! Solve the linearized system with the dense or the sparse Hessian.
+  bool solveLinearSystem(const State& state);
+
   //! Default implementation to solve the linear system H*dx = g to obtain optimal perturbation dx.
   bool solveDefaultImpl(
       const HessianMatrix& H,
@@ -208,7 +268,15 @@ private:
   inline void allocateMemory(State& state)
   {
     const int dim = state.getDimension();
-    H_.resize(dim, dim);
+    if (useSparseHessian())
+    {
+      H_.resize(0, 0);
+      H_sparse_.resize(dim);
+    }
+    else
+    {
+      H_.resize(dim, dim);
+    }
     g_.resize(dim);
     dx_.resize(dim);
   }
@@ -221,6 +289,15 @@ protected:
   //! Hessian or approximation Jacobian*Jacobian^T.
   HessianMatrix H_;
 
+  //! Hessian in block-sparse form, see evaluateErrorSparse().
+  BlockSparseHessian H_sparse_;
+
+  //! Sparse Cholesky and conjugate gradient backends.
+  SparseLinearSolver sparse_solver_;
+
+  //! Lower triangle of the dense Hessian H_, for the sparse backends.
+  SparseMatrix H_lower_;
+
   //! Jacobian*residual.
   GradientVector g_;
 
@@ -35,6 +35,9 @@
 
 namespace ze {
 
+// fwd
+class ThreadPool;
+
 enum class PoseOptimizerResidualType
 {
   Bearing,
@@ -116,6 +119,13 @@ public:
       const real_t prior_weight_pos,
       const real_t prior_weight_rot);
 
+  //! Evaluates the residual blocks in parallel. The measurements are split in
+  //! chunks of chunk_size that are accumulated separately and summed up in a
+  //! fixed order, so the result does not depend on the number of threads. It
+  //! may differ from the serial evaluation in the last bits. The thread pool
+  //! is not owned and must outlive the optimizer. nullptr disables it.
+  void setThreadPool(ThreadPool* thread_pool, uint32_t chunk_size = 256u);
+
   real_t evaluateError(
       const Transformation& T_B_W,
       HessianMatrix* H,
@@ -134,6 +144,11 @@ private:
   //! Checks whether given data is valid. Throws if not.
   void checkData() const;
 
+  real_t evaluateErrorParallel(
+      const Transformation& T_B_W,
+      HessianMatrix* H,
+      GradientVector* g);
+
   std::vector<PoseOptimizerFrameData>& data_;
 
   //! @name Prior
@@ -142,6 +157,12 @@ private:
   real_t prior_weight_pos_ {0.0};
   real_t prior_weight_rot_ {0.0};
   //! @}
+
+  //! @name Parallel evaluation
+  //! @{
+  ThreadPool* thread_pool_ {nullptr};
+  uint32_t parallel_chunk_size_ {256u};
+  //! @}
 };
 
 //! Returns sum of chi2 errors (weighted and whitened errors) and
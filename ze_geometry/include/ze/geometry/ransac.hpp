@@ -0,0 +1,543 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <ze/common/logging.hpp>
+#include <ze/common/timer.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+struct RansacOptions
+{
+  //! Points with a distance to the model smaller than threshold are inliers.
+  real_t threshold{0.0};
+
+  //! Max number of hypotheses.
+  uint32_t max_iterations{100u};
+
+  //! Probability of drawing at least one outlier-free sample, used for
+  //! adaptive termination.
+  real_t probability{0.999};
+
+  //! Time budget in microseconds, 0 means unlimited. Checked before every
+  //! hypothesis and every local optimization step.
+  uint64_t max_time_us{0u};
+
+  //! Reject hypotheses early with Wald's sequential probability ratio test.
+  bool use_sprt{true};
+
+  //! Initial probability that a point is consistent with a bad model. It is
+  //! re-estimated from the rejected hypotheses.
+  real_t sprt_delta{0.01};
+
+  //! Initial (lower bound of the) inlier ratio, increased with the best model.
+  real_t sprt_epsilon{0.05};
+
+  //! Time to compute a hypothesis in units of point verifications.
+  real_t sprt_model_cost{200.0};
+
+  //! Refine every new best hypothesis on its inliers (LO-RANSAC).
+  bool use_local_optimization{true};
+
+  //! Max number of refinements of a new best hypothesis.
+  uint32_t lo_max_iterations{3u};
+};
+
+struct RansacSummary
+{
+  uint32_t num_iterations{0u};
+  uint32_t num_rejected_by_sprt{0u};
+  uint32_t num_local_optimizations{0u};
+  bool deadline_reached{false};
+};
+
+//! Native RANSAC with adaptive termination, PROSAC sampling, SPRT early
+//! rejection, LO refinement and a time budget.
+//!
+//! Problem follows the interface of opengv::sac::SampleConsensusProblem:
+//!   model_t, getSampleSize(), isSampleGood(sample),
+//!   computeModelCoefficients(sample, model),
+//!   getSelectedDistancesToModel(model, indices, distances) and
+//!   optimizeModelCoefficients(inliers, model, optimized_model).
+template<typename Problem>
+class Ransac
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  using Model = typename Problem::model_t;
+
+  Ransac() = default;
+
+  Ransac(const RansacOptions& options)
+    : options_(options)
+  {}
+
+  //! Estimates the model from num_points correspondences. If ordering is not
+  //! empty, it holds the point indices sorted by decreasing match quality and
+  //! hypotheses are sampled progressively from the best points (PROSAC).
+  //! Returns false if no model was found.
+  bool computeModel(
+      Problem& problem,
+      const uint32_t num_points,
+      const std::vector<int>& ordering = std::vector<int>());
+
+  inline const Model& model() const { return model_; }
+
+  //! Sorted indices of the inliers of the best model.
+  inline const std::vector<int>& inliers() const { return inliers_; }
+
+  inline const RansacSummary& summary() const { return summary_; }
+
+  RansacOptions options_;
+
+private:
+  //! Draws a sample of sample_size distinct points.
+  void drawSample(const uint32_t sample_size, std::vector<int>& sample);
+
+  //! Draws the PROSAC sample of the current iteration from ordering.
+  void drawProsacSample(
+      const uint32_t sample_size, const std::vector<int>& ordering,
+      std::vector<int>& sample);
+
+  //! Computes the distances of all points to the model in random order and
+  //! counts the inliers. Returns false if SPRT rejects the model, then
+  //! num_inliers counts the consistent points among the tested ones.
+  bool verify(
+      const Problem& problem, const Model& model, const bool use_sprt,
+      uint32_t& num_inliers, uint32_t& num_tested);
+
+  //! Collects the inliers from the distances of the last verification.
+  void collectInliers();
+
+  //! PROSAC termination: Finds the prefix of the ordering whose inliers are
+  //! unlikely to be random and that needs the fewest iterations.
+  void updateProsacTermination(
+      const uint32_t sample_size, const std::vector<int>& ordering);
+
+  //! Decision threshold of the SPRT for the current epsilon and delta.
+  real_t sprtThreshold() const;
+
+  //! Number of iterations needed to draw an outlier-free sample.
+  uint32_t requiredIterations(const uint32_t sample_size, const real_t inlier_ratio) const;
+
+  inline bool deadlineReached(Timer& timer) const
+  {
+    return options_.max_time_us > 0u
+        && static_cast<uint64_t>(timer.stopAndGetNanoseconds()) > options_.max_time_us * 1000u;
+  }
+
+  Model model_;
+  std::vector<int> inliers_;
+  RansacSummary summary_;
+
+  std::mt19937 gen_;
+  uint32_t num_points_{0u};
+  std::vector<int> verification_order_;
+  std::vector<double> distances_;
+  std::vector<int> chunk_indices_;
+  std::vector<double> chunk_distances_;
+
+  //! @name SPRT
+  //! @{
+  real_t sprt_epsilon_;
+  real_t sprt_delta_;
+  real_t sprt_threshold_;
+  //! @}
+
+  //! @name PROSAC
+  //! @{
+  uint32_t prosac_n_;
+  uint32_t prosac_t_;
+  real_t prosac_T_n_;
+  uint32_t prosac_T_n_prime_;
+  uint32_t prosac_stop_n_;
+  uint32_t prosac_stop_iterations_;
+  std::vector<uint8_t> is_inlier_;
+  //! @}
+};
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+bool Ransac<Problem>::computeModel(
+    Problem& problem,
+    const uint32_t num_points,
+    const std::vector<int>& ordering)
+{
+  Timer timer;
+  summary_ = RansacSummary();
+  inliers_.clear();
+  num_points_ = num_points;
+  const uint32_t sample_size = problem.getSampleSize();
+  if (num_points < sample_size)
+  {
+    VLOG(10) << "RANSAC: Not enough points.";
+    return false;
+  }
+
+  // Verify points in random order, SPRT decides on a prefix of it.
+  verification_order_.resize(num_points);
+  std::iota(verification_order_.begin(), verification_order_.end(), 0);
+  std::shuffle(verification_order_.begin(), verification_order_.end(), gen_);
+  distances_.resize(num_points);
+
+  sprt_epsilon_ = options_.sprt_epsilon;
+  sprt_delta_ = options_.sprt_delta;
+  sprt_threshold_ = sprtThreshold();
+  uint32_t num_rejected_delta = 0u;
+
+  const bool use_prosac = !ordering.empty();
+  if (use_prosac)
+  {
+    CHECK_EQ(ordering.size(), num_points);
+    // Average number of samples that only contain points of the first n, out
+    // of T_N samples, for n = sample_size.
+    const real_t T_N = 200000;
+    prosac_n_ = sample_size;
+    prosac_T_n_ = T_N;
+    for (uint32_t i = 0u; i < sample_size; ++i)
+    {
+      prosac_T_n_ *= static_cast<real_t>(prosac_n_ - i) / (num_points - i);
+    }
+    prosac_T_n_prime_ = 1u;
+    prosac_t_ = 0u;
+    prosac_stop_n_ = num_points;
+    prosac_stop_iterations_ = options_.max_iterations;
+  }
+
+  std::vector<int> sample;
+  Model model;
+  uint32_t best_num_inliers = 0u;
+  uint32_t max_iterations = options_.max_iterations;
+  uint32_t iter = 0u;
+  for (; iter < max_iterations; ++iter)
+  {
+    if (deadlineReached(timer))
+    {
+      summary_.deadline_reached = true;
+      break;
+    }
+    if (use_prosac && iter >= prosac_stop_iterations_ && prosac_n_ >= prosac_stop_n_)
+    {
+      break;
+    }
+
+    // Hypothesis.
+    const int max_sample_checks = 10;
+    bool sample_good = false;
+    for (int i = 0; i < max_sample_checks && !sample_good; ++i)
+    {
+      if (use_prosac)
+      {
+        drawProsacSample(sample_size, ordering, sample);
+      }
+      else
+      {
+        drawSample(sample_size, sample);
+      }
+      sample_good = problem.isSampleGood(sample);
+    }
+    if (!sample_good || !problem.computeModelCoefficients(sample, model))
+    {
+      continue;
+    }
+
+    // Verification.
+    uint32_t num_inliers, num_tested;
+    if (!verify(problem, model, options_.use_sprt, num_inliers, num_tested))
+    {
+      ++summary_.num_rejected_by_sprt;
+      // Re-estimate delta as average inlier ratio of the rejected models.
+      const real_t delta = static_cast<real_t>(num_inliers) / num_tested;
+      sprt_delta_ = (sprt_delta_ * num_rejected_delta + delta) / (num_rejected_delta + 1u);
+      sprt_delta_ = std::max(sprt_delta_, real_t{1.0e-3});
+      ++num_rejected_delta;
+      sprt_threshold_ = sprtThreshold();
+      continue;
+    }
+
+    if (num_inliers <= best_num_inliers)
+    {
+      continue;
+    }
+
+    // New best model.
+    model_ = model;
+    best_num_inliers = num_inliers;
+    collectInliers();
+
+    if (options_.use_local_optimization)
+    {
+      for (uint32_t i = 0u; i < options_.lo_max_iterations; ++i)
+      {
+        if (deadlineReached(timer))
+        {
+          summary_.deadline_reached = true;
+          break;
+        }
+        Model optimized_model;
+        problem.optimizeModelCoefficients(inliers_, model_, optimized_model);
+        ++summary_.num_local_optimizations;
+        uint32_t num_optimized_inliers, num_optimized_tested;
+        verify(problem, optimized_model, false, num_optimized_inliers, num_optimized_tested);
+        if (num_optimized_inliers < best_num_inliers)
+        {
+          break;
+        }
+        // Keep the refined model also with the same support, it is fitted to
+        // all inliers instead of a minimal sample.
+        const bool support_increased = num_optimized_inliers > best_num_inliers;
+        model_ = optimized_model;
+        best_num_inliers = num_optimized_inliers;
+        collectInliers();
+        if (!support_increased)
+        {
+          break;
+        }
+      }
+    }
+
+    // Adaptive termination and SPRT update.
+    const real_t inlier_ratio = static_cast<real_t>(best_num_inliers) / num_points;
+    max_iterations = std::min(options_.max_iterations,
+                              requiredIterations(sample_size, inlier_ratio));
+    if (use_prosac)
+    {
+      updateProsacTermination(sample_size, ordering);
+    }
+    if (inlier_ratio > sprt_epsilon_)
+    {
+      sprt_epsilon_ = inlier_ratio;
+      sprt_threshold_ = sprtThreshold();
+    }
+  }
+  summary_.num_iterations = iter;
+
+  VLOG(10) << "RANSAC: #iter = " << summary_.num_iterations
+           << ", #inliers = " << best_num_inliers
+           << ", #SPRT rejections = " << summary_.num_rejected_by_sprt
+           << ", #LO = " << summary_.num_local_optimizations
+           << (summary_.deadline_reached ? ", deadline reached" : "");
+  return best_num_inliers > 0u;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+void Ransac<Problem>::drawSample(
+    const uint32_t sample_size, std::vector<int>& sample)
+{
+  std::uniform_int_distribution<int> dist(0, num_points_ - 1);
+  sample.clear();
+  while (sample.size() < sample_size)
+  {
+    const int idx = dist(gen_);
+    if (std::find(sample.begin(), sample.end(), idx) == sample.end())
+    {
+      sample.push_back(idx);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+void Ransac<Problem>::drawProsacSample(
+    const uint32_t sample_size, const std::vector<int>& ordering,
+    std::vector<int>& sample)
+{
+  // Chum and Matas, "Matching with PROSAC - Progressive Sample Consensus".
+  ++prosac_t_;
+  if (prosac_t_ > prosac_T_n_prime_ && prosac_n_ < num_points_)
+  {
+    const real_t T_n_next =
+        prosac_T_n_ * (prosac_n_ + 1u) / (prosac_n_ + 1u - sample_size);
+    ++prosac_n_;
+    prosac_T_n_prime_ += static_cast<uint32_t>(std::ceil(T_n_next - prosac_T_n_));
+    prosac_T_n_ = T_n_next;
+  }
+
+  // Sample from the first n points, or the n-th point and sample_size - 1 of
+  // the first n - 1 points.
+  const bool include_nth = prosac_T_n_prime_ >= prosac_t_;
+  const uint32_t n = include_nth ? prosac_n_ - 1u : prosac_n_;
+  std::uniform_int_distribution<int> dist(0, std::max(n, 1u) - 1);
+  sample.clear();
+  if (include_nth)
+  {
+    sample.push_back(ordering[prosac_n_ - 1u]);
+  }
+  while (sample.size() < sample_size)
+  {
+    const int idx = ordering[dist(gen_)];
+    if (std::find(sample.begin(), sample.end(), idx) == sample.end())
+    {
+      sample.push_back(idx);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+bool Ransac<Problem>::verify(
+    const Problem& problem, const Model& model, const bool use_sprt,
+    uint32_t& num_inliers, uint32_t& num_tested)
+{
+  // Evaluate in chunks to amortize the virtual call of the problem.
+  const uint32_t chunk_size = 32u;
+  const double threshold = options_.threshold;
+  const bool sprt = use_sprt && sprt_epsilon_ > sprt_delta_;
+  const real_t lambda_inlier = sprt_delta_ / sprt_epsilon_;
+  const real_t lambda_outlier = (1.0 - sprt_delta_) / (1.0 - sprt_epsilon_);
+  real_t lambda = 1.0;
+  std::vector<int>& indices = chunk_indices_;
+  std::vector<double>& distances = chunk_distances_;
+  num_inliers = 0u;
+  num_tested = 0u;
+  while (num_tested < num_points_)
+  {
+    const uint32_t end = std::min(num_points_, num_tested + chunk_size);
+    indices.assign(verification_order_.begin() + num_tested,
+                   verification_order_.begin() + end);
+    distances.clear();
+    problem.getSelectedDistancesToModel(model, indices, distances);
+    for (size_t i = 0u; i < indices.size(); ++i)
+    {
+      distances_[indices[i]] = distances[i];
+      ++num_tested;
+      if (distances[i] < threshold)
+      {
+        ++num_inliers;
+        lambda *= lambda_inlier;
+      }
+      else
+      {
+        lambda *= lambda_outlier;
+      }
+      if (sprt && lambda > sprt_threshold_)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+void Ransac<Problem>::collectInliers()
+{
+  inliers_.clear();
+  for (uint32_t i = 0u; i < num_points_; ++i)
+  {
+    if (distances_[i] < options_.threshold)
+    {
+      inliers_.push_back(i);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+void Ransac<Problem>::updateProsacTermination(
+    const uint32_t sample_size, const std::vector<int>& ordering)
+{
+  is_inlier_.assign(num_points_, 0u);
+  for (int i : inliers_)
+  {
+    is_inlier_[i] = 1u;
+  }
+
+  // Probability that a point is consistent with a wrong model.
+  const real_t beta = sprt_delta_;
+  uint32_t num_inliers_n = 0u;
+  for (uint32_t n = 1u; n <= num_points_; ++n)
+  {
+    num_inliers_n += is_inlier_[ordering[n - 1u]];
+    if (n < sample_size)
+    {
+      continue;
+    }
+    // Non-randomness: Besides the sample, the number of inliers must exceed
+    // what a wrong model achieves with probability 5%, normal approximation
+    // of the binomial distribution.
+    const real_t mean = (n - sample_size) * beta;
+    const real_t stddev = std::sqrt(mean * (1.0 - beta));
+    if (num_inliers_n < sample_size + 1u + mean + 1.645 * stddev)
+    {
+      continue;
+    }
+    const uint32_t iterations = requiredIterations(
+          sample_size, static_cast<real_t>(num_inliers_n) / n);
+    if (iterations < prosac_stop_iterations_)
+    {
+      prosac_stop_iterations_ = iterations;
+      prosac_stop_n_ = n;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+real_t Ransac<Problem>::sprtThreshold() const
+{
+  // Matas and Chum, "Randomized RANSAC with Sequential Probability Ratio Test".
+  if (sprt_epsilon_ <= sprt_delta_)
+  {
+    return std::numeric_limits<real_t>::max();
+  }
+  const real_t eps = sprt_epsilon_;
+  const real_t delta = sprt_delta_;
+  const real_t C = (1.0 - delta) * std::log((1.0 - delta) / (1.0 - eps))
+                 + delta * std::log(delta / eps);
+  const real_t K = options_.sprt_model_cost * C + 1.0;
+  real_t A = K;
+  for (int i = 0; i < 10; ++i)
+  {
+    A = K + std::log(A);
+  }
+  return A;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Problem>
+uint32_t Ransac<Problem>::requiredIterations(
+    const uint32_t sample_size, const real_t inlier_ratio) const
+{
+  const real_t eps = std::numeric_limits<real_t>::epsilon();
+  real_t p_no_outliers = 1.0 - std::pow(inlier_ratio, static_cast<real_t>(sample_size));
+  p_no_outliers = std::max(eps, std::min(1.0 - eps, p_no_outliers));
+  const real_t k = std::log(1.0 - options_.probability) / std::log(p_no_outliers);
+  return k < static_cast<real_t>(std::numeric_limits<uint32_t>::max())
+      ? static_cast<uint32_t>(std::ceil(k)) : std::numeric_limits<uint32_t>::max();
+}
+
+} // namespace ze
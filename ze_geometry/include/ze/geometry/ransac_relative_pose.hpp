@@ -27,6 +27,7 @@
 
 #include <ze/common/types.hpp>
 #include <ze/common/transformation.hpp>
+#include <ze/geometry/ransac.hpp>
 
 namespace ze {
 
@@ -54,6 +55,9 @@ enum class RelativePoseAlgorithm {
   TwoPointRotationOnly     //!< 2-point relative pose, assumes no translation between frames.
 };
 
+//! RANSAC on the minimal solvers of OpenGV, see Ransac for the settings.
+//! Optional match scores (higher is better, one per correspondence) enable
+//! PROSAC sampling from the best matches first.
 class RansacRelativePose
 {
 public:
@@ -67,47 +71,57 @@ public:
       const Bearings& f_ref,
       const Bearings& f_cur,
       const RelativePoseAlgorithm method,
-      Transformation& T_cur_ref);
+      Transformation& T_cur_ref,
+      const VectorX& match_scores = VectorX());
 
   bool solve(
       const BearingsVector& f_ref,
       const BearingsVector& f_cur,
       const RelativePoseAlgorithm method,
-      Transformation& T_cur_ref);
+      Transformation& T_cur_ref,
+      const VectorX& match_scores = VectorX());
 
   bool solveRelativePose(
       const BearingsVector& f_ref,
       const BearingsVector& f_cur,
-      Transformation& T_cur_ref);
+      Transformation& T_cur_ref,
+      const VectorX& match_scores = VectorX());
 
   bool solveTranslationOnly(
       const BearingsVector& f_ref,
       const BearingsVector& f_cur,
-      Transformation& T_cur_ref);
+      Transformation& T_cur_ref,
+      const VectorX& match_scores = VectorX());
 
   bool solveRotationOnly(
       const BearingsVector& f_ref,
       const BearingsVector& f_cur,
-      Transformation& T_cur_ref);
+      Transformation& T_cur_ref,
+      const VectorX& match_scores = VectorX());
+
+  inline uint32_t numIterations() const { return summary_.num_iterations; }
 
-  inline uint32_t numIterations() const { return num_iterations_; }
+  inline const RansacSummary& summary() const { return summary_; }
 
   inline const std::vector<int>& inliers() const { return inliers_; }
 
   std::vector<int> outliers();
 
-  //! @name: OpenGV settings.
-  //! @{
-  real_t ogv_threshold_;
-  uint32_t ogv_max_iterations_ = 100;
-  real_t ogv_init_probability_ = 0.999;
-  uint32_t ogv_verbosity_level_ = 0u;
-  //! @}
+  //! RANSAC settings. The threshold is set from the reprojection threshold
+  //! in the constructor and is compared to 1 - cos(angle) errors.
+  RansacOptions options_;
 
 private:
+  //! Runs RANSAC on the OpenGV sample-consensus problem.
+  template<typename Problem>
+  bool solveProblem(
+      Problem& problem,
+      const uint32_t num_measurements,
+      const VectorX& match_scores,
+      Transformation& T_cur_ref);
+
   uint32_t num_measurements_ = 0u;
-  uint32_t num_iterations_ = 0u;
-  real_t result_probability_;
+  RansacSummary summary_;
   std::vector<int> inliers_;
 };
 
@@ -26,12 +26,16 @@
 #pragma once
 
 #include <tuple>
+#include <vector>
 
 #include <ze/common/types.hpp>
 #include <ze/common/transformation.hpp>
 
 namespace ze {
 
+//! Number of points that the batched triangulation functions process together.
+constexpr int c_triangulation_batch_size = 8;
+
 //! Return depth in reference frame.
 inline std::pair<real_t, bool> depthFromTriangulation(
     const Transformation& T_cur_ref,
@@ -58,7 +62,8 @@ Position triangulateNonLinear(
     const Eigen::Ref<const Bearing>& f_B);
 
 //! Triangulate multiple 3d points using triangulateNonLinear and compute
-//! the corresponding reprojection errors.
+//! the corresponding reprojection errors. The points are processed in blocks
+//! of c_triangulation_batch_size in SIMD lanes.
 void triangulateManyAndComputeAngularErrors(
     const Transformation& T_A_B,
     const Bearings& f_A_vec,
@@ -66,6 +71,19 @@ void triangulateManyAndComputeAngularErrors(
     Positions& p_A,
     VectorX& reprojection_erors);
 
+//! Triangulate multiple 3d points seen from two viewpoints using
+//! triangulateNonLinear, followed by at most num_iterations Gauss-Newton
+//! refinements of the unit-plane errors in both frames, as in
+//! triangulateGaussNewton. The points are processed in blocks of
+//! c_triangulation_batch_size in SIMD lanes. A point is not updated anymore
+//! once it converged or its error increased.
+void triangulateManyGaussNewton(
+    const Transformation& T_A_B,
+    const Bearings& f_A_vec,
+    const Bearings& f_B_vec,
+    Positions& p_A,
+    const uint32_t num_iterations = 5u);
+
 //! DLT triangulation [Hartley and Zisserman, 2nd edition, p. 312].
 //! @param T_C_W vector of camera poses (camera in world coordinates).
 //! @param f_C bearing vectors in camera frame.
@@ -77,6 +95,23 @@ std::pair<Vector4, bool> triangulateHomogeneousDLT(
     const Bearings& p_C,
     const real_t rank_tol = 1e-9);
 
+//! Batched DLT triangulation of multiple points that are observed in the same
+//! views. The normal equations of blocks of c_triangulation_batch_size points
+//! are accumulated in SIMD lanes, the solution is the eigenvector of the
+//! smallest eigenvalue. Points whose rank can't be decided reliably from the
+//! normal equations fall back to triangulateHomogeneousDLT().
+//! @param T_C_W vector of camera poses (camera in world coordinates).
+//! @param f_C bearing vectors per camera, f_C[i].col(j) observes point j.
+//! @param p_W_homogeneous Triangulated points, in homogeneous coordinates.
+//! @param success Success per point.
+//! @param rank_tol Rank tolerance on the singular values.
+void triangulateManyHomogeneousDLT(
+    const TransformationVector& T_C_W,
+    const std::vector<Bearings>& f_C,
+    HomPositions& p_W_homogeneous,
+    std::vector<bool>& success,
+    const real_t rank_tol = 1e-9);
+
 //! Non-linear least squares refinement of the triangulation using Gauss-Newton.
 void triangulateGaussNewton(
     const TransformationVector& T_C_W,
@@ -40,12 +40,26 @@ PoseAligner::PoseAligner(
     const TransformationVector& T_W_B,
     const real_t measurement_sigma_pos,
     const real_t measurement_sigma_rot)
+  : PoseAligner(T_W_A, T_W_B, measurement_sigma_pos, measurement_sigma_rot,
+                0u, T_W_A.size())
+{}
+
+PoseAligner::PoseAligner(
+    const TransformationVector& T_W_A,
+    const TransformationVector& T_W_B,
+    const real_t measurement_sigma_pos,
+    const real_t measurement_sigma_rot,
+    const size_t first_pose,
+    const size_t num_poses)
   : T_W_A_(T_W_A)
   , T_W_B_(T_W_B)
+  , first_pose_(first_pose)
+  , num_poses_(num_poses)
   , measurement_sigma_pos_(measurement_sigma_pos)
   , measurement_sigma_rot_(measurement_sigma_rot)
 {
   CHECK_EQ(T_W_A_.size(), T_W_B_.size());
+  CHECK_LE(first_pose_ + num_poses_, T_W_A_.size());
 }
 
 double PoseAligner::evaluateError(
@@ -56,13 +70,14 @@ double PoseAligner::evaluateError(
   double chi2 = 0.0;
 
   // Compute prediction error.
-  Matrix6X residuals(6, T_W_A_.size());
-
+  Matrix6X residuals(6, num_poses_);
+  const Transformation& T_W_A0 = T_W_A_[first_pose_];
+  const Transformation T_A0_W = T_W_A0.inverse();
 
-  for (size_t i = 0; i < T_W_A_.size(); ++i)
+  for (size_t i = 0; i < num_poses_; ++i)
   {
-    Transformation T_A0_Ai = T_W_A_[0].inverse() * T_W_A_[i];
-    Transformation T_Bi_A0 = T_W_B_[i].inverse() * T_W_A_[0];
+    Transformation T_A0_Ai = T_A0_W * T_W_A_[first_pose_ + i];
+    Transformation T_Bi_A0 = T_W_B_[first_pose_ + i].inverse() * T_W_A0;
     Transformation T_Bi_Ai = T_Bi_A0 * T_A0_B0 * T_A0_Ai;
     residuals.col(i) = T_Bi_Ai.log();
   }
@@ -77,11 +92,11 @@ double PoseAligner::evaluateError(
 
   if (H && g)
   {
-    for (size_t i = 0; i < T_W_A_.size(); ++i)
+    for (size_t i = 0; i < num_poses_; ++i)
     {
       // Compute Jacobian (if necessary, this can be optimized a lot).
-      Transformation T_A0_Ai = T_W_A_[0].inverse() * T_W_A_[i];
-      Transformation T_Bi_A0 = T_W_B_[i].inverse() * T_W_A_[0];
+      Transformation T_A0_Ai = T_A0_W * T_W_A_[first_pose_ + i];
+      Transformation T_Bi_A0 = T_W_B_[first_pose_ + i].inverse() * T_W_A0;
       Matrix6 J = dRelpose_dTransformation(T_A0_B0, T_Bi_A0, T_A0_Ai);
 
       // Compute square-root of inverse covariance:
@@ -126,7 +126,9 @@ real_t Clam::evaluateError(
   // ---------------------------------------------------------------------------
   // Mapping
 
-  //! @todo(cfo): This can be optimized a lot!
+  // Every residual only depends on the pose and one inverse depth. Hence, the
+  // Hessian has arrowhead structure and we only accumulate the pose block, the
+  // pose / inverse-depth cross terms and the inverse-depth diagonal.
   for (size_t i = 0; i < data_.size(); ++i)
   {
     const ClamFrameData& data = data_[i];
@@ -147,17 +149,22 @@ real_t Clam::evaluateError(
       // Whiten error
       err /= measurement_sigma_mapping_;
 
-      Matrix2X J(2, g->size());
-      J.setZero();
-      J.block<2,6>(0, 0) = H1;
-      J.block<2,1>(0, 6 + m.first) = H2;
-
-      // Whiten Jacobian.
-      J /= measurement_sigma_mapping_;
+      if (H && g)
+      {
+        // Whiten Jacobian.
+        H1 /= measurement_sigma_mapping_;
+        H2 /= measurement_sigma_mapping_;
 
-      // Compute Hessian and Gradient Vector.
-      H->noalias() += J.transpose() * J * weight;
-      g->noalias() -= J.transpose() * err * weight;
+        // Compute Hessian and Gradient Vector.
+        const int k = 6 + m.first;
+        const Vector6 H_pose_depth = H1.transpose() * H2 * weight;
+        H->topLeftCorner<6,6>().noalias() += H1.transpose() * H1 * weight;
+        H->block<6,1>(0, k) += H_pose_depth;
+        H->block<1,6>(k, 0) += H_pose_depth.transpose();
+        (*H)(k, k) += H2.squaredNorm() * weight;
+        g->head<6>().noalias() -= H1.transpose() * err * weight;
+        (*g)(k) -= H2.col(0).dot(err) * weight;
+      }
 
       // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
       chi2 += 0.5 * weight * err.squaredNorm();
@@ -166,7 +173,7 @@ real_t Clam::evaluateError(
 
   // ---------------------------------------------------------------------------
   // Prior
-  if (prior_weight_rot_ > 0.0f || prior_weight_pos_ > 0.0f)
+  if (H && g && (prior_weight_rot_ > 0.0f || prior_weight_pos_ > 0.0f))
   {
     applyPosePrior(
           T_Bc_Br, T_Bc_Br_prior_, prior_weight_rot_, prior_weight_pos_,
@@ -176,4 +183,40 @@ real_t Clam::evaluateError(
   return chi2;
 }
 
+bool Clam::solve(
+    const ClamState& /*state*/,
+    const HessianMatrix& H,
+    const GradientVector& g,
+    UpdateVector& dx)
+{
+  // Eliminate the inverse depths with the Schur complement on the pose:
+  // (H_pp - H_pd D^-1 H_dp) dx_p = g_p - H_pd D^-1 g_d,
+  // where D is the diagonal inverse-depth block.
+  const int n = H.rows() - 6;
+  VectorX D_inv(n);
+  for (int k = 0; k < n; ++k)
+  {
+    // Inverse depths without measurements are not updated.
+    const real_t d = H(6 + k, 6 + k);
+    D_inv(k) = (d > 0.0) ? 1.0 / d : 0.0;
+  }
+
+  const auto H_pd = H.block(0, 6, 6, n);
+  const auto g_d = g.tail(n);
+  const Matrix6X H_pd_D_inv = H_pd * D_inv.asDiagonal();
+  const Matrix6 S = H.topLeftCorner<6,6>() - H_pd_D_inv * H_pd.transpose();
+  const Vector6 rhs = g.head<6>() - H_pd_D_inv * g_d;
+
+  const Vector6 dx_pose = S.ldlt().solve(rhs);
+  if (std::isnan(dx_pose[0]))
+  {
+    return false;
+  }
+  dx.head<6>() = dx_pose;
+
+  // Back-substitute the inverse depths.
+  dx.tail(n) = D_inv.cwiseProduct(g_d - H_pd.transpose() * dx_pose);
+  return true;
+}
+
 } // namespace ze
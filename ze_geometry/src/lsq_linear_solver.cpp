@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <ze/geometry/lsq_linear_solver.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ze {
+
+// -----------------------------------------------------------------------------
+void BlockSparseHessian::resize(int dim)
+{
+  CHECK_GE(dim, 0);
+  dim_ = dim;
+  triplets_.clear();
+  H_.resize(dim, dim);
+  H_.setZero();
+  assembled_ = true;
+}
+
+// -----------------------------------------------------------------------------
+void BlockSparseHessian::setZero()
+{
+  triplets_.clear();
+  assembled_ = false;
+}
+
+// -----------------------------------------------------------------------------
+const SparseMatrix& BlockSparseHessian::matrix()
+{
+  if (!assembled_)
+  {
+    // Sums duplicate entries and yields sorted, compressed columns.
+    H_.setFromTriplets(triplets_.begin(), triplets_.end());
+    assembled_ = true;
+  }
+  return H_;
+}
+
+// -----------------------------------------------------------------------------
+VectorX BlockSparseHessian::diagonal()
+{
+  const SparseMatrix& H = matrix();
+  VectorX diag = VectorX::Zero(dim_);
+  for (int j = 0; j < H.outerSize(); ++j)
+  {
+    // Columns are sorted and hold the lower triangle only, hence the diagonal
+    // element is the first one of the column if it exists.
+    SparseMatrix::InnerIterator it(H, j);
+    if (it && it.row() == j)
+    {
+      diag(j) = it.value();
+    }
+  }
+  return diag;
+}
+
+// -----------------------------------------------------------------------------
+void BlockSparseHessian::addDiagonalDamping(real_t mu)
+{
+  matrix();
+  for (int j = 0; j < H_.outerSize(); ++j)
+  {
+    SparseMatrix::InnerIterator it(H_, j);
+    if (it && it.row() == j)
+    {
+      it.valueRef() += it.value() * mu;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+MatrixX BlockSparseHessian::toDense()
+{
+  MatrixX H = MatrixX(matrix());
+  H.triangularView<Eigen::StrictlyUpper>() = H.transpose();
+  return H;
+}
+
+// -----------------------------------------------------------------------------
+bool SparseLinearSolver::patternChanged(const SparseMatrix& H) const
+{
+  CHECK(H.isCompressed());
+  const size_t num_outer = H.outerSize() + 1;
+  const size_t num_inner = H.nonZeros();
+  return num_outer != outer_index_.size()
+      || num_inner != inner_index_.size()
+      || !std::equal(outer_index_.begin(), outer_index_.end(), H.outerIndexPtr())
+      || !std::equal(inner_index_.begin(), inner_index_.end(), H.innerIndexPtr());
+}
+
+// -----------------------------------------------------------------------------
+bool SparseLinearSolver::solve(
+    LinearSolverType type,
+    const SparseMatrix& H,
+    const Eigen::Ref<const VectorX>& g,
+    Eigen::Ref<VectorX> dx)
+{
+  CHECK_EQ(H.rows(), H.cols());
+  CHECK_EQ(H.rows(), g.size());
+  CHECK_EQ(H.rows(), dx.size());
+
+  switch (type)
+  {
+    case LinearSolverType::SparseCholesky:
+    {
+      if (patternChanged(H))
+      {
+        ldlt_.analyzePattern(H);
+        outer_index_.assign(H.outerIndexPtr(), H.outerIndexPtr() + H.outerSize() + 1);
+        inner_index_.assign(H.innerIndexPtr(), H.innerIndexPtr() + H.nonZeros());
+        ++num_symbolic_factorizations_;
+      }
+      ldlt_.factorize(H);
+      if (ldlt_.info() != Eigen::Success)
+      {
+        return false;
+      }
+      dx = ldlt_.solve(g);
+      break;
+    }
+    case LinearSolverType::ConjugateGradient:
+    {
+      cg_.setTolerance(cg_tolerance);
+      cg_.setMaxIterations(cg_max_iter > 0u ? cg_max_iter : H.rows());
+      cg_.compute(H);
+      dx = cg_.solve(g);
+      num_cg_iterations_ = cg_.iterations();
+      if (cg_.info() == Eigen::NumericalIssue)
+      {
+        return false;
+      }
+      break;
+    }
+    case LinearSolverType::DenseLDLT:
+    {
+      MatrixX H_dense = MatrixX(H);
+      dx = H_dense.ldlt().solve(g);
+      break;
+    }
+  }
+  return dx.size() == 0 || !std::isnan(dx[0]);
+}
+
+// -----------------------------------------------------------------------------
+void denseToSparseLower(const Eigen::Ref<const MatrixX>& H, SparseMatrix* H_sparse)
+{
+  CHECK_NOTNULL(H_sparse);
+  CHECK_EQ(H.rows(), H.cols());
+  std::vector<Eigen::Triplet<real_t>> triplets;
+  for (int j = 0; j < H.cols(); ++j)
+  {
+    for (int i = j; i < H.rows(); ++i)
+    {
+      if (H(i, j) != 0.0)
+      {
+        triplets.emplace_back(i, j, H(i, j));
+      }
+    }
+  }
+  H_sparse->resize(H.rows(), H.cols());
+  H_sparse->setFromTriplets(triplets.begin(), triplets.end());
+}
+
+} // namespace ze
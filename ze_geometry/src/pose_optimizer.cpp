@@ -33,6 +33,7 @@
 #include <ze/common/logging.hpp>
 #include <ze/common/matrix.hpp>
 #include <ze/common/stl_utils.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/geometry/pose_prior.hpp>
 
 namespace ze {
@@ -93,37 +94,51 @@ void PoseOptimizer::setPrior(
   prior_weight_rot_ = prior_weight_rot;
 }
 
+//------------------------------------------------------------------------------
+void PoseOptimizer::setThreadPool(ThreadPool* thread_pool, uint32_t chunk_size)
+{
+  CHECK_GT(chunk_size, 0u);
+  thread_pool_ = thread_pool;
+  parallel_chunk_size_ = chunk_size;
+}
+
 //------------------------------------------------------------------------------
 real_t PoseOptimizer::evaluateError(
     const Transformation& T_B_W, HessianMatrix* H, GradientVector* g)
 {
   real_t chi2 = real_t{0.0};
-
-  // Loop over all cameras in rig.
-  VLOG(400) << "Num residual blocks = " << data_.size();
-  for (auto& residual_block : data_)
+  if (thread_pool_)
   {
-    VLOG(400) << "Process residual block " << residual_block.camera_idx;
-    if (residual_block.kp_idx.size() == 0 && residual_block.lines_W.empty())
-    {
-      VLOG(40) << "Residual block has no measurements.";
-      continue;
-    }
-
-    switch (residual_block.type)
+    chi2 = evaluateErrorParallel(T_B_W, H, g);
+  }
+  else
+  {
+    // Loop over all cameras in rig.
+    VLOG(400) << "Num residual blocks = " << data_.size();
+    for (auto& residual_block : data_)
     {
-      case PoseOptimizerResidualType::Bearing:
-        chi2 += evaluateBearingErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
-        break;
-      case PoseOptimizerResidualType::UnitPlane:
-        chi2 += evaluateUnitPlaneErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
-        break;
-      case PoseOptimizerResidualType::Line:
-        chi2 += evaluateLineErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
-        break;
-      default:
-        LOG(FATAL) << "Residual type not implemented.";
-        break;
+      VLOG(400) << "Process residual block " << residual_block.camera_idx;
+      if (residual_block.kp_idx.size() == 0 && residual_block.lines_W.empty())
+      {
+        VLOG(40) << "Residual block has no measurements.";
+        continue;
+      }
+
+      switch (residual_block.type)
+      {
+        case PoseOptimizerResidualType::Bearing:
+          chi2 += evaluateBearingErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
+          break;
+        case PoseOptimizerResidualType::UnitPlane:
+          chi2 += evaluateUnitPlaneErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
+          break;
+        case PoseOptimizerResidualType::Line:
+          chi2 += evaluateLineErrors(T_B_W, iter_ == 0, residual_block, H, g).first;
+          break;
+        default:
+          LOG(FATAL) << "Residual type not implemented.";
+          break;
+      }
     }
   }
 
@@ -136,73 +151,104 @@ real_t PoseOptimizer::evaluateError(
   return chi2;
 }
 
+namespace {
+
+//! Errors and robust weights of a residual block at the linearization point.
+//! They are computed for the whole block before the Hessian is accumulated
+//! because the scale of the robust cost function depends on all errors.
+struct ResidualBlockErrors
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  Transformation T_C_W;
+  Positions p_C;
+  Matrix3X line_measurements_W;
+  Bearings f_err;
+  Matrix2X err;
+  VectorX err_norm;
+  VectorX weights;
+  real_t chi2 = real_t{0.0};
+};
+
+//! Hessian and gradient of a subset of the measurements.
+struct NormalEquations
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  PoseOptimizer::HessianMatrix H;
+  PoseOptimizer::GradientVector g;
+};
+
 //------------------------------------------------------------------------------
-std::pair<real_t, VectorX> evaluateBearingErrors(
+void computeBearingErrors(
     const Transformation& T_B_W,
     const bool first_iteration,
     PoseOptimizerFrameData& data,
-    PoseOptimizer::HessianMatrix* H,
-    PoseOptimizer::GradientVector* g)
+    ResidualBlockErrors& e)
 {
   // Transform points from world coordinates to camera coordinates.
-  const Transformation T_C_W = data.T_C_B * T_B_W;
-  Positions p_C = T_C_W.transformVectorized(data.p_W);
+  e.T_C_W = data.T_C_B * T_B_W;
+  e.p_C = e.T_C_W.transformVectorized(data.p_W);
 
   // Normalize points to obtain estimated bearing vectors.
-  Bearings f_est = p_C;
+  Bearings f_est = e.p_C;
   normalizeBearings(f_est);
 
   // Compute difference between bearing vectors.
-  Bearings f_err = f_est - data.f;
-  VectorX f_err_norm = f_err.colwise().norm();
+  e.f_err = f_est - data.f;
+  e.err_norm = e.f_err.colwise().norm();
 
   // Account that features at higher levels have higher uncertainty.
-  f_err_norm.array() /= data.scale.array();
+  e.err_norm.array() /= data.scale.array();
 
   // At the first iteration, compute the scale of the error.
   if (first_iteration)
   {
-    data.measurement_sigma = PoseOptimizer::ScaleEstimator::compute(f_err_norm);
+    data.measurement_sigma = PoseOptimizer::ScaleEstimator::compute(e.err_norm);
   }
 
   // Robust cost function.
-  VectorX weights = PoseOptimizer::WeightFunction::weightVectorized(
-                      f_err_norm.array() / data.measurement_sigma);
+  e.weights = PoseOptimizer::WeightFunction::weightVectorized(
+                e.err_norm.array() / data.measurement_sigma);
 
   // Instead of whitening the error and the Jacobian, we apply sigma to the weights:
-  weights.array() /= (data.scale.array() * data.measurement_sigma * data.measurement_sigma);
+  e.weights.array() /= (data.scale.array() * data.measurement_sigma * data.measurement_sigma);
 
-  if (H && g)
+  // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
+  e.chi2 = real_t{0.5} * e.weights.dot(e.f_err.colwise().squaredNorm());
+}
+
+//------------------------------------------------------------------------------
+void accumulateBearingErrors(
+    const PoseOptimizerFrameData& data,
+    const ResidualBlockErrors& e,
+    const int begin,
+    const int end,
+    PoseOptimizer::HessianMatrix& H,
+    PoseOptimizer::GradientVector& g)
+{
+  const Matrix3 R_C_W = e.T_C_W.getRotationMatrix();
+  Matrix36 G;
+  G.block<3,3>(0,0) = I_3x3;
+  for (int i = begin; i < end; ++i)
   {
-    const Matrix3 R_C_W = T_C_W.getRotationMatrix();
-    const int n = data.f.cols();
-    Matrix36 G;
-    G.block<3,3>(0,0) = I_3x3;
-    for (int i = 0; i < n; ++i)
-    {
-      // Jacobian computation.
-      G.block<3,3>(0,3) = -skewSymmetric(data.p_W.col(i));
-      Matrix3 J_normalization = dBearing_dLandmark(p_C.col(i));
-      Matrix36 J = J_normalization * R_C_W * G;
-
-      // Compute Hessian and Gradient Vector.
-      H->noalias() += J.transpose() * J * weights(i);
-      g->noalias() -= J.transpose() * f_err.col(i) * weights(i);
-    }
+    // Jacobian computation.
+    G.block<3,3>(0,3) = -skewSymmetric(data.p_W.col(i));
+    Matrix3 J_normalization = dBearing_dLandmark(e.p_C.col(i));
+    Matrix36 J = J_normalization * R_C_W * G;
+
+    // Compute Hessian and Gradient Vector.
+    H.noalias() += J.transpose() * J * e.weights(i);
+    g.noalias() -= J.transpose() * e.f_err.col(i) * e.weights(i);
   }
-
-  // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
-  return std::make_pair(real_t{0.5} * weights.dot(f_err.colwise().squaredNorm()),
-                        f_err_norm);
 }
 
 //------------------------------------------------------------------------------
-std::pair<real_t, VectorX> evaluateUnitPlaneErrors(
+void computeUnitPlaneErrors(
     const Transformation& T_B_W,
     const bool first_iteration,
     PoseOptimizerFrameData& data,
-    PoseOptimizer::HessianMatrix* H,
-    PoseOptimizer::GradientVector* g)
+    ResidualBlockErrors& e)
 {
   if (first_iteration)
   {
@@ -210,107 +256,309 @@ std::pair<real_t, VectorX> evaluateUnitPlaneErrors(
   }
 
   // Transform points from world coordinates to camera coordinates.
-  const Transformation T_C_W = data.T_C_B * T_B_W;
-  Positions p_C = T_C_W.transformVectorized(data.p_W);
+  e.T_C_W = data.T_C_B * T_B_W;
+  e.p_C = e.T_C_W.transformVectorized(data.p_W);
 
   // Compute difference on unit plane.
-  Keypoints uv_err = project2Vectorized(p_C) - data.uv;
-  VectorX uv_err_norm = uv_err.colwise().norm();
+  e.err = project2Vectorized(e.p_C) - data.uv;
+  e.err_norm = e.err.colwise().norm();
 
   // Account that features at higher levels have higher uncertainty.
-  uv_err_norm.array() /= data.scale.array();
+  e.err_norm.array() /= data.scale.array();
 
   // At the first iteration, compute the scale of the error.
   if (first_iteration)
   {
     data.measurement_sigma =
-        PoseOptimizer::ScaleEstimator::compute(uv_err_norm);
+        PoseOptimizer::ScaleEstimator::compute(e.err_norm);
   }
 
   // Robust cost function.
-  VectorX weights = PoseOptimizer::WeightFunction::weightVectorized(
-                      uv_err_norm.array() / data.measurement_sigma);
+  e.weights = PoseOptimizer::WeightFunction::weightVectorized(
+                e.err_norm.array() / data.measurement_sigma);
 
   // Instead of whitening the error and the Jacobian, we apply sigma to the weights:
-  weights.array() /= (data.scale.array() * data.measurement_sigma * data.measurement_sigma);
+  e.weights.array() /= (data.scale.array() * data.measurement_sigma * data.measurement_sigma);
 
-  if (H && g)
+  // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
+  e.chi2 = real_t{0.5} * e.weights.dot(e.err.colwise().squaredNorm());
+}
+
+//------------------------------------------------------------------------------
+void accumulateUnitPlaneErrors(
+    const PoseOptimizerFrameData& data,
+    const ResidualBlockErrors& e,
+    const int begin,
+    const int end,
+    PoseOptimizer::HessianMatrix& H,
+    PoseOptimizer::GradientVector& g)
+{
+  const Matrix3 R_C_W = e.T_C_W.getRotationMatrix();
+  Matrix36 G;
+  G.block<3,3>(0,0) = I_3x3;
+  for (int i = begin; i < end; ++i)
   {
-    const Matrix3 R_C_W = T_C_W.getRotationMatrix();
-    const int n = data.f.cols();
-    Matrix36 G;
-    G.block<3,3>(0,0) = I_3x3;
-    for (int i = 0; i < n; ++i)
-    {
-      // Jacobian computation.
-      G.block<3,3>(0,3) = -skewSymmetric(data.p_W.col(i));
-      Matrix23 J_proj = dUv_dLandmark(p_C.col(i));
-      Matrix26 J = J_proj * R_C_W * G;
-
-      // Compute Hessian and Gradient Vector.
-      H->noalias() += J.transpose() * J * weights(i);
-      g->noalias() -= J.transpose() * uv_err.col(i) * weights(i);
-    }
+    // Jacobian computation.
+    G.block<3,3>(0,3) = -skewSymmetric(data.p_W.col(i));
+    Matrix23 J_proj = dUv_dLandmark(e.p_C.col(i));
+    Matrix26 J = J_proj * R_C_W * G;
+
+    // Compute Hessian and Gradient Vector.
+    H.noalias() += J.transpose() * J * e.weights(i);
+    g.noalias() -= J.transpose() * e.err.col(i) * e.weights(i);
   }
-
-  // Compute log-likelihood : 1/(2*sigma^2)*(z-h(x))^2 = 1/2*e'R'*R*e
-  return std::make_pair(real_t{0.5} * weights.dot(uv_err.colwise().squaredNorm()),
-                        uv_err_norm);
 }
 
 //------------------------------------------------------------------------------
-std::pair<real_t, VectorX> evaluateLineErrors(
+void computeLineErrors(
     const Transformation& T_B_W,
     const bool first_iteration,
     PoseOptimizerFrameData& data,
-    PoseOptimizer::HessianMatrix* H,
-    PoseOptimizer::GradientVector* g)
+    ResidualBlockErrors& e)
 {
-  const Transformation T_C_W = data.T_C_B * T_B_W;
-  const Matrix3 R_C_W = T_C_W.getRotationMatrix();
-  const Vector3 camera_pos_W = T_C_W.inverse().getPosition();
+  e.T_C_W = data.T_C_B * T_B_W;
+  const Matrix3 R_C_W = e.T_C_W.getRotationMatrix();
+  const Vector3 camera_pos_W = e.T_C_W.inverse().getPosition();
   // Compute error.
-  const Matrix3X line_measurements_W = R_C_W.transpose() * data.line_measurements_C;
+  e.line_measurements_W = R_C_W.transpose() * data.line_measurements_C;
   const size_t n = data.line_measurements_C.cols();
-  Matrix2X error(2, n);
+  e.err.resize(2, n);
   for (size_t i = 0; i < n; ++i)
   {
-    error.col(i) = data.lines_W[i].calculateMeasurementError(line_measurements_W.col(i),
+    e.err.col(i) = data.lines_W[i].calculateMeasurementError(e.line_measurements_W.col(i),
                                                              camera_pos_W);
   }
-  VectorX error_norm = error.colwise().norm();
+  e.err_norm = e.err.colwise().norm();
 
   // At the first iteration, compute the scale of the error.
   if (first_iteration)
   {
-    data.measurement_sigma = PoseOptimizer::ScaleEstimator::compute(error_norm);
+    data.measurement_sigma = PoseOptimizer::ScaleEstimator::compute(e.err_norm);
   }
 
   // Robust cost function.
-  VectorX weights(n);
-  weights.setOnes();
+  e.weights.resize(n);
+  e.weights.setOnes();
 
   // Instead of whitening the error and the Jacobian, we apply sigma to the weights:
   // weights.array() /= (data.measurement_sigma * data.measurement_sigma);
 
+  e.chi2 = real_t{0.5} * e.weights.dot(e.err.colwise().squaredNorm());
+}
+
+//------------------------------------------------------------------------------
+void accumulateLineErrors(
+    const Transformation& T_B_W,
+    const PoseOptimizerFrameData& data,
+    const ResidualBlockErrors& e,
+    const int begin,
+    const int end,
+    PoseOptimizer::HessianMatrix& H,
+    PoseOptimizer::GradientVector& g)
+{
+  for (int i = begin; i < end; ++i)
+  {
+    // Jacobian computation.
+    Matrix26 J = dLineMeasurement_dPose(T_B_W, data.T_C_B,
+                                        e.line_measurements_W.col(i),
+                                        data.lines_W[i].anchorPoint(),
+                                        data.lines_W[i].direction());
+
+    // Compute Hessian and Gradient Vector.
+    H.noalias() += J.transpose() * J * e.weights(i);
+    g.noalias() -= J.transpose() * e.err.col(i) * e.weights(i);
+  }
+}
+
+//------------------------------------------------------------------------------
+int numMeasurements(const PoseOptimizerFrameData& data)
+{
+  return data.type == PoseOptimizerResidualType::Line
+      ? data.line_measurements_C.cols() : data.f.cols();
+}
+
+//------------------------------------------------------------------------------
+void computeErrors(
+    const Transformation& T_B_W,
+    const bool first_iteration,
+    PoseOptimizerFrameData& data,
+    ResidualBlockErrors& e)
+{
+  switch (data.type)
+  {
+    case PoseOptimizerResidualType::Bearing:
+      computeBearingErrors(T_B_W, first_iteration, data, e);
+      break;
+    case PoseOptimizerResidualType::UnitPlane:
+      computeUnitPlaneErrors(T_B_W, first_iteration, data, e);
+      break;
+    case PoseOptimizerResidualType::Line:
+      computeLineErrors(T_B_W, first_iteration, data, e);
+      break;
+    default:
+      LOG(FATAL) << "Residual type not implemented.";
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+void accumulateErrors(
+    const Transformation& T_B_W,
+    const PoseOptimizerFrameData& data,
+    const ResidualBlockErrors& e,
+    const int begin,
+    const int end,
+    PoseOptimizer::HessianMatrix& H,
+    PoseOptimizer::GradientVector& g)
+{
+  switch (data.type)
+  {
+    case PoseOptimizerResidualType::Bearing:
+      accumulateBearingErrors(data, e, begin, end, H, g);
+      break;
+    case PoseOptimizerResidualType::UnitPlane:
+      accumulateUnitPlaneErrors(data, e, begin, end, H, g);
+      break;
+    case PoseOptimizerResidualType::Line:
+      accumulateLineErrors(T_B_W, data, e, begin, end, H, g);
+      break;
+    default:
+      LOG(FATAL) << "Residual type not implemented.";
+      break;
+  }
+}
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+real_t PoseOptimizer::evaluateErrorParallel(
+    const Transformation& T_B_W, HessianMatrix* H, GradientVector* g)
+{
+  // Errors and weights per residual block (i.e., camera in rig).
+  std::vector<ResidualBlockErrors, Eigen::aligned_allocator<ResidualBlockErrors>>
+      errors(data_.size());
+  std::vector<uint8_t> has_measurements(data_.size(), 0u);
+  const bool first_iteration = iter_ == 0;
+  thread_pool_->parallelFor(0u, data_.size(), 1u, [&](size_t i)
+  {
+    if (data_[i].kp_idx.size() == 0 && data_[i].lines_W.empty())
+    {
+      return;
+    }
+    has_measurements[i] = 1u;
+    computeErrors(T_B_W, first_iteration, data_[i], errors[i]);
+  });
+
+  // Sum up in order of the residual blocks, as in the serial evaluation.
+  real_t chi2 = real_t{0.0};
+  for (size_t i = 0u; i < data_.size(); ++i)
+  {
+    chi2 += errors[i].chi2;
+  }
+
   if (H && g)
   {
-    for (size_t i = 0; i < n; ++i)
+    // Split the measurements of all residual blocks in chunks of fixed size.
+    // Every chunk is accumulated separately and the chunks are reduced in
+    // order, hence the result does not depend on the number of threads.
+    struct MeasurementChunk
+    {
+      size_t block;
+      int begin;
+      int end;
+    };
+    std::vector<MeasurementChunk> chunks;
+    const int chunk_size = static_cast<int>(parallel_chunk_size_);
+    for (size_t i = 0u; i < data_.size(); ++i)
     {
-      // Jacobian computation.
-      Matrix26 J = dLineMeasurement_dPose(T_B_W, data.T_C_B,
-                                          line_measurements_W.col(i),
-                                          data.lines_W[i].anchorPoint(),
-                                          data.lines_W[i].direction());
-
-      // Compute Hessian and Gradient Vector.
-      H->noalias() += J.transpose() * J * weights(i);
-      g->noalias() -= J.transpose() * error.col(i) * weights(i);
+      if (!has_measurements[i])
+      {
+        continue;
+      }
+      const int n = numMeasurements(data_[i]);
+      for (int begin = 0; begin < n; begin += chunk_size)
+      {
+        chunks.push_back({i, begin, std::min(n, begin + chunk_size)});
+      }
     }
+
+    NormalEquations zero;
+    zero.H.setZero();
+    zero.g.setZero();
+    NormalEquations sum = thread_pool_->parallelReduce(
+          0u, chunks.size(), 1u, zero,
+          [&](size_t chunk_begin, size_t chunk_end, NormalEquations& acc)
+    {
+      for (size_t c = chunk_begin; c < chunk_end; ++c)
+      {
+        const MeasurementChunk& chunk = chunks[c];
+        accumulateErrors(T_B_W, data_[chunk.block], errors[chunk.block],
+                         chunk.begin, chunk.end, acc.H, acc.g);
+      }
+    },
+    [](const NormalEquations& lhs, const NormalEquations& rhs)
+    {
+      NormalEquations res;
+      res.H = lhs.H + rhs.H;
+      res.g = lhs.g + rhs.g;
+      return res;
+    });
+    *H += sum.H;
+    *g += sum.g;
+  }
+
+  return chi2;
+}
+
+//------------------------------------------------------------------------------
+std::pair<real_t, VectorX> evaluateBearingErrors(
+    const Transformation& T_B_W,
+    const bool first_iteration,
+    PoseOptimizerFrameData& data,
+    PoseOptimizer::HessianMatrix* H,
+    PoseOptimizer::GradientVector* g)
+{
+  ResidualBlockErrors e;
+  computeBearingErrors(T_B_W, first_iteration, data, e);
+  if (H && g)
+  {
+    accumulateBearingErrors(data, e, 0, data.f.cols(), *H, *g);
   }
+  return std::make_pair(e.chi2, e.err_norm);
+}
 
-  return std::make_pair(real_t{0.5} * weights.dot(error.colwise().squaredNorm()),
-                        error_norm);
+//------------------------------------------------------------------------------
+std::pair<real_t, VectorX> evaluateUnitPlaneErrors(
+    const Transformation& T_B_W,
+    const bool first_iteration,
+    PoseOptimizerFrameData& data,
+    PoseOptimizer::HessianMatrix* H,
+    PoseOptimizer::GradientVector* g)
+{
+  ResidualBlockErrors e;
+  computeUnitPlaneErrors(T_B_W, first_iteration, data, e);
+  if (H && g)
+  {
+    accumulateUnitPlaneErrors(data, e, 0, data.f.cols(), *H, *g);
+  }
+  return std::make_pair(e.chi2, e.err_norm);
+}
+
+//------------------------------------------------------------------------------
+std::pair<real_t, VectorX> evaluateLineErrors(
+    const Transformation& T_B_W,
+    const bool first_iteration,
+    PoseOptimizerFrameData& data,
+    PoseOptimizer::HessianMatrix* H,
+    PoseOptimizer::GradientVector* g)
+{
+  ResidualBlockErrors e;
+  computeLineErrors(T_B_W, first_iteration, data, e);
+  if (H && g)
+  {
+    accumulateLineErrors(T_B_W, data, e, 0, data.line_measurements_C.cols(), *H, *g);
+  }
+  return std::make_pair(e.chi2, e.err_norm);
 }
 
 //------------------------------------------------------------------------------
@@ -25,9 +25,10 @@
 
 #include <ze/geometry/ransac_relative_pose.hpp>
 
+#include <numeric>
+
 #include <glog/logging.h>
 
-#include <opengv/sac/Ransac.hpp>
 #include <opengv/sac_problems/relative_pose/CentralRelativePoseSacProblem.hpp>
 #include <opengv/sac_problems/relative_pose/TranslationOnlySacProblem.hpp>
 #include <opengv/sac_problems/relative_pose/RotationOnlySacProblem.hpp>
@@ -40,12 +41,29 @@
 
 namespace ze {
 
+namespace {
+
+Transformation transformationFromModel(const opengv::transformation_t& model)
+{
+  Matrix3 R = model.leftCols<3>().cast<real_t>();
+  Vector3 t = model.rightCols<1>().cast<real_t>();
+  return Transformation(Eigen::Quaternion<real_t>(R).normalized(), t);
+}
+
+Transformation transformationFromModel(const opengv::rotation_t& model)
+{
+  Matrix3 R = model.cast<real_t>();
+  return Transformation(Eigen::Quaternion<real_t>(R).normalized(), Vector3::Zero());
+}
+
+} // anonymous namespace
+
 RansacRelativePose::RansacRelativePose(
     const Camera& cam,
     const real_t& reprojection_threshold_px)
-  : ogv_threshold_(
-      1.0 - std::cos(cam.getApproxAnglePerPixel() * reprojection_threshold_px))
 {
+  options_.threshold =
+      1.0 - std::cos(cam.getApproxAnglePerPixel() * reprojection_threshold_px);
   VLOG(3) << "RANSAC THRESHOLD = " << cam.getApproxAnglePerPixel() * reprojection_threshold_px;
 }
 
@@ -53,30 +71,32 @@ bool RansacRelativePose::solve(
       const Bearings& f_ref,
       const Bearings& f_cur,
       const RelativePoseAlgorithm method,
-      Transformation& T_cur_ref)
+      Transformation& T_cur_ref,
+      const VectorX& match_scores)
 {
   BearingsVector f_ref_v = bearingsVectorFromBearings(f_ref);
   BearingsVector f_cur_v = bearingsVectorFromBearings(f_cur);
-  return solve(f_ref_v, f_cur_v, method, T_cur_ref);
+  return solve(f_ref_v, f_cur_v, method, T_cur_ref, match_scores);
 }
 
 bool RansacRelativePose::solve(
     const BearingsVector& f_ref,
     const BearingsVector& f_cur,
     const RelativePoseAlgorithm method,
-    Transformation& T_cur_ref)
+    Transformation& T_cur_ref,
+    const VectorX& match_scores)
 {
   CHECK_EQ(f_ref.size(), f_cur.size());
   switch(method)
   {
     case RelativePoseAlgorithm::FivePoint:
-      return solveRelativePose(f_ref, f_cur, T_cur_ref);
+      return solveRelativePose(f_ref, f_cur, T_cur_ref, match_scores);
       break;
     case RelativePoseAlgorithm::TwoPointTranslationOnly:
-      return solveTranslationOnly(f_ref, f_cur, T_cur_ref);
+      return solveTranslationOnly(f_ref, f_cur, T_cur_ref, match_scores);
       break;
     case RelativePoseAlgorithm::TwoPointRotationOnly:
-      return solveRotationOnly(f_ref, f_cur, T_cur_ref);
+      return solveRotationOnly(f_ref, f_cur, T_cur_ref, match_scores);
       break;
     default:
       LOG(FATAL) << "Algorithm not implemented";
@@ -85,43 +105,61 @@ bool RansacRelativePose::solve(
   return false;
 }
 
+// -----------------------------------------------------------------------------
+template<typename Problem>
+bool RansacRelativePose::solveProblem(
+    Problem& problem,
+    const uint32_t num_measurements,
+    const VectorX& match_scores,
+    Transformation& T_cur_ref)
+{
+  // PROSAC ordering: best matches first.
+  std::vector<int> ordering;
+  if (match_scores.size() > 0)
+  {
+    CHECK_EQ(match_scores.size(), num_measurements);
+    ordering.resize(num_measurements);
+    std::iota(ordering.begin(), ordering.end(), 0);
+    std::stable_sort(ordering.begin(), ordering.end(), [&](int lhs, int rhs)
+    {
+      return match_scores(lhs) > match_scores(rhs);
+    });
+  }
+
+  Ransac<Problem> ransac(options_);
+  const bool success = ransac.computeModel(problem, num_measurements, ordering);
+  summary_ = ransac.summary();
+  num_measurements_ = num_measurements;
+  if (!success)
+  {
+    inliers_.clear();
+    return false;
+  }
+
+  T_cur_ref = transformationFromModel(ransac.model());
+  inliers_ = ransac.inliers();
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 bool RansacRelativePose::solveRelativePose(
     const BearingsVector& f_ref,
     const BearingsVector& f_cur,
-    Transformation& T_cur_ref)
+    Transformation& T_cur_ref,
+    const VectorX& match_scores)
 {
-  // Setup problem.
-  //! @todo: Unify all the repetitive code.
   using Problem = opengv::sac_problems::relative_pose::CentralRelativePoseSacProblem;
   using Adapter = opengv::relative_pose::CentralRelativeAdapter;
   Adapter adapter(f_cur, f_ref);
-  boost::shared_ptr<Problem> problem(new Problem(adapter, Problem::NISTER));
-  opengv::sac::Ransac<Problem> ransac;
-  ransac.sac_model_ = problem;
-  ransac.threshold_ = ogv_threshold_;
-  ransac.max_iterations_ = ogv_max_iterations_;
-  ransac.probability_ = ogv_init_probability_;
-
-  // Solve.
-  if(!ransac.computeModel(ogv_verbosity_level_))
+  Problem problem(adapter, Problem::NISTER);
+  if (!solveProblem(problem, f_ref.size(), match_scores, T_cur_ref))
   {
     LOG(WARNING) << "5Pt RANSAC could not find a solution";
     return false;
   }
   VLOG(10) << "5Pt RANSAC:"
-           << ", #iter = " << ransac.iterations_
-           << ", #inliers = " << ransac.inliers_.size();
-
-  // Process results.
-  Matrix3 R = ransac.model_coefficients_.leftCols<3>().cast<real_t>();
-  Vector3 t = ransac.model_coefficients_.rightCols<1>().cast<real_t>();
-  T_cur_ref = Transformation(Eigen::Quaternion<real_t>(R).normalized(), t);
-
-  result_probability_ = ransac.probability_;
-  num_iterations_ = ransac.iterations_;
-  inliers_ = ransac.inliers_;
-  num_measurements_ = f_ref.size();
+           << ", #iter = " << summary_.num_iterations
+           << ", #inliers = " << inliers_.size();
   return true;
 }
 
@@ -129,39 +167,21 @@ bool RansacRelativePose::solveRelativePose(
 bool RansacRelativePose::solveTranslationOnly(
     const BearingsVector& f_ref,
     const BearingsVector& f_cur,
-    Transformation& T_cur_ref)
+    Transformation& T_cur_ref,
+    const VectorX& match_scores)
 {
-  // Setup Problem.
-  //! @todo: Unify all the repetitive code.
   using Problem = opengv::sac_problems::relative_pose::TranslationOnlySacProblem;
   using Adapter = opengv::relative_pose::CentralRelativeAdapter;
   Adapter adapter(f_cur, f_ref, T_cur_ref.getRotationMatrix().cast<double>());
-  boost::shared_ptr<Problem> problem(new Problem(adapter));
-  opengv::sac::Ransac<Problem> ransac;
-  ransac.sac_model_ = problem;
-  ransac.threshold_ = ogv_threshold_;
-  ransac.max_iterations_ = ogv_max_iterations_;
-  ransac.probability_ = ogv_init_probability_;
-
-  // Solve.
-  if(!ransac.computeModel(ogv_verbosity_level_))
+  Problem problem(adapter);
+  if (!solveProblem(problem, f_ref.size(), match_scores, T_cur_ref))
   {
     LOG(WARNING) << "2Pt RANSAC could not find a solution";
     return false;
   }
   VLOG(10) << "2pt RANSAC:"
-           << ", #iter = " << ransac.iterations_
-           << ", #inliers = " << ransac.inliers_.size();
-
-  // Process results.
-  Matrix3 R = ransac.model_coefficients_.leftCols<3>().cast<real_t>();
-  Vector3 t = ransac.model_coefficients_.rightCols<1>().cast<real_t>();
-  T_cur_ref = Transformation(Eigen::Quaternion<real_t>(R).normalized(), t);
-
-  result_probability_ = ransac.probability_;
-  num_iterations_ = ransac.iterations_;
-  inliers_ = ransac.inliers_;
-  num_measurements_ = f_ref.size();
+           << ", #iter = " << summary_.num_iterations
+           << ", #inliers = " << inliers_.size();
   return true;
 }
 
@@ -169,38 +189,21 @@ bool RansacRelativePose::solveTranslationOnly(
 bool RansacRelativePose::solveRotationOnly(
     const BearingsVector& f_ref,
     const BearingsVector& f_cur,
-    Transformation& T_cur_ref)
+    Transformation& T_cur_ref,
+    const VectorX& match_scores)
 {
-  // Setup Problem.
-  //! @todo: Unify all the repetitive code.
   using Problem = opengv::sac_problems::relative_pose::RotationOnlySacProblem;
-  opengv::relative_pose::CentralRelativeAdapter adapter(f_cur, f_ref);
-  boost::shared_ptr<Problem> problem(new Problem(adapter));
-  opengv::sac::Ransac<Problem> ransac;
-  ransac.sac_model_ = problem;
-  ransac.threshold_ = ogv_threshold_;
-  ransac.max_iterations_ = ogv_max_iterations_;
-  ransac.probability_ = ogv_init_probability_;
-
-  // Solve.
-  if(!ransac.computeModel(ogv_verbosity_level_))
+  using Adapter = opengv::relative_pose::CentralRelativeAdapter;
+  Adapter adapter(f_cur, f_ref);
+  Problem problem(adapter);
+  if (!solveProblem(problem, f_ref.size(), match_scores, T_cur_ref))
   {
     LOG(WARNING) << "2Pt RANSAC could not find a solution";
     return false;
   }
   VLOG(10) << "2pt Rotation-Only RANSAC:"
-           << ", #iter = " << ransac.iterations_
-           << ", #inliers = " << ransac.inliers_.size();
-
-  // Process results.
-  Matrix3 R = ransac.model_coefficients_.leftCols<3>().cast<real_t>();
-  Vector3 t = ransac.model_coefficients_.rightCols<1>().cast<real_t>();
-  T_cur_ref = Transformation(Eigen::Quaternion<real_t>(R).normalized(), t);
-
-  result_probability_ = ransac.probability_;
-  num_iterations_ = ransac.iterations_;
-  inliers_ = ransac.inliers_;
-  num_measurements_ = f_ref.size();
+           << ", #iter = " << summary_.num_iterations
+           << ", #inliers = " << inliers_.size();
   return true;
 }
 
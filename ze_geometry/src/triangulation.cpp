@@ -26,6 +26,7 @@
 #include <ze/geometry/triangulation.hpp>
 
 #include <algorithm>
+#include <limits>
 #include <ze/common/logging.hpp>
 #include <ze/common/matrix.hpp>
 #include <ze/common/manifold.hpp>
@@ -33,6 +34,147 @@
 
 namespace ze {
 
+namespace {
+
+//! Round-off bound of the A^T * A eigenvalues in units of eps * trace.
+constexpr real_t c_eigenvalue_tol_factor = 64.0;
+
+//! One value per point of a batch, processed in SIMD lanes.
+using Lanes = Eigen::Array<real_t, c_triangulation_batch_size, 1>;
+using LaneMask = Eigen::Array<bool, c_triangulation_batch_size, 1>;
+
+//! Batch of 3d vectors in structure-of-arrays layout.
+struct Vector3Lanes
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  Lanes x, y, z;
+
+  //! Loads the columns [begin, begin + n) of M. The remaining lanes repeat the
+  //! last column so that they hold valid data.
+  void load(const Matrix3X& M, int begin, int n)
+  {
+    for (int k = 0; k < c_triangulation_batch_size; ++k)
+    {
+      const int col = begin + std::min(k, n - 1);
+      x(k) = M(0, col);
+      y(k) = M(1, col);
+      z(k) = M(2, col);
+    }
+  }
+
+  void store(Matrix3X& M, int begin, int n) const
+  {
+    for (int k = 0; k < n; ++k)
+    {
+      M(0, begin + k) = x(k);
+      M(1, begin + k) = y(k);
+      M(2, begin + k) = z(k);
+    }
+  }
+};
+
+inline Lanes dot(const Vector3Lanes& a, const Vector3Lanes& b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+//! R * a + t
+inline Vector3Lanes transform(const Matrix3& R, const Vector3& t, const Vector3Lanes& a)
+{
+  Vector3Lanes b;
+  b.x = R(0,0) * a.x + R(0,1) * a.y + R(0,2) * a.z + t(0);
+  b.y = R(1,0) * a.x + R(1,1) * a.y + R(1,2) * a.z + t(1);
+  b.z = R(2,0) * a.x + R(2,1) * a.y + R(2,2) * a.z + t(2);
+  return b;
+}
+
+//! Closed-form midpoint triangulation, see triangulateNonLinear.
+Vector3Lanes triangulateNonLinearLanes(
+    const Matrix3& R_A_B, const Vector3& t_A_B,
+    const Vector3Lanes& f_A, const Vector3Lanes& f_B)
+{
+  const Vector3Lanes f_A_hat = transform(R_A_B, Vector3::Zero(), f_B);
+  const Lanes b0 = t_A_B(0) * f_A.x + t_A_B(1) * f_A.y + t_A_B(2) * f_A.z;
+  const Lanes b1 = t_A_B(0) * f_A_hat.x + t_A_B(1) * f_A_hat.y + t_A_B(2) * f_A_hat.z;
+  const Lanes a00 = dot(f_A, f_A);
+  const Lanes a10 = dot(f_A, f_A_hat);
+  const Lanes a01 = -a10;
+  const Lanes a11 = -dot(f_A_hat, f_A_hat);
+  const Lanes inv_det = (a00 * a11 - a01 * a10).inverse();
+  const Lanes lambda0 = (a11 * b0 - a01 * b1) * inv_det;
+  const Lanes lambda1 = (a00 * b1 - a10 * b0) * inv_det;
+  Vector3Lanes p_A;
+  p_A.x = 0.5 * (lambda0 * f_A.x + t_A_B(0) + lambda1 * f_A_hat.x);
+  p_A.y = 0.5 * (lambda0 * f_A.y + t_A_B(1) + lambda1 * f_A_hat.y);
+  p_A.z = 0.5 * (lambda0 * f_A.z + t_A_B(2) + lambda1 * f_A_hat.z);
+  return p_A;
+}
+
+//! Symmetric 3x3 normal equations in lanes.
+struct NormalEquationsLanes
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  Lanes A00, A01, A02, A11, A12, A22;
+  Lanes b0, b1, b2;
+  Lanes chi2;
+
+  void setZero()
+  {
+    A00.setZero(); A01.setZero(); A02.setZero();
+    A11.setZero(); A12.setZero(); A22.setZero();
+    b0.setZero(); b1.setZero(); b2.setZero();
+    chi2.setZero();
+  }
+
+  //! Adds the unit-plane error of the observation f of point p_C, where
+  //! p_C = R * p + t and J = dUv_dLandmark(p_C) * R.
+  void addObservation(const Matrix3& R, const Vector3Lanes& p_C, const Vector3Lanes& f)
+  {
+    const Lanes inv_z = p_C.z.inverse();
+    const Lanes u = p_C.x * inv_z;
+    const Lanes v = p_C.y * inv_z;
+    const Lanes inv_fz = f.z.inverse();
+    const Lanes e0 = u - f.x * inv_fz;
+    const Lanes e1 = v - f.y * inv_fz;
+    // dUv_dLandmark = [1/z, 0, -u/z; 0, 1/z, -v/z]
+    Lanes J0[3], J1[3];
+    for (int c = 0; c < 3; ++c)
+    {
+      J0[c] = inv_z * (R(0,c) - u * R(2,c));
+      J1[c] = inv_z * (R(1,c) - v * R(2,c));
+    }
+    A00 += J0[0] * J0[0] + J1[0] * J1[0];
+    A01 += J0[0] * J0[1] + J1[0] * J1[1];
+    A02 += J0[0] * J0[2] + J1[0] * J1[2];
+    A11 += J0[1] * J0[1] + J1[1] * J1[1];
+    A12 += J0[1] * J0[2] + J1[1] * J1[2];
+    A22 += J0[2] * J0[2] + J1[2] * J1[2];
+    b0 -= J0[0] * e0 + J1[0] * e1;
+    b1 -= J0[1] * e0 + J1[1] * e1;
+    b2 -= J0[2] * e0 + J1[2] * e1;
+    chi2 += e0 * e0 + e1 * e1;
+  }
+
+  //! Solves A * dp = b with the adjugate.
+  Vector3Lanes solve() const
+  {
+    const Lanes C00 = A11 * A22 - A12 * A12;
+    const Lanes C01 = A02 * A12 - A01 * A22;
+    const Lanes C02 = A01 * A12 - A02 * A11;
+    const Lanes C11 = A00 * A22 - A02 * A02;
+    const Lanes C12 = A01 * A02 - A00 * A12;
+    const Lanes C22 = A00 * A11 - A01 * A01;
+    const Lanes inv_det = (A00 * C00 + A01 * C01 + A02 * C02).inverse();
+    Vector3Lanes dp;
+    dp.x = (C00 * b0 + C01 * b1 + C02 * b2) * inv_det;
+    dp.y = (C01 * b0 + C11 * b1 + C12 * b2) * inv_det;
+    dp.z = (C02 * b0 + C12 * b1 + C22 * b2) * inv_det;
+    return dp;
+  }
+};
+
+} // anonymous namespace
+
 //------------------------------------------------------------------------------
 Position triangulateNonLinear(
     const Transformation& T_A_B,
@@ -67,17 +209,88 @@ void triangulateManyAndComputeAngularErrors(
   CHECK_EQ(f_A_vec.cols(), p_A.cols());
   CHECK_EQ(f_A_vec.cols(), reprojection_erors.size());
   const Transformation T_B_A = T_A_B.inverse();
-  for (int i = 0; i < f_A_vec.cols(); ++i)
+  const Matrix3 R_A_B = T_A_B.getRotationMatrix();
+  const Matrix3 R_B_A = T_B_A.getRotationMatrix();
+  Vector3Lanes f_A, f_B;
+  const int n = f_A_vec.cols();
+  for (int begin = 0; begin < n; begin += c_triangulation_batch_size)
   {
-    p_A.col(i) = triangulateNonLinear(T_A_B, f_A_vec.col(i), f_B_vec.col(i));
-    Bearing f_A_predicted = p_A.col(i).normalized();
-    Bearing f_B_predicted = (T_B_A * p_A.col(i)).normalized();
+    const int n_batch = std::min(c_triangulation_batch_size, n - begin);
+    f_A.load(f_A_vec, begin, n_batch);
+    f_B.load(f_B_vec, begin, n_batch);
+    const Vector3Lanes p = triangulateNonLinearLanes(R_A_B, T_A_B.getPosition(), f_A, f_B);
+    const Vector3Lanes p_B = transform(R_B_A, T_B_A.getPosition(), p);
 
     // Bearing-vector based outlier criterium (select threshold accordingly):
     // 1 - (f1' * f2) = 1 - cos(alpha) as used in OpenGV.
-    real_t reproj_error_1 = 1.0 - (f_A_vec.col(i).dot(f_A_predicted));
-    real_t reproj_error_2 = 1.0 - (f_B_vec.col(i).dot(f_B_predicted));
-    reprojection_erors(i) = reproj_error_1 + reproj_error_2;
+    const Lanes reproj_error_1 = 1.0 - dot(f_A, p) / dot(p, p).sqrt();
+    const Lanes reproj_error_2 = 1.0 - dot(f_B, p_B) / dot(p_B, p_B).sqrt();
+    p.store(p_A, begin, n_batch);
+    reprojection_erors.segment(begin, n_batch) =
+        (reproj_error_1 + reproj_error_2).head(n_batch);
+  }
+}
+
+//------------------------------------------------------------------------------
+void triangulateManyGaussNewton(
+    const Transformation& T_A_B,
+    const Bearings& f_A_vec,
+    const Bearings& f_B_vec,
+    Positions& p_A,
+    const uint32_t num_iterations)
+{
+  CHECK_EQ(f_A_vec.cols(), f_B_vec.cols());
+  CHECK_EQ(f_A_vec.cols(), p_A.cols());
+  const Transformation T_B_A = T_A_B.inverse();
+  const Matrix3 R_A_B = T_A_B.getRotationMatrix();
+  const Matrix3 R_B_A = T_B_A.getRotationMatrix();
+  const Vector3& t_B_A = T_B_A.getPosition();
+  constexpr real_t eps{1e-7};
+  Vector3Lanes f_A, f_B;
+  NormalEquationsLanes normal_equations;
+  const int n = f_A_vec.cols();
+  for (int begin = 0; begin < n; begin += c_triangulation_batch_size)
+  {
+    const int n_batch = std::min(c_triangulation_batch_size, n - begin);
+    f_A.load(f_A_vec, begin, n_batch);
+    f_B.load(f_B_vec, begin, n_batch);
+    Vector3Lanes p = triangulateNonLinearLanes(R_A_B, T_A_B.getPosition(), f_A, f_B);
+
+    // Lanes of parallel rays are not refined.
+    constexpr real_t inf = std::numeric_limits<real_t>::infinity();
+    LaneMask active = (p.x.abs() < inf) && (p.y.abs() < inf) && (p.z.abs() < inf);
+    Vector3Lanes p_old = p;
+    Lanes chi2 = Lanes::Zero();
+    for (uint32_t iter = 0u; iter < num_iterations && active.any(); ++iter)
+    {
+      normal_equations.setZero();
+      normal_equations.addObservation(Matrix3::Identity(), p, f_A);
+      normal_equations.addObservation(R_B_A, transform(R_B_A, t_B_A, p), f_B);
+      const Vector3Lanes dp = normal_equations.solve();
+
+      // Roll back lanes whose error increased or whose update failed.
+      LaneMask failed = active && !(dp.x == dp.x);
+      if (iter > 0u)
+      {
+        failed = failed || (active && (normal_equations.chi2 > chi2));
+      }
+      p.x = failed.select(p_old.x, p.x);
+      p.y = failed.select(p_old.y, p.y);
+      p.z = failed.select(p_old.z, p.z);
+      active = active && !failed;
+
+      // Update the active lanes.
+      p_old = p;
+      p.x = active.select(p.x + dp.x, p.x);
+      p.y = active.select(p.y + dp.y, p.y);
+      p.z = active.select(p.z + dp.z, p.z);
+      chi2 = active.select(normal_equations.chi2, chi2);
+
+      // Stop lanes that converged.
+      const Lanes dp_max = dp.x.abs().max(dp.y.abs()).max(dp.z.abs());
+      active = active && (dp_max > eps);
+    }
+    p.store(p_A, begin, n_batch);
   }
 }
 
@@ -118,6 +331,109 @@ std::pair<Vector4, bool> triangulateHomogeneousDLT(
   return std::make_pair(p_W_homogeneous, success);
 }
 
+//------------------------------------------------------------------------------
+void triangulateManyHomogeneousDLT(
+    const TransformationVector& T_C_W,
+    const std::vector<Bearings>& f_C,
+    HomPositions& p_W_homogeneous,
+    std::vector<bool>& success,
+    const real_t rank_tol)
+{
+  const size_t m = T_C_W.size();
+  CHECK_GE(m, 2u);
+  CHECK_EQ(f_C.size(), m);
+  const int n = f_C[0].cols();
+  for (size_t i = 1; i < m; ++i)
+  {
+    CHECK_EQ(f_C[i].cols(), n);
+  }
+  p_W_homogeneous.resize(4, n);
+  success.resize(n);
+
+  std::vector<Matrix34, Eigen::aligned_allocator<Matrix34>> projections(m);
+  for (size_t i = 0; i < m; ++i)
+  {
+    projections[i] = T_C_W[i].getTransformationMatrix().topRows<3>();
+  }
+
+  // Upper triangle of A^T * A, row-major.
+  constexpr int num_entries = 10;
+  Lanes AtA[num_entries];
+  Vector3Lanes f;
+  Eigen::SelfAdjointEigenSolver<Matrix4> eigen_solver;
+  for (int begin = 0; begin < n; begin += c_triangulation_batch_size)
+  {
+    const int n_batch = std::min(c_triangulation_batch_size, n - begin);
+    for (int k = 0; k < num_entries; ++k)
+    {
+      AtA[k].setZero();
+    }
+    for (size_t i = 0; i < m; ++i)
+    {
+      // Rows of the DLT matrix: uv(0) * P.row(2) - P.row(0) and
+      // uv(1) * P.row(2) - P.row(1).
+      f.load(f_C[i], begin, n_batch);
+      const Lanes inv_z = f.z.inverse();
+      const Lanes u = f.x * inv_z;
+      const Lanes v = f.y * inv_z;
+      const Matrix34& P = projections[i];
+      Lanes r0[4], r1[4];
+      for (int c = 0; c < 4; ++c)
+      {
+        r0[c] = u * P(2, c) - P(0, c);
+        r1[c] = v * P(2, c) - P(1, c);
+      }
+      int k = 0;
+      for (int r = 0; r < 4; ++r)
+      {
+        for (int c = r; c < 4; ++c)
+        {
+          AtA[k++] += r0[r] * r0[c] + r1[r] * r1[c];
+        }
+      }
+    }
+
+    for (int j = 0; j < n_batch; ++j)
+    {
+      Matrix4 M;
+      int k = 0;
+      for (int r = 0; r < 4; ++r)
+      {
+        for (int c = r; c < 4; ++c)
+        {
+          M(r, c) = M(c, r) = AtA[k++](j);
+        }
+      }
+      eigen_solver.compute(M);
+      // Eigenvalues are sorted increasingly, singular values of A are their
+      // roots. Forming A^T * A squares the condition number, its eigenvalues
+      // are only accurate up to about eps * trace. Accept rank >= 3 only if
+      // the second smallest one is clearly above rank_tol^2, otherwise decide
+      // on the singular values of A as the scalar version does.
+      const real_t lambda_tol = rank_tol * rank_tol
+          + c_eigenvalue_tol_factor * std::numeric_limits<real_t>::epsilon() * M.trace();
+      if (eigen_solver.eigenvalues()(1) > lambda_tol)
+      {
+        p_W_homogeneous.col(begin + j) = eigen_solver.eigenvectors().col(0);
+        success[begin + j] = true;
+      }
+      else
+      {
+        Bearings f_j(3, m);
+        for (size_t i = 0; i < m; ++i)
+        {
+          f_j.col(i) = f_C[i].col(begin + j);
+        }
+        Vector4 p_W_hom_j;
+        bool success_j;
+        std::tie(p_W_hom_j, success_j) = triangulateHomogeneousDLT(T_C_W, f_j, rank_tol);
+        p_W_homogeneous.col(begin + j) = p_W_hom_j;
+        success[begin + j] = success_j;
+      }
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 void triangulateGaussNewton(
     const TransformationVector& T_C_W,
@@ -100,4 +100,45 @@ TEST(AlignPosesTest, testOptimization)
   EXPECT_LT(T_err.log().norm(), 1.5e-5);
 }
 
+TEST(AlignPosesTest, testWindowedOptimization)
+{
+  using namespace ze;
+
+  const size_t n_poses = 30;
+  const size_t first_pose = 7;
+  const size_t num_poses = 12;
+
+  // Random trajectory and a noisy estimate of it.
+  TransformationVector T_W_A(n_poses);
+  TransformationVector T_W_B(n_poses);
+  for (size_t i = 0; i < n_poses; ++i)
+  {
+    T_W_A[i].setRandom(2.0);
+    T_W_B[i] = T_W_A[i] * Transformation::exp(0.01 * Vector6::Random());
+  }
+
+  // Aligning a window must give the same result as aligning a copy of it.
+  TransformationVector T_W_A_window(T_W_A.begin() + first_pose,
+                                    T_W_A.begin() + first_pose + num_poses);
+  TransformationVector T_W_B_window(T_W_B.begin() + first_pose,
+                                    T_W_B.begin() + first_pose + num_poses);
+
+  const real_t sigma_pos = 0.05;
+  const real_t sigma_rot = 5.0 / 180 * M_PI;
+  const Transformation T_A0_B0_init =
+      T_W_A[first_pose].inverse() * T_W_B[first_pose];
+
+  Transformation T_A0_B0_window = T_A0_B0_init;
+  PoseAligner problem_window(T_W_A, T_W_B, sigma_pos, sigma_rot,
+                             first_pose, num_poses);
+  problem_window.optimize(T_A0_B0_window);
+
+  Transformation T_A0_B0_copy = T_A0_B0_init;
+  PoseAligner problem_copy(T_W_A_window, T_W_B_window, sigma_pos, sigma_rot);
+  problem_copy.optimize(T_A0_B0_copy);
+
+  EXPECT_LT((T_A0_B0_window.inverse() * T_A0_B0_copy).log().norm(), 1e-10);
+  EXPECT_GT((T_A0_B0_window.inverse() * T_A0_B0_init).log().norm(), 1e-6);
+}
+
 ZE_UNITTEST_ENTRYPOINT
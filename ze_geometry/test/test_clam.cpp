@@ -248,7 +248,111 @@ TEST(ClamTests, testExperiment)
   }
 }
 
+TEST(ClamTests, testSchurComplementSolve)
+{
+  using namespace ze;
 
+  Transformation T_C_B, T_Bc_Br;
+  T_C_B.setRandom();
+  T_Bc_Br = Transformation::exp((Vector6() << 0.2, 0.2, 0.2, 0.1, 0.1, 0.1).finished());
+  Camera::Ptr cam = std::make_shared<PinholeCamera>(
+                      createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0));
+  CameraRig rig({T_C_B}, {cam}, "rig");
+
+  // Landmarks in front of the reference camera, observed in the current camera.
+  // The last landmark has no measurement.
+  const size_t n = 400;
+  Keypoints px_Cr = generateRandomKeypoints(cam->size(), 10, n);
+  Bearings f_Cr = cam->backProjectVectorized(px_Cr);
+  ClamLandmarks landmarks;
+  landmarks.f_Br = T_C_B.getRotation().inverse().rotateVectorized(f_Cr);
+  landmarks.origin_Br = T_C_B.inverse().getPosition().replicate(1, n);
+
+  ClamFrameData data;
+  data.T_C_B = T_C_B;
+  const Transformation T_Cc_Cr = T_C_B * T_Bc_Br * T_C_B.inverse();
+  for (size_t i = 0; i + 1 < n; ++i)
+  {
+    const Keypoint px_Cc = cam->project(T_Cc_Cr * (f_Cr.col(i) * 2.0));
+    data.landmark_measurements.push_back(
+          std::make_pair(i, px_Cc + Vector2(0.5, -0.5)));
+  }
+  std::vector<ClamFrameData> data_vec = { data };
+
+  Clam clam(landmarks, data_vec, rig, T_Bc_Br, 0.2, 10.0);
+  ClamState state;
+  state.at<0>() = T_Bc_Br * Transformation::exp(
+                    (Vector6() << 0.01, 0.02, 0.01, 0.01, 0.02, 0.01).finished());
+  state.at<1>().setConstant(n, 1.0 / 1.5);
+
+  Clam::HessianMatrix H(6 + n, 6 + n);
+  Clam::GradientVector g(6 + n);
+  H.setZero();
+  g.setZero();
+  ze::Timer t;
+  clam.evaluateError(state, &H, &g);
+  Clam::UpdateVector dx(6 + n);
+  EXPECT_TRUE(clam.solve(state, H, g, dx));
+  VLOG(1) << "linearization and solve took " << t.stopAndGetMilliseconds() << " ms";
+
+  // Compare with a dense solve, the unobserved inverse-depth is not updated.
+  H(5 + n, 5 + n) = 1.0;
+  const VectorX dx_dense = H.ldlt().solve(g);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(dx, dx_dense, 1e-8 * dx_dense.norm()));
+  EXPECT_EQ(dx(5 + n), 0.0);
+}
 
+TEST(ClamTests, testLevenbergMarquardtWithPrior)
+{
+  using namespace ze;
+
+  Transformation T_C_B, T_Bc_Br;
+  T_C_B.setRandom();
+  T_Bc_Br = Transformation::exp((Vector6() << 0.2, 0.2, 0.2, 0.1, 0.1, 0.1).finished());
+  Camera::Ptr cam = std::make_shared<PinholeCamera>(
+                      createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0));
+  CameraRig rig({T_C_B}, {cam}, "rig");
+
+  const size_t n = 100;
+  Keypoints px_Cr = generateRandomKeypoints(cam->size(), 10, n);
+  Bearings f_Cr = cam->backProjectVectorized(px_Cr);
+  ClamLandmarks landmarks;
+  landmarks.f_Br = T_C_B.getRotation().inverse().rotateVectorized(f_Cr);
+  landmarks.origin_Br = T_C_B.inverse().getPosition().replicate(1, n);
+
+  ClamFrameData data;
+  data.T_C_B = T_C_B;
+  const Transformation T_Cc_Cr = T_C_B * T_Bc_Br * T_C_B.inverse();
+  for (size_t i = 0; i < n; ++i)
+  {
+    const Keypoint px_Cc = cam->project(T_Cc_Cr * (f_Cr.col(i) * 2.0));
+    if (isVisible(cam->width(), cam->height(), px_Cc))
+    {
+      data.landmark_measurements.push_back(std::make_pair(i, px_Cc));
+    }
+  }
+  std::vector<ClamFrameData> data_vec = { data };
+
+  // Levenberg-Marquardt evaluates the error of every trial step without
+  // Hessian and gradient, the prior must then be skipped.
+  Clam clam(landmarks, data_vec, rig, T_Bc_Br, 0.2, 10.0);
+  clam.solver_options_.strategy = SolverStrategy::LevenbergMarquardt;
+  ClamState state;
+  state.at<0>() = T_Bc_Br * Transformation::exp(
+                    (Vector6() << 0.05, 0.05, 0.05, 0.05, 0.05, 0.05).finished());
+  state.at<1>().setConstant(n, 1.0 / 1.5);
+
+  Clam::HessianMatrix H(6 + n, 6 + n);
+  Clam::GradientVector g(6 + n);
+  H.setZero();
+  g.setZero();
+  const real_t chi2 = clam.evaluateError(state, &H, &g);
+  EXPECT_EQ(clam.evaluateError(state, nullptr, nullptr), chi2);
+
+  clam.optimize(state);
+  Transformation T_err = T_Bc_Br * state.at<0>().inverse();
+  EXPECT_LT(T_err.getPosition().norm(), 1e-4);
+  EXPECT_LT(T_err.getRotation().log().norm(), 1e-4);
+}
 
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,250 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <cmath>
+#include <random>
+#include <ze/common/benchmark.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/types.hpp>
+#include <ze/geometry/lsq_linear_solver.hpp>
+#include <ze/geometry/lsq_solver.hpp>
+#include <ze/geometry/lsq_state.hpp>
+
+namespace ze {
+
+// Smooths a 1D signal with nonlinear measurements sin(x_i) = z_i and
+// smoothness constraints x_{i+1} - x_i = d_i. The Hessian is tridiagonal.
+using SignalState = State<VectorX>;
+
+class SignalSmoother : public LeastSquaresSolver<SignalState, SignalSmoother>
+{
+public:
+  using LeastSquaresSolver::HessianMatrix;
+  using LeastSquaresSolver::GradientVector;
+
+  SignalSmoother(
+      const LeastSquaresSolverOptions& options,
+      const VectorX& z, const VectorX& d)
+    : LeastSquaresSolver(options)
+    , z_(z)
+    , d_(d)
+  {}
+
+  real_t evaluateError(const SignalState& state, HessianMatrix* H, GradientVector* g)
+  {
+    return evaluate(state, [&](int row, int col, const MatrixX& block) {
+      H->block(row, col, block.rows(), block.cols()) += block;
+    }, H != nullptr, g);
+  }
+
+  real_t evaluateErrorSparse(const SignalState& state, BlockSparseHessian* H, GradientVector* g)
+  {
+    return evaluate(state, [&](int row, int col, const MatrixX& block) {
+      H->addBlock(row, col, block);
+    }, true, g);
+  }
+
+private:
+  template<typename AddBlock>
+  real_t evaluate(const SignalState& state, const AddBlock& add_block,
+                  bool linearize, GradientVector* g)
+  {
+    const VectorX& x = state.at<0>();
+    real_t chi2 = 0.0;
+    for (int i = 0; i < x.size(); ++i)
+    {
+      const real_t r = std::sin(x(i)) - z_(i);
+      chi2 += 0.5 * r * r;
+      if (linearize)
+      {
+        const real_t J = std::cos(x(i));
+        add_block(i, i, MatrixX::Constant(1, 1, J * J));
+        (*g)(i) -= J * r;
+      }
+    }
+    for (int i = 0; i + 1 < x.size(); ++i)
+    {
+      const real_t r = x(i + 1) - x(i) - d_(i);
+      chi2 += 0.5 * r * r;
+      if (linearize)
+      {
+        MatrixX block(2, 2);
+        block << 1, -1, -1, 1;
+        add_block(i, i, block);
+        (*g)(i) += r;
+        (*g)(i + 1) -= r;
+      }
+    }
+    return chi2;
+  }
+
+  VectorX z_;
+  VectorX d_;
+};
+
+} // namespace ze
+
+TEST(LsqLinearSolverTests, testBlockSparseHessian)
+{
+  using namespace ze;
+
+  BlockSparseHessian H;
+  H.resize(9);
+  MatrixX H_dense = MatrixX::Zero(9, 9);
+
+  Matrix3 A = Matrix3::Random();
+  Matrix3 B = Matrix3::Random();
+  Matrix3 C = Matrix3::Random();
+  C = (C + C.transpose()).eval();
+
+  // Off-diagonal blocks in both triangles and a repeated diagonal block.
+  H.addBlock(3, 0, A);
+  H.addBlock(3, 6, B);
+  H.addBlock(6, 6, C);
+  H.addBlock(6, 6, C);
+  H_dense.block<3,3>(3, 0) += A;
+  H_dense.block<3,3>(0, 3) += A.transpose();
+  H_dense.block<3,3>(3, 6) += B;
+  H_dense.block<3,3>(6, 3) += B.transpose();
+  H_dense.block<3,3>(6, 6) += 2.0 * C;
+
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(H.toDense(), H_dense, 1e-12));
+  EXPECT_EQ(H.nonZeros(), 9 + 9 + 6);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(H.diagonal(), H_dense.diagonal(), 1e-12));
+
+  H.addDiagonalDamping(0.5);
+  H_dense += (H_dense.diagonal() * 0.5).asDiagonal();
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(H.toDense(), H_dense, 1e-12));
+
+  H.setZero();
+  EXPECT_EQ(H.nonZeros(), 0);
+}
+
+TEST(LsqLinearSolverTests, testSparseLinearSolver)
+{
+  using namespace ze;
+
+  // Random sparse SPD matrix.
+  const int n = 50;
+  MatrixX J = MatrixX::Zero(2 * n, n);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<real_t> dist(-1.0, 1.0);
+  for (int i = 0; i < 2 * n; ++i)
+  {
+    J(i, i % n) = 1.0 + dist(gen);
+    J(i, (i * 7 + 3) % n) += dist(gen);
+  }
+  MatrixX H_dense = J.transpose() * J + MatrixX::Identity(n, n);
+  VectorX g = VectorX::Random(n);
+  VectorX dx_ref = H_dense.ldlt().solve(g);
+
+  SparseMatrix H;
+  denseToSparseLower(H_dense, &H);
+  EXPECT_LT(H.nonZeros(), n * (n + 1) / 2);
+
+  SparseLinearSolver solver;
+  VectorX dx(n);
+  EXPECT_TRUE(solver.solve(LinearSolverType::SparseCholesky, H, g, dx));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(dx, dx_ref, 1e-8));
+
+  // Same pattern, different values: symbolic factorization is reused.
+  H.coeffRef(0, 0) += 1.0;
+  H_dense(0, 0) += 1.0;
+  dx_ref = H_dense.ldlt().solve(g);
+  EXPECT_TRUE(solver.solve(LinearSolverType::SparseCholesky, H, g, dx));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(dx, dx_ref, 1e-8));
+  EXPECT_EQ(solver.numSymbolicFactorizations(), 1u);
+
+  // Changed pattern.
+  H_dense(n - 1, 0) = H_dense(0, n - 1) = 0.01;
+  denseToSparseLower(H_dense, &H);
+  dx_ref = H_dense.ldlt().solve(g);
+  EXPECT_TRUE(solver.solve(LinearSolverType::SparseCholesky, H, g, dx));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(dx, dx_ref, 1e-8));
+  EXPECT_EQ(solver.numSymbolicFactorizations(), 2u);
+
+  EXPECT_TRUE(solver.solve(LinearSolverType::ConjugateGradient, H, g, dx));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(dx, dx_ref, 1e-6));
+  EXPECT_GT(solver.numCgIterations(), 0u);
+}
+
+TEST(LsqLinearSolverTests, testDynamicStateBackends)
+{
+  using namespace ze;
+
+  const int n = 1000;
+  std::mt19937 gen(0);
+  std::normal_distribution<real_t> noise(0.0, 0.01);
+  VectorX x_true(n), z(n), d(n - 1);
+  for (int i = 0; i < n; ++i)
+  {
+    x_true(i) = 0.5 + 0.3 * std::sin(i * 0.01);
+    z(i) = std::sin(x_true(i)) + noise(gen);
+  }
+  for (int i = 0; i + 1 < n; ++i)
+  {
+    d(i) = x_true(i + 1) - x_true(i) + noise(gen);
+  }
+
+  auto run = [&](LinearSolverType type, SolverStrategy strategy,
+                 uint32_t* num_symbolic = nullptr) -> VectorX
+  {
+    LeastSquaresSolverOptions options;
+    options.strategy = strategy;
+    options.linear_solver = type;
+    options.max_iter = 10u;
+    SignalSmoother smoother(options, z, d);
+    SignalState state;
+    state.at<0>() = VectorX::Constant(n, 0.5);
+    smoother.optimize(state);
+    if (num_symbolic)
+    {
+      *num_symbolic = smoother.sparseLinearSolver().numSymbolicFactorizations();
+    }
+    return state.at<0>();
+  };
+
+  for (SolverStrategy strategy : { SolverStrategy::GaussNewton,
+                                   SolverStrategy::LevenbergMarquardt })
+  {
+    VectorX x_dense, x_sparse, x_cg;
+    uint32_t num_symbolic = 0u;
+    runTimingBenchmark([&]() {
+      x_dense = run(LinearSolverType::DenseLDLT, strategy); },
+      1, 1, "Dense LDLT", true);
+    runTimingBenchmark([&]() {
+      x_sparse = run(LinearSolverType::SparseCholesky, strategy, &num_symbolic); },
+      1, 3, "Sparse Cholesky", true);
+    runTimingBenchmark([&]() {
+      x_cg = run(LinearSolverType::ConjugateGradient, strategy); },
+      1, 3, "Conjugate Gradient", true);
+
+    EXPECT_LT((x_dense - x_true).cwiseAbs().maxCoeff(), 0.05);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(x_sparse, x_dense, 1e-8));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(x_cg, x_dense, 1e-6));
+    EXPECT_EQ(num_symbolic, 1u);
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -27,6 +27,7 @@
 #include <ze/common/benchmark.hpp>
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/matrix.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/common/timer.hpp>
 #include <ze/common/types.hpp>
 #include <ze/common/transformation.hpp>
@@ -208,4 +209,105 @@ TEST(PoseOptimizerTests, testSolver_withLines)
         0.0, 0.0, T_B_W, T_B_W_perturbed, data, "Line, No Prior");
 }
 
+TEST(PoseOptimizerTests, testParallelEvaluation)
+{
+  using namespace ze;
+
+  Transformation T_B_W;
+  T_B_W.setRandom();
+  PinholeCamera cam = createTestPinholeCamera();
+  std::ranlux24 gen;
+  std::normal_distribution<real_t> px_noise(0.0, 1.0);
+
+  // Rig with three cameras and many measurements per camera.
+  const size_t n = 1500;
+  PoseOptimizerFrameDataVec data_vec;
+  for (uint32_t cam_idx = 0u; cam_idx < 3u; ++cam_idx)
+  {
+    Transformation T_C_B;
+    T_C_B.setRandom();
+    Keypoints px;
+    Bearings f;
+    Positions p_C;
+    std::tie(px, f, p_C) = generateRandomVisible3dPoints(cam, n, 10, 1.0, 3.0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      px(0, i) += px_noise(gen);
+      px(1, i) += px_noise(gen);
+    }
+
+    PoseOptimizerFrameData data;
+    data.camera_idx = cam_idx;
+    data.type = cam_idx == 1u ? PoseOptimizerResidualType::Bearing
+                              : PoseOptimizerResidualType::UnitPlane;
+    data.f = cam.backProjectVectorized(px);
+    data.kp_idx = KeypointIndices(n, 1);
+    data.p_W = (T_B_W.inverse() * T_C_B.inverse()).transformVectorized(p_C);
+    data.T_C_B = T_C_B;
+    data.scale = VectorX::Ones(n);
+    data_vec.push_back(data);
+  }
+
+  Transformation T_B_W_perturbed =
+      T_B_W * Transformation::exp((Vector6() << 0.1, 0.1, 0.1, 0.1, 0.1, 0.1).finished());
+
+  // Serial reference.
+  PoseOptimizer::HessianMatrix H_serial;
+  PoseOptimizer::GradientVector g_serial;
+  Transformation T_serial = T_B_W_perturbed;
+  {
+    PoseOptimizerFrameDataVec data_copy = data_vec;
+    PoseOptimizer optimizer(PoseOptimizer::getDefaultSolverOptions(), data_copy);
+    H_serial.setZero();
+    g_serial.setZero();
+    optimizer.evaluateError(T_B_W_perturbed, &H_serial, &g_serial);
+    runTimingBenchmark([&]() {
+      PoseOptimizer opt(PoseOptimizer::getDefaultSolverOptions(), data_copy);
+      T_serial = T_B_W_perturbed;
+      opt.optimize(T_serial);
+    }, 1, 5, "Serial", true);
+  }
+
+  PoseOptimizer::HessianMatrix H_first;
+  PoseOptimizer::GradientVector g_first;
+  Transformation T_first;
+  for (size_t num_threads : { 1u, 2u, 4u })
+  {
+    ThreadPool pool(num_threads);
+    PoseOptimizerFrameDataVec data_copy = data_vec;
+    PoseOptimizer optimizer(PoseOptimizer::getDefaultSolverOptions(), data_copy);
+    optimizer.setThreadPool(&pool, 128u);
+    PoseOptimizer::HessianMatrix H = PoseOptimizer::HessianMatrix::Zero();
+    PoseOptimizer::GradientVector g = PoseOptimizer::GradientVector::Zero();
+    optimizer.evaluateError(T_B_W_perturbed, &H, &g);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(H, H_serial, 1e-8 * H_serial.norm()));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(g, g_serial, 1e-8 * g_serial.norm()));
+
+    Transformation T_parallel;
+    runTimingBenchmark([&]() {
+      PoseOptimizer opt(PoseOptimizer::getDefaultSolverOptions(), data_copy);
+      opt.setThreadPool(&pool, 128u);
+      T_parallel = T_B_W_perturbed;
+      opt.optimize(T_parallel);
+    }, 1, 5, "Parallel, " + std::to_string(num_threads) + " threads", true);
+    Transformation T_err = T_parallel * T_serial.inverse();
+    EXPECT_LT(T_err.log().norm(), 1e-6);
+
+    if (num_threads == 1u)
+    {
+      H_first = H;
+      g_first = g;
+      T_first = T_parallel;
+    }
+    else
+    {
+      // Bit-identical for any number of threads.
+      EXPECT_TRUE(H == H_first);
+      EXPECT_TRUE(g == g_first);
+      EXPECT_TRUE(T_parallel.getTransformationMatrix()
+                  == T_first.getTransformationMatrix());
+    }
+  }
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,194 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <numeric>
+#include <random>
+#include <Eigen/Cholesky>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/types.hpp>
+#include <ze/geometry/ransac.hpp>
+
+namespace ze {
+
+//! Fits a 2D line y = a*x + b.
+struct LineFittingProblem
+{
+  using model_t = Vector2;
+
+  Matrix2X points;
+
+  int getSampleSize() const
+  {
+    return 2;
+  }
+
+  bool isSampleGood(const std::vector<int>& sample) const
+  {
+    return points(0, sample[0]) != points(0, sample[1]);
+  }
+
+  bool computeModelCoefficients(const std::vector<int>& sample, model_t& model) const
+  {
+    const Vector2 p0 = points.col(sample[0]);
+    const Vector2 p1 = points.col(sample[1]);
+    model(0) = (p1(1) - p0(1)) / (p1(0) - p0(0));
+    model(1) = p0(1) - model(0) * p0(0);
+    return true;
+  }
+
+  void getSelectedDistancesToModel(
+      const model_t& model, const std::vector<int>& indices,
+      std::vector<double>& distances) const
+  {
+    distances.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      const Vector2 p = points.col(indices[i]);
+      distances[i] = std::abs(p(1) - model(0) * p(0) - model(1));
+    }
+  }
+
+  void optimizeModelCoefficients(
+      const std::vector<int>& inliers, const model_t& /*model*/,
+      model_t& optimized_model)
+  {
+    MatrixX A(inliers.size(), 2);
+    VectorX b(inliers.size());
+    for (size_t i = 0; i < inliers.size(); ++i)
+    {
+      A(i, 0) = points(0, inliers[i]);
+      A(i, 1) = 1.0;
+      b(i) = points(1, inliers[i]);
+    }
+    optimized_model = (A.transpose() * A).ldlt().solve(A.transpose() * b);
+  }
+};
+
+//! First num_inliers points lie on y = 0.5*x + 1 with noise, the others are
+//! uniformly distributed.
+LineFittingProblem createProblem(int num_points, int num_inliers, real_t noise)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<real_t> uniform(-10.0, 10.0);
+  std::normal_distribution<real_t> gaussian(0.0, noise);
+  LineFittingProblem problem;
+  problem.points.resize(2, num_points);
+  for (int i = 0; i < num_points; ++i)
+  {
+    const real_t x = uniform(gen);
+    problem.points(0, i) = x;
+    problem.points(1, i) = i < num_inliers ? 0.5 * x + 1.0 + gaussian(gen) : uniform(gen);
+  }
+  return problem;
+}
+
+} // namespace ze
+
+TEST(RansacTests, testLineFitting)
+{
+  using namespace ze;
+
+  const int n = 1000, n_inliers = 600;
+  LineFittingProblem problem = createProblem(n, n_inliers, 0.01);
+
+  RansacOptions options;
+  options.threshold = 0.05;
+  options.max_iterations = 1000u;
+  Ransac<LineFittingProblem> ransac(options);
+  EXPECT_TRUE(ransac.computeModel(problem, n));
+  EXPECT_NEAR(ransac.model()(0), 0.5, 1e-3);
+  EXPECT_NEAR(ransac.model()(1), 1.0, 1e-3);
+  EXPECT_GE(ransac.inliers().size(), 0.99 * n_inliers);
+  EXPECT_LE(ransac.inliers().size(), 1.02 * n_inliers);
+  EXPECT_TRUE(std::is_sorted(ransac.inliers().begin(), ransac.inliers().end()));
+
+  // Adaptive termination well before max_iterations, bad hypotheses are
+  // rejected early and the best hypothesis is refined.
+  EXPECT_LT(ransac.summary().num_iterations, 100u);
+  EXPECT_GT(ransac.summary().num_rejected_by_sprt, 0u);
+  EXPECT_GT(ransac.summary().num_local_optimizations, 0u);
+  EXPECT_FALSE(ransac.summary().deadline_reached);
+
+  // Same result without SPRT and LO.
+  options.use_sprt = false;
+  options.use_local_optimization = false;
+  Ransac<LineFittingProblem> ransac_plain(options);
+  EXPECT_TRUE(ransac_plain.computeModel(problem, n));
+  EXPECT_NEAR(ransac_plain.model()(0), 0.5, 1e-2);
+  EXPECT_EQ(ransac_plain.summary().num_rejected_by_sprt, 0u);
+  EXPECT_EQ(ransac_plain.summary().num_local_optimizations, 0u);
+}
+
+TEST(RansacTests, testProsac)
+{
+  using namespace ze;
+
+  // 90% outliers: uniform sampling needs hundreds of iterations.
+  const int n = 2000, n_inliers = 200;
+  LineFittingProblem problem = createProblem(n, n_inliers, 0.01);
+
+  // Match scores rank most inliers first.
+  std::vector<int> ordering(n);
+  std::iota(ordering.begin(), ordering.end(), 0);
+  std::swap(ordering[10], ordering[1500]);
+
+  RansacOptions options;
+  options.threshold = 0.05;
+  options.max_iterations = 100000u;
+  Ransac<LineFittingProblem> prosac(options);
+  EXPECT_TRUE(prosac.computeModel(problem, n, ordering));
+  EXPECT_NEAR(prosac.model()(0), 0.5, 1e-3);
+  EXPECT_GE(prosac.inliers().size(), 0.99 * n_inliers);
+
+  Ransac<LineFittingProblem> ransac(options);
+  EXPECT_TRUE(ransac.computeModel(problem, n));
+  EXPECT_NEAR(ransac.model()(0), 0.5, 1e-3);
+  VLOG(1) << "Iterations PROSAC = " << prosac.summary().num_iterations
+          << ", RANSAC = " << ransac.summary().num_iterations;
+  EXPECT_LT(prosac.summary().num_iterations, ransac.summary().num_iterations);
+}
+
+TEST(RansacTests, testDeadline)
+{
+  using namespace ze;
+
+  const int n = 20000, n_inliers = 200;
+  LineFittingProblem problem = createProblem(n, n_inliers, 0.01);
+
+  RansacOptions options;
+  options.threshold = 0.05;
+  options.max_iterations = 1000000u;
+  options.use_sprt = false;
+  options.max_time_us = 2000u;
+  Ransac<LineFittingProblem> ransac(options);
+  Timer timer;
+  ransac.computeModel(problem, n);
+  const real_t elapsed_ms = timer.stopAndGetMilliseconds();
+  EXPECT_TRUE(ransac.summary().deadline_reached);
+  EXPECT_LT(ransac.summary().num_iterations, options.max_iterations);
+  // Only a sanity bound, a tight one would fail on loaded machines.
+  EXPECT_LT(elapsed_ms, 100.0 * options.max_time_us * 1e-3);
+}
+
+ZE_UNITTEST_ENTRYPOINT
@@ -74,7 +74,6 @@ TEST(RansacRelativePoseTests, testFivePointAndTranslationOnly)
   // Some outliers, Five-Point
   Transformation T;
   RansacRelativePose ransac(cam, 1.0);
-  ransac.ogv_verbosity_level_ = 2;
   bool success = ransac.solve(f_ref, f_cur, RelativePoseAlgorithm::FivePoint, T);
   EXPECT_TRUE(success);
   EXPECT_EQ(ransac.inliers().size(), n_points - n_outliers);
@@ -116,7 +115,6 @@ TEST(RansacRelativePoseTests, testRotationOnly)
   // Some outliers, Five-Point
   Transformation T;
   RansacRelativePose ransac(cam, 1.0);
-  ransac.ogv_verbosity_level_ = 2;
   bool success = ransac.solve(f_ref, f_cur, RelativePoseAlgorithm::TwoPointRotationOnly, T);
   EXPECT_TRUE(success);
   EXPECT_EQ(ransac.inliers().size(), n_points - n_outliers);
@@ -24,6 +24,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <random>
+#include <ze/common/benchmark.hpp>
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/matrix.hpp>
 #include <ze/common/timer.hpp>
@@ -118,4 +119,170 @@ TEST(TriangulationTests, testNonlinearRefinement)
   EXPECT_LT((p_W_estimated - p_W_true).norm(), tol);
 }
 
+TEST(TriangulationTests, testBatchedTwoViews)
+{
+  using namespace ze;
+
+  // Points in front of both cameras, not a multiple of the batch size.
+  const int n = 1003;
+  PinholeCamera cam = createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0);
+  Keypoints px_A;
+  Bearings f_A;
+  Positions p_A_true;
+  std::tie(px_A, f_A, p_A_true) = generateRandomVisible3dPoints(cam, n, 10, 2.0, 8.0);
+  Transformation T_A_B;
+  T_A_B.setRandom(0.5, 0.1);
+  Bearings f_B = T_A_B.inverse().transformVectorized(p_A_true);
+  normalizeBearings(f_B);
+
+  // Add noise.
+  std::ranlux24 gen;
+  std::normal_distribution<real_t> noise(0.0, 0.001);
+  for (int i = 0; i < n; ++i)
+  {
+    f_A.col(i) = (f_A.col(i) + Vector3(noise(gen), noise(gen), 0.0)).normalized();
+    f_B.col(i) = (f_B.col(i) + Vector3(noise(gen), noise(gen), 0.0)).normalized();
+  }
+
+  // Midpoint and angular errors.
+  Positions p_A(3, n);
+  VectorX errors(n);
+  runTimingBenchmark([&]() {
+    triangulateManyAndComputeAngularErrors(T_A_B, f_A, f_B, p_A, errors); },
+    10, 10, "Batched midpoint", true);
+  const Transformation T_B_A = T_A_B.inverse();
+  for (int i = 0; i < n; ++i)
+  {
+    Position p = triangulateNonLinear(T_A_B, f_A.col(i), f_B.col(i));
+    real_t error = 2.0 - f_A.col(i).dot(p.normalized())
+                   - f_B.col(i).dot((T_B_A * p).normalized());
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(p_A.col(i), p, 1e-9 * p.norm()));
+    EXPECT_NEAR(errors(i), error, 1e-12);
+  }
+
+  // Gauss-Newton refinement.
+  TransformationVector T_C_W = { Transformation(), T_B_A };
+  Positions p_A_refined(3, n);
+  runTimingBenchmark([&]() {
+    triangulateManyGaussNewton(T_A_B, f_A, f_B, p_A_refined); },
+    10, 10, "Batched Gauss-Newton", true);
+  runTimingBenchmark([&]() {
+    Bearings f_C(3, 2);
+    for (int i = 0; i < n; ++i)
+    {
+      f_C << f_A.col(i), f_B.col(i);
+      Position p = triangulateNonLinear(T_A_B, f_A.col(i), f_B.col(i));
+      triangulateGaussNewton(T_C_W, f_C, p);
+    } },
+    10, 10, "Scalar Gauss-Newton", true);
+  for (int i = 0; i < n; ++i)
+  {
+    Bearings f_C(3, 2);
+    f_C << f_A.col(i), f_B.col(i);
+    Position p = triangulateNonLinear(T_A_B, f_A.col(i), f_B.col(i));
+    triangulateGaussNewton(T_C_W, f_C, p);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(p_A_refined.col(i), p, 1e-6 * p.norm()));
+  }
+}
+
+TEST(TriangulationTests, testBatchedDLT)
+{
+  using namespace ze;
+
+  // Observe many points from the same cameras.
+  const int n = 1003;
+  const int m = 5;
+  Transformation T_W_C0;
+  T_W_C0.setRandom();
+  PinholeCamera cam = createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0);
+  Keypoints px;
+  Bearings f_C0;
+  Positions p_C0;
+  std::tie(px, f_C0, p_C0) = generateRandomVisible3dPoints(cam, n, 10, 2.0, 8.0);
+  const Positions p_W_true = T_W_C0.transformVectorized(p_C0);
+
+  TransformationVector T_C_W;
+  std::vector<Bearings> f_C;
+  for (int i = 0; i < m; ++i)
+  {
+    Transformation T_C_C0;
+    T_C_C0.setRandom(0.2, 0.05);
+    T_C_W.push_back(T_C_C0 * T_W_C0.inverse());
+    Bearings f = T_C_W.back().transformVectorized(p_W_true);
+    normalizeBearings(f);
+    f_C.push_back(f);
+  }
+
+  HomPositions p_W_homogeneous;
+  std::vector<bool> success;
+  runTimingBenchmark([&]() {
+    triangulateManyHomogeneousDLT(T_C_W, f_C, p_W_homogeneous, success); },
+    10, 10, "Batched DLT", true);
+  runTimingBenchmark([&]() {
+    for (int j = 0; j < n; ++j)
+    {
+      Bearings f(3, m);
+      for (int i = 0; i < m; ++i)
+      {
+        f.col(i) = f_C[i].col(j);
+      }
+      triangulateHomogeneousDLT(T_C_W, f);
+    } },
+    10, 10, "Scalar DLT", true);
+
+  ASSERT_EQ(p_W_homogeneous.cols(), n);
+  for (int j = 0; j < n; ++j)
+  {
+    Bearings f(3, m);
+    for (int i = 0; i < m; ++i)
+    {
+      f.col(i) = f_C[i].col(j);
+    }
+    Vector4 p_W_hom_scalar;
+    bool success_scalar;
+    std::tie(p_W_hom_scalar, success_scalar) = triangulateHomogeneousDLT(T_C_W, f);
+    EXPECT_EQ(success[j], success_scalar);
+    const Vector3 p_W = p_W_homogeneous.col(j).head<3>() / p_W_homogeneous(3, j);
+    const Vector3 p_W_scalar = p_W_hom_scalar.head<3>() / p_W_hom_scalar(3);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(p_W, p_W_scalar, 1e-6));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(p_W, p_W_true.col(j), 1e-6));
+  }
+}
+
+TEST(TriangulationTests, testBatchedDLTDegenerate)
+{
+  using namespace ze;
+
+  // All cameras at the same pose: no point can be triangulated.
+  const int n = 16;
+  const int m = 3;
+  Transformation T_W_C0;
+  T_W_C0.setRandom();
+  PinholeCamera cam = createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0);
+  Keypoints px;
+  Bearings f_C0;
+  Positions p_C0;
+  std::tie(px, f_C0, p_C0) = generateRandomVisible3dPoints(cam, n, 10, 2.0, 8.0);
+
+  TransformationVector T_C_W(m, T_W_C0.inverse());
+  std::vector<Bearings> f_C(m, f_C0);
+
+  HomPositions p_W_homogeneous;
+  std::vector<bool> success;
+  triangulateManyHomogeneousDLT(T_C_W, f_C, p_W_homogeneous, success);
+  ASSERT_EQ(p_W_homogeneous.cols(), n);
+  for (int j = 0; j < n; ++j)
+  {
+    Bearings f(3, m);
+    for (int i = 0; i < m; ++i)
+    {
+      f.col(i) = f_C[i].col(j);
+    }
+    bool success_scalar;
+    std::tie(std::ignore, success_scalar) = triangulateHomogeneousDLT(T_C_W, f);
+    EXPECT_FALSE(success_scalar);
+    EXPECT_EQ(success[j], success_scalar);
+  }
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -25,8 +25,6 @@
 
 #pragma once
 
-#include <mutex>
-
 #include <ze/imu/imu_model.hpp>
 #include <ze/common/ringbuffer.hpp>
 
@@ -48,7 +46,6 @@ struct InterpolatorDifferentiatorLinear
     const auto it_after = it_before + 1;
     if (it_after == buffer->times().end())
     {
-      LOG(WARNING) << "Interpolation hit end of buffer.";
       return (return_t() << buffer->data().col(it_before.container_index()),
           Vector3::Zero()).finished();
     }
@@ -79,6 +76,9 @@ using DefaultInterpolator = InterpolatorLinear;
 //! An IMU Buffer with an underlying Gyro and Accel model that also corrects
 //! measurement timestamps. The timestamps are corrected when inserted into the
 //! buffers.
+//! The buffers are single-writer SeqLock ringbuffers: Gyroscope and
+//! accelerometer measurements must each be inserted from one thread, readers
+//! never block the insertion.
 template<int BufferSize, typename GyroInterp,
 typename AccelInterp = GyroInterp>
 class ImuBuffer
@@ -127,8 +127,9 @@ protected:
 private:
   //! The underlying storage structures for accelerometer and gyroscope
   //! measurements.
-  Ringbuffer<real_t, 3, BufferSize> acc_buffer_;
-  Ringbuffer<real_t, 3, BufferSize> gyr_buffer_;
+  using SensorBuffer = Ringbuffer<real_t, 3, BufferSize, RingbufferSync::SeqLock>;
+  SensorBuffer acc_buffer_;
+  SensorBuffer gyr_buffer_;
 
   ImuModel::Ptr imu_model_;
 
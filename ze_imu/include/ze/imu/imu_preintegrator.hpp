@@ -0,0 +1,177 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <tuple>
+
+#include <ze/imu/imu_model.hpp>
+#include <ze/imu/imu_noise_model.hpp>
+#include <ze/common/logging.hpp>
+#include <ze/common/macros.hpp>
+#include <ze/common/time_conversions.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+//! Incremental on-manifold IMU preintegration.
+//!
+//! Accumulates the relative motion increments deltaR, deltaV and deltaP
+//! between the first and the last integrated sample, their 9x9 covariance
+//! (ordered [R, v, p]) and the Jacobians with respect to the accelerometer and
+//! gyroscope biases. Measurements are integrated with a zero-order hold at the
+//! bias linearization point. When the bias estimate changes, the deltas are
+//! corrected to first order through the bias Jacobians instead of being
+//! re-integrated.
+//!
+//! C. Forster et al., "On-Manifold Preintegration for Real-Time
+//! Visual-Inertial Odometry", IEEE Transactions on Robotics, 2017.
+class ImuPreintegrator
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  ZE_POINTER_TYPEDEFS(ImuPreintegrator);
+
+  //! Noise densities are read from the noise models. ImuNoiseNone results in a
+  //! zero covariance.
+  ImuPreintegrator(const ImuNoiseModel::Ptr& acc_noise,
+                   const ImuNoiseModel::Ptr& gyr_noise);
+
+  //! Use the noise models of the accelerometer and gyroscope of an IMU.
+  explicit ImuPreintegrator(const ImuModel::Ptr& imu_model);
+
+  //! Restart preintegration at the given timestamp. The bias linearization
+  //! point is kept.
+  void reset(int64_t stamp);
+
+  //! Restart preintegration and set a new bias linearization point.
+  void reset(int64_t stamp, const Vector3& acc_bias, const Vector3& gyr_bias);
+
+  //! Integrate a single measurement, held constant from the last integrated
+  //! timestamp to stamp_to. Cost is independent of the number of samples that
+  //! have been integrated before.
+  void integrate(int64_t stamp_to, const Eigen::Ref<const ImuAccGyr>& acc_gyr);
+
+  //! Integrate a block of rectified measurements as returned by
+  //! ImuBuffer::getBetweenValuesInterpolated. Measurement k is held constant
+  //! on [stamps(k), stamps(k+1)), the last measurement is not used. The first
+  //! stamp must coincide with the last integrated timestamp.
+  void integrate(const ImuStamps& stamps,
+                 const ImuAccGyrContainer& acc_gyr);
+
+  //! Pull the rectified measurements between the last integrated timestamp and
+  //! stamp_to from an ImuBuffer and integrate them.
+  //! Returns false if the buffer does not cover the requested interval.
+  template<typename ImuBufferT>
+  bool integrateFromBuffer(ImuBufferT& buffer, int64_t stamp_to)
+  {
+    ImuStamps stamps;
+    ImuAccGyrContainer acc_gyr;
+    std::tie(stamps, acc_gyr) =
+        buffer.getBetweenValuesInterpolated(stamp_end_, stamp_to);
+    if (stamps.size() == 0)
+    {
+      return false;
+    }
+    integrate(stamps, acc_gyr);
+    return true;
+  }
+
+  //! @name Preintegrated measurements at the bias linearization point.
+  //! @{
+  inline const Matrix3& deltaR() const { return delta_R_; }
+  inline const Vector3& deltaV() const { return delta_v_; }
+  inline const Vector3& deltaP() const { return delta_p_; }
+  inline real_t deltaT() const { return delta_t_; }
+  inline int64_t stampStart() const { return stamp_start_; }
+  inline int64_t stampEnd() const { return stamp_end_; }
+  inline size_t numMeasurements() const { return num_measurements_; }
+  //! @}
+
+  //! Covariance of [deltaR, deltaV, deltaP], rotation in the tangent space.
+  inline const Matrix9& covariance() const { return covariance_; }
+
+  //! @name Jacobians with respect to the biases.
+  //! @{
+  inline const Matrix3& dR_dbg() const { return dR_dbg_; }
+  inline const Matrix3& dV_dba() const { return dV_dba_; }
+  inline const Matrix3& dV_dbg() const { return dV_dbg_; }
+  inline const Matrix3& dP_dba() const { return dP_dba_; }
+  inline const Matrix3& dP_dbg() const { return dP_dbg_; }
+  //! @}
+
+  //! @name Bias linearization point.
+  //! @{
+  inline const Vector3& accBias() const { return acc_bias_; }
+  inline const Vector3& gyrBias() const { return gyr_bias_; }
+  //! @}
+
+  //! @name First-order bias corrected measurements.
+  //! @{
+  Matrix3 deltaRCorrected(const Vector3& gyr_bias) const;
+  Vector3 deltaVCorrected(const Vector3& acc_bias,
+                          const Vector3& gyr_bias) const;
+  Vector3 deltaPCorrected(const Vector3& acc_bias,
+                          const Vector3& gyr_bias) const;
+  //! @}
+
+  //! Predict the state at the end of the preintegration window from the state
+  //! R_W_B, v_W and p_W at the start, using the bias corrected measurements.
+  void predict(const Matrix3& R_W_Bi, const Vector3& v_W_i,
+               const Vector3& p_W_i, const Vector3& g_W,
+               const Vector3& acc_bias, const Vector3& gyr_bias,
+               Matrix3* R_W_Bj, Vector3* v_W_j, Vector3* p_W_j) const;
+
+private:
+  //! Single preintegration step with bias-free measurements.
+  void integrateStep(const Vector3& acc, const Vector3& gyr, real_t dt);
+
+  //! Continuous-time noise densities squared.
+  real_t acc_noise_density_sq_ = 0.0;
+  real_t gyr_noise_density_sq_ = 0.0;
+
+  //! Bias linearization point.
+  Vector3 acc_bias_ = Vector3::Zero();
+  Vector3 gyr_bias_ = Vector3::Zero();
+
+  int64_t stamp_start_ = -1;
+  int64_t stamp_end_ = -1;
+  size_t num_measurements_ = 0u;
+
+  real_t delta_t_ = 0.0;
+  Matrix3 delta_R_ = I_3x3;
+  Vector3 delta_v_ = Vector3::Zero();
+  Vector3 delta_p_ = Vector3::Zero();
+
+  Matrix9 covariance_ = Z_9x9;
+
+  Matrix3 dR_dbg_ = Z_3x3;
+  Matrix3 dV_dba_ = Z_3x3;
+  Matrix3 dV_dbg_ = Z_3x3;
+  Matrix3 dP_dba_ = Z_3x3;
+  Matrix3 dP_dbg_ = Z_3x3;
+};
+
+} // namespace ze
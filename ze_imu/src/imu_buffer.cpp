@@ -62,26 +62,45 @@ template<int BufferSize, typename GyroInterp, typename AccelInterp>
 bool ImuBuffer<BufferSize, GyroInterp, AccelInterp>::get(int64_t time,
                                               Eigen::Ref<ImuAccGyr> out)
 {
-  std::lock_guard<std::mutex> gyr_lock(gyr_buffer_.mutex());
-  std::lock_guard<std::mutex> acc_lock(acc_buffer_.mutex());
-
-  if (time > gyr_buffer_.times().back()
-      || time > acc_buffer_.times().back())
+  // Interpolate on a consistent state of both buffers, rectify afterwards.
+  VectorX w, a;
+  bool hit_end = false;
+  const bool success = gyr_buffer_.read([&]()
   {
-    return false;
+    return acc_buffer_.read([&]()
+    {
+      hit_end = false;
+      if (gyr_buffer_.times().empty() || acc_buffer_.times().empty()
+          || time > gyr_buffer_.times().back()
+          || time > acc_buffer_.times().back())
+      {
+        return false;
+      }
+
+      const auto gyro_before = gyr_buffer_.iterator_equal_or_before(time);
+      const auto acc_before = acc_buffer_.iterator_equal_or_before(time);
+
+      if (gyro_before == gyr_buffer_.times().end()
+          || acc_before == acc_buffer_.times().end()) {
+        return false;
+      }
+
+      hit_end = gyro_before + 1 == gyr_buffer_.times().end()
+          || acc_before + 1 == acc_buffer_.times().end();
+      w = GyroInterp::interpolate(&gyr_buffer_, time, gyro_before);
+      a = AccelInterp::interpolate(&acc_buffer_, time, acc_before);
+      return true;
+    });
+  });
+
+  if (hit_end)
+  {
+    LOG(WARNING) << "Interpolation hit end of buffer.";
   }
-
-  const auto gyro_before = gyr_buffer_.iterator_equal_or_before(time);
-  const auto acc_before = acc_buffer_.iterator_equal_or_before(time);
-
-  if (gyro_before == gyr_buffer_.times().end()
-      || acc_before == acc_buffer_.times().end()) {
+  if (!success)
+  {
     return false;
   }
-
-  VectorX w = GyroInterp::interpolate(&gyr_buffer_, time, gyro_before);
-  VectorX a = AccelInterp::interpolate(&acc_buffer_, time, acc_before);
-
   out = imu_model_->undistort(a, w);
   return true;
 }
@@ -114,75 +133,117 @@ ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getBetweenValuesInterpolated(
   ImuAccGyrContainer rectified_measurements;
   ImuStamps stamps;
 
-  std::lock_guard<std::mutex> gyr_lock(gyr_buffer_.mutex());
-  std::lock_guard<std::mutex> acc_lock(acc_buffer_.mutex());
-
-  if(gyr_buffer_.times().size() < 2)
+  // Read a consistent state of both buffers. Warnings are only logged for
+  // the consistent result.
+  bool hit_end = false;
+  const char* warning = gyr_buffer_.read([&]()
   {
-    LOG(WARNING) << "Buffer has less than 2 entries.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
-  }
-
-  const time_t oldest_stamp = gyr_buffer_.times().front();
-  const time_t newest_stamp = gyr_buffer_.times().back();
-  if (stamp_from < oldest_stamp)
+    return acc_buffer_.read([&]() -> const char*
+    {
+      hit_end = false;
+      stamps.resize(0);
+      rectified_measurements.resize(Eigen::NoChange, 0);
+
+      if(gyr_buffer_.times().size() < 2)
+      {
+        return "Buffer has less than 2 entries.";
+      }
+
+      const time_t oldest_stamp = gyr_buffer_.times().front();
+      const time_t newest_stamp = gyr_buffer_.times().back();
+      if (stamp_from < oldest_stamp)
+      {
+        return "Requests older timestamp than in buffer.";
+      }
+      if (stamp_to > newest_stamp)
+      {
+        return "Requests newer timestamp than in buffer.";
+      }
+
+      const auto it_from_before = gyr_buffer_.iterator_equal_or_before(stamp_from);
+      const auto it_to_after = gyr_buffer_.iterator_equal_or_after(stamp_to);
+      if (it_from_before == gyr_buffer_.times().end()
+          || it_to_after == gyr_buffer_.times().end()
+          || it_to_after <= it_from_before)
+      {
+        // Only possible while the buffer is modified.
+        return "Inconsistent buffer.";
+      }
+      const auto it_from_after = it_from_before + 1;
+      const auto it_to_before = it_to_after - 1;
+      if (it_from_after == it_to_before)
+      {
+        return "Not enough data for interpolation";
+      }
+
+      // Accelerometer measurements are interpolated at the gyroscope stamps.
+      auto accAt = [&](time_t t, VectorX* a) -> bool
+      {
+        const auto acc_before = acc_buffer_.iterator_equal_or_before(t);
+        if (acc_before == acc_buffer_.times().end())
+        {
+          return false;
+        }
+        hit_end |= acc_before + 1 == acc_buffer_.times().end();
+        *a = AccelInterp::interpolate(&acc_buffer_, t, acc_before);
+        return true;
+      };
+
+      // resize containers
+      const size_t range = it_to_before.index() - it_from_after.index() + 3;
+      rectified_measurements.resize(Eigen::NoChange, range);
+      stamps.resize(range);
+
+      // first element
+      VectorX w = GyroInterp::interpolate(&gyr_buffer_, stamp_from, it_from_before);
+      VectorX a;
+      if (!accAt(stamp_from, &a))
+      {
+        return "Accelerometer has no data before requested timestamp.";
+      }
+      stamps(0) = stamp_from;
+      rectified_measurements.col(0) = imu_model_->undistort(a, w);
+
+      // this is a real edge case where we hit the two consecutive timestamps
+      //  with from and to.
+      size_t col = 1;
+      if (range > 2)
+      {
+        for (auto it=it_from_before+1; it!=it_to_after; ++it) {
+          w = GyroInterp::interpolate(&gyr_buffer_, (*it), it);
+          if (!accAt(*it, &a))
+          {
+            return "Accelerometer has no data before requested timestamp.";
+          }
+          stamps(col) = (*it);
+          rectified_measurements.col(col) = imu_model_->undistort(a, w);
+          ++col;
+        }
+      }
+
+      // last element
+      w = GyroInterp::interpolate(&gyr_buffer_, stamp_to, it_to_before);
+      if (!accAt(stamp_to, &a))
+      {
+        return "Accelerometer has no data before requested timestamp.";
+      }
+      stamps(range - 1) = stamp_to;
+      rectified_measurements.col(range - 1) = imu_model_->undistort(a, w);
+      return nullptr;
+    });
+  });
+
+  if (hit_end)
   {
-    LOG(WARNING) << "Requests older timestamp than in buffer.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
-  }
-  if (stamp_to > newest_stamp)
-  {
-    LOG(WARNING) << "Requests newer timestamp than in buffer.";
-    // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    LOG(WARNING) << "Interpolation hit end of buffer.";
   }
-
-  const auto it_from_before = gyr_buffer_.iterator_equal_or_before(stamp_from);
-  const auto it_to_after = gyr_buffer_.iterator_equal_or_after(stamp_to);
-  CHECK(it_from_before != gyr_buffer_.times().end());
-  CHECK(it_to_after != gyr_buffer_.times().end());
-  const auto it_from_after = it_from_before + 1;
-  const auto it_to_before = it_to_after - 1;
-  if (it_from_after == it_to_before)
+  if (warning)
   {
-    LOG(WARNING) << "Not enough data for interpolation";
+    LOG(WARNING) << warning;
     // return empty means unsuccessful.
-    return std::make_pair(stamps, rectified_measurements);
+    stamps.resize(0);
+    rectified_measurements.resize(Eigen::NoChange, 0);
   }
-
-  // resize containers
-  const size_t range = it_to_before.index() - it_from_after.index() + 3;
-  rectified_measurements.resize(Eigen::NoChange, range);
-  stamps.resize(range);
-
-  // first element
-  VectorX w = GyroInterp::interpolate(&gyr_buffer_, stamp_from, it_from_before);
-  VectorX a = AccelInterp::interpolate(&acc_buffer_, stamp_from);
-  stamps(0) = stamp_from;
-  rectified_measurements.col(0) = imu_model_->undistort(a, w);
-
-  // this is a real edge case where we hit the two consecutive timestamps
-  //  with from and to.
-  size_t col = 1;
-  if (range > 2)
-  {
-    for (auto it=it_from_before+1; it!=it_to_after; ++it) {
-      w = GyroInterp::interpolate(&gyr_buffer_, (*it), it);
-      a = AccelInterp::interpolate(&acc_buffer_, (*it));
-      stamps(col) = (*it);
-      rectified_measurements.col(col) = imu_model_->undistort(a, w);
-      ++col;
-    }
-  }
-
-  // last element
-  w = GyroInterp::interpolate(&gyr_buffer_, stamp_to, it_to_before);
-  a = AccelInterp::interpolate(&acc_buffer_, stamp_to);
-  stamps(range - 1) = stamp_to;
-  rectified_measurements.col(range - 1) = imu_model_->undistort(a, w);
-
   return std::make_pair(stamps, rectified_measurements);
 }
 
@@ -190,10 +251,24 @@ template<int BufferSize, typename GyroInterp, typename AccelInterp>
 std::tuple<int64_t, int64_t, bool>
 ImuBuffer<BufferSize, GyroInterp, AccelInterp>::getOldestAndNewestStamp() const
 {
-  std::tuple<int64_t, int64_t, bool> accel =
-      acc_buffer_.getOldestAndNewestStamp();
-  std::tuple<int64_t, int64_t, bool> gyro =
-      gyr_buffer_.getOldestAndNewestStamp();
+  // Both stamps from a consistent state of the two buffers.
+  std::tuple<int64_t, int64_t, bool> accel;
+  std::tuple<int64_t, int64_t, bool> gyro;
+  std::tie(accel, gyro) = gyr_buffer_.read([&]()
+  {
+    return acc_buffer_.read([&]()
+    {
+      auto stamps = [](const SensorBuffer& buffer)
+      {
+        if (buffer.times().empty())
+        {
+          return std::make_tuple(int64_t{-1}, int64_t{-1}, false);
+        }
+        return std::make_tuple(buffer.times().front(), buffer.times().back(), true);
+      };
+      return std::make_pair(stamps(acc_buffer_), stamps(gyr_buffer_));
+    });
+  });
 
   if (!std::get<2>(accel) || !std::get<2>(gyro))
   {
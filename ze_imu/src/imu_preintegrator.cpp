@@ -0,0 +1,203 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/imu/imu_preintegrator.hpp>
+
+#include <ze/common/matrix.hpp>
+#include <ze/common/transformation.hpp>
+
+namespace ze {
+
+namespace {
+
+real_t noiseDensitySquared(const ImuNoiseModel::Ptr& noise)
+{
+  CHECK(noise);
+  switch (noise->type())
+  {
+    case ImuNoiseType::None:
+      return 0.0;
+    case ImuNoiseType::WhiteBrownian:
+    {
+      const real_t density =
+          std::static_pointer_cast<ImuNoiseWhiteBrownian>(noise)->noiseDensity();
+      return density * density;
+    }
+    default:
+      LOG(FATAL) << "Unsupported noise model: " << noise->typeAsString();
+  }
+  return 0.0;
+}
+
+} // anonymous namespace
+
+ImuPreintegrator::ImuPreintegrator(
+    const ImuNoiseModel::Ptr& acc_noise,
+    const ImuNoiseModel::Ptr& gyr_noise)
+  : acc_noise_density_sq_(noiseDensitySquared(acc_noise))
+  , gyr_noise_density_sq_(noiseDensitySquared(gyr_noise))
+{
+}
+
+ImuPreintegrator::ImuPreintegrator(const ImuModel::Ptr& imu_model)
+  : ImuPreintegrator(imu_model->accelerometerModel()->noiseModel(),
+                     imu_model->gyroscopeModel()->noiseModel())
+{
+}
+
+void ImuPreintegrator::reset(int64_t stamp)
+{
+  stamp_start_ = stamp;
+  stamp_end_ = stamp;
+  num_measurements_ = 0u;
+  delta_t_ = 0.0;
+  delta_R_ = I_3x3;
+  delta_v_.setZero();
+  delta_p_.setZero();
+  covariance_.setZero();
+  dR_dbg_.setZero();
+  dV_dba_.setZero();
+  dV_dbg_.setZero();
+  dP_dba_.setZero();
+  dP_dbg_.setZero();
+}
+
+void ImuPreintegrator::reset(
+    int64_t stamp, const Vector3& acc_bias, const Vector3& gyr_bias)
+{
+  acc_bias_ = acc_bias;
+  gyr_bias_ = gyr_bias;
+  reset(stamp);
+}
+
+void ImuPreintegrator::integrate(
+    int64_t stamp_to, const Eigen::Ref<const ImuAccGyr>& acc_gyr)
+{
+  DEBUG_CHECK_GE(stamp_start_, 0) << "Call reset() before integrating.";
+  CHECK_GT(stamp_to, stamp_end_);
+  const real_t dt = nanosecToSecTrunc(stamp_to - stamp_end_);
+  integrateStep(acc_gyr.head<3>() - acc_bias_,
+                acc_gyr.tail<3>() - gyr_bias_, dt);
+  stamp_end_ = stamp_to;
+  ++num_measurements_;
+}
+
+void ImuPreintegrator::integrate(
+    const ImuStamps& stamps, const ImuAccGyrContainer& acc_gyr)
+{
+  DEBUG_CHECK_GE(stamp_start_, 0) << "Call reset() before integrating.";
+  CHECK_EQ(stamps.size(), acc_gyr.cols());
+  CHECK_GE(stamps.size(), 2);
+  CHECK_EQ(stamps(0), stamp_end_);
+  for (int i = 0; i < stamps.size() - 1; ++i)
+  {
+    integrate(stamps(i + 1), acc_gyr.col(i));
+  }
+}
+
+void ImuPreintegrator::integrateStep(
+    const Vector3& acc, const Vector3& gyr, real_t dt)
+{
+  const real_t dt2 = dt * dt;
+  const Vector3 theta = gyr * dt;
+  const Matrix3 dR = Quaternion::exp(theta).getRotationMatrix();
+  const Matrix3 Jr = expmapDerivativeSO3(theta);
+  const Matrix3 R_acc_skew = delta_R_ * skewSymmetric(acc);
+
+  // Covariance propagation: Sigma = A * Sigma * A' + B * Qg * B' + C * Qa * C'.
+  // Only the non-trivial blocks of A, B and C are formed.
+  if (acc_noise_density_sq_ > 0.0 || gyr_noise_density_sq_ > 0.0)
+  {
+    Matrix9 A = I_9x9;
+    A.block<3,3>(0,0) = dR.transpose();
+    A.block<3,3>(3,0) = -R_acc_skew * dt;
+    A.block<3,3>(6,0) = -0.5 * R_acc_skew * dt2;
+    A.block<3,3>(6,3) = I_3x3 * dt;
+
+    // Discrete-time noise variances are density^2 / dt.
+    const real_t var_gyr = gyr_noise_density_sq_ / dt;
+    const real_t var_acc = acc_noise_density_sq_ / dt;
+    Matrix93 B_gyr = Matrix93::Zero();
+    B_gyr.block<3,3>(0,0) = Jr * dt;
+    Matrix93 B_acc = Matrix93::Zero();
+    B_acc.block<3,3>(3,0) = delta_R_ * dt;
+    B_acc.block<3,3>(6,0) = 0.5 * delta_R_ * dt2;
+
+    covariance_ = A * covariance_ * A.transpose()
+        + var_gyr * B_gyr * B_gyr.transpose()
+        + var_acc * B_acc * B_acc.transpose();
+  }
+
+  // Bias Jacobians. Position and velocity use the rotation before the update.
+  dP_dba_ += dV_dba_ * dt - 0.5 * delta_R_ * dt2;
+  dP_dbg_ += dV_dbg_ * dt - 0.5 * R_acc_skew * dR_dbg_ * dt2;
+  dV_dba_ -= delta_R_ * dt;
+  dV_dbg_ -= R_acc_skew * dR_dbg_ * dt;
+  dR_dbg_ = dR.transpose() * dR_dbg_ - Jr * dt;
+
+  // Preintegrated measurements.
+  const Vector3 acc_rotated = delta_R_ * acc;
+  delta_p_ += delta_v_ * dt + 0.5 * acc_rotated * dt2;
+  delta_v_ += acc_rotated * dt;
+  delta_R_ = delta_R_ * dR;
+  delta_t_ += dt;
+}
+
+Matrix3 ImuPreintegrator::deltaRCorrected(const Vector3& gyr_bias) const
+{
+  return delta_R_
+      * Quaternion::exp(dR_dbg_ * (gyr_bias - gyr_bias_)).getRotationMatrix();
+}
+
+Vector3 ImuPreintegrator::deltaVCorrected(
+    const Vector3& acc_bias, const Vector3& gyr_bias) const
+{
+  return delta_v_ + dV_dba_ * (acc_bias - acc_bias_)
+      + dV_dbg_ * (gyr_bias - gyr_bias_);
+}
+
+Vector3 ImuPreintegrator::deltaPCorrected(
+    const Vector3& acc_bias, const Vector3& gyr_bias) const
+{
+  return delta_p_ + dP_dba_ * (acc_bias - acc_bias_)
+      + dP_dbg_ * (gyr_bias - gyr_bias_);
+}
+
+void ImuPreintegrator::predict(
+    const Matrix3& R_W_Bi, const Vector3& v_W_i, const Vector3& p_W_i,
+    const Vector3& g_W, const Vector3& acc_bias, const Vector3& gyr_bias,
+    Matrix3* R_W_Bj, Vector3* v_W_j, Vector3* p_W_j) const
+{
+  CHECK_NOTNULL(R_W_Bj);
+  CHECK_NOTNULL(v_W_j);
+  CHECK_NOTNULL(p_W_j);
+  const real_t dt = delta_t_;
+  *R_W_Bj = R_W_Bi * deltaRCorrected(gyr_bias);
+  *v_W_j = v_W_i + g_W * dt + R_W_Bi * deltaVCorrected(acc_bias, gyr_bias);
+  *p_W_j = p_W_i + v_W_i * dt + 0.5 * g_W * dt * dt
+      + R_W_Bi * deltaPCorrected(acc_bias, gyr_bias);
+}
+
+} // namespace ze
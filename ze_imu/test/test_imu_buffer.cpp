@@ -23,6 +23,9 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <atomic>
+#include <thread>
+
 #include <ze/common/test_entrypoint.hpp>
 
 #include <ze/imu/imu_buffer.hpp>
@@ -167,4 +170,93 @@ TEST(ImuBufferTest, testDifferentiation)
   EXPECT_TRUE(EIGEN_MATRIX_NEAR(ref, m, 1e-10));
 }
 
+TEST(ImuBufferTest, testConcurrentReaders)
+{
+  using namespace ze;
+  std::shared_ptr<ImuIntrinsicModelCalibrated> intrinsics =
+      std::make_shared<ImuIntrinsicModelCalibrated>();
+  std::shared_ptr<ImuNoiseNone> noise = std::make_shared<ImuNoiseNone>();
+  ImuModel::Ptr model(std::make_shared<ImuModel>(
+                        std::make_shared<AccelerometerModel>(intrinsics, noise),
+                        std::make_shared<GyroscopeModel>(intrinsics, noise)));
+  ImuBufferLinear2000::Ptr buffer = std::make_shared<ImuBufferLinear2000>(model);
+
+  // Measurements are linear in time, so every interpolated value must be too.
+  auto measurement = [](int64_t t)
+  {
+    ImuAccGyr value;
+    value << t, 2 * t, 3 * t, -t, -2 * t, -3 * t;
+    return value;
+  };
+  auto consistent = [&](int64_t t, const ImuAccGyr& value)
+  {
+    return (value - measurement(t)).cwiseAbs().maxCoeff() < 1e-3;
+  };
+  for (int64_t t = 0; t < 100; ++t)
+  {
+    buffer->insertImuMeasurement(t, measurement(t));
+  }
+
+  const int num_readers = 2;
+  const int64_t min_reads = 20000;
+  std::atomic<bool> done(false);
+  std::atomic<int> num_started(0);
+  std::atomic<int64_t> num_reads(0);
+  std::atomic<int> num_errors(0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < num_readers; ++r)
+  {
+    readers.emplace_back([&]()
+    {
+      ++num_started;
+      while (!done)
+      {
+        ++num_reads;
+        int64_t newest;
+        bool success;
+        std::tie(std::ignore, newest, success) = buffer->getOldestAndNewestStamp();
+        if (!success)
+        {
+          ++num_errors;
+          continue;
+        }
+
+        ImuAccGyr value;
+        if (buffer->get(newest - 10, value) && !consistent(newest - 10, value))
+        {
+          ++num_errors;
+        }
+
+        ImuStamps stamps;
+        ImuAccGyrContainer values;
+        std::tie(stamps, values) =
+            buffer->getBetweenValuesInterpolated(newest - 50, newest - 20);
+        for (int k = 0; k < stamps.size(); ++k)
+        {
+          if (!consistent(stamps(k), values.col(k)))
+          {
+            ++num_errors;
+          }
+        }
+      }
+    });
+  }
+
+  // Write while the readers are running, until they read often enough.
+  while (num_started < num_readers)
+  {
+    std::this_thread::yield();
+  }
+  for (int64_t t = 100; t < 20000 || num_reads < min_reads; ++t)
+  {
+    buffer->insertImuMeasurement(t, measurement(t));
+  }
+  done = true;
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+  EXPECT_EQ(num_errors, 0);
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -0,0 +1,217 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/transformation.hpp>
+#include <ze/imu/imu_buffer.hpp>
+#include <ze/imu/imu_preintegrator.hpp>
+
+namespace {
+
+ze::ImuModel::Ptr createImuModel(const ze::ImuNoiseModel::Ptr& noise)
+{
+  using namespace ze;
+  std::shared_ptr<ImuIntrinsicModelCalibrated> intrinsics =
+      std::make_shared<ImuIntrinsicModelCalibrated>();
+  AccelerometerModel::Ptr a_model =
+      std::make_shared<AccelerometerModel>(intrinsics, noise);
+  GyroscopeModel::Ptr g_model =
+      std::make_shared<GyroscopeModel>(intrinsics, noise);
+  return std::make_shared<ImuModel>(a_model, g_model);
+}
+
+} // anonymous namespace
+
+TEST(ImuPreintegratorTest, testConstantMeasurements)
+{
+  using namespace ze;
+  ImuPreintegrator preintegrator(createImuModel(std::make_shared<ImuNoiseNone>()));
+  preintegrator.reset(0);
+
+  ImuAccGyr acc_gyr;
+  acc_gyr << 1.0, -2.0, 0.5, 0.0, 0.0, 0.0;
+  const int64_t dt_ns = millisecToNanosec(1);
+  for (int i = 1; i <= 1000; ++i)
+  {
+    preintegrator.integrate(i * dt_ns, acc_gyr);
+  }
+  EXPECT_EQ(preintegrator.numMeasurements(), 1000u);
+  EXPECT_NEAR(preintegrator.deltaT(), 1.0, 1e-9);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(preintegrator.deltaR(), I_3x3, 1e-12));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(preintegrator.deltaV(),
+                                Vector3(acc_gyr.head<3>()), 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(preintegrator.deltaP(),
+                                Vector3(0.5 * acc_gyr.head<3>()), 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(preintegrator.covariance(), Z_9x9, 1e-12));
+
+  // Pure rotation.
+  acc_gyr << 0.0, 0.0, 0.0, 0.3, -0.1, 0.2;
+  preintegrator.reset(0);
+  for (int i = 1; i <= 1000; ++i)
+  {
+    preintegrator.integrate(i * dt_ns, acc_gyr);
+  }
+  const Matrix3 R_ref =
+      Quaternion::exp(Vector3(acc_gyr.tail<3>())).getRotationMatrix();
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(preintegrator.deltaR(), R_ref, 1e-9));
+}
+
+TEST(ImuPreintegratorTest, testBiasCorrection)
+{
+  using namespace ze;
+  ImuNoiseModel::Ptr noise = std::make_shared<ImuNoiseNone>();
+
+  const int n = 500;
+  const int64_t dt_ns = millisecToNanosec(2);
+  ImuStamps stamps(n + 1);
+  ImuAccGyrContainer acc_gyr(6, n + 1);
+  for (int i = 0; i <= n; ++i)
+  {
+    stamps(i) = i * dt_ns;
+    const real_t t = nanosecToSecTrunc(stamps(i));
+    acc_gyr.col(i) << std::sin(t), 9.81 + std::cos(2.0 * t), 0.2 * t,
+                      0.5 * std::cos(t), 0.1, -0.3 * std::sin(3.0 * t);
+  }
+
+  const Vector3 acc_bias_lin(0.1, -0.05, 0.02);
+  const Vector3 gyr_bias_lin(0.01, 0.02, -0.01);
+  ImuPreintegrator preintegrator(noise, noise);
+  preintegrator.reset(0, acc_bias_lin, gyr_bias_lin);
+  preintegrator.integrate(stamps, acc_gyr);
+
+  // Re-integrate at a slightly different bias and compare with the first-order
+  // correction.
+  const Vector3 acc_bias = acc_bias_lin + Vector3(0.01, 0.005, -0.01);
+  const Vector3 gyr_bias = gyr_bias_lin + Vector3(-0.002, 0.001, 0.003);
+  ImuPreintegrator reference(noise, noise);
+  reference.reset(0, acc_bias, gyr_bias);
+  reference.integrate(stamps, acc_gyr);
+
+  const Vector3 dR_err = Quaternion::fromApproximateRotationMatrix(
+        preintegrator.deltaRCorrected(gyr_bias).transpose()
+        * reference.deltaR()).log();
+  EXPECT_LT(dR_err.norm(), 1e-5);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                preintegrator.deltaVCorrected(acc_bias, gyr_bias),
+                reference.deltaV(), 1e-4));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                preintegrator.deltaPCorrected(acc_bias, gyr_bias),
+                reference.deltaP(), 1e-4));
+
+  // The uncorrected deltas must be clearly worse.
+  EXPECT_GT((preintegrator.deltaV() - reference.deltaV()).norm(), 1e-3);
+}
+
+TEST(ImuPreintegratorTest, testPredict)
+{
+  using namespace ze;
+  ImuNoiseModel::Ptr noise = std::make_shared<ImuNoiseNone>();
+  ImuPreintegrator preintegrator(noise, noise);
+  preintegrator.reset(0);
+
+  // A body at rest measures the reaction to gravity.
+  const Vector3 g_W(0.0, 0.0, -9.81);
+  const Matrix3 R_W_B = Quaternion::exp(Vector3(0.1, -0.2, 0.3)).getRotationMatrix();
+  ImuAccGyr acc_gyr;
+  acc_gyr << -R_W_B.transpose() * g_W, Vector3::Zero();
+  for (int i = 1; i <= 200; ++i)
+  {
+    preintegrator.integrate(i * millisecToNanosec(5), acc_gyr);
+  }
+
+  Matrix3 R_W_Bj;
+  Vector3 v_W_j, p_W_j;
+  const Vector3 v_W_i(1.0, 0.0, 0.0);
+  const Vector3 p_W_i(0.0, 2.0, 0.0);
+  preintegrator.predict(R_W_B, v_W_i, p_W_i, g_W, Vector3::Zero(),
+                        Vector3::Zero(), &R_W_Bj, &v_W_j, &p_W_j);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(R_W_Bj, R_W_B, 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(v_W_j, v_W_i, 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(p_W_j, Vector3(p_W_i + v_W_i), 1e-9));
+}
+
+TEST(ImuPreintegratorTest, testCovariance)
+{
+  using namespace ze;
+  ImuNoiseModel::Ptr noise =
+      std::make_shared<ImuNoiseWhiteBrownian>(0.01, 200.0, 0.001);
+  ImuPreintegrator preintegrator(noise, noise);
+  preintegrator.reset(0);
+
+  ImuAccGyr acc_gyr;
+  acc_gyr << 0.2, 0.1, 9.81, 0.1, 0.2, -0.1;
+  real_t last_trace = 0.0;
+  for (int i = 1; i <= 100; ++i)
+  {
+    preintegrator.integrate(i * millisecToNanosec(5), acc_gyr);
+    const Matrix9& cov = preintegrator.covariance();
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(cov, Matrix9(cov.transpose()), 1e-12));
+    EXPECT_GT(cov.trace(), last_trace);
+    last_trace = cov.trace();
+  }
+
+  // Rotation uncertainty of a pure random walk: sigma^2 * t.
+  EXPECT_NEAR(preintegrator.covariance()(0,0), 0.01 * 0.01 * 0.5, 1e-6);
+}
+
+TEST(ImuPreintegratorTest, testIntegrateFromBuffer)
+{
+  using namespace ze;
+  ImuModel::Ptr model = createImuModel(std::make_shared<ImuNoiseNone>());
+  ImuBufferLinear5000 buffer(model);
+
+  ImuAccGyr acc_gyr;
+  acc_gyr << 0.0, 0.0, 9.81, 0.0, 0.0, 0.5;
+  const int64_t dt_ns = millisecToNanosec(1);
+  for (int i = 0; i <= 1000; ++i)
+  {
+    buffer.insertImuMeasurement(i * dt_ns, acc_gyr);
+  }
+
+  // Extending the window in steps gives the same result as one block.
+  ImuPreintegrator incremental(model);
+  incremental.reset(100 * dt_ns);
+  for (int i = 200; i <= 900; i += 100)
+  {
+    EXPECT_TRUE(incremental.integrateFromBuffer(buffer, i * dt_ns));
+  }
+  ImuPreintegrator batch(model);
+  batch.reset(100 * dt_ns);
+  EXPECT_TRUE(batch.integrateFromBuffer(buffer, 900 * dt_ns));
+
+  EXPECT_EQ(incremental.stampEnd(), 900 * dt_ns);
+  EXPECT_NEAR(incremental.deltaT(), 0.8, 1e-9);
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(incremental.deltaR(), batch.deltaR(), 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(incremental.deltaV(), batch.deltaV(), 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(incremental.deltaP(), batch.deltaP(), 1e-9));
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                incremental.deltaR(),
+                Quaternion::exp(Vector3(0.0, 0.0, 0.4)).getRotationMatrix(), 1e-9));
+
+  // Out of buffer range.
+  EXPECT_FALSE(incremental.integrateFromBuffer(buffer, 2000 * dt_ns));
+}
+
+ZE_UNITTEST_ENTRYPOINT
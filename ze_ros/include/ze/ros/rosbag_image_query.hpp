@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <list>
+#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <rosbag/bag.h>
+#include <rosbag/message_instance.h>
 
 #include <imp/bridge/ros/ros_bridge.hpp>
 #include <imp/core/image.hpp>
@@ -14,13 +18,21 @@
 
 namespace ze {
 
+//! Queries images by timestamp from a rosbag.
+//! On loading, a per-topic index of the message times of all image topics
+//! is built, such that queries are binary searches instead of new rosbag
+//! views. Decoded images are kept in an LRU cache with a byte budget.
+//! Note that cached images are shared between queries and must not be
+//! modified by the caller.
 class RosbagImageQuery
 {
 public:
   ZE_POINTER_TYPEDEFS(RosbagImageQuery);
 
   RosbagImageQuery() = default;
-  RosbagImageQuery(const std::string& bagfile_path);
+  RosbagImageQuery(
+      const std::string& bagfile_path,
+      const size_t cache_budget_bytes = 256u * 1024u * 1024u);
   ~RosbagImageQuery() = default;
 
   bool loadRosbag(const std::string& bagfile_path);
@@ -30,8 +42,56 @@ public:
       const int64_t stamp_ns,
       const real_t search_range_ms = 10.0);
 
+  //! Returns the images closest to all query stamps. Every image is decoded
+  //! only once and images are read in bag order, such that each chunk of the
+  //! bag is loaded at most once per call. Stamps need not be sorted.
+  StampedImages getStampedImagesAtTimes(
+      const std::string& img_topic,
+      const std::vector<int64_t>& stamps_ns,
+      const real_t search_range_ms = 10.0);
+
+  //! Maximum number of bytes of decoded images kept in the cache. A budget of
+  //! zero disables caching.
+  void setCacheBudget(const size_t cache_budget_bytes);
+  inline size_t cacheBudget() const { return cache_budget_bytes_; }
+  inline size_t cacheSize() const { return cache_size_bytes_; }
+
 private:
+  //! Message times and instances of one image topic, sorted by time.
+  struct TopicIndex
+  {
+    uint32_t id;
+    std::vector<int64_t> stamps_ns;
+    std::vector<rosbag::MessageInstance> messages;
+  };
+
+  //! Cache key: Topic id in the upper and message index in the lower 32 bits.
+  using CacheKey = uint64_t;
+  using CacheList = std::list<std::pair<CacheKey, StampedImage>>;
+
+  void buildIndex();
+
+  const TopicIndex* topicIndex(const std::string& img_topic) const;
+
+  //! Returns the index of the closest message within the search range or -1.
+  int64_t closestMessage(
+      const TopicIndex& index,
+      const int64_t stamp_ns,
+      const int64_t search_range_ns) const;
+
+  StampedImage loadImage(const TopicIndex& index, const size_t message_idx);
+
+  void insertIntoCache(const CacheKey key, const StampedImage& image);
+
+  void shrinkCache();
+
   rosbag::Bag bag_;
+  std::map<std::string, TopicIndex> topic_indices_;
+
+  size_t cache_budget_bytes_ = 256u * 1024u * 1024u;
+  size_t cache_size_bytes_ = 0u;
+  CacheList cache_;  //!< Most recently used first.
+  std::unordered_map<CacheKey, CacheList::iterator> cache_map_;
 };
 
 }  // namespace ze
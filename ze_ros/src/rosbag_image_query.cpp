@@ -4,14 +4,22 @@
 
 #include <ze/ros/rosbag_image_query.hpp>
 
+#include <algorithm>
+#include <limits>
+
 #include <glog/logging.h>
 #include <rosbag/view.h>
+#include <rosbag/query.h>
+#include <ze/common/logging.hpp>
 #include <ze/common/file_utils.hpp>
 #include <ze/common/time_conversions.hpp>
 
 namespace ze {
 
-RosbagImageQuery::RosbagImageQuery(const std::string& bagfile_path)
+RosbagImageQuery::RosbagImageQuery(
+    const std::string& bagfile_path,
+    const size_t cache_budget_bytes)
+  : cache_budget_bytes_(cache_budget_bytes)
 {
   CHECK(loadRosbag(bagfile_path));
 }
@@ -29,55 +37,202 @@ bool RosbagImageQuery::loadRosbag(const std::string& bagfile_path)
     LOG(ERROR) << "Could not open rosbag: " << bagfile_path << ": " << exception.what();
     return false;
   }
+  buildIndex();
   return true;
 }
 
+void RosbagImageQuery::buildIndex()
+{
+  topic_indices_.clear();
+  cache_.clear();
+  cache_map_.clear();
+  cache_size_bytes_ = 0u;
+
+  // Iterating a view only touches the bag index, no message data is read.
+  // Messages are visited in time order, hence every topic index is sorted.
+  rosbag::View view(bag_, rosbag::TypeQuery("sensor_msgs/Image"));
+  for (const rosbag::MessageInstance& message : view)
+  {
+    auto it = topic_indices_.find(message.getTopic());
+    if (it == topic_indices_.end())
+    {
+      TopicIndex index;
+      index.id = topic_indices_.size();
+      it = topic_indices_.emplace(message.getTopic(), index).first;
+    }
+    it->second.stamps_ns.push_back(message.getTime().toNSec());
+    it->second.messages.push_back(message);
+  }
+
+  for (const auto& it : topic_indices_)
+  {
+    VLOG(1) << "Indexed " << it.second.stamps_ns.size()
+            << " images on topic " << it.first;
+  }
+}
+
+const RosbagImageQuery::TopicIndex* RosbagImageQuery::topicIndex(
+    const std::string& img_topic) const
+{
+  auto it = topic_indices_.find(img_topic);
+  if (it == topic_indices_.end())
+  {
+    LOG(WARNING) << "No images on topic " << img_topic << " in bag.";
+    return nullptr;
+  }
+  return &it->second;
+}
+
+int64_t RosbagImageQuery::closestMessage(
+    const TopicIndex& index,
+    const int64_t stamp_ns,
+    const int64_t search_range_ns) const
+{
+  const std::vector<int64_t>& stamps = index.stamps_ns;
+  const auto upper = std::lower_bound(stamps.begin(), stamps.end(), stamp_ns);
+
+  // Compare with the predecessor, which wins ties as in a forward scan.
+  int64_t best_idx = -1;
+  int64_t best_time_diff = std::numeric_limits<int64_t>::max();
+  if (upper != stamps.begin())
+  {
+    best_idx = (upper - stamps.begin()) - 1;
+    best_time_diff = stamp_ns - stamps[best_idx];
+  }
+  if (upper != stamps.end() && *upper - stamp_ns < best_time_diff)
+  {
+    best_idx = upper - stamps.begin();
+    best_time_diff = *upper - stamp_ns;
+  }
+  if (best_idx < 0 || best_time_diff > search_range_ns)
+  {
+    return -1;
+  }
+  return best_idx;
+}
+
+StampedImage RosbagImageQuery::loadImage(
+    const TopicIndex& index, const size_t message_idx)
+{
+  DEBUG_CHECK_LT(message_idx, index.messages.size());
+  const CacheKey key =
+      (static_cast<CacheKey>(index.id) << 32) | static_cast<CacheKey>(message_idx);
+  auto it = cache_map_.find(key);
+  if (it != cache_map_.end())
+  {
+    cache_.splice(cache_.begin(), cache_, it->second);
+    return it->second->second;
+  }
+
+  sensor_msgs::ImageConstPtr msg =
+      index.messages[message_idx].instantiate<sensor_msgs::Image>();
+  CHECK(msg);
+  StampedImage image = std::make_pair(msg->header.stamp.toNSec(),
+                                      toImageCpu(msg));
+  insertIntoCache(key, image);
+  return image;
+}
+
+void RosbagImageQuery::insertIntoCache(
+    const CacheKey key, const StampedImage& image)
+{
+  if (!image.second || image.second->bytes() > cache_budget_bytes_)
+  {
+    return;
+  }
+  cache_.emplace_front(key, image);
+  cache_map_[key] = cache_.begin();
+  cache_size_bytes_ += image.second->bytes();
+  shrinkCache();
+}
+
+void RosbagImageQuery::shrinkCache()
+{
+  while (cache_size_bytes_ > cache_budget_bytes_)
+  {
+    DEBUG_CHECK(!cache_.empty());
+    cache_size_bytes_ -= cache_.back().second.second->bytes();
+    cache_map_.erase(cache_.back().first);
+    cache_.pop_back();
+  }
+}
+
+void RosbagImageQuery::setCacheBudget(const size_t cache_budget_bytes)
+{
+  cache_budget_bytes_ = cache_budget_bytes;
+  shrinkCache();
+}
+
+namespace {
+
+void warnNoImageFound()
+{
+  LOG(WARNING) << "No image found in bag with this timestamp. If this "
+               << "problem is persistent, you may need to re-index the bag: "
+               << "rosrun ze_rosbag_tools bagrestamper.py -i dataset.bag -o dataset_new.bag";
+}
+
+} // unnamed namespace
+
 StampedImage RosbagImageQuery::getStampedImageAtTime(
     const std::string& img_topic,
     const int64_t stamp_ns,
     const real_t search_range_ms)
 {
-  // Considering rounding errors.
+  const TopicIndex* index = topicIndex(img_topic);
+  const int64_t message_idx =
+      index ? closestMessage(*index, stamp_ns, millisecToNanosec(search_range_ms))
+            : -1;
+  if (message_idx < 0)
+  {
+    warnNoImageFound();
+    return std::make_pair(-1, ImageBase::Ptr());
+  }
+  return loadImage(*index, message_idx);
+}
+
+StampedImages RosbagImageQuery::getStampedImagesAtTimes(
+    const std::string& img_topic,
+    const std::vector<int64_t>& stamps_ns,
+    const real_t search_range_ms)
+{
+  StampedImages images(stamps_ns.size(),
+                       std::make_pair(-1, ImageBase::Ptr()));
+  const TopicIndex* index = topicIndex(img_topic);
+  if (!index)
+  {
+    return images;
+  }
+
+  // Resolve all queries first, then load the images in bag order.
   const int64_t search_range_ns = millisecToNanosec(search_range_ms);
-  ros::Time time_min, time_max;
-  time_min.fromNSec(stamp_ns - search_range_ns);
-  time_max.fromNSec(stamp_ns + search_range_ns);
-  rosbag::View view(bag_, rosbag::TopicQuery(img_topic), time_min, time_max);
+  std::vector<std::pair<int64_t, size_t>> requests; // (message, query)
+  requests.reserve(stamps_ns.size());
+  for (size_t i = 0u; i < stamps_ns.size(); ++i)
+  {
+    const int64_t message_idx =
+        closestMessage(*index, stamps_ns[i], search_range_ns);
+    if (message_idx < 0)
+    {
+      warnNoImageFound();
+      continue;
+    }
+    requests.emplace_back(message_idx, i);
+  }
+  std::sort(requests.begin(), requests.end());
 
-  VLOG(100) << "Found messages that fit = " << view.size();
-  int64_t best_time_diff = std::numeric_limits<int64_t>::max();
-  sensor_msgs::ImageConstPtr best_match_message;
-  for (const rosbag::MessageInstance& message : view)
+  for (size_t i = 0u; i < requests.size(); ++i)
   {
-    const int64_t time_diff =
-        std::abs(static_cast<int64_t>(message.getTime().toNSec()) - stamp_ns);
-    if (time_diff < best_time_diff)
+    if (i > 0u && requests[i].first == requests[i - 1u].first)
     {
-      best_time_diff = time_diff;
-      best_match_message = message.instantiate<sensor_msgs::Image>();
-      CHECK(best_match_message);
+      images[requests[i].second] = images[requests[i - 1u].second];
     }
     else
     {
-      break; // Already passed relevant time.
+      images[requests[i].second] = loadImage(*index, requests[i].first);
     }
   }
-
-  // Extract image
-  int64_t best_match_stamp = -1;
-  ImageBase::Ptr best_match_img;
-  if (best_match_message)
-  {
-    best_match_stamp = best_match_message->header.stamp.toNSec();
-    best_match_img = toImageCpu(*best_match_message);
-  }
-  else
-  {
-    LOG(WARNING) << "No image found in bag with this timestamp. If this "
-                 << "problem is persistent, you may need to re-index the bag: "
-                 << "rosrun ze_rosbag_tools bagrestamper.py -i dataset.bag -o dataset_new.bag";
-  }
-  return std::make_pair(best_match_stamp, best_match_img);
+  return images;
 }
 
 }  // namespace ze
@@ -58,4 +58,36 @@ TEST(RosbagImageQueryTests, testImageQuery)
   }
 }
 
+TEST(RosbagImageQueryTests, testBatchedImageQuery)
+{
+  using namespace ze;
+
+  std::string data_dir = getTestDataDir("rosbag_euroc_snippet");
+  std::string bag_filename = joinPath(data_dir, "dataset.bag");
+  RosbagImageQuery rosbag(bag_filename);
+
+  std::vector<int64_t> stamps = {
+    nanosecFromSecAndNanosec(1403636618, 463555500),
+    nanosecFromSecAndNanosec(1403636617, 863555500),
+    nanosecFromSecAndNanosec(1403636618, 463555500),
+    nanosecFromSecAndNanosec(1303636617, 0) };
+  StampedImages res = rosbag.getStampedImagesAtTimes("/cam0/image_raw", stamps);
+  ASSERT_EQ(res.size(), stamps.size());
+  for (size_t i = 0u; i < 3u; ++i)
+  {
+    EXPECT_EQ(res[i].first, stamps[i]);
+    ASSERT_TRUE(res[i].second != nullptr);
+    StampedImage single = rosbag.getStampedImageAtTime("/cam0/image_raw", stamps[i]);
+    EXPECT_EQ(single.first, res[i].first);
+    // Served from the cache.
+    EXPECT_EQ(single.second, res[i].second);
+  }
+  EXPECT_EQ(res[3].first, -1);
+  EXPECT_TRUE(res[3].second == nullptr);
+  EXPECT_EQ(rosbag.cacheSize(), 2u * res[0].second->bytes());
+
+  rosbag.setCacheBudget(0u);
+  EXPECT_EQ(rosbag.cacheSize(), 0u);
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -341,6 +341,22 @@ public:
    */
   VectorX evalD(real_t t, int derivative_order) const;
 
+  /**
+   * Evaluate the spline curve and its derivatives at many times.
+   *
+   * The times must be sorted in non-decreasing order. The segments are walked
+   * monotonically instead of being searched for every time and the basis of a
+   * segment is only combined with its coefficients once.
+   *
+   * @param times The sorted times to evaluate the spline at.
+   * @param max_derivative_order The highest derivative order to evaluate.
+   *
+   * @return For every derivative order d in [0, max_derivative_order] a
+   *         matrix whose column i is evalD(times[i], d).
+   */
+  std::vector<MatrixX> evalDBatch(const VectorX& times,
+                                  int max_derivative_order) const;
+
   /**
    * Evaluate the derivative of the spline curve at time t and retrieve the Jacobian
    * of the value with respect to small changes in the paramter vector. The Jacobian
@@ -745,6 +761,11 @@ protected:
    */
   real_t d_1(int k, int i, int j);
 
+  /// Implementation of evalDBatch with a basis of compile-time size Order.
+  template<int Order>
+  void evalDBatchImpl(const VectorX& times,
+                      std::vector<MatrixX>& values) const;
+
   /// The order of the spline.
   int spline_order_;
 
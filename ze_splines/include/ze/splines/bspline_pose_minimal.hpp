@@ -160,6 +160,16 @@ class BSplinePoseMinimal : public BSpline
         MatrixX* J,
         VectorXi* coefficient_indices) const;
 
+    //! Evaluates the poses, linear velocities and accelerations in the world
+    //! frame and the body-frame angular velocities at the sorted times in one
+    //! pass, see BSpline::evalDBatch. Outputs that are null are skipped.
+    void evalPoseBatch(
+        const VectorX& times,
+        TransformationVector* T_W_B,
+        Matrix3X* linear_velocity_W,
+        Matrix3X* linear_acceleration_W,
+        Matrix3X* angular_velocity_B) const;
+
     //! takes the two transformation matrices at two points in time
     //! to construct a pose spline
     void initPoseSpline(
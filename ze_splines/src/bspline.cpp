@@ -35,10 +35,87 @@
 #include <Eigen/Cholesky>
 #include <Eigen/LU>
 #include <Eigen/QR>
+#include <Eigen/SparseCholesky>
 #include <boost/tuple/tuple.hpp>
 
 namespace ze {
 
+namespace {
+
+//! Normal equations of a least-squares problem in the spline coefficients.
+//! Every constraint only depends on the coefficients of one time segment,
+//! i.e. on spline_order consecutive coefficient vectors. The contributions
+//! are summed per segment and the resulting banded system is solved with a
+//! sparse Cholesky decomposition, which is linear in the number of segments.
+class BandedNormalEquations
+{
+public:
+  BandedNormalEquations(int num_coefficients, int dim, int spline_order)
+    : D_(dim)
+    , block_size_(spline_order * dim)
+    , H_blocks_(num_coefficients - spline_order + 1,
+                MatrixX::Zero(block_size_, block_size_))
+    , g_(VectorX::Zero(num_coefficients * dim))
+  {}
+
+  //! Adds the constraint J * x.segment(col, J.cols()) = b.
+  void addConstraint(int col, const MatrixX& J, const VectorX& b)
+  {
+    addHessianBlock(col, J.transpose() * J);
+    g_.segment(col, block_size_).noalias() += J.transpose() * b;
+  }
+
+  //! Adds the quadratic term x.segment(col, H.cols())' * H * x.segment(...).
+  void addHessianBlock(int col, const MatrixX& H)
+  {
+    DEBUG_CHECK_EQ(col % D_, 0);
+    DEBUG_CHECK_EQ(H.rows(), block_size_);
+    H_blocks_.at(col / D_) += H;
+  }
+
+  VectorX solve() const
+  {
+    // Assemble the lower triangle.
+    std::vector<Eigen::Triplet<real_t>> triplets;
+    triplets.reserve(H_blocks_.size() * block_size_ * (block_size_ + 1) / 2);
+    for (size_t s = 0u; s < H_blocks_.size(); ++s)
+    {
+      const int offset = s * D_;
+      for (int c = 0; c < block_size_; ++c)
+      {
+        for (int r = c; r < block_size_; ++r)
+        {
+          triplets.push_back(
+                Eigen::Triplet<real_t>(offset + r, offset + c, H_blocks_[s](r, c)));
+        }
+      }
+    }
+    Eigen::SparseMatrix<real_t> H(g_.size(), g_.size());
+    H.setFromTriplets(triplets.begin(), triplets.end());
+
+    // The natural ordering keeps the factorization within the band.
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<real_t>, Eigen::Lower,
+                          Eigen::NaturalOrdering<int>> ldlt(H);
+    if (ldlt.info() == Eigen::Success)
+    {
+      return ldlt.solve(g_);
+    }
+
+    // Rank deficient, e.g. too few points and no regularization. The dense
+    // LDLT only reads the lower triangle, too.
+    VLOG(1) << "Sparse LDLT failed, falling back to dense LDLT.";
+    return MatrixX(H).ldlt().solve(g_);
+  }
+
+private:
+  int D_;
+  int block_size_;
+  std::vector<MatrixX> H_blocks_;
+  VectorX g_;
+};
+
+} // anonymous namespace
+
 BSpline::BSpline(int spline_order)
   : spline_order_(spline_order)
 {
@@ -402,6 +479,108 @@ VectorX BSpline::evalD(real_t t, int derivative_order) const
   return rv;
 }
 
+template<int Order>
+void BSpline::evalDBatchImpl(const VectorX& times,
+                             std::vector<MatrixX>& values) const
+{
+  using BasisMatrix = Eigen::Matrix<real_t, Order, Order>;
+  using BasisVector = Eigen::Matrix<real_t, Order, 1>;
+  using SegmentMatrix = Eigen::Matrix<real_t, Eigen::Dynamic, Order>;
+
+  const int D = coefficients_.rows();
+  const int num_derivatives = values.size();
+  const int max_index = knots_.size() - spline_order_ - 1;
+  const real_t t_max_value = t_max();
+
+  // Derivative factors of the monomials, see computeU.
+  MatrixX factors = MatrixX::Zero(num_derivatives, spline_order_);
+  for (int d = 0; d < num_derivatives; ++d)
+  {
+    for (int i = d; i < spline_order_; ++i)
+    {
+      factors(d, i) = dmul(i, d);
+    }
+  }
+
+  int index = computeTIndex(times[0]).second;
+  bool update_segment = true;
+  SegmentMatrix P(D, spline_order_);
+  VectorX multipliers(num_derivatives);
+  BasisVector powers(spline_order_);
+  BasisVector u(spline_order_);
+  for (int k = 0; k < times.size(); ++k)
+  {
+    real_t t = times[k];
+    DEBUG_CHECK(k == 0 || times[k-1] <= t) << "The times must be sorted.";
+
+    // Same as computeTIndex, but starting from the previous segment.
+    if (std::abs(t_max_value - t) < 1e-10)
+    {
+      t = t_max_value;
+    }
+    while (index < max_index && knots_[index + 1] <= t)
+    {
+      ++index;
+      update_segment = true;
+    }
+
+    const real_t delta_t = knots_[index + 1] - knots_[index];
+    if (update_segment)
+    {
+      // [c_0 c_1 c_2 c_3] * B^T of this segment, as in evalD.
+      const int bidx = index - spline_order_ + 1;
+      const BasisMatrix B = basis_matrices_[bidx];
+      P.noalias() = coefficients_.block(0, bidx, D, spline_order_) * B.transpose();
+      for (int d = 0; d < num_derivatives; ++d)
+      {
+        multipliers(d) = (delta_t > 0.0) ? 1.0 / pow(delta_t, d) : 0.0;
+      }
+      update_segment = false;
+    }
+
+    const real_t uval = (delta_t > 0.0) ? (t - knots_[index]) / delta_t : 0.0;
+    powers(0) = 1.0;
+    for (int i = 1; i < spline_order_; ++i)
+    {
+      powers(i) = powers(i - 1) * uval;
+    }
+    for (int d = 0; d < num_derivatives; ++d)
+    {
+      u.setZero();
+      for (int i = d; i < spline_order_; ++i)
+      {
+        u(i) = multipliers(d) * powers(i - d) * factors(d, i);
+      }
+      values[d].col(k).noalias() = P * u;
+    }
+  }
+}
+
+std::vector<MatrixX> BSpline::evalDBatch(const VectorX& times,
+                                         int max_derivative_order) const
+{
+  CHECK_GE(max_derivative_order, 0) << "To integrate, use the integral function";
+  std::vector<MatrixX> values(max_derivative_order + 1,
+                              MatrixX(coefficients_.rows(), times.size()));
+  if (times.size() == 0)
+  {
+    return values;
+  }
+  // Checks the range of the times.
+  computeTIndex(times[times.size() - 1]);
+
+  switch (spline_order_)
+  {
+    case 2: evalDBatchImpl<2>(times, values); break;
+    case 3: evalDBatchImpl<3>(times, values); break;
+    case 4: evalDBatchImpl<4>(times, values); break;
+    case 5: evalDBatchImpl<5>(times, values); break;
+    case 6: evalDBatchImpl<6>(times, values); break;
+    default: evalDBatchImpl<Eigen::Dynamic>(times, values); break;
+  }
+  return values;
+}
+
 VectorX BSpline::evalDAndJacobian(real_t t,
                                   int derivative_order,
                                   MatrixX* Jacobian,
@@ -830,55 +1009,29 @@ void BSpline::initSpline2(const VectorX& times,
   // Set the knots and zero the coefficients
   setKnotsAndCoefficients(knots, MatrixX::Zero(D,C));
 
-  // Now we have to solve an Ax = b linear system to determine the correct coefficient vectors.
-  int coefficientDim = C * D;
-
-  int numConstraints = (knots.size() - 2 * spline_order_ + 2) + interpolation_points.cols();
-  int constraintSize = numConstraints * D;
-
-  MatrixX A = MatrixX::Zero(constraintSize, coefficientDim);
-  VectorX b = VectorX::Zero(constraintSize);
+  // Now we have to solve an Ax = b linear system to determine the correct
+  // coefficient vectors, in the least-squares sense.
+  BandedNormalEquations normal_equations(C, D, spline_order_);
 
-  int brow = 0;
-  //int bcol = 0;
   // Now add the regularization constraint.
-  //A.block(brow,bcol,coefficientDim,coefficientDim) = 1e-1* MatrixX::Identity(coefficientDim, coefficientDim);
-  //b.segment(brow,coefficientDim) = VectorX::Zero(coefficientDim);
-  //brow += coefficientDim;
+  const VectorX zero = VectorX::Zero(D);
   for(int i = spline_order_ - 1; i < (int)knots.size() - spline_order_ + 1; i++)
   {
     VectorXi coeffIndices = localCoefficientVectorIndices(knots[i]);
-
-    A.block(brow,coeffIndices[0],D,coeffIndices.size()) = lambda * Phi(knots[i],2);
-    b.segment(brow,D) = VectorX::Zero(D);
-    brow += D;
+    normal_equations.addConstraint(coeffIndices[0], lambda * Phi(knots[i],2), zero);
   }
 
   // Add the position constraints.
   for(int i = 0; i < interpolation_points.cols(); i++)
   {
     VectorXi coeffIndices = localCoefficientVectorIndices(times[i]);
-    A.block(brow,coeffIndices[0],D,coeffIndices.size()) = Phi(times[i],0);
-
-    b.segment(brow,D) = interpolation_points.col(i);
-    brow += D;
+    normal_equations.addConstraint(coeffIndices[0], Phi(times[i],0),
+                                   interpolation_points.col(i));
   }
 
-  // Now we solve the Ax=b system
-  //if(A.rows() != A.cols())
-  //  {
-  // The system is over constrained. This happens for odd ordered splines.
-  b = (A.transpose() * b).eval();
-  A = (A.transpose() * A).eval();
-  //  }
-
-  // Solve for the coefficient vector.
-  VectorX c = A.ldlt().solve(b);
-  // ldlt doesn't work for this problem. It may be because the ldlt decomposition
-  // requires the matrix to be positive or negative semidefinite
-  // http://eigen.tuxfamily.org/dox-devel/TutorialLinearAlgebra.html#TutorialLinAlgRankRevealing
-  // which may imply that it is symmetric. Our A matrix is only symmetric in the over-constrained case.
-  // VectorX c = A.ldlt().solve(b);
+  // Solve the normal equations for the coefficient vector. The system is
+  // over constrained for odd ordered splines.
+  VectorX c = normal_equations.solve();
   setCoefficientVector(c);
 }
 
@@ -915,38 +1068,27 @@ void BSpline::initSpline3(const VectorX& times,
 
   setKnotsAndCoefficients(knots, MatrixX::Zero(D,C));
 
-  // Now we have to solve an Ax = b linear system to determine the correct coefficient vectors.
-  int coefficientDim = C * D;
-
-  int numConstraints = interpolation_points.cols();
-  int constraintSize = numConstraints * D;
-
-  MatrixX A = MatrixX::Zero(constraintSize, coefficientDim);
-  VectorX b = VectorX::Zero(constraintSize);
+  // Now we have to solve an Ax = b linear system to determine the correct
+  // coefficient vectors, in the least-squares sense.
+  BandedNormalEquations normal_equations(C, D, spline_order_);
 
-  int brow = 0;
   // Add the position constraints.
   for(int i = 0; i < interpolation_points.cols(); i++)
   {
     VectorXi coeffIndices = localCoefficientVectorIndices(times[i]);
-
-    A.block(brow,coeffIndices[0],D,coeffIndices.size()) = Phi(times[i],0);
-
-    b.segment(brow,D) = interpolation_points.col(i);
-    brow += D;
+    normal_equations.addConstraint(coeffIndices[0], Phi(times[i],0),
+                                   interpolation_points.col(i));
   }
 
-  b = (A.transpose() * b).eval();
-  A = (A.transpose() * A).eval();
-
-  // Add the motion constraint.
+  // Add the motion constraint, see curveQuadraticIntegralDiag.
   VectorX W = VectorX::Constant(D,lambda);
+  for(int s = 0; s < numValidTimeSegments(); s++)
+  {
+    normal_equations.addHessianBlock(s * D, segmentQuadraticIntegralDiag(W, s, 2));
+  }
 
-  A += curveQuadraticIntegralDiag(W, 2);
-
-  VectorX c = A.ldlt().solve(b);
+  VectorX c = normal_equations.solve();
   setCoefficientVector(c);
-
 }
 
 void BSpline::addCurveSegment2(real_t t,
@@ -370,6 +370,55 @@ Vector3 BSplinePoseMinimal<RP>::angularVelocityAndJacobian(
   return omega;
 }
 
+template<class RP>
+void BSplinePoseMinimal<RP>::evalPoseBatch(
+    const VectorX& times,
+    TransformationVector* T_W_B,
+    Matrix3X* linear_velocity_W,
+    Matrix3X* linear_acceleration_W,
+    Matrix3X* angular_velocity_B) const
+{
+  const int max_derivative_order =
+      linear_acceleration_W ? 2 : ((linear_velocity_W || angular_velocity_B) ? 1 : 0);
+  const std::vector<MatrixX> v = evalDBatch(times, max_derivative_order);
+
+  if (T_W_B)
+  {
+    T_W_B->resize(times.size());
+  }
+  if (linear_velocity_W)
+  {
+    *linear_velocity_W = v[1].topRows<3>();
+  }
+  if (linear_acceleration_W)
+  {
+    *linear_acceleration_W = v[2].topRows<3>();
+  }
+  if (angular_velocity_B)
+  {
+    angular_velocity_B->resize(3, times.size());
+  }
+  if (!T_W_B && !angular_velocity_B)
+  {
+    return;
+  }
+
+  for (int i = 0; i < times.size(); ++i)
+  {
+    if (T_W_B)
+    {
+      (*T_W_B)[i] = Transformation(curveValueToTransformation(v[0].col(i)));
+    }
+    if (angular_velocity_B)
+    {
+      // See angularVelocityBodyFrame.
+      RP rp(Vector3(v[0].col(i).tail<3>()));
+      angular_velocity_B->col(i) =
+          -rp.getRotationMatrix().transpose() * rp.toSMatrix() * v[1].col(i).tail<3>();
+    }
+  }
+}
+
 template<class RP>
 void BSplinePoseMinimal<RP>::initPoseSpline(
     real_t t0,
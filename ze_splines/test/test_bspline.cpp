@@ -23,12 +23,15 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+
 #include <ze/splines/bspline.hpp>
 
 // Bring in gtest
 #include <ze/common/test_entrypoint.hpp>
 #include <ze/common/numerical_derivative.hpp>
 #include <ze/common/manifold.hpp>
+#include <ze/common/random_matrix.hpp>
 
 namespace ze {
 
@@ -226,4 +229,96 @@ TEST(SplineTestSuite, testGetBi)
   }
 }
 
+// Check that the banded least-squares fits match the dense solution.
+TEST(SplineTestSuite, testInitSplineBandedSolver)
+{
+  using namespace ze;
+
+  const int D = 3;
+  const int num_points = 200;
+  const int num_segments = 20;
+  const real_t lambda = 1e-2;
+  VectorX times = VectorX::LinSpaced(num_points, 0.0, 10.0);
+  MatrixX points = randomMatrixUniformDistributed(D, num_points, true, -1.0, 1.0);
+
+  for (int order = 2; order < 6; ++order)
+  {
+    // initSpline2: position constraints and acceleration regularization.
+    BSpline bs2(order);
+    bs2.initSpline2(times, points, num_segments, lambda);
+    const std::vector<real_t> knots = bs2.knots();
+    const int C = bs2.coefficientVectorLength();
+    MatrixX A2 = MatrixX::Zero((knots.size() - 2 * order + 2 + num_points) * D, C);
+    VectorX b2 = VectorX::Zero(A2.rows());
+    int row = 0;
+    for (int i = order - 1; i < static_cast<int>(knots.size()) - order + 1; ++i)
+    {
+      A2.block(row, bs2.localCoefficientVectorIndices(knots[i])[0], D, order * D) =
+          lambda * bs2.Phi(knots[i], 2);
+      row += D;
+    }
+    for (int i = 0; i < num_points; ++i)
+    {
+      A2.block(row, bs2.localCoefficientVectorIndices(times[i])[0], D, order * D) =
+          bs2.Phi(times[i], 0);
+      b2.segment(row, D) = points.col(i);
+      row += D;
+    }
+    VectorX c2 = (A2.transpose() * A2).ldlt().solve(A2.transpose() * b2);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(bs2.coefficientVector(), c2, 1e-8));
+
+    // initSpline3: position constraints and integrated acceleration.
+    BSpline bs3(order);
+    bs3.initSpline3(times, points, num_segments, lambda);
+    MatrixX A3 = A2.bottomRows(num_points * D);
+    VectorX b3 = b2.tail(num_points * D);
+    MatrixX H3 = A3.transpose() * A3
+                 + bs3.curveQuadraticIntegralDiag(VectorX::Constant(D, lambda), 2);
+    VectorX c3 = H3.ldlt().solve(A3.transpose() * b3);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(bs3.coefficientVector(), c3, 1e-8));
+  }
+}
+
+// Check that the batch evaluation matches the evaluation at single times.
+TEST(SplineTestSuite, testEvalDBatch)
+{
+  using namespace ze;
+
+  const int segments = 10;
+  const int dim = 3;
+  for (int order = 2; order < 9; ++order)
+  {
+    BSpline bs(order);
+    std::vector<real_t> knots;
+    for (int i = 0; i < bs.numKnotsRequired(segments); ++i)
+    {
+      knots.push_back(0.5 * i);
+    }
+    bs.setKnotsAndCoefficients(
+          knots, MatrixX::Random(dim, bs.numCoefficientsRequired(segments)));
+
+    // Random times, the knots and the boundaries of the valid time interval.
+    VectorX times(230);
+    times.head(200) = VectorX::Random(200).array() * 0.5 + 0.5;
+    times.head(200) = bs.t_min() + times.head(200).array() * (bs.t_max() - bs.t_min());
+    times.segment(200, 28) =
+        VectorX::LinSpaced(28, bs.t_min() - 0.5, bs.t_max() + 0.5).array()
+        .max(bs.t_min()).min(bs.t_max());
+    times(228) = bs.t_min();
+    times(229) = bs.t_max();
+    std::sort(times.data(), times.data() + times.size());
+
+    const int max_derivative_order = std::min(order - 1, 3);
+    const std::vector<MatrixX> values = bs.evalDBatch(times, max_derivative_order);
+    ASSERT_EQ(static_cast<int>(values.size()), max_derivative_order + 1);
+    for (int d = 0; d <= max_derivative_order; ++d)
+    {
+      for (int i = 0; i < times.size(); ++i)
+      {
+        EXPECT_TRUE(EIGEN_MATRIX_NEAR(values[d].col(i), bs.evalD(times[i], d), 1e-10));
+      }
+    }
+  }
+}
+
 ZE_UNITTEST_ENTRYPOINT
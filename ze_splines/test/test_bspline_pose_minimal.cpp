@@ -369,4 +369,43 @@ TEST(BSplinePoseMinimalTestSuite, testInitializePoses)
   }
 }
 
+TEST(BSplinePoseMinimalTestSuite, testEvalPoseBatch)
+{
+  using namespace ze;
+
+  BSplinePoseMinimal<ze::sm::RotationVector> bs(4);
+  bs.initPoseSpline(0.0, 1.0, bs.curveValueToTransformation(VectorX::Random(6)),
+                    bs.curveValueToTransformation(VectorX::Random(6)));
+  for (int i = 2; i < 10; ++i)
+  {
+    bs.addPoseSegment(i, bs.curveValueToTransformation(VectorX::Random(6)));
+  }
+
+  VectorX times = VectorX::LinSpaced(1000, bs.t_min(), bs.t_max());
+  TransformationVector T_W_B;
+  Matrix3X linear_velocity_W, linear_acceleration_W, angular_velocity_B;
+  bs.evalPoseBatch(times, &T_W_B, &linear_velocity_W, &linear_acceleration_W,
+                   &angular_velocity_B);
+  ASSERT_EQ(static_cast<int>(T_W_B.size()), times.size());
+  for (int i = 0; i < times.size(); ++i)
+  {
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                  T_W_B[i].getTransformationMatrix(),
+                  bs.transformation(times[i]), 1e-10));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                  linear_velocity_W.col(i), bs.linearVelocity(times[i]), 1e-10));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                  linear_acceleration_W.col(i), bs.linearAcceleration(times[i]), 1e-10));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(
+                  angular_velocity_B.col(i), bs.angularVelocityBodyFrame(times[i]), 1e-10));
+  }
+
+  // Only the poses.
+  TransformationVector T_W_B_only;
+  bs.evalPoseBatch(times, &T_W_B_only, nullptr, nullptr, nullptr);
+  ASSERT_EQ(T_W_B_only.size(), T_W_B.size());
+  EXPECT_TRUE(EIGEN_MATRIX_NEAR(T_W_B_only.back().getTransformationMatrix(),
+                                T_W_B.back().getTransformationMatrix(), 1e-12));
+}
+
 ZE_UNITTEST_ENTRYPOINT
@@ -25,10 +25,14 @@
 
 #pragma once
 
+#include <vector>
 #include <ze/common/transformation.hpp>
 
 namespace ze {
 
+// fwd
+class ThreadPool;
+
 struct RelativeError
 {
   size_t first_frame;
@@ -47,11 +51,26 @@ struct RelativeError
 std::vector<real_t> trajectoryDistances(
     const TransformationVector& poses);
 
+//! Returns the first frame after first_frame that is further than
+//! segment_length away, or -1 if there is none. Uses a binary search on the
+//! cumulative distances, which are non-decreasing.
 int32_t lastFrameFromSegmentLength(
     const std::vector<real_t>& dist,
     const size_t first_frame,
     const real_t segment_length);
 
+//! Expresses the alignment T_Aj_Bj of the segment starting at previous_frame
+//! with respect to first_frame, used to warm-start the next alignment.
+Transformation transferAlignment(
+    const TransformationVector& T_W_A,
+    const TransformationVector& T_W_B,
+    const Transformation& T_Aj_Bj,
+    const size_t previous_frame,
+    const size_t first_frame);
+
+//! Computes the relative errors of all segments of length segment_length.
+//! With warm_start_alignment, the least-squares alignment of a segment is
+//! initialized with the alignment of the previous segment.
 std::vector<RelativeError> calcSequenceErrors(
     const TransformationVector& poses_gt,
     const TransformationVector& poses_es,
@@ -59,6 +78,21 @@ std::vector<RelativeError> calcSequenceErrors(
     const size_t skip_num_frames_between_segment_evaluation,
     const bool use_least_squares_alignment,
     const double least_squares_align_range,
-    const bool least_squares_align_translation_only);
+    const bool least_squares_align_translation_only,
+    const bool warm_start_alignment = false);
+
+//! Computes the relative errors for multiple segment lengths. The result
+//! contains one vector of errors per segment length. The segment lengths are
+//! evaluated in parallel if a thread pool is provided.
+std::vector<std::vector<RelativeError>> calcSequenceErrors(
+    const TransformationVector& poses_gt,
+    const TransformationVector& poses_es,
+    const std::vector<real_t>& segment_lengths,
+    const size_t skip_num_frames_between_segment_evaluation,
+    const bool use_least_squares_alignment,
+    const double least_squares_align_range,
+    const bool least_squares_align_translation_only,
+    const bool warm_start_alignment = false,
+    ThreadPool* thread_pool = nullptr);
 
 } // namespace ze
@@ -25,6 +25,9 @@
 
 #include <ze/trajectory_analysis/kitti_evaluation.hpp>
 
+#include <algorithm>
+#include <ze/common/logging.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/geometry/align_poses.hpp>
 #include <ze/geometry/align_points.hpp>
 
@@ -59,37 +62,69 @@ int32_t lastFrameFromSegmentLength(
     const size_t first_frame,
     const real_t segment_length)
 {
-  for (size_t i = first_frame; i < dist.size(); i++)
+  if (first_frame >= dist.size())
   {
-    if (dist.at(i) > dist.at(first_frame) + segment_length)
-      return i;
+    return -1;
   }
-  return -1;
+  auto it = std::upper_bound(dist.begin() + first_frame, dist.end(),
+                             dist[first_frame] + segment_length);
+  if (it == dist.end())
+  {
+    return -1;
+  }
+  return static_cast<int32_t>(it - dist.begin());
 }
 
-std::vector<RelativeError> calcSequenceErrors(
+Transformation transferAlignment(
+    const TransformationVector& T_W_A,
+    const TransformationVector& T_W_B,
+    const Transformation& T_Aj_Bj,
+    const size_t previous_frame,
+    const size_t first_frame)
+{
+  return T_W_A.at(first_frame).inverse() * T_W_A.at(previous_frame) * T_Aj_Bj
+       * T_W_B.at(previous_frame).inverse() * T_W_B.at(first_frame);
+}
+
+namespace {
+
+std::vector<RelativeError> calcSequenceErrorsImpl(
     const TransformationVector& T_W_A, // groundtruth
     const TransformationVector& T_W_B,
-    const real_t& segment_length,
+    const std::vector<real_t>& dist_gt,
+    const std::vector<real_t>& dist_es,
+    const real_t segment_length,
     const size_t skip_num_frames_between_segment_evaluation,
     const bool use_least_squares_alignment,
     const double least_squares_align_range,
-    const bool least_squares_align_translation_only)
+    const bool least_squares_align_translation_only,
+    const bool warm_start_alignment)
 {
-  // Pre-compute cumulative distances (from ground truth as reference).
-  std::vector<real_t> dist_gt = trajectoryDistances(T_W_A);
-  std::vector<real_t> dist_es = trajectoryDistances(T_W_B);
+  CHECK_EQ(T_W_A.size(), T_W_B.size());
+  CHECK_GT(skip_num_frames_between_segment_evaluation, 0u);
+
+  // Alignment of the previous segment, used as warm start.
+  bool has_previous_alignment = false;
+  size_t previous_first_frame = 0u;
+  Transformation T_A0_B0_previous;
 
   // Compute relative errors for all start positions.
   std::vector<RelativeError> errors;
+  size_t last_frame = 0u;
   for (size_t first_frame = 0; first_frame < T_W_A.size();
        first_frame += skip_num_frames_between_segment_evaluation)
   {
-    // Find last frame to compare with.
-    int32_t last_frame = lastFrameFromSegmentLength(dist_gt, first_frame, segment_length);
-    if (last_frame == -1)
+    // Find last frame to compare with. As the cumulative distances are
+    // non-decreasing, the last frame never moves backwards.
+    last_frame = std::max(last_frame, first_frame);
+    const real_t max_dist = dist_gt[first_frame] + segment_length;
+    while (last_frame < dist_gt.size() && dist_gt[last_frame] <= max_dist)
     {
-      continue; // continue, if segment is longer than trajectory.
+      ++last_frame;
+    }
+    if (last_frame == dist_gt.size())
+    {
+      break; // all remaining segments are longer than the trajectory.
     }
 
     // Perform a least-squares alignment of the first part of the trajectories.
@@ -117,16 +152,22 @@ std::vector<RelativeError> calcSequenceErrors(
       }
       else
       {
-        TransformationVector T_W_es_align(
-              T_W_B.begin() + first_frame, T_W_B.begin() + first_frame + n_align_poses);
-        TransformationVector T_W_gt_align(
-              T_W_A.begin() + first_frame, T_W_A.begin() + first_frame + n_align_poses);
-        VLOG(40) << "T_W_es_align size = " << T_W_es_align.size();
+        if (warm_start_alignment && has_previous_alignment)
+        {
+          T_A0_B0 = transferAlignment(T_W_A, T_W_B, T_A0_B0_previous,
+                                      previous_first_frame, first_frame);
+        }
+        VLOG(40) << "n_align_poses = " << n_align_poses;
 
         const real_t sigma_pos = 0.05;
         const real_t sigma_rot = 5.0 / 180 * M_PI;
-        PoseAligner problem(T_W_gt_align, T_W_es_align, sigma_pos, sigma_rot);
+        PoseAligner problem(T_W_A, T_W_B, sigma_pos, sigma_rot,
+                            first_frame, n_align_poses);
         problem.optimize(T_A0_B0);
+
+        has_previous_alignment = true;
+        previous_first_frame = first_frame;
+        T_A0_B0_previous = T_A0_B0;
       }
     }
 
@@ -161,4 +202,66 @@ std::vector<RelativeError> calcSequenceErrors(
   return errors;
 }
 
+} // anonymous namespace
+
+std::vector<RelativeError> calcSequenceErrors(
+    const TransformationVector& T_W_A, // groundtruth
+    const TransformationVector& T_W_B,
+    const real_t& segment_length,
+    const size_t skip_num_frames_between_segment_evaluation,
+    const bool use_least_squares_alignment,
+    const double least_squares_align_range,
+    const bool least_squares_align_translation_only,
+    const bool warm_start_alignment)
+{
+  // Pre-compute cumulative distances (from ground truth as reference).
+  std::vector<real_t> dist_gt = trajectoryDistances(T_W_A);
+  std::vector<real_t> dist_es = trajectoryDistances(T_W_B);
+
+  return calcSequenceErrorsImpl(
+        T_W_A, T_W_B, dist_gt, dist_es, segment_length,
+        skip_num_frames_between_segment_evaluation, use_least_squares_alignment,
+        least_squares_align_range, least_squares_align_translation_only,
+        warm_start_alignment);
+}
+
+std::vector<std::vector<RelativeError>> calcSequenceErrors(
+    const TransformationVector& T_W_A, // groundtruth
+    const TransformationVector& T_W_B,
+    const std::vector<real_t>& segment_lengths,
+    const size_t skip_num_frames_between_segment_evaluation,
+    const bool use_least_squares_alignment,
+    const double least_squares_align_range,
+    const bool least_squares_align_translation_only,
+    const bool warm_start_alignment,
+    ThreadPool* thread_pool)
+{
+  // The cumulative distances are shared by all segment lengths.
+  std::vector<real_t> dist_gt = trajectoryDistances(T_W_A);
+  std::vector<real_t> dist_es = trajectoryDistances(T_W_B);
+
+  std::vector<std::vector<RelativeError>> errors(segment_lengths.size());
+  auto evaluate = [&](size_t i)
+  {
+    errors[i] = calcSequenceErrorsImpl(
+          T_W_A, T_W_B, dist_gt, dist_es, segment_lengths[i],
+          skip_num_frames_between_segment_evaluation,
+          use_least_squares_alignment, least_squares_align_range,
+          least_squares_align_translation_only, warm_start_alignment);
+  };
+
+  if (thread_pool)
+  {
+    thread_pool->parallelFor(0u, segment_lengths.size(), 1u, evaluate);
+  }
+  else
+  {
+    for (size_t i = 0u; i < segment_lengths.size(); ++i)
+    {
+      evaluate(i);
+    }
+  }
+  return errors;
+}
+
 } // namespace ze
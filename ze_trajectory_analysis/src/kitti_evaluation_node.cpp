@@ -23,6 +23,7 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <memory>
 #include <string>
 #include <iostream>
 #include <glog/logging.h>
@@ -30,6 +31,8 @@
 
 #include <ze/common/file_utils.hpp>
 #include <ze/common/csv_trajectory.hpp>
+#include <ze/common/string_utils.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/trajectory_analysis/kitti_evaluation.hpp>
 
 DEFINE_string(data_dir, ".", "Path to data");
@@ -41,10 +44,13 @@ DEFINE_string(format_gt, "pose", "Format of the groundtruth {pose, euroc, swe}."
 DEFINE_double(offset_sec, 0.0, "time offset added to the timestamps of the estimate");
 DEFINE_double(max_difference_sec, 0.02, "maximally allowed time difference for matching entries");
 DEFINE_double(segment_length, 50, "Segment length of relative error evaluation. [meters]");
+DEFINE_string(segment_lengths, "", "Comma-separated segment lengths, e.g. '100,200,400'. Overrides segment_length. [meters]");
+DEFINE_int32(num_threads, 1, "Number of threads to evaluate multiple segment lengths in parallel.");
 DEFINE_double(skip_frames, 10, "Number of frames to skip between evaluation.");
 DEFINE_bool(least_squares_align, false, "Use least squares to align 20% of the segment length.");
 DEFINE_bool(least_squares_align_translation_only, false, "Ignore the orientation for the LSQ alignment.");
 DEFINE_double(least_squares_align_range, 0.2, "Portion of the segment that should be least squares aligned.");
+DEFINE_bool(least_squares_align_warm_start, false, "Initialize the LSQ alignment with the one of the previous segment.");
 
 ze::PoseSeries::Ptr loadData(const std::string& format,
                              const std::string& datapath)
@@ -126,36 +132,59 @@ int main(int argc, char** argv)
   }
 
   // Kitti evaluation
+  std::vector<ze::real_t> segment_lengths;
+  if (FLAGS_segment_lengths.empty())
+  {
+    segment_lengths.push_back(FLAGS_segment_length);
+  }
+  else
+  {
+    for (const std::string& s : ze::splitString(FLAGS_segment_lengths, ','))
+    {
+      segment_lengths.push_back(std::stod(s));
+    }
+  }
+
   VLOG(1) << "Computing relative errors...";
-  std::vector<ze::RelativeError> errors =
-      ze::calcSequenceErrors(gt_poses, es_poses, FLAGS_segment_length,
+  std::unique_ptr<ze::ThreadPool> thread_pool;
+  if (FLAGS_num_threads > 1)
+  {
+    thread_pool.reset(new ze::ThreadPool(FLAGS_num_threads));
+  }
+  std::vector<std::vector<ze::RelativeError>> errors =
+      ze::calcSequenceErrors(gt_poses, es_poses, segment_lengths,
                              FLAGS_skip_frames, FLAGS_least_squares_align,
                              FLAGS_least_squares_align_range,
-                             FLAGS_least_squares_align_translation_only);
+                             FLAGS_least_squares_align_translation_only,
+                             FLAGS_least_squares_align_warm_start,
+                             thread_pool.get());
   VLOG(1) << "...done";
 
-  // Write result to file
-  std::string filename_result =
-      FLAGS_filename_result_prefix + "_"
-      + std::to_string(static_cast<int>(FLAGS_segment_length)) + ".csv";
-  VLOG(1) << "Write result to file: " << ze::joinPath(FLAGS_data_dir, filename_result);
-  std::ofstream fs;
-  ze::openOutputFileStream(ze::joinPath(FLAGS_data_dir, filename_result), &fs);
-  fs << "# First frame index, err-tx, err-ty, err-tz, err-ax, err-ay, err-az, length, num frames, err-scale\n";
-  for(const ze::RelativeError& err : errors)
+  // Write result to file, one per segment length.
+  for (size_t i = 0u; i < segment_lengths.size(); ++i)
   {
-    fs << err.first_frame << ", "
-       << err.W_t_gt_es.x() << ", "
-       << err.W_t_gt_es.y() << ", "
-       << err.W_t_gt_es.z() << ", "
-       << err.W_R_gt_es.x() << ", "
-       << err.W_R_gt_es.y() << ", "
-       << err.W_R_gt_es.z() << ", "
-       << err.len << ", "
-       << err.num_frames << ", "
-       << err.scale_error << "\n";
+    std::string filename_result =
+        FLAGS_filename_result_prefix + "_"
+        + std::to_string(static_cast<int>(segment_lengths[i])) + ".csv";
+    VLOG(1) << "Write result to file: " << ze::joinPath(FLAGS_data_dir, filename_result);
+    std::ofstream fs;
+    ze::openOutputFileStream(ze::joinPath(FLAGS_data_dir, filename_result), &fs);
+    fs << "# First frame index, err-tx, err-ty, err-tz, err-ax, err-ay, err-az, length, num frames, err-scale\n";
+    for(const ze::RelativeError& err : errors[i])
+    {
+      fs << err.first_frame << ", "
+         << err.W_t_gt_es.x() << ", "
+         << err.W_t_gt_es.y() << ", "
+         << err.W_t_gt_es.z() << ", "
+         << err.W_R_gt_es.x() << ", "
+         << err.W_R_gt_es.y() << ", "
+         << err.W_R_gt_es.z() << ", "
+         << err.len << ", "
+         << err.num_frames << ", "
+         << err.scale_error << "\n";
+    }
+    fs.close();
   }
-  fs.close();
   VLOG(1) << "Finished.";
 
   return 0;
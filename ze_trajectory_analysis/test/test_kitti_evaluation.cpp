@@ -0,0 +1,244 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <vector>
+
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
+#include <ze/common/transformation.hpp>
+#include <ze/trajectory_analysis/kitti_evaluation.hpp>
+
+namespace {
+
+using namespace ze;
+
+// Helix with a stationary part, the estimate drifts slowly away from it.
+void generateTrajectories(
+    const size_t n, TransformationVector* T_W_A, TransformationVector* T_W_B)
+{
+  T_W_A->resize(n);
+  T_W_B->resize(n);
+  Transformation T_drift;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const real_t s = (i > n / 3 && i < n / 2) ? n / 3 : i;
+    const Vector3 t_W_A(5.0 * std::cos(0.05 * s), 5.0 * std::sin(0.05 * s), 0.02 * s);
+    const Quaternion R_W_A(Vector3(0.1, -0.05, 0.05 * s));
+    (*T_W_A)[i] = Transformation(R_W_A, t_W_A);
+
+    T_drift = T_drift * Transformation::exp(
+                (Vector6() << 0.001, -0.002, 0.001, 0.0005, 0.001, -0.0005).finished());
+    (*T_W_B)[i] = (*T_W_A)[i] * T_drift;
+  }
+}
+
+// Linear scan as reference for lastFrameFromSegmentLength.
+int32_t lastFrameLinearScan(
+    const std::vector<real_t>& dist, const size_t first_frame,
+    const real_t segment_length)
+{
+  for (size_t i = first_frame; i < dist.size(); ++i)
+  {
+    if (dist[i] > dist[first_frame] + segment_length)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void expectEqualErrors(
+    const std::vector<RelativeError>& errors_a,
+    const std::vector<RelativeError>& errors_b,
+    const real_t tol)
+{
+  ASSERT_EQ(errors_a.size(), errors_b.size());
+  for (size_t i = 0; i < errors_a.size(); ++i)
+  {
+    EXPECT_EQ(errors_a[i].first_frame, errors_b[i].first_frame);
+    EXPECT_EQ(errors_a[i].num_frames, errors_b[i].num_frames);
+    EXPECT_EQ(errors_a[i].len, errors_b[i].len);
+    EXPECT_NEAR(errors_a[i].scale_error, errors_b[i].scale_error, tol);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(errors_a[i].W_t_gt_es, errors_b[i].W_t_gt_es, tol));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(errors_a[i].W_R_gt_es, errors_b[i].W_R_gt_es, tol));
+  }
+}
+
+} // anonymous namespace
+
+TEST(KittiEvaluationTest, testLastFrameFromSegmentLength)
+{
+  using namespace ze;
+
+  TransformationVector T_W_A, T_W_B;
+  generateTrajectories(400, &T_W_A, &T_W_B);
+  std::vector<real_t> dist = trajectoryDistances(T_W_A);
+  ASSERT_EQ(dist.size(), T_W_A.size());
+
+  for (real_t segment_length : { 0.0, 0.1, 1.0, 5.0, 20.0, 1000.0 })
+  {
+    for (size_t first_frame = 0; first_frame < dist.size(); ++first_frame)
+    {
+      EXPECT_EQ(lastFrameFromSegmentLength(dist, first_frame, segment_length),
+                lastFrameLinearScan(dist, first_frame, segment_length));
+    }
+  }
+
+  // No frame is found past the end or for segments longer than the trajectory.
+  EXPECT_EQ(lastFrameFromSegmentLength(dist, dist.size(), 1.0), -1);
+  EXPECT_EQ(lastFrameFromSegmentLength(dist, 0u, dist.back() + 1.0), -1);
+  EXPECT_EQ(lastFrameFromSegmentLength(dist, dist.size() - 1, 0.0), -1);
+}
+
+TEST(KittiEvaluationTest, testSequenceErrorsSegments)
+{
+  using namespace ze;
+
+  TransformationVector T_W_A, T_W_B;
+  generateTrajectories(400, &T_W_A, &T_W_B);
+  std::vector<real_t> dist = trajectoryDistances(T_W_A);
+
+  // The scan must visit the same segments as a search per first frame, and
+  // stop at the first frame without a segment.
+  for (size_t skip : { 1u, 7u })
+  {
+    for (real_t segment_length : { 1.0, 5.0, 20.0 })
+    {
+      std::vector<RelativeError> errors = calcSequenceErrors(
+            T_W_A, T_W_B, segment_length, skip, false, 0.0, false);
+
+      size_t k = 0u;
+      for (size_t first_frame = 0; first_frame < dist.size(); first_frame += skip)
+      {
+        const int32_t last_frame =
+            lastFrameLinearScan(dist, first_frame, segment_length);
+        if (last_frame == -1)
+        {
+          break;
+        }
+        ASSERT_LT(k, errors.size());
+        EXPECT_EQ(errors[k].first_frame, first_frame);
+        EXPECT_EQ(errors[k].num_frames,
+                  static_cast<int>(last_frame - first_frame + 1));
+        ++k;
+      }
+      EXPECT_EQ(k, errors.size());
+      EXPECT_FALSE(errors.empty());
+    }
+  }
+
+  // Segments longer than the trajectory.
+  EXPECT_TRUE(calcSequenceErrors(
+                T_W_A, T_W_B, dist.back() + 1.0, 1u, false, 0.0, false).empty());
+}
+
+TEST(KittiEvaluationTest, testTransferAlignment)
+{
+  using namespace ze;
+
+  TransformationVector T_W_A, T_W_B;
+  generateTrajectories(100, &T_W_A, &T_W_B);
+
+  // If the estimate differs by a rigid transformation, the alignment of one
+  // segment transferred to another is the exact alignment of that segment.
+  Transformation T_G;
+  T_G.setRandom(1.0);
+  for (size_t i = 0; i < T_W_B.size(); ++i)
+  {
+    T_W_B[i] = T_G * T_W_A[i];
+  }
+  auto exactAlignment = [&](size_t j)
+  {
+    return T_W_A[j].inverse() * T_G * T_W_A[j];
+  };
+  for (size_t j : { 0u, 10u, 55u })
+  {
+    for (size_t k : { 0u, 11u, 99u })
+    {
+      const Transformation T_Ak_Bk =
+          transferAlignment(T_W_A, T_W_B, exactAlignment(j), j, k);
+      EXPECT_LT((T_Ak_Bk.inverse() * exactAlignment(k)).log().norm(), 1e-10);
+    }
+  }
+
+  // Transfer to the same frame is the identity.
+  Transformation T_A_B;
+  T_A_B.setRandom();
+  EXPECT_LT((transferAlignment(T_W_A, T_W_B, T_A_B, 5u, 5u).inverse() * T_A_B)
+            .log().norm(), 1e-10);
+}
+
+TEST(KittiEvaluationTest, testWarmStartAlignment)
+{
+  using namespace ze;
+
+  TransformationVector T_W_A, T_W_B;
+  generateTrajectories(300, &T_W_A, &T_W_B);
+
+  // Warm and cold started alignments converge to the same solution.
+  std::vector<RelativeError> errors_cold = calcSequenceErrors(
+        T_W_A, T_W_B, 5.0, 3u, true, 0.5, false, false);
+  std::vector<RelativeError> errors_warm = calcSequenceErrors(
+        T_W_A, T_W_B, 5.0, 3u, true, 0.5, false, true);
+  EXPECT_FALSE(errors_cold.empty());
+  expectEqualErrors(errors_cold, errors_warm, 1e-4);
+}
+
+TEST(KittiEvaluationTest, testMultipleSegmentLengths)
+{
+  using namespace ze;
+
+  TransformationVector T_W_A, T_W_B;
+  generateTrajectories(300, &T_W_A, &T_W_B);
+
+  const std::vector<real_t> segment_lengths = { 1.0, 2.0, 5.0, 10.0, 1000.0 };
+  ThreadPool thread_pool(4);
+  for (bool align : { false, true })
+  {
+    for (bool warm_start : { false, true })
+    {
+      std::vector<std::vector<RelativeError>> errors_serial = calcSequenceErrors(
+            T_W_A, T_W_B, segment_lengths, 2u, align, 0.5, false, warm_start);
+      std::vector<std::vector<RelativeError>> errors_parallel = calcSequenceErrors(
+            T_W_A, T_W_B, segment_lengths, 2u, align, 0.5, false, warm_start,
+            &thread_pool);
+      ASSERT_EQ(errors_serial.size(), segment_lengths.size());
+      ASSERT_EQ(errors_parallel.size(), segment_lengths.size());
+
+      for (size_t i = 0; i < segment_lengths.size(); ++i)
+      {
+        std::vector<RelativeError> errors_single = calcSequenceErrors(
+              T_W_A, T_W_B, segment_lengths[i], 2u, align, 0.5, false,
+              warm_start);
+        expectEqualErrors(errors_serial[i], errors_single, 0.0);
+        expectEqualErrors(errors_parallel[i], errors_single, 0.0);
+      }
+      EXPECT_TRUE(errors_serial.back().empty());
+    }
+  }
+}
+
+ZE_UNITTEST_ENTRYPOINT
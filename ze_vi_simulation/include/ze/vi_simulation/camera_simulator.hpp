@@ -26,12 +26,14 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
+#include <random>
+#include <vector>
 #include <ze/common/macros.hpp>
 #include <ze/common/timer_collection.hpp>
 #include <ze/common/transformation.hpp>
 #include <ze/common/types.hpp>
 #include <ze/vi_simulation/camera_simulator_types.hpp>
+#include <ze/vi_simulation/landmark_grid.hpp>
 
 namespace ze {
 
@@ -48,6 +50,10 @@ struct CameraSimulatorOptions
   uint32_t max_num_landmarks_ { 10000 };
   real_t min_depth_m { 2.0 };
   real_t max_depth_m { 7.0 };
+  //! Cell size of the spatial index over the landmarks.
+  real_t landmark_grid_cell_size_m { 1.0 };
+  //! Seed of the map and keypoint noise, 0 for a random seed.
+  uint32_t random_seed { 0u };
 };
 
 // -----------------------------------------------------------------------------
@@ -69,6 +75,8 @@ public:
     : trajectory_(trajectory)
     , rig_(camera_rig)
     , options_(options)
+    , landmark_grid_(options.landmark_grid_cell_size_m)
+    , gen_(options.random_seed != 0u ? options.random_seed : std::random_device{}())
   {}
 
   void setVisualizer(const std::shared_ptr<Visualizer>& visualizer);
@@ -86,8 +94,25 @@ public:
   CameraMeasurementsVector getMeasurementsCorrupted(
       real_t time);
 
+  //! Noise-free observations of camera cam_idx at body pose T_W_B, without
+  //! track ids. Does not modify the simulator and can be called concurrently.
+  CameraMeasurements getVisibleLandmarks(
+      const uint32_t cam_idx,
+      const Transformation& T_W_B) const;
+
+  //! Assigns the track ids of the observations of all cameras at the next
+  //! time step. A track continues if its landmark was observed in the
+  //! previous time step. getMeasurements() is getVisibleLandmarks() for all
+  //! cameras followed by assignTrackIds().
+  void assignTrackIds(CameraMeasurementsVector& measurements);
+
+  //! Adds keypoint noise to the observations.
+  void corruptMeasurements(CameraMeasurementsVector& measurements) const;
+
   void reset();
 
+  uint32_t numCameras() const;
+
   inline const TrajectorySimulator& trajectory() const { return *trajectory_; }
 
   DECLARE_TIMER(SimTimer, timer_,
@@ -100,6 +125,12 @@ private:
       const uint32_t lm_min_idx,
       const uint32_t lm_max_idx);
 
+  CameraMeasurements visibleLandmarksImpl(
+      const uint32_t cam_idx,
+      const Transformation& T_W_B,
+      const uint32_t lm_min_idx,
+      const uint32_t lm_max_idx) const;
+
   std::shared_ptr<TrajectorySimulator> trajectory_;
   std::shared_ptr<CameraRig> rig_;
   CameraSimulatorOptions options_;
@@ -109,8 +140,20 @@ private:
   Positions landmarks_W_;
   Bearings normals_W_;
 
+  //! Spatial index over landmarks_W_ and viewing cone per camera, so that only
+  //! landmarks close to the field of view are projected.
+  LandmarkGrid landmark_grid_;
+  std::vector<ViewingCone> viewing_cones_;
+
   int32_t track_id_counter_ = 0;
-  std::unordered_map<int32_t, int32_t> global_lm_id_to_track_id_map_;
+  //! Track id of each landmark and the time step in which it was last
+  //! observed, indexed by the global landmark id.
+  std::vector<int32_t> lm_track_ids_;
+  std::vector<int64_t> lm_last_observed_step_;
+  int64_t step_ = 0;
+
+  //! Generator of the landmarks and the keypoint noise.
+  mutable std::mt19937 gen_;
 };
 
 
@@ -82,7 +82,8 @@ class ContinuousBiasSimulator : public ImuBiasSimulator
 {
 public:
   //! Given the process noise, start/end times and number of samples to take
-  //! initializes a spline from a discrete random walk.
+  //! initializes a spline from a discrete random walk. A non-zero seed makes
+  //! the random walk reproducible.
   ContinuousBiasSimulator(
       const Vector3& gyr_bias_noise_density,
       const Vector3& acc_bias_noise_density,
@@ -91,7 +92,8 @@ public:
       size_t samples,
       size_t spline_order = 3,
       size_t spline_segments = 0,
-      size_t spline_smoothing_lambda = 1e-5);
+      size_t spline_smoothing_lambda = 1e-5,
+      uint32_t seed = 0u);
 
   //! Get accelerometer bias at time t.
   const Vector3 accelerometer(real_t t) const
@@ -129,6 +131,7 @@ private:
   size_t spline_order_;
   size_t spline_segments_;
   real_t spline_smoothing_lambda_;
+  uint32_t seed_;
 
   //! The first three elements are the accelerometer bias, last 3 elements are
   //! the gyrocope bias.
@@ -78,19 +78,51 @@ public:
     return trajectory_->acceleration_B(t) + Rbw.rotate(gravity());
   }
 
+  //! Specific force and angular velocity at the sorted times, using the batch
+  //! evaluation of the trajectory. The first three rows of the result hold
+  //! the specific force, the last three the angular velocity.
+  ImuAccGyrContainer actualMeasurements(const VectorX& times) const
+  {
+    TransformationVector T_W_B;
+    Matrix3X acceleration_W;
+    Matrix3X angular_velocity_B;
+    trajectory_->evalBatch(times, &T_W_B, nullptr, &acceleration_W,
+                           &angular_velocity_B);
+    ImuAccGyrContainer acc_gyr(6, times.size());
+    for (int i = 0; i < times.size(); ++i)
+    {
+      // See specificForceActual.
+      const Quaternion Rbw(T_W_B[i].getRotation().inverse());
+      acc_gyr.block<3,1>(0, i) =
+          Rbw.rotate(acceleration_W.col(i)) + Rbw.rotate(gravity());
+    }
+    acc_gyr.bottomRows<3>() = angular_velocity_B;
+    return acc_gyr;
+  }
+
   //! The angular velocity corrupted by noise and bias.
   Vector3 angularVelocityCorrupted(real_t t) const
   {
-    return angularVelocityActual(t) + bias_->gyroscope(t) +
-        gyro_noise_->sample() * gyro_noise_bandwidth_hz_sqrt_;
+    return angularVelocityActual(t) + bias_->gyroscope(t) + gyroscopeNoise();
   }
 
   //! The specific force corrupted by noise and bias.
   Vector3 specificForceCorrupted(real_t t) const
   {
     return specificForceActual(t) + bias_->accelerometer(t) +
-        accelerometer_noise_->sample() *
-        accelerometer_noise_bandwidth_hz_sqrt_;
+        accelerometerNoise();
+  }
+
+  //! Sample of the gyroscope noise.
+  Vector3 gyroscopeNoise() const
+  {
+    return gyro_noise_->sample() * gyro_noise_bandwidth_hz_sqrt_;
+  }
+
+  //! Sample of the accelerometer noise.
+  Vector3 accelerometerNoise() const
+  {
+    return accelerometer_noise_->sample() * accelerometer_noise_bandwidth_hz_sqrt_;
   }
 
   //! Gyro and accel bias.
@@ -0,0 +1,102 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <ze/common/transformation.hpp>
+#include <ze/common/types.hpp>
+
+namespace ze {
+
+// fwd.
+class Camera;
+
+// -----------------------------------------------------------------------------
+//! Viewing volume of a camera: all points with depth in [min_depth, max_depth]
+//! whose bearing is at most half_angle away from the optical axis.
+struct ViewingCone
+{
+  real_t min_depth;
+  real_t max_depth;
+  real_t half_angle;
+};
+
+// -----------------------------------------------------------------------------
+//! Voxel hash over landmark positions. Each cell stores the indices of the
+//! landmarks it contains in the order they were inserted.
+class LandmarkGrid
+{
+public:
+  explicit LandmarkGrid(real_t cell_size);
+
+  //! Inserts the landmarks p_W. Column i gets the index first_index + i.
+  void insert(const Eigen::Ref<const Positions>& p_W, uint32_t first_index);
+
+  void clear();
+
+  inline size_t numCells() const { return cells_.size(); }
+
+  inline real_t cellSize() const { return cell_size_; }
+
+  //! Returns the sorted indices in [min_index, max_index) of all landmarks in
+  //! cells that intersect the viewing cone of a camera at pose T_W_C. The
+  //! result is a superset of the landmarks inside the cone.
+  std::vector<uint32_t> candidates(
+      const Transformation& T_W_C,
+      const ViewingCone& cone,
+      const uint32_t min_index,
+      const uint32_t max_index) const;
+
+private:
+  using CellKey = uint64_t;
+  using CellIndex = Eigen::Matrix<int64_t, 3, 1>;
+
+  CellIndex cellIndex(const Eigen::Ref<const Position>& p_W) const;
+  CellKey cellKey(const CellIndex& idx) const;
+
+  //! Conservative test whether the cell with given index intersects the cone.
+  bool intersects(
+      const CellIndex& idx,
+      const Transformation& T_C_W,
+      const ViewingCone& cone) const;
+
+  struct Cell
+  {
+    CellIndex index;
+    std::vector<uint32_t> landmarks;
+  };
+
+  real_t cell_size_;
+  std::unordered_map<CellKey, Cell> cells_;
+};
+
+//! Returns the largest angle between the optical axis and the bearing vector
+//! of a pixel on the image border.
+real_t maxBearingAngle(const Camera& cam);
+
+} // namespace ze
@@ -52,6 +52,47 @@ public:
   //! Get the acceleration in the world frame (without gravity).
   virtual Vector3 acceleration_W(real_t t) const = 0;
 
+  //! Evaluates T_W_B, velocity_W, acceleration_W and angularVelocity_B at the
+  //! sorted times. Outputs that are null are skipped.
+  virtual void evalBatch(
+      const VectorX& times,
+      TransformationVector* T_W_B,
+      Matrix3X* velocity_W,
+      Matrix3X* acceleration_W,
+      Matrix3X* angular_velocity_B) const
+  {
+    if (T_W_B)
+    {
+      T_W_B->resize(times.size());
+    }
+    for (Matrix3X* m : { velocity_W, acceleration_W, angular_velocity_B })
+    {
+      if (m)
+      {
+        m->resize(3, times.size());
+      }
+    }
+    for (int i = 0; i < times.size(); ++i)
+    {
+      if (T_W_B)
+      {
+        (*T_W_B)[i] = this->T_W_B(times[i]);
+      }
+      if (velocity_W)
+      {
+        velocity_W->col(i) = this->velocity_W(times[i]);
+      }
+      if (acceleration_W)
+      {
+        acceleration_W->col(i) = this->acceleration_W(times[i]);
+      }
+      if (angular_velocity_B)
+      {
+        angular_velocity_B->col(i) = angularVelocity_B(times[i]);
+      }
+    }
+  }
+
   //! Start time of the scenario
   virtual real_t start() const = 0;
 
@@ -123,6 +164,18 @@ public:
     return bs_->t_max();
   }
 
+  //! Evaluates the spline once per segment for all sorted times.
+  virtual void evalBatch(
+      const VectorX& times,
+      TransformationVector* T_W_B,
+      Matrix3X* velocity_W,
+      Matrix3X* acceleration_W,
+      Matrix3X* angular_velocity_B) const override
+  {
+    bs_->evalPoseBatch(times, T_W_B, velocity_W, acceleration_W,
+                       angular_velocity_B);
+  }
+
 private:
   const std::shared_ptr<BSplinePoseMinimalRotationVector> bs_;
 };
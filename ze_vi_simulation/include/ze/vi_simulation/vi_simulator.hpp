@@ -26,6 +26,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <ze/common/macros.hpp>
 #include <ze/common/transformation.hpp>
 #include <ze/vi_simulation/camera_simulator_types.hpp>
@@ -38,6 +39,7 @@ class CameraSimulator;
 struct CameraSimulatorOptions;
 class TrajectorySimulator;
 class ImuSimulator;
+class ThreadPool;
 class Visualizer;
 
 // -----------------------------------------------------------------------------
@@ -70,6 +72,8 @@ struct ViSensorData
   };
   Groundtruth groundtruth;
 };
+using ViSensorDataVector =
+    std::vector<ViSensorData, Eigen::aligned_allocator<ViSensorData>>;
 
 // -----------------------------------------------------------------------------
 class ViSimulator
@@ -77,6 +81,9 @@ class ViSimulator
 public:
   ZE_POINTER_TYPEDEFS(ViSimulator);
 
+  //! A non-zero random_seed makes the bias, the inertial noise and, unless
+  //! camera_sim_options has its own seed, the map and keypoint noise
+  //! reproducible.
   ViSimulator(
       const std::shared_ptr<TrajectorySimulator>& trajectory,
       const std::shared_ptr<CameraRig>& camera_rig,
@@ -87,12 +94,22 @@ public:
       const real_t acc_noise_sigma = 0.00186,
       const uint32_t cam_framerate_hz = 20,
       const uint32_t imu_bandwidth_hz = 200,
-      const real_t gravity_magnitude = 9.81);
+      const real_t gravity_magnitude = 9.81,
+      const uint32_t random_seed = 0u);
 
   void initialize();
 
   std::pair<ViSensorData, bool> getMeasurement();
 
+  //! Returns the next num_measurements measurements, or fewer at the end of
+  //! the trajectory. Equivalent to calling getMeasurement() repeatedly, but
+  //! the noise-free measurements of all timestamps and cameras are simulated
+  //! in parallel if a thread pool is provided. Track ids and noise are then
+  //! added sequentially in the order of the timestamps.
+  ViSensorDataVector getMeasurements(
+      const uint32_t num_measurements,
+      ThreadPool* thread_pool = nullptr);
+
   void setVisualizer(const std::shared_ptr<Visualizer>& visualizer);
 
   void visualize(
@@ -116,7 +133,8 @@ private:
 
 // -----------------------------------------------------------------------------
 
-//! Outdoor car scenario with stereo camera.
-ViSimulator::Ptr createViSimulationScenario1();
+//! Outdoor car scenario with stereo camera. A non-zero seed makes the
+//! simulated measurements reproducible.
+ViSimulator::Ptr createViSimulationScenario1(uint32_t random_seed = 0u);
 
 } // namespace ze
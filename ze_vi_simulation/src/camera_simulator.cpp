@@ -25,9 +25,9 @@
 
 #include <ze/vi_simulation/camera_simulator.hpp>
 
+#include <algorithm>
 #include <ze/cameras/camera_rig.hpp>
 #include <ze/cameras/camera_utils.hpp>
-#include <ze/common/random_matrix.hpp>
 #include <ze/vi_simulation/trajectory_simulator.hpp>
 #include <ze/visualization/viz_interface.hpp>
 
@@ -43,6 +43,16 @@ void CameraSimulator::initializeMap()
   int num_landmarks_per_frame = options_.num_keypoints_per_frame / rig_->size();
   uint32_t num_landmarks = 0u;
   landmarks_W_.resize(Eigen::NoChange, options_.max_num_landmarks_);
+  landmark_grid_.clear();
+
+  // The border of the image is discretized per pixel, add a small margin.
+  viewing_cones_.clear();
+  for (uint32_t cam_idx = 0u; cam_idx < rig_->size(); ++cam_idx)
+  {
+    viewing_cones_.push_back(
+          ViewingCone{options_.min_depth_m, options_.max_depth_m,
+                      maxBearingAngle(rig_->at(cam_idx)) + 0.01});
+  }
 
   for (uint32_t i = 0u; i < num_frames; ++i)
   {
@@ -62,17 +72,33 @@ void CameraSimulator::initializeMap()
       int32_t num_new_landmarks = std::max(0, num_landmarks_per_frame - num_visible);
       CHECK_GE(num_new_landmarks, 0);
 
-      Positions p_C;
-      std::tie(std::ignore, std::ignore, p_C) =
-          generateRandomVisible3dPoints(
-            rig_->at(cam_idx), num_new_landmarks,
-            10u, options_.min_depth_m, options_.max_depth_m);
+      // As generateRandomVisible3dPoints, but drawn from the own generator.
+      const Camera& cam = rig_->at(cam_idx);
+      const uint32_t margin = 10u;
+      std::uniform_real_distribution<real_t> sample_x(margin, cam.width() - 1 - margin);
+      std::uniform_real_distribution<real_t> sample_y(margin, cam.height() - 1 - margin);
+      std::uniform_real_distribution<real_t> sample_depth(
+            options_.min_depth_m, options_.max_depth_m);
+      Keypoints px(2, num_new_landmarks);
+      for (int32_t k = 0; k < num_new_landmarks; ++k)
+      {
+        px(0, k) = sample_x(gen_);
+        px(1, k) = sample_y(gen_);
+      }
+      Positions p_C = cam.backProjectVectorized(px);
+      for (int32_t k = 0; k < num_new_landmarks; ++k)
+      {
+        p_C.col(k) *= sample_depth(gen_);
+      }
 
       DEBUG_CHECK_LE(static_cast<int>(num_landmarks + num_new_landmarks),
                      landmarks_W_.cols());
 
       landmarks_W_.middleCols(num_landmarks, num_new_landmarks)
           =  (T_W_B * rig_->T_B_C(cam_idx)).transformVectorized(p_C);
+      landmark_grid_.insert(
+            landmarks_W_.middleCols(num_landmarks, num_new_landmarks),
+            num_landmarks);
 
       num_landmarks += num_new_landmarks;
     }
@@ -81,6 +107,9 @@ void CameraSimulator::initializeMap()
 
   VLOG(1) << "Initialized map with " << num_landmarks << " visible landmarks.";
   landmarks_W_.conservativeResize(Eigen::NoChange, num_landmarks);
+  lm_track_ids_.assign(num_landmarks, -1);
+  lm_last_observed_step_.assign(num_landmarks, -1);
+  step_ = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -91,19 +120,42 @@ CameraMeasurements CameraSimulator::visibleLandmarks(
     const uint32_t lm_max_idx)
 {
   auto t = timer_[SimTimer::visible_landmarks].timeScope();
+  return visibleLandmarksImpl(cam_idx, T_W_B, lm_min_idx, lm_max_idx);
+}
 
+// -----------------------------------------------------------------------------
+CameraMeasurements CameraSimulator::visibleLandmarksImpl(
+    const uint32_t cam_idx,
+    const Transformation& T_W_B,
+    const uint32_t lm_min_idx,
+    const uint32_t lm_max_idx) const
+{
   const uint32_t num_landmarks = lm_max_idx - lm_min_idx;
   if (num_landmarks == 0)
   {
     return CameraMeasurements();
   }
 
+  // Only project the landmarks close to the viewing cone of the camera.
+  const Transformation T_W_C = T_W_B * rig_->T_B_C(cam_idx);
+  const std::vector<uint32_t> candidates =
+      landmark_grid_.candidates(T_W_C, viewing_cones_.at(cam_idx),
+                                lm_min_idx, lm_max_idx);
+  if (candidates.empty())
+  {
+    return CameraMeasurements();
+  }
+
   const Size2u image_size = rig_->at(cam_idx).size();
-  const auto lm_W = landmarks_W_.middleCols(lm_min_idx, num_landmarks);
-  const auto lm_C = (T_W_B * rig_->T_B_C(cam_idx)).inverse().transformVectorized(lm_W);
+  Positions lm_W(3, candidates.size());
+  for (size_t i = 0u; i < candidates.size(); ++i)
+  {
+    lm_W.col(i) = landmarks_W_.col(candidates[i]);
+  }
+  const Positions lm_C = T_W_C.inverse().transformVectorized(lm_W);
   Keypoints px = rig_->at(cam_idx).projectVectorized(lm_C);
   std::vector<uint32_t> visible_indices;
-  for (uint32_t i = 0u; i < num_landmarks; ++i)
+  for (uint32_t i = 0u; i < candidates.size(); ++i)
   {
     if (lm_C(2,i) < options_.min_depth_m ||
         lm_C(2,i) > options_.max_depth_m)
@@ -125,7 +177,7 @@ CameraMeasurements CameraSimulator::visibleLandmarks(
   for (size_t i = 0; i < visible_indices.size(); ++i)
   {
     m.keypoints_.col(i) = px.col(visible_indices[i]);
-    m.global_landmark_ids_[i] = visible_indices[i];
+    m.global_landmark_ids_[i] = candidates[visible_indices[i]];
   }
 
   return m;
@@ -141,59 +193,103 @@ CameraMeasurementsVector CameraSimulator::getMeasurements(real_t time)
   auto t = timer_[SimTimer::get_measurements].timeScope();
 
   Transformation T_W_B = trajectory_->T_W_B(time);
-  std::unordered_map<int32_t, int32_t> new_global_lm_id_to_track_id_map;
   CameraMeasurementsVector measurements;
-
   for (uint32_t cam_idx = 0u; cam_idx < rig_->size(); ++cam_idx)
   {
-    CameraMeasurements m = visibleLandmarks(cam_idx, T_W_B, 0u, landmarks_W_.cols());
+    measurements.push_back(
+          visibleLandmarks(cam_idx, T_W_B, 0u, landmarks_W_.cols()));
+  }
+  assignTrackIds(measurements);
+
+  return measurements;
+}
+
+// -----------------------------------------------------------------------------
+CameraMeasurements CameraSimulator::getVisibleLandmarks(
+    const uint32_t cam_idx,
+    const Transformation& T_W_B) const
+{
+  CHECK_GT(landmarks_W_.cols(), 0) << "Map has not been initialized.";
+  return visibleLandmarksImpl(cam_idx, T_W_B, 0u, landmarks_W_.cols());
+}
+
+// -----------------------------------------------------------------------------
+void CameraSimulator::assignTrackIds(CameraMeasurementsVector& measurements)
+{
+  ++step_;
+
+  // Look up all tracks before updating them, such that all cameras continue
+  // the tracks of the previous time step.
+  for (CameraMeasurements& m : measurements)
+  {
     m.local_track_ids_.resize(m.keypoints_.cols());
     for (int32_t i = 0; i < m.keypoints_.cols(); ++i)
     {
       const int32_t lm_id = m.global_landmark_ids_[i];
-      int32_t track_id = -1;
-      auto res = global_lm_id_to_track_id_map_.find(lm_id);
-      if (res == global_lm_id_to_track_id_map_.end())
+      DEBUG_CHECK_LT(lm_id, static_cast<int32_t>(lm_track_ids_.size()));
+      if (lm_last_observed_step_[lm_id] == step_ - 1)
       {
-        // This is a new track:
-        track_id = track_id_counter_;
-        ++track_id_counter_;
+        // This is an existing track:
+        m.local_track_ids_[i] = lm_track_ids_[lm_id];
       }
       else
       {
-        // This is an existing track:
-        track_id = res->second;
+        // This is a new track:
+        m.local_track_ids_[i] = track_id_counter_;
+        ++track_id_counter_;
       }
-      m.local_track_ids_[i] = track_id;
-
-      // Update our list of tracks:
-      new_global_lm_id_to_track_id_map[lm_id] = track_id;
     }
-    measurements.push_back(m);
   }
 
   // Update our list of active tracks:
-  global_lm_id_to_track_id_map_ = new_global_lm_id_to_track_id_map;
-
-  return measurements;
+  for (const CameraMeasurements& m : measurements)
+  {
+    for (int32_t i = 0; i < m.keypoints_.cols(); ++i)
+    {
+      const int32_t lm_id = m.global_landmark_ids_[i];
+      lm_track_ids_[lm_id] = m.local_track_ids_[i];
+      lm_last_observed_step_[lm_id] = step_;
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
-CameraMeasurementsVector CameraSimulator::getMeasurementsCorrupted(real_t time)
+void CameraSimulator::corruptMeasurements(
+    CameraMeasurementsVector& measurements) const
 {
-  CameraMeasurementsVector measurements = getMeasurements(time);
   for (CameraMeasurements& m : measurements)
   {
-    m.keypoints_ += randomMatrixNormalDistributed(2, m.keypoints_.cols(), false,
-                                                  0.0, options_.keypoint_noise_sigma);
+    if (m.keypoints_.cols() == 0)
+    {
+      continue;
+    }
+    std::normal_distribution<real_t> noise(0.0, options_.keypoint_noise_sigma);
+    for (int k = 0; k < m.keypoints_.cols(); ++k)
+    {
+      m.keypoints_(0, k) += noise(gen_);
+      m.keypoints_(1, k) += noise(gen_);
+    }
   }
+}
+
+// -----------------------------------------------------------------------------
+CameraMeasurementsVector CameraSimulator::getMeasurementsCorrupted(real_t time)
+{
+  CameraMeasurementsVector measurements = getMeasurements(time);
+  corruptMeasurements(measurements);
   return measurements;
 }
 
 // -----------------------------------------------------------------------------
 void CameraSimulator::reset()
 {
-  global_lm_id_to_track_id_map_.clear();
+  std::fill(lm_last_observed_step_.begin(), lm_last_observed_step_.end(), -1);
+}
+
+// -----------------------------------------------------------------------------
+uint32_t CameraSimulator::numCameras() const
+{
+  return rig_->size();
 }
 
 // -----------------------------------------------------------------------------
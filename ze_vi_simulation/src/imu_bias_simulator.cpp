@@ -36,7 +36,8 @@ ContinuousBiasSimulator::ContinuousBiasSimulator(
     size_t samples,
     size_t spline_order,
     size_t spline_segments,
-    size_t spline_smoothing_lambda)
+    size_t spline_smoothing_lambda,
+    uint32_t seed)
   : gyr_bias_noise_density_(gyr_bias_noise_density)
   , acc_bias_noise_density_(acc_bias_noise_density)
   , start_(start_time)
@@ -45,6 +46,7 @@ ContinuousBiasSimulator::ContinuousBiasSimulator(
   , spline_order_(spline_order)
   , spline_segments_(spline_segments)
   , spline_smoothing_lambda_(spline_smoothing_lambda)
+  , seed_(seed)
   , bs_(3)
 {
   if (spline_segments_ == 0)
@@ -62,7 +64,9 @@ void ContinuousBiasSimulator::initialize()
   noise.head<3>() = acc_bias_noise_density_;
   noise.tail<3>() = gyr_bias_noise_density_;
   // merge acc and bias noise
-  RandomVectorSampler<6>::Ptr sampler = RandomVectorSampler<6>::sigmas(noise);
+  RandomVectorSampler<6>::Ptr sampler = (seed_ != 0u) ?
+        RandomVectorSampler<6>::sigmasSeeded(noise, seed_) :
+        RandomVectorSampler<6>::sigmas(noise);
 
   // sampling interval
   real_t dt = (end_ - start_) / samples_;
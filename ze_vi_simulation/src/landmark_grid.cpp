@@ -0,0 +1,210 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <ze/vi_simulation/landmark_grid.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ze/cameras/camera.hpp>
+#include <ze/common/logging.hpp>
+
+namespace ze {
+
+// -----------------------------------------------------------------------------
+LandmarkGrid::LandmarkGrid(real_t cell_size)
+  : cell_size_(cell_size)
+{
+  CHECK_GT(cell_size_, 0.0);
+}
+
+// -----------------------------------------------------------------------------
+void LandmarkGrid::insert(
+    const Eigen::Ref<const Positions>& p_W, uint32_t first_index)
+{
+  for (int i = 0; i < p_W.cols(); ++i)
+  {
+    const CellIndex idx = cellIndex(p_W.col(i));
+    Cell& cell = cells_[cellKey(idx)];
+    cell.index = idx;
+    cell.landmarks.push_back(first_index + i);
+  }
+}
+
+// -----------------------------------------------------------------------------
+void LandmarkGrid::clear()
+{
+  cells_.clear();
+}
+
+// -----------------------------------------------------------------------------
+std::vector<uint32_t> LandmarkGrid::candidates(
+    const Transformation& T_W_C,
+    const ViewingCone& cone,
+    const uint32_t min_index,
+    const uint32_t max_index) const
+{
+  const Transformation T_C_W = T_W_C.inverse();
+  std::vector<uint32_t> indices;
+  auto collect = [&](const Cell& cell)
+  {
+    if (!intersects(cell.index, T_C_W, cone))
+    {
+      return;
+    }
+    for (const uint32_t i : cell.landmarks)
+    {
+      if (i >= min_index && i < max_index)
+      {
+        indices.push_back(i);
+      }
+    }
+  };
+
+  // Visit the cells in the bounding box of the cone, unless there are fewer
+  // occupied cells than that.
+  bool visit_box = false;
+  CellIndex box_min, box_max;
+  if (cone.half_angle < 0.5 * M_PI - 1e-3)
+  {
+    const real_t r = cone.max_depth * std::tan(cone.half_angle);
+    Position p_W_min = Position::Constant(std::numeric_limits<real_t>::max());
+    Position p_W_max = -p_W_min;
+    for (int i = 0; i < 8; ++i)
+    {
+      const Position p_C((i & 1) ? r : -r,
+                         (i & 2) ? r : -r,
+                         (i & 4) ? cone.max_depth : cone.min_depth);
+      const Position p_W = T_W_C * p_C;
+      p_W_min = p_W_min.cwiseMin(p_W);
+      p_W_max = p_W_max.cwiseMax(p_W);
+    }
+    box_min = cellIndex(p_W_min);
+    box_max = cellIndex(p_W_max);
+    const real_t num_box_cells =
+        (box_max - box_min + CellIndex::Ones()).cast<real_t>().prod();
+    visit_box = num_box_cells < static_cast<real_t>(cells_.size());
+  }
+
+  if (visit_box)
+  {
+    for (int64_t x = box_min(0); x <= box_max(0); ++x)
+    {
+      for (int64_t y = box_min(1); y <= box_max(1); ++y)
+      {
+        for (int64_t z = box_min(2); z <= box_max(2); ++z)
+        {
+          auto it = cells_.find(cellKey(CellIndex(x, y, z)));
+          if (it != cells_.end())
+          {
+            collect(it->second);
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    for (const auto& it : cells_)
+    {
+      collect(it.second);
+    }
+  }
+
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+// -----------------------------------------------------------------------------
+LandmarkGrid::CellIndex LandmarkGrid::cellIndex(
+    const Eigen::Ref<const Position>& p_W) const
+{
+  return CellIndex(static_cast<int64_t>(std::floor(p_W(0) / cell_size_)),
+                   static_cast<int64_t>(std::floor(p_W(1) / cell_size_)),
+                   static_cast<int64_t>(std::floor(p_W(2) / cell_size_)));
+}
+
+// -----------------------------------------------------------------------------
+LandmarkGrid::CellKey LandmarkGrid::cellKey(const CellIndex& idx) const
+{
+  // 21 bits per coordinate, i.e. unique keys for |idx| < 2^20.
+  DEBUG_CHECK_LT(idx.cwiseAbs().maxCoeff(), int64_t{1} << 20);
+  constexpr uint64_t mask = (uint64_t{1} << 21) - 1u;
+  return ((static_cast<uint64_t>(idx(0)) & mask) << 42)
+       | ((static_cast<uint64_t>(idx(1)) & mask) << 21)
+       |  (static_cast<uint64_t>(idx(2)) & mask);
+}
+
+// -----------------------------------------------------------------------------
+bool LandmarkGrid::intersects(
+    const CellIndex& idx,
+    const Transformation& T_C_W,
+    const ViewingCone& cone) const
+{
+  // Test the bounding sphere of the cell against the depth range and the cone.
+  const Position center_W =
+      (idx.cast<real_t>() + Vector3::Constant(0.5)) * cell_size_;
+  const Position c = T_C_W * center_W;
+  const real_t radius = 0.5 * std::sqrt(3.0) * cell_size_;
+  if (c(2) + radius < cone.min_depth || c(2) - radius > cone.max_depth)
+  {
+    return false;
+  }
+  const real_t dist = c.norm();
+  if (dist <= radius)
+  {
+    return true;
+  }
+  const real_t angle = std::acos(std::max(real_t{-1.0}, std::min(real_t{1.0}, c(2) / dist)));
+  return angle <= cone.half_angle + std::asin(radius / dist);
+}
+
+// -----------------------------------------------------------------------------
+real_t maxBearingAngle(const Camera& cam)
+{
+  const uint32_t w = cam.width();
+  const uint32_t h = cam.height();
+  Keypoints px(2, 2 * (w + h));
+  int n = 0;
+  for (uint32_t x = 0u; x < w; ++x)
+  {
+    px.col(n++) = Keypoint(x, 0);
+    px.col(n++) = Keypoint(x, h);
+  }
+  for (uint32_t y = 0u; y < h; ++y)
+  {
+    px.col(n++) = Keypoint(0, y);
+    px.col(n++) = Keypoint(w, y);
+  }
+  const Bearings f = cam.backProjectVectorized(px);
+  real_t max_angle = 0.0;
+  for (int i = 0; i < f.cols(); ++i)
+  {
+    max_angle = std::max(max_angle, std::acos(f(2,i) / f.col(i).norm()));
+  }
+  return max_angle;
+}
+
+} // namespace ze
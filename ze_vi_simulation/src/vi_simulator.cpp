@@ -29,6 +29,7 @@
 #include <ze/common/test_utils.hpp>
 #include <ze/common/csv_trajectory.hpp>
 #include <ze/common/path_utils.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/vi_simulation/trajectory_simulator.hpp>
 #include <ze/vi_simulation/camera_simulator.hpp>
 #include <ze/vi_simulation/imu_simulator.hpp>
@@ -47,7 +48,8 @@ ViSimulator::ViSimulator(
     const real_t acc_noise_sigma,
     const uint32_t cam_framerate_hz,
     const uint32_t imu_bandwidth_hz,
-    const real_t gravity_magnitude)
+    const real_t gravity_magnitude,
+    const uint32_t random_seed)
   : trajectory_(trajectory)
   , cam_dt_ns_(secToNanosec(1.0 / cam_framerate_hz))
   , imu_dt_ns_(secToNanosec(1.0 / imu_bandwidth_hz))
@@ -64,7 +66,8 @@ ViSimulator::ViSimulator(
              Vector3::Constant(acc_bias_noise_sigma),
              trajectory->start(),
              trajectory->end(),
-             100); // Results in malloc: (trajectory->end() - trajectory->start()) * imu_bandwidth_hz);
+             100, // Results in malloc: (trajectory->end() - trajectory->start()) * imu_bandwidth_hz);
+             3u, 0u, 1e-5, random_seed);
     VLOG(1) << "done.";
   }
   catch (const std::bad_alloc& e)
@@ -74,20 +77,31 @@ ViSimulator::ViSimulator(
   }
 
   VLOG(1) << "Initialize IMU ...";
+  auto noiseSampler = [random_seed](real_t sigma, uint32_t offset)
+  {
+    return (random_seed != 0u) ?
+          RandomVectorSampler<3>::sigmasSeeded(Vector3::Constant(sigma), random_seed + offset) :
+          RandomVectorSampler<3>::sigmas(Vector3::Constant(sigma));
+  };
   imu_ = std::make_shared<ImuSimulator>(
            trajectory,
            bias,
-           RandomVectorSampler<3>::sigmas(Vector3::Constant(acc_noise_sigma)),
-           RandomVectorSampler<3>::sigmas(Vector3::Constant(gyr_noise_sigma)),
+           noiseSampler(acc_noise_sigma, 1u),
+           noiseSampler(gyr_noise_sigma, 2u),
            imu_bandwidth_hz,
            imu_bandwidth_hz,
            gravity_magnitude);
   VLOG(1) << "done.";
 
+  CameraSimulatorOptions camera_options = camera_sim_options;
+  if (random_seed != 0u && camera_options.random_seed == 0u)
+  {
+    camera_options.random_seed = random_seed + 3u;
+  }
   camera_ = std::make_shared<CameraSimulator>(
               trajectory,
               camera_rig,
-              camera_sim_options);
+              camera_options);
 }
 
 // -----------------------------------------------------------------------------
@@ -148,6 +162,103 @@ std::pair<ViSensorData, bool> ViSimulator::getMeasurement()
   return std::make_pair(data, true);
 }
 
+// -----------------------------------------------------------------------------
+ViSensorDataVector ViSimulator::getMeasurements(
+    const uint32_t num_measurements,
+    ThreadPool* thread_pool)
+{
+  uint32_t n = 0u;
+  while (n < num_measurements
+         && nanosecToSecTrunc(last_sample_stamp_ns_ + (n + 1) * cam_dt_ns_)
+            <= trajectory_->end())
+  {
+    ++n;
+  }
+  if (n < num_measurements)
+  {
+    LOG(WARNING) << "Reached end of trajectory!";
+  }
+
+  ViSensorDataVector data(n);
+  const uint32_t num_cameras = camera_->numCameras();
+  const uint32_t num_imu_measurements = cam_dt_ns_ / imu_dt_ns_ + 1u;
+
+  auto parallelFor = [thread_pool](size_t end, const std::function<void(size_t)>& f)
+  {
+    if (thread_pool)
+    {
+      thread_pool->parallelFor(0u, end, 0u, f);
+    }
+    else
+    {
+      for (size_t i = 0u; i < end; ++i)
+      {
+        f(i);
+      }
+    }
+  };
+
+  // Groundtruth and noise-free inertial measurements per timestamp.
+  parallelFor(n, [&](size_t k)
+  {
+    ViSensorData& d = data[k];
+    d.timestamp = last_sample_stamp_ns_ + (k + 1) * cam_dt_ns_;
+    const real_t time_s = nanosecToSecTrunc(d.timestamp);
+    d.groundtruth.T_W_Bk = trajectory_->T_W_B(time_s);
+    d.groundtruth.linear_velocity_W = trajectory_->velocity_W(time_s);
+    d.groundtruth.angular_velocity_B = trajectory_->angularVelocity_B(time_s);
+    d.groundtruth.acc_bias = imu_->bias()->accelerometer(time_s);
+    d.groundtruth.gyr_bias = imu_->bias()->gyroscope(time_s);
+
+    d.imu_stamps.resize(num_imu_measurements);
+    VectorX imu_times(num_imu_measurements);
+    int64_t imu_stamp_ns = d.timestamp - cam_dt_ns_;
+    for (uint32_t i = 0; i < num_imu_measurements; ++i)
+    {
+      d.imu_stamps(i) = imu_stamp_ns;
+      imu_times(i) = nanosecToSecTrunc(imu_stamp_ns);
+      imu_stamp_ns += imu_dt_ns_;
+    }
+    d.imu_measurements = imu_->actualMeasurements(imu_times);
+    for (uint32_t i = 0; i < num_imu_measurements; ++i)
+    {
+      d.imu_measurements.block<3,1>(0, i) += imu_->bias()->accelerometer(imu_times(i));
+      d.imu_measurements.block<3,1>(3, i) += imu_->bias()->gyroscope(imu_times(i));
+    }
+    d.cam_measurements.resize(num_cameras);
+  });
+
+  // Noise-free camera measurements per timestamp and camera.
+  parallelFor(n * num_cameras, [&](size_t i)
+  {
+    ViSensorData& d = data[i / num_cameras];
+    const uint32_t cam_idx = i % num_cameras;
+    d.cam_measurements[cam_idx] =
+        camera_->getVisibleLandmarks(cam_idx, d.groundtruth.T_W_Bk);
+  });
+
+  // Track ids and noise, in the same order as getMeasurement().
+  for (ViSensorData& d : data)
+  {
+    camera_->assignTrackIds(d.cam_measurements);
+    camera_->corruptMeasurements(d.cam_measurements);
+    for (uint32_t i = 0; i < num_imu_measurements; ++i)
+    {
+      d.imu_measurements.block<3,1>(0, i) += imu_->accelerometerNoise();
+      d.imu_measurements.block<3,1>(3, i) += imu_->gyroscopeNoise();
+    }
+  }
+
+  // Prepare next iteration:
+  if (n > 0u)
+  {
+    last_sample_stamp_ns_ = data.back().timestamp;
+    T_W_Bk_ = data.back().groundtruth.T_W_Bk;
+  }
+
+  return data;
+}
+
 // -----------------------------------------------------------------------------
 void ViSimulator::setVisualizer(const std::shared_ptr<Visualizer>& visualizer)
 {
@@ -166,7 +277,7 @@ void ViSimulator::visualize(
 }
 
 // -----------------------------------------------------------------------------
-ViSimulator::Ptr createViSimulationScenario1()
+ViSimulator::Ptr createViSimulationScenario1(uint32_t random_seed)
 {
   // Create trajectory:
   PoseSeries pose_series;
@@ -194,7 +305,9 @@ ViSimulator::Ptr createViSimulationScenario1()
   cam_sim_options.max_depth_m = 10.0;
   cam_sim_options.max_num_landmarks_ = 20000;
   ViSimulator::Ptr vi_sim =
-      std::make_shared<ViSimulator>(trajectory, rig, cam_sim_options);
+      std::make_shared<ViSimulator>(trajectory, rig, cam_sim_options,
+                                    0.0000266, 0.000433, 0.000186, 0.00186,
+                                    20, 200, 9.81, random_seed);
   vi_sim->initialize();
   return vi_sim;
 }
@@ -0,0 +1,98 @@
+// Copyright (c) 2015-2016, ETH Zurich, Wyss Zurich, Zurich Eye
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the ETH Zurich, Wyss Zurich, Zurich Eye nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL ETH Zurich, Wyss Zurich, Zurich Eye BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+
+#include <ze/cameras/camera_impl.hpp>
+#include <ze/common/test_entrypoint.hpp>
+#include <ze/common/random_matrix.hpp>
+#include <ze/vi_simulation/landmark_grid.hpp>
+
+namespace {
+
+std::vector<uint32_t> landmarksInCone(
+    const ze::Positions& p_W,
+    const ze::Transformation& T_W_C,
+    const ze::ViewingCone& cone)
+{
+  std::vector<uint32_t> indices;
+  const ze::Positions p_C = T_W_C.inverse().transformVectorized(p_W);
+  for (int i = 0; i < p_C.cols(); ++i)
+  {
+    if (p_C(2,i) >= cone.min_depth && p_C(2,i) <= cone.max_depth
+        && std::acos(p_C(2,i) / p_C.col(i).norm()) <= cone.half_angle)
+    {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+} // anonymous namespace
+
+TEST(LandmarkGridTests, testCandidatesContainLandmarksInCone)
+{
+  using namespace ze;
+
+  const Positions p_W = randomMatrixUniformDistributed(3, 20000, false, -50.0, 50.0);
+  const ViewingCone cone { 2.0, 7.0, 0.9 };
+
+  // Small cells visit the bounding box of the cone, large cells all cells.
+  for (const real_t cell_size : { 0.5, 1.0, 20.0 })
+  {
+    LandmarkGrid grid(cell_size);
+    grid.insert(p_W.leftCols(10000), 0u);
+    grid.insert(p_W.rightCols(10000), 10000u);
+    for (int i = 0; i < 20; ++i)
+    {
+      Transformation T_W_C;
+      T_W_C.setRandom(40.0, M_PI);
+      const std::vector<uint32_t> candidates =
+          grid.candidates(T_W_C, cone, 0u, p_W.cols());
+      EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+      EXPECT_LE(candidates.size(), static_cast<size_t>(p_W.cols()));
+      for (const uint32_t idx : landmarksInCone(p_W, T_W_C, cone))
+      {
+        EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(), idx));
+      }
+
+      // Restrict the index range.
+      for (const uint32_t idx : grid.candidates(T_W_C, cone, 5000u, 6000u))
+      {
+        EXPECT_GE(idx, 5000u);
+        EXPECT_LT(idx, 6000u);
+      }
+    }
+  }
+}
+
+TEST(LandmarkGridTests, testMaxBearingAngle)
+{
+  using namespace ze;
+  PinholeCamera cam = createPinholeCamera(640, 480, 329.11, 329.11, 320.0, 240.0);
+  EXPECT_NEAR(maxBearingAngle(cam), std::atan(400.0 / 329.11), 1e-8);
+}
+
+ZE_UNITTEST_ENTRYPOINT
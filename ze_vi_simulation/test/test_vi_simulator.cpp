@@ -23,7 +23,10 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <map>
+
 #include <ze/common/test_entrypoint.hpp>
+#include <ze/common/thread_pool.hpp>
 #include <ze/common/timer_statistics.hpp>
 #include <ze/vi_simulation/camera_simulator.hpp>
 #include <ze/vi_simulation/vi_simulator.hpp>
@@ -55,4 +58,125 @@ TEST(CameraSimulator, testSplineScenario)
   VLOG(1) << "Average time per frame = " << timer.mean() << " milliseconds.";
 }
 
+TEST(CameraSimulator, testBatchedMeasurements)
+{
+  using namespace ze;
+
+  ViSimulator::Ptr sim = createViSimulationScenario1();
+  ViSensorData data;
+  bool success;
+  std::tie(data, success) = sim->getMeasurement();
+  ASSERT_TRUE(success);
+
+  ThreadPool pool(4);
+  TimerStatistics timer;
+  ViSensorDataVector batch;
+  {
+    auto t = timer.timeScope();
+    batch = sim->getMeasurements(200, &pool);
+  }
+  VLOG(1) << "Time for 200 frames = " << timer.mean() << " milliseconds.";
+  ASSERT_EQ(batch.size(), 200u);
+
+  // The batch continues the measurements of the previous call.
+  ViSensorData previous = data;
+  for (const ViSensorData& d : batch)
+  {
+    EXPECT_EQ(d.imu_stamps(0), previous.timestamp);
+    EXPECT_EQ(d.imu_stamps(d.imu_stamps.size()-1), d.timestamp);
+    ASSERT_EQ(d.cam_measurements.size(), previous.cam_measurements.size());
+
+    // Landmarks that were observed in the previous frame keep their track.
+    std::map<int32_t, int32_t> previous_tracks;
+    int32_t max_previous_track_id = -1;
+    for (const CameraMeasurements& m : previous.cam_measurements)
+    {
+      for (size_t i = 0u; i < m.global_landmark_ids_.size(); ++i)
+      {
+        previous_tracks[m.global_landmark_ids_[i]] = m.local_track_ids_[i];
+        max_previous_track_id = std::max(max_previous_track_id, m.local_track_ids_[i]);
+      }
+    }
+    for (const CameraMeasurements& m : d.cam_measurements)
+    {
+      ASSERT_EQ(m.local_track_ids_.size(), m.global_landmark_ids_.size());
+      for (size_t i = 0u; i < m.global_landmark_ids_.size(); ++i)
+      {
+        auto it = previous_tracks.find(m.global_landmark_ids_[i]);
+        if (it != previous_tracks.end())
+        {
+          EXPECT_EQ(m.local_track_ids_[i], it->second);
+        }
+        else
+        {
+          EXPECT_GT(m.local_track_ids_[i], max_previous_track_id);
+        }
+      }
+    }
+    previous = d;
+  }
+
+  // Sequential sampling continues after the batch.
+  std::tie(data, success) = sim->getMeasurement();
+  EXPECT_TRUE(success);
+  EXPECT_EQ(data.imu_stamps(0), batch.back().timestamp);
+}
+
+TEST(CameraSimulator, testSeededDeterminism)
+{
+  using namespace ze;
+
+  auto expectEqualData = [](const ViSensorData& a, const ViSensorData& b, real_t tol)
+  {
+    EXPECT_EQ(a.timestamp, b.timestamp);
+    EXPECT_TRUE(a.imu_stamps == b.imu_stamps);
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(a.imu_measurements, b.imu_measurements, tol));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(a.groundtruth.acc_bias, b.groundtruth.acc_bias, tol));
+    EXPECT_TRUE(EIGEN_MATRIX_NEAR(a.groundtruth.gyr_bias, b.groundtruth.gyr_bias, tol));
+    ASSERT_EQ(a.cam_measurements.size(), b.cam_measurements.size());
+    for (size_t i = 0u; i < a.cam_measurements.size(); ++i)
+    {
+      const CameraMeasurements& m_a = a.cam_measurements[i];
+      const CameraMeasurements& m_b = b.cam_measurements[i];
+      EXPECT_EQ(m_a.global_landmark_ids_, m_b.global_landmark_ids_);
+      EXPECT_EQ(m_a.local_track_ids_, m_b.local_track_ids_);
+      ASSERT_EQ(m_a.keypoints_.cols(), m_b.keypoints_.cols());
+      if (m_a.keypoints_.cols() > 0)
+      {
+        EXPECT_TRUE(EIGEN_MATRIX_NEAR(m_a.keypoints_, m_b.keypoints_, tol));
+      }
+    }
+  };
+
+  // Simulators of the same seeded scenario sample the same measurements,
+  // whether sequentially or in batches on any number of threads.
+  const uint32_t n = 100u;
+  ViSimulator::Ptr sim_sequential = createViSimulationScenario1(7u);
+  ViSimulator::Ptr sim_1 = createViSimulationScenario1(7u);
+  ViSimulator::Ptr sim_4 = createViSimulationScenario1(7u);
+  ThreadPool pool_1(1);
+  ThreadPool pool_4(4);
+  ViSensorDataVector batch_1 = sim_1->getMeasurements(n, &pool_1);
+  ViSensorDataVector batch_4 = sim_4->getMeasurements(n, &pool_4);
+  ASSERT_EQ(batch_1.size(), n);
+  ASSERT_EQ(batch_4.size(), n);
+  for (uint32_t k = 0u; k < n; ++k)
+  {
+    ViSensorData data;
+    bool success;
+    std::tie(data, success) = sim_sequential->getMeasurement();
+    ASSERT_TRUE(success);
+    // The batch evaluates the trajectory differently, up to rounding.
+    expectEqualData(data, batch_4[k], 1e-8);
+    expectEqualData(batch_1[k], batch_4[k], 0.0);
+  }
+
+  // Another seed gives other noise.
+  ViSimulator::Ptr sim_other = createViSimulationScenario1(8u);
+  ViSensorData data_other;
+  std::tie(data_other, std::ignore) = sim_other->getMeasurement();
+  EXPECT_FALSE(EIGEN_MATRIX_NEAR(data_other.imu_measurements,
+                                 batch_4[0].imu_measurements, 1e-8));
+}
+
 ZE_UNITTEST_ENTRYPOINT